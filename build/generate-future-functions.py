@@ -56,6 +56,7 @@ typedef_list = [
     typedef("size_t", None),
     typedef("ssize_t", None),
     typedef("uint32_t", None),
+    typedef("uint32_ptr", "uint32_t *"),
 
     # Const fundamental.
     typedef("const_char_ptr", "const char *"),
@@ -123,6 +124,16 @@ future_functions = [
                      param("bson_ptr", "reply"),
                      param("bson_error_ptr", "error")]),
 
+    future_function("bool",
+                    "mongoc_client_command_pipeline",
+                    [param("mongoc_client_ptr", "client"),
+                     param("const_char_ptr", "db_name"),
+                     param("const_bson_ptr_ptr", "commands"),
+                     param("size_t", "n_commands"),
+                     param("const_mongoc_read_prefs_ptr", "read_prefs"),
+                     param("bson_ptr", "replies"),
+                     param("bson_error_ptr", "errors")]),
+
     future_function("bool",
                     "mongoc_client_command_with_opts",
                     [param("mongoc_client_ptr", "client"),
@@ -281,6 +292,12 @@ future_functions = [
                     [param("mongoc_cursor_ptr", "cursor"),
                      param("const_bson_ptr_ptr", "doc")]),
 
+    future_function("bool",
+                    "mongoc_cursor_next_batch",
+                    [param("mongoc_cursor_ptr", "cursor"),
+                     param("const_bson_ptr_ptr", "batch"),
+                     param("uint32_ptr", "n_docs")]),
+
     future_function("char_ptr_ptr",
                     "mongoc_client_get_database_names_with_opts",
                     [param("mongoc_client_ptr", "client"),
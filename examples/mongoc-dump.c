@@ -42,7 +42,11 @@ mongoc_dump_collection (mongoc_client_t *client,
 {
    mongoc_collection_t *col;
    mongoc_cursor_t *cursor;
-   const bson_t *doc;
+   const bson_t *batch;
+   uint32_t n_docs;
+   bson_iter_t iter;
+   const uint8_t *data;
+   uint32_t len;
    bson_error_t error;
    bson_t query = BSON_INITIALIZER;
    FILE *stream;
@@ -65,12 +69,16 @@ mongoc_dump_collection (mongoc_client_t *client,
    col = mongoc_client_get_collection (client, database, collection);
    cursor = mongoc_collection_find_with_opts (col, &query, NULL, NULL);
 
-   while (mongoc_cursor_next (cursor, &doc)) {
-      if (BSON_UNLIKELY (doc->len !=
-                         fwrite (bson_get_data (doc), 1, doc->len, stream))) {
-         fprintf (stderr, "Failed to write %u bytes to %s\n", doc->len, path);
-         ret = EXIT_FAILURE;
-         goto cleanup;
+   /* copy each batch's documents to the file without parsing them */
+   while (mongoc_cursor_next_batch (cursor, &batch, &n_docs)) {
+      bson_iter_init (&iter, batch);
+      while (bson_iter_next (&iter)) {
+         bson_iter_document (&iter, &len, &data);
+         if (BSON_UNLIKELY (len != fwrite (data, 1, len, stream))) {
+            fprintf (stderr, "Failed to write %u bytes to %s\n", len, path);
+            ret = EXIT_FAILURE;
+            goto cleanup;
+         }
       }
    }
 
@@ -33,6 +33,7 @@
 BSON_BEGIN_DECLS
 
 typedef enum {
+   MONGOC_ASYNC_CMD_INITIATE,
    MONGOC_ASYNC_CMD_SETUP,
    MONGOC_ASYNC_CMD_SEND,
    MONGOC_ASYNC_CMD_RECV_LEN,
@@ -41,9 +42,20 @@ typedef enum {
    MONGOC_ASYNC_CMD_CANCELED_STATE,
 } mongoc_async_cmd_state_t;
 
+struct _mongoc_async_cmd;
+
+/* create a stream and begin a non-blocking connect, or set acmd->error */
+typedef mongoc_stream_t *(*mongoc_async_cmd_initiate_t) (
+   struct _mongoc_async_cmd *acmd);
+
 typedef struct _mongoc_async_cmd {
    mongoc_stream_t *stream;
 
+   /* if set, the cmd owns its stream and creates it when the delay passes */
+   mongoc_async_cmd_initiate_t initiator;
+   void *initiate_ctx;
+   int64_t initiate_delay_msec;
+
    mongoc_async_t *async;
    mongoc_async_cmd_state_t state;
    int events;
@@ -81,6 +93,19 @@ mongoc_async_cmd_new (mongoc_async_t *async,
                       void *cb_data,
                       int64_t timeout_msec);
 
+mongoc_async_cmd_t *
+mongoc_async_cmd_new_delayed (mongoc_async_t *async,
+                              mongoc_async_cmd_initiate_t initiator,
+                              void *initiate_ctx,
+                              int64_t initiate_delay_msec,
+                              mongoc_async_cmd_setup_t setup,
+                              void *setup_ctx,
+                              const char *dbname,
+                              const bson_t *cmd,
+                              mongoc_async_cmd_cb_t cb,
+                              void *cb_data,
+                              int64_t timeout_msec);
+
 void
 mongoc_async_cmd_destroy (mongoc_async_cmd_t *acmd);
 
@@ -38,6 +38,8 @@
 typedef mongoc_async_cmd_result_t (*_mongoc_async_cmd_phase_t) (
    mongoc_async_cmd_t *cmd);
 
+mongoc_async_cmd_result_t
+_mongoc_async_cmd_phase_initiate (mongoc_async_cmd_t *cmd);
 mongoc_async_cmd_result_t
 _mongoc_async_cmd_phase_setup (mongoc_async_cmd_t *cmd);
 mongoc_async_cmd_result_t
@@ -48,6 +50,7 @@ mongoc_async_cmd_result_t
 _mongoc_async_cmd_phase_recv_rpc (mongoc_async_cmd_t *cmd);
 
 static const _mongoc_async_cmd_phase_t gMongocCMDPhases[] = {
+   _mongoc_async_cmd_phase_initiate,
    _mongoc_async_cmd_phase_setup,
    _mongoc_async_cmd_phase_send,
    _mongoc_async_cmd_phase_recv_len,
@@ -95,6 +98,8 @@ mongoc_async_cmd_run (mongoc_async_cmd_t *acmd)
    phase_callback = gMongocCMDPhases[acmd->state];
    if (phase_callback) {
       result = phase_callback (acmd);
+   } else if (acmd->state == MONGOC_ASYNC_CMD_CANCELED_STATE) {
+      result = MONGOC_ASYNC_CMD_CANCELED;
    } else {
       result = MONGOC_ASYNC_CMD_ERROR;
    }
@@ -106,10 +111,11 @@ mongoc_async_cmd_run (mongoc_async_cmd_t *acmd)
    rtt_msec = (bson_get_monotonic_time () - acmd->cmd_started) / 1000;
 
    if (result == MONGOC_ASYNC_CMD_SUCCESS) {
-      acmd->cb (result, &acmd->reply, rtt_msec, acmd->data, &acmd->error);
+      acmd->cb (
+         acmd, result, &acmd->reply, rtt_msec, acmd->data, &acmd->error);
    } else {
       /* we're in ERROR, TIMEOUT, or CANCELED */
-      acmd->cb (result, NULL, rtt_msec, acmd->data, &acmd->error);
+      acmd->cb (acmd, result, NULL, rtt_msec, acmd->data, &acmd->error);
    }
 
    mongoc_async_cmd_destroy (acmd);
@@ -151,27 +157,24 @@ _mongoc_async_cmd_state_start (mongoc_async_cmd_t *acmd)
    acmd->events = POLLOUT;
 }
 
-mongoc_async_cmd_t *
-mongoc_async_cmd_new (mongoc_async_t *async,
-                      mongoc_stream_t *stream,
-                      mongoc_async_cmd_setup_t setup,
-                      void *setup_ctx,
-                      const char *dbname,
-                      const bson_t *cmd,
-                      mongoc_async_cmd_cb_t cb,
-                      void *cb_data,
-                      int64_t timeout_msec)
+static mongoc_async_cmd_t *
+_mongoc_async_cmd_new (mongoc_async_t *async,
+                       mongoc_async_cmd_setup_t setup,
+                       void *setup_ctx,
+                       const char *dbname,
+                       const bson_t *cmd,
+                       mongoc_async_cmd_cb_t cb,
+                       void *cb_data,
+                       int64_t timeout_msec)
 {
    mongoc_async_cmd_t *acmd;
 
    BSON_ASSERT (cmd);
    BSON_ASSERT (dbname);
-   BSON_ASSERT (stream);
 
    acmd = (mongoc_async_cmd_t *) bson_malloc0 (sizeof (*acmd));
    acmd->async = async;
    acmd->timeout_msec = timeout_msec;
-   acmd->stream = stream;
    acmd->setup = setup;
    acmd->setup_ctx = setup_ctx;
    acmd->cb = cb;
@@ -184,14 +187,76 @@ mongoc_async_cmd_new (mongoc_async_t *async,
 
    _mongoc_async_cmd_init_send (acmd, dbname);
 
-   _mongoc_async_cmd_state_start (acmd);
-
    async->ncmds++;
    DL_APPEND (async->cmds, acmd);
 
    return acmd;
 }
 
+mongoc_async_cmd_t *
+mongoc_async_cmd_new (mongoc_async_t *async,
+                      mongoc_stream_t *stream,
+                      mongoc_async_cmd_setup_t setup,
+                      void *setup_ctx,
+                      const char *dbname,
+                      const bson_t *cmd,
+                      mongoc_async_cmd_cb_t cb,
+                      void *cb_data,
+                      int64_t timeout_msec)
+{
+   mongoc_async_cmd_t *acmd;
+
+   BSON_ASSERT (stream);
+
+   acmd = _mongoc_async_cmd_new (
+      async, setup, setup_ctx, dbname, cmd, cb, cb_data, timeout_msec);
+   acmd->stream = stream;
+
+   _mongoc_async_cmd_state_start (acmd);
+
+   return acmd;
+}
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * mongoc_async_cmd_new_delayed --
+ *
+ *       Like mongoc_async_cmd_new, but mongoc_async_run calls @initiator
+ *       to create the stream once @initiate_delay_msec has passed. The
+ *       cmd destroys the stream unless the callback takes it by setting
+ *       acmd->stream to NULL. @timeout_msec counts from the initiation.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+mongoc_async_cmd_t *
+mongoc_async_cmd_new_delayed (mongoc_async_t *async,
+                              mongoc_async_cmd_initiate_t initiator,
+                              void *initiate_ctx,
+                              int64_t initiate_delay_msec,
+                              mongoc_async_cmd_setup_t setup,
+                              void *setup_ctx,
+                              const char *dbname,
+                              const bson_t *cmd,
+                              mongoc_async_cmd_cb_t cb,
+                              void *cb_data,
+                              int64_t timeout_msec)
+{
+   mongoc_async_cmd_t *acmd;
+
+   BSON_ASSERT (initiator);
+
+   acmd = _mongoc_async_cmd_new (
+      async, setup, setup_ctx, dbname, cmd, cb, cb_data, timeout_msec);
+   acmd->initiator = initiator;
+   acmd->initiate_ctx = initiate_ctx;
+   acmd->initiate_delay_msec = initiate_delay_msec;
+   acmd->state = MONGOC_ASYNC_CMD_INITIATE;
+   acmd->events = 0;
+
+   return acmd;
+}
 
 void
 mongoc_async_cmd_destroy (mongoc_async_cmd_t *acmd)
@@ -201,6 +266,10 @@ mongoc_async_cmd_destroy (mongoc_async_cmd_t *acmd)
    DL_DELETE (acmd->async->cmds, acmd);
    acmd->async->ncmds--;
 
+   if (acmd->initiator && acmd->stream) {
+      mongoc_stream_failed (acmd->stream);
+   }
+
    bson_destroy (&acmd->cmd);
 
    if (acmd->reply_needs_cleanup) {
@@ -213,6 +282,21 @@ mongoc_async_cmd_destroy (mongoc_async_cmd_t *acmd)
    bson_free (acmd);
 }
 
+mongoc_async_cmd_result_t
+_mongoc_async_cmd_phase_initiate (mongoc_async_cmd_t *acmd)
+{
+   acmd->stream = acmd->initiator (acmd);
+   if (!acmd->stream) {
+      return MONGOC_ASYNC_CMD_ERROR;
+   }
+
+   /* the timeout counts from the connect, not from the delay */
+   acmd->connect_started = bson_get_monotonic_time ();
+   _mongoc_async_cmd_state_start (acmd);
+
+   return MONGOC_ASYNC_CMD_IN_PROGRESS;
+}
+
 mongoc_async_cmd_result_t
 _mongoc_async_cmd_phase_setup (mongoc_async_cmd_t *acmd)
 {
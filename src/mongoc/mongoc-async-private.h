@@ -39,9 +39,11 @@ typedef enum {
    MONGOC_ASYNC_CMD_SUCCESS,
    MONGOC_ASYNC_CMD_ERROR,
    MONGOC_ASYNC_CMD_TIMEOUT,
+   MONGOC_ASYNC_CMD_CANCELED,
 } mongoc_async_cmd_result_t;
 
-typedef void (*mongoc_async_cmd_cb_t) (mongoc_async_cmd_result_t result,
+typedef void (*mongoc_async_cmd_cb_t) (struct _mongoc_async_cmd *acmd,
+                                       mongoc_async_cmd_result_t result,
                                        const bson_t *bson,
                                        int64_t rtt_msec,
                                        void *data,
@@ -19,6 +19,7 @@
 
 #include "mongoc-async-private.h"
 #include "mongoc-async-cmd-private.h"
+#include "mongoc-util-private.h"
 #include "utlist.h"
 #include "mongoc.h"
 
@@ -51,8 +52,10 @@ void
 mongoc_async_run (mongoc_async_t *async)
 {
    mongoc_async_cmd_t *acmd, *tmp;
+   mongoc_async_cmd_t **acmds_polled = NULL;
    mongoc_stream_poll_t *poller = NULL;
    int i;
+   int nstreams;
    ssize_t nactive;
    int64_t now;
    int64_t expire_at;
@@ -69,71 +72,104 @@ mongoc_async_run (mongoc_async_t *async)
    }
 
    while (async->ncmds) {
+      /* begin delayed connects that are due, report canceled cmds */
+      DL_FOREACH_SAFE (async->cmds, acmd, tmp)
+      {
+         if (acmd->state == MONGOC_ASYNC_CMD_CANCELED_STATE ||
+             (acmd->state == MONGOC_ASYNC_CMD_INITIATE &&
+              now >= acmd->connect_started +
+                        acmd->initiate_delay_msec * 1000)) {
+            mongoc_async_cmd_run (acmd);
+         }
+      }
+
+      if (!async->ncmds) {
+         break;
+      }
+
       /* ncmds grows if we discover a replica & start calling ismaster on it */
       if (poll_size < async->ncmds) {
          poller = (mongoc_stream_poll_t *) bson_realloc (
             poller, sizeof (*poller) * async->ncmds);
+         acmds_polled = (mongoc_async_cmd_t **) bson_realloc (
+            acmds_polled, sizeof (*acmds_polled) * async->ncmds);
 
          poll_size = async->ncmds;
       }
 
-      i = 0;
+      nstreams = 0;
       expire_at = INT64_MAX;
       DL_FOREACH (async->cmds, acmd)
       {
-         poller[i].stream = acmd->stream;
-         poller[i].events = acmd->events;
-         poller[i].revents = 0;
          BSON_ASSERT (acmd->connect_started > 0);
+
+         if (acmd->state == MONGOC_ASYNC_CMD_INITIATE) {
+            /* no stream yet, wake up when it's time to connect */
+            expire_at = BSON_MIN (
+               expire_at,
+               acmd->connect_started + acmd->initiate_delay_msec * 1000);
+            continue;
+         }
+
+         poller[nstreams].stream = acmd->stream;
+         poller[nstreams].events = acmd->events;
+         poller[nstreams].revents = 0;
+         acmds_polled[nstreams] = acmd;
          expire_at = BSON_MIN (
             expire_at, acmd->connect_started + acmd->timeout_msec * 1000);
-         i++;
+         nstreams++;
       }
 
       poll_timeout_msec = BSON_MAX (0, (expire_at - now) / 1000);
       BSON_ASSERT (poll_timeout_msec < INT32_MAX);
-      nactive =
-         mongoc_stream_poll (poller, async->ncmds, (int32_t) poll_timeout_msec);
-
-      if (nactive) {
-         i = 0;
-         DL_FOREACH_SAFE (async->cmds, acmd, tmp)
-         {
-            if (poller[i].revents & (POLLERR | POLLHUP)) {
-               int hup = poller[i].revents & POLLHUP;
-               if (acmd->state == MONGOC_ASYNC_CMD_SEND) {
-                  bson_set_error (&acmd->error,
-                                  MONGOC_ERROR_STREAM,
-                                  MONGOC_ERROR_STREAM_CONNECT,
-                                  hup ? "connection refused"
-                                      : "unknown connection error");
-               } else {
-                  bson_set_error (&acmd->error,
-                                  MONGOC_ERROR_STREAM,
-                                  MONGOC_ERROR_STREAM_SOCKET,
-                                  hup ? "connection closed"
-                                      : "unknown socket error");
-               }
-
-               acmd->state = MONGOC_ASYNC_CMD_ERROR_STATE;
-            }
 
-            if ((poller[i].revents & poller[i].events) ||
-                acmd->state == MONGOC_ASYNC_CMD_ERROR_STATE) {
-               mongoc_async_cmd_run (acmd);
-               nactive--;
-            }
+      if (nstreams) {
+         nactive = mongoc_stream_poll (
+            poller, (size_t) nstreams, (int32_t) poll_timeout_msec);
+      } else {
+         _mongoc_usleep (poll_timeout_msec * 1000);
+         nactive = 0;
+      }
 
-            if (!nactive) {
-               break;
+      /* callbacks may cancel other cmds, but only destroy their own */
+      for (i = 0; i < nstreams && nactive > 0; i++) {
+         acmd = acmds_polled[i];
+
+         if (acmd->state != MONGOC_ASYNC_CMD_CANCELED_STATE &&
+             (poller[i].revents & (POLLERR | POLLHUP))) {
+            int hup = poller[i].revents & POLLHUP;
+            if (acmd->state == MONGOC_ASYNC_CMD_SEND) {
+               bson_set_error (&acmd->error,
+                               MONGOC_ERROR_STREAM,
+                               MONGOC_ERROR_STREAM_CONNECT,
+                               hup ? "connection refused"
+                                   : "unknown connection error");
+            } else {
+               bson_set_error (&acmd->error,
+                               MONGOC_ERROR_STREAM,
+                               MONGOC_ERROR_STREAM_SOCKET,
+                               hup ? "connection closed"
+                                   : "unknown socket error");
             }
 
-            i++;
+            acmd->state = MONGOC_ASYNC_CMD_ERROR_STATE;
+         }
+
+         if ((poller[i].revents & poller[i].events) ||
+             acmd->state == MONGOC_ASYNC_CMD_ERROR_STATE) {
+            mongoc_async_cmd_run (acmd);
+            nactive--;
          }
       }
 
       DL_FOREACH_SAFE (async->cmds, acmd, tmp)
       {
+         /* not connecting yet, or reported at the top of the loop */
+         if (acmd->state == MONGOC_ASYNC_CMD_INITIATE ||
+             acmd->state == MONGOC_ASYNC_CMD_CANCELED_STATE) {
+            continue;
+         }
+
          if (now > acmd->connect_started + acmd->timeout_msec * 1000) {
             bson_set_error (&acmd->error,
                             MONGOC_ERROR_STREAM,
@@ -142,7 +178,8 @@ mongoc_async_run (mongoc_async_t *async)
                                ? "connection timeout"
                                : "socket timeout");
 
-            acmd->cb (MONGOC_ASYNC_CMD_TIMEOUT,
+            acmd->cb (acmd,
+                      MONGOC_ASYNC_CMD_TIMEOUT,
                       NULL,
                       (now - acmd->connect_started) / 1000,
                       acmd->data,
@@ -158,5 +195,6 @@ mongoc_async_run (mongoc_async_t *async)
 
    if (poll_size) {
       bson_free (poller);
+      bson_free (acmds_polled);
    }
 }
@@ -28,6 +28,9 @@
 
 BSON_BEGIN_DECLS
 
+/* connections a parallel bulk write uses if the caller doesn't say */
+#define MONGOC_BULK_PARALLEL_DEFAULT_CONNECTIONS 4
+
 struct _mongoc_bulk_operation_t {
    char *database;
    char *collection;
@@ -37,9 +40,16 @@ struct _mongoc_bulk_operation_t {
    mongoc_bulk_write_flags_t flags;
    uint32_t server_id;
    mongoc_array_t commands;
+   uint32_t n_operations;
    mongoc_write_result_t result;
    bool executed;
    int64_t operation_id;
+   /* the document mongoc_bulk_operation_insert_begin builds in place, at the
+    * end of the payload of the command at index writer_command */
+   bson_writer_t *writer;
+   bson_t *writer_document;
+   size_t writer_command;
+   bool writer_command_is_new;
 };
 
 
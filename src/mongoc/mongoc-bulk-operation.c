@@ -18,6 +18,8 @@
 #include "mongoc-bulk-operation.h"
 #include "mongoc-bulk-operation-private.h"
 #include "mongoc-client-private.h"
+#include "mongoc-client-pool.h"
+#include "mongoc-thread-private.h"
 #include "mongoc-trace-private.h"
 #include "mongoc-write-concern-private.h"
 #include "mongoc-util-private.h"
@@ -99,6 +101,10 @@ mongoc_bulk_operation_destroy (mongoc_bulk_operation_t *bulk) /* IN */
          _mongoc_write_command_destroy (command);
       }
 
+      if (bulk->writer) {
+         bson_writer_destroy (bulk->writer);
+      }
+
       bson_free (bulk->database);
       bson_free (bulk->collection);
       mongoc_write_concern_destroy (bulk->write_concern);
@@ -133,6 +139,87 @@ mongoc_bulk_operation_destroy (mongoc_bulk_operation_t *bulk) /* IN */
       };                                                                      \
    } while (0)
 
+/* a document built in place must be finished before anything else is added */
+#define BULK_RETURN_IF_INSERT_BEGUN                                        \
+   do {                                                                    \
+      if (bulk->writer) {                                                  \
+         bson_set_error (error,                                            \
+                         MONGOC_ERROR_COMMAND,                             \
+                         MONGOC_ERROR_COMMAND_INVALID_ARG,                 \
+                         "mongoc_bulk_operation_insert_end() must be "     \
+                         "called before another operation is added.");     \
+         return false;                                                     \
+      }                                                                    \
+   } while (0)
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * _mongoc_bulk_operation_find_command --
+ *
+ *       Find the command to append an operation of @type with @opts to.
+ *       An ordered bulk only appends to its last command. An unordered
+ *       bulk appends to the latest command of the same type whose
+ *       operations are compatible, so that interleaved inserts, updates,
+ *       and deletes are sent in as few commands as possible.
+ *
+ * Returns:
+ *       A command, or NULL if the caller must start a new one.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+static mongoc_write_command_t *
+_mongoc_bulk_operation_find_command (mongoc_bulk_operation_t *bulk,
+                                     int type,
+                                     const bson_t *opts)
+{
+   mongoc_write_command_t *command;
+   size_t i;
+
+   /* callers check that no document is being built in place */
+   BSON_ASSERT (!bulk->writer);
+
+   for (i = bulk->commands.len; i > 0; i--) {
+      command =
+         &_mongoc_array_index (&bulk->commands, mongoc_write_command_t, i - 1);
+
+      if (bulk->flags.ordered) {
+         return command->type == type ? command : NULL;
+      }
+
+      if (command->type == type &&
+          _mongoc_write_command_is_compatible (command, opts)) {
+         return command;
+      }
+   }
+
+   return NULL;
+}
+
+
+/* add a command to the bulk, or count an operation appended to one. an
+ * unordered bulk's commands record each operation's index, which errors and
+ * upserts are reported with */
+static void
+_mongoc_bulk_operation_appended (mongoc_bulk_operation_t *bulk,
+                                 mongoc_write_command_t *command,
+                                 bool is_new)
+{
+   if (is_new) {
+      _mongoc_array_append_val (&bulk->commands, *command);
+      command = &_mongoc_array_index (
+         &bulk->commands, mongoc_write_command_t, bulk->commands.len - 1);
+   }
+
+   if (!bulk->flags.ordered) {
+      _mongoc_array_append_val (&command->indexes, bulk->n_operations);
+   }
+
+   bulk->n_operations++;
+}
+
 
 bool
 _mongoc_bulk_operation_remove_with_opts (mongoc_bulk_operation_t *bulk,
@@ -149,20 +236,21 @@ _mongoc_bulk_operation_remove_with_opts (mongoc_bulk_operation_t *bulk,
    BSON_ASSERT (selector);
 
    BULK_RETURN_IF_PRIOR_ERROR;
+   BULK_RETURN_IF_INSERT_BEGUN;
 
-   if (bulk->commands.len) {
-      last = &_mongoc_array_index (
-         &bulk->commands, mongoc_write_command_t, bulk->commands.len - 1);
-      if (last->type == MONGOC_WRITE_COMMAND_DELETE) {
-         _mongoc_write_command_delete_append (last, selector, opts);
-         RETURN (true);
-      }
+   last = _mongoc_bulk_operation_find_command (
+      bulk, MONGOC_WRITE_COMMAND_DELETE, opts);
+
+   if (last) {
+      _mongoc_write_command_delete_append (last, selector, opts);
+      _mongoc_bulk_operation_appended (bulk, last, false);
+      RETURN (true);
    }
 
    _mongoc_write_command_init_delete (
       &command, selector, NULL, opts, bulk->flags, bulk->operation_id);
 
-   _mongoc_array_append_val (&bulk->commands, command);
+   _mongoc_bulk_operation_appended (bulk, &command, true);
 
    RETURN (true);
 }
@@ -352,20 +440,20 @@ mongoc_bulk_operation_insert_with_opts (mongoc_bulk_operation_t *bulk,
    BSON_ASSERT (document);
 
    BULK_RETURN_IF_PRIOR_ERROR;
+   BULK_RETURN_IF_INSERT_BEGUN;
 
    if (!_mongoc_validate_new_document (
           document, _mongoc_default_insert_vflags, error)) {
       return false;
    }
 
-   if (bulk->commands.len) {
-      last = &_mongoc_array_index (
-         &bulk->commands, mongoc_write_command_t, bulk->commands.len - 1);
+   last = _mongoc_bulk_operation_find_command (
+      bulk, MONGOC_WRITE_COMMAND_INSERT, opts);
 
-      if (last->type == MONGOC_WRITE_COMMAND_INSERT) {
-         _mongoc_write_command_insert_append (last, document);
-         return true;
-      }
+   if (last) {
+      _mongoc_write_command_insert_append (last, document);
+      _mongoc_bulk_operation_appended (bulk, last, false);
+      return true;
    }
 
    _mongoc_write_command_init_insert (
@@ -376,11 +464,154 @@ mongoc_bulk_operation_insert_with_opts (mongoc_bulk_operation_t *bulk,
       bulk->operation_id,
       !mongoc_write_concern_is_acknowledged (bulk->write_concern));
 
-   _mongoc_array_append_val (&bulk->commands, command);
+   _mongoc_bulk_operation_appended (bulk, &command, true);
 
    return true;
 }
 
+/*
+ *--------------------------------------------------------------------------
+ *
+ * mongoc_bulk_operation_insert_begin --
+ *
+ *       Start a document to insert, built in place in the payload of the
+ *       bulk's insert command. Set @document to a bson_t that fields can
+ *       be appended to until mongoc_bulk_operation_insert_end is called.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+bool
+mongoc_bulk_operation_insert_begin (mongoc_bulk_operation_t *bulk,
+                                    const bson_t *opts,
+                                    bson_t **document,
+                                    bson_error_t *error)
+{
+   mongoc_write_command_t command = {0};
+   mongoc_write_command_t *last;
+   mongoc_buffer_t *payload;
+
+   ENTRY;
+
+   BSON_ASSERT (bulk);
+   BSON_ASSERT (document);
+
+   BULK_RETURN_IF_PRIOR_ERROR;
+
+   if (bulk->writer) {
+      bson_set_error (error,
+                      MONGOC_ERROR_COMMAND,
+                      MONGOC_ERROR_COMMAND_INVALID_ARG,
+                      "mongoc_bulk_operation_insert_end() must be called "
+                      "before another document is begun.");
+      RETURN (false);
+   }
+
+   last = _mongoc_bulk_operation_find_command (
+      bulk, MONGOC_WRITE_COMMAND_INSERT, opts);
+
+   bulk->writer_command_is_new = !last;
+   if (!last) {
+      _mongoc_write_command_init_insert (
+         &command,
+         NULL,
+         opts,
+         bulk->flags,
+         bulk->operation_id,
+         !mongoc_write_concern_is_acknowledged (bulk->write_concern));
+
+      _mongoc_array_append_val (&bulk->commands, command);
+      last = &_mongoc_array_index (
+         &bulk->commands, mongoc_write_command_t, bulk->commands.len - 1);
+   }
+
+   bulk->writer_command =
+      (size_t) (last - (mongoc_write_command_t *) bulk->commands.data);
+
+   payload = &last->payload;
+   bulk->writer = bson_writer_new (&payload->data,
+                                   &payload->datalen,
+                                   (size_t) payload->off + payload->len,
+                                   payload->realloc_func,
+                                   payload->realloc_data);
+
+   BSON_ASSERT (bson_writer_begin (bulk->writer, &bulk->writer_document));
+   *document = bulk->writer_document;
+
+   RETURN (true);
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * mongoc_bulk_operation_insert_end --
+ *
+ *       Finish the document begun by mongoc_bulk_operation_insert_begin,
+ *       adding an "_id" if it has none. If the document is invalid it is
+ *       discarded.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+bool
+mongoc_bulk_operation_insert_end (mongoc_bulk_operation_t *bulk,
+                                  bson_error_t *error)
+{
+   mongoc_write_command_t *command;
+   bson_t *document;
+   bson_iter_t iter;
+   bson_oid_t oid;
+   bool ret;
+
+   ENTRY;
+
+   BSON_ASSERT (bulk);
+
+   if (!bulk->writer) {
+      bson_set_error (error,
+                      MONGOC_ERROR_COMMAND,
+                      MONGOC_ERROR_COMMAND_INVALID_ARG,
+                      "mongoc_bulk_operation_insert_begin() must be called "
+                      "first.");
+      RETURN (false);
+   }
+
+   command = &_mongoc_array_index (
+      &bulk->commands, mongoc_write_command_t, bulk->writer_command);
+   document = bulk->writer_document;
+
+   ret = _mongoc_validate_new_document (
+      document, _mongoc_default_insert_vflags, error);
+
+   if (ret) {
+      if (!bson_iter_init_find (&iter, document, "_id")) {
+         bson_oid_init (&oid, NULL);
+         BSON_APPEND_OID (document, "_id", &oid);
+      }
+
+      bson_writer_end (bulk->writer);
+      command->payload.len =
+         bson_writer_get_length (bulk->writer) - (size_t) command->payload.off;
+      command->n_documents++;
+      _mongoc_bulk_operation_appended (bulk, command, false);
+   } else {
+      bson_writer_rollback (bulk->writer);
+
+      if (bulk->writer_command_is_new) {
+         _mongoc_write_command_destroy (command);
+         bulk->commands.len--;
+      }
+   }
+
+   bson_writer_destroy (bulk->writer);
+   bulk->writer = NULL;
+   bulk->writer_document = NULL;
+
+   RETURN (ret);
+}
+
+
 bool
 _mongoc_bulk_operation_replace_one_with_opts (mongoc_bulk_operation_t *bulk,
                                               const bson_t *selector,
@@ -394,6 +625,7 @@ _mongoc_bulk_operation_replace_one_with_opts (mongoc_bulk_operation_t *bulk,
    ENTRY;
 
    BULK_RETURN_IF_PRIOR_ERROR;
+   BULK_RETURN_IF_INSERT_BEGUN;
 
    BSON_ASSERT (bulk);
    BSON_ASSERT (selector);
@@ -404,18 +636,18 @@ _mongoc_bulk_operation_replace_one_with_opts (mongoc_bulk_operation_t *bulk,
       RETURN (false);
    }
 
-   if (bulk->commands.len) {
-      last = &_mongoc_array_index (
-         &bulk->commands, mongoc_write_command_t, bulk->commands.len - 1);
-      if (last->type == MONGOC_WRITE_COMMAND_UPDATE) {
-         _mongoc_write_command_update_append (last, selector, document, opts);
-         RETURN (true);
-      }
+   last = _mongoc_bulk_operation_find_command (
+      bulk, MONGOC_WRITE_COMMAND_UPDATE, opts);
+
+   if (last) {
+      _mongoc_write_command_update_append (last, selector, document, opts);
+      _mongoc_bulk_operation_appended (bulk, last, false);
+      RETURN (true);
    }
 
    _mongoc_write_command_init_update (
       &command, selector, document, opts, bulk->flags, bulk->operation_id);
-   _mongoc_array_append_val (&bulk->commands, command);
+   _mongoc_bulk_operation_appended (bulk, &command, true);
 
    RETURN (true);
 }
@@ -506,24 +738,25 @@ _mongoc_bulk_operation_update_with_opts (mongoc_bulk_operation_t *bulk,
    BSON_ASSERT (document);
 
    BULK_RETURN_IF_PRIOR_ERROR;
+   BULK_RETURN_IF_INSERT_BEGUN;
 
    if (!_mongoc_validate_update (
           document, _mongoc_default_update_vflags, error)) {
       RETURN (false);
    }
 
-   if (bulk->commands.len) {
-      last = &_mongoc_array_index (
-         &bulk->commands, mongoc_write_command_t, bulk->commands.len - 1);
-      if (last->type == MONGOC_WRITE_COMMAND_UPDATE) {
-         _mongoc_write_command_update_append (last, selector, document, opts);
-         RETURN (true);
-      }
+   last = _mongoc_bulk_operation_find_command (
+      bulk, MONGOC_WRITE_COMMAND_UPDATE, opts);
+
+   if (last) {
+      _mongoc_write_command_update_append (last, selector, document, opts);
+      _mongoc_bulk_operation_appended (bulk, last, false);
+      RETURN (true);
    }
 
    _mongoc_write_command_init_update (
       &command, selector, document, opts, bulk->flags, bulk->operation_id);
-   _mongoc_array_append_val (&bulk->commands, command);
+   _mongoc_bulk_operation_appended (bulk, &command, true);
 
    RETURN (true);
 }
@@ -664,57 +897,46 @@ mongoc_bulk_operation_update_one (mongoc_bulk_operation_t *bulk,
    EXIT;
 }
 
-uint32_t
-mongoc_bulk_operation_execute (mongoc_bulk_operation_t *bulk, /* IN */
-                               bson_t *reply,                 /* OUT */
-                               bson_error_t *error)           /* OUT */
+/* reset the result of a previous execution, and check that the bulk can be
+ * executed */
+static bool
+_mongoc_bulk_operation_start (mongoc_bulk_operation_t *bulk,
+                              bson_error_t *error)
 {
-   mongoc_cluster_t *cluster;
-   mongoc_write_command_t *command;
-   mongoc_server_stream_t *server_stream;
-   bool ret;
-   uint32_t offset = 0;
-   int i;
-
-   ENTRY;
-
-   BSON_ASSERT (bulk);
-
-   if (reply) {
-      bson_init (reply);
-   }
-
-   if (!bulk->client) {
-      bson_set_error (error,
-                      MONGOC_ERROR_COMMAND,
-                      MONGOC_ERROR_COMMAND_INVALID_ARG,
-                      "mongoc_bulk_operation_execute() requires a client "
-                      "and one has not been set.");
-      RETURN (false);
-   }
-   cluster = &bulk->client->cluster;
+   bool counts_only;
 
    if (bulk->executed) {
+      counts_only = bulk->result.counts_only;
       _mongoc_write_result_destroy (&bulk->result);
       _mongoc_write_result_init (&bulk->result);
+      bulk->result.counts_only = counts_only;
    }
 
    bulk->executed = true;
 
+   if (bulk->writer) {
+      bson_set_error (error,
+                      MONGOC_ERROR_COMMAND,
+                      MONGOC_ERROR_COMMAND_INVALID_ARG,
+                      "mongoc_bulk_operation_insert_end() must be called "
+                      "before executing the bulk.");
+      return false;
+   }
+
    if (!bulk->database) {
       bson_set_error (error,
                       MONGOC_ERROR_COMMAND,
                       MONGOC_ERROR_COMMAND_INVALID_ARG,
                       "mongoc_bulk_operation_execute() requires a database "
                       "and one has not been set.");
-      RETURN (false);
+      return false;
    } else if (!bulk->collection) {
       bson_set_error (error,
                       MONGOC_ERROR_COMMAND,
                       MONGOC_ERROR_COMMAND_INVALID_ARG,
                       "mongoc_bulk_operation_execute() requires a collection "
                       "and one has not been set.");
-      RETURN (false);
+      return false;
    }
 
    /* error stored by functions like mongoc_bulk_operation_insert that
@@ -724,7 +946,7 @@ mongoc_bulk_operation_execute (mongoc_bulk_operation_t *bulk, /* IN */
          memcpy (error, &bulk->result.error, sizeof (bson_error_t));
       }
 
-      RETURN (false);
+      return false;
    }
 
    if (!bulk->commands.len) {
@@ -732,6 +954,44 @@ mongoc_bulk_operation_execute (mongoc_bulk_operation_t *bulk, /* IN */
                       MONGOC_ERROR_COMMAND,
                       MONGOC_ERROR_COMMAND_INVALID_ARG,
                       "Cannot do an empty bulk write");
+      return false;
+   }
+
+   return true;
+}
+
+
+uint32_t
+mongoc_bulk_operation_execute (mongoc_bulk_operation_t *bulk, /* IN */
+                               bson_t *reply,                 /* OUT */
+                               bson_error_t *error)           /* OUT */
+{
+   mongoc_cluster_t *cluster;
+   mongoc_write_command_t *command;
+   mongoc_server_stream_t *server_stream;
+   bool ret;
+   uint32_t offset = 0;
+   int i;
+
+   ENTRY;
+
+   BSON_ASSERT (bulk);
+
+   if (reply) {
+      bson_init (reply);
+   }
+
+   if (!bulk->client) {
+      bson_set_error (error,
+                      MONGOC_ERROR_COMMAND,
+                      MONGOC_ERROR_COMMAND_INVALID_ARG,
+                      "mongoc_bulk_operation_execute() requires a client "
+                      "and one has not been set.");
+      RETURN (false);
+   }
+   cluster = &bulk->client->cluster;
+
+   if (!_mongoc_bulk_operation_start (bulk, error)) {
       RETURN (false);
    }
 
@@ -750,13 +1010,14 @@ mongoc_bulk_operation_execute (mongoc_bulk_operation_t *bulk, /* IN */
       command =
          &_mongoc_array_index (&bulk->commands, mongoc_write_command_t, i);
 
+      /* an unordered bulk's commands map their operations to indexes */
       _mongoc_write_command_execute (command,
                                      bulk->client,
                                      server_stream,
                                      bulk->database,
                                      bulk->collection,
                                      bulk->write_concern,
-                                     offset,
+                                     command->indexes.len ? 0 : offset,
                                      bulk->session,
                                      &bulk->result);
 
@@ -773,6 +1034,10 @@ mongoc_bulk_operation_execute (mongoc_bulk_operation_t *bulk, /* IN */
    }
 
 cleanup:
+   if (!bulk->flags.ordered && bulk->commands.len > 1) {
+      _mongoc_write_result_sort_by_index (&bulk->result);
+   }
+
    ret = MONGOC_WRITE_RESULT_COMPLETE (&bulk->result,
                                        bulk->client->error_api_version,
                                        bulk->write_concern,
@@ -783,6 +1048,307 @@ cleanup:
    RETURN (ret ? bulk->server_id : 0);
 }
 
+
+/* state shared by the threads of mongoc_bulk_operation_execute_parallel */
+typedef struct {
+   mongoc_bulk_operation_t *bulk;
+   mongoc_mutex_t mutex;
+   /* the next operations to send */
+   size_t command;
+   uint32_t document;
+   uint32_t payload_offset;
+   int32_t max_batch_size;
+   int32_t max_batch_bytes;
+   bool stop;
+} mongoc_bulk_parallel_t;
+
+
+typedef struct {
+   mongoc_bulk_parallel_t *parallel;
+   mongoc_client_t *client;
+   mongoc_thread_t thread;
+} mongoc_bulk_parallel_worker_t;
+
+
+/* claim the next batch of operations, the caller holds the lock */
+static bool
+_mongoc_bulk_parallel_next (mongoc_bulk_parallel_t *parallel,
+                            mongoc_write_command_t **command,
+                            uint32_t *first_document,
+                            uint32_t *n_documents,
+                            uint32_t *payload_offset,
+                            uint32_t *len)
+{
+   mongoc_bulk_operation_t *bulk;
+   mongoc_write_command_t *c;
+   int32_t doc_len;
+
+   bulk = parallel->bulk;
+
+   while (!parallel->stop && parallel->command < bulk->commands.len) {
+      c = &_mongoc_array_index (
+         &bulk->commands, mongoc_write_command_t, parallel->command);
+
+      if (parallel->document == c->n_documents) {
+         parallel->command++;
+         parallel->document = 0;
+         parallel->payload_offset = 0;
+         continue;
+      }
+
+      *command = c;
+      *first_document = parallel->document;
+      *payload_offset = parallel->payload_offset;
+      *n_documents = 0;
+      *len = 0;
+
+      /* at least one operation, oversized ones fail when they're sent */
+      while (parallel->document < c->n_documents &&
+             *n_documents < (uint32_t) parallel->max_batch_size) {
+         memcpy (&doc_len, c->payload.data + parallel->payload_offset, 4);
+         doc_len = BSON_UINT32_FROM_LE (doc_len);
+
+         if (*n_documents &&
+             *len + (uint32_t) doc_len > (uint32_t) parallel->max_batch_bytes) {
+            break;
+         }
+
+         *len += (uint32_t) doc_len;
+         (*n_documents)++;
+         parallel->document++;
+         parallel->payload_offset += (uint32_t) doc_len;
+      }
+
+      return true;
+   }
+
+   return false;
+}
+
+
+/* send batches of operations on one client's connection until none are
+ * left, or until a batch fails in a way that must stop the bulk */
+static void *
+_mongoc_bulk_parallel_worker (void *data)
+{
+   mongoc_bulk_parallel_worker_t *worker;
+   mongoc_bulk_parallel_t *parallel;
+   mongoc_bulk_operation_t *bulk;
+   mongoc_write_command_t *command;
+   mongoc_write_command_t slice;
+   mongoc_write_result_t result;
+   mongoc_server_stream_t *server_stream;
+   uint32_t first_document;
+   uint32_t n_documents;
+   uint32_t payload_offset;
+   uint32_t len;
+   bool found;
+
+   worker = (mongoc_bulk_parallel_worker_t *) data;
+   parallel = worker->parallel;
+   bulk = parallel->bulk;
+
+   for (;;) {
+      mongoc_mutex_lock (&parallel->mutex);
+      found = _mongoc_bulk_parallel_next (parallel,
+                                          &command,
+                                          &first_document,
+                                          &n_documents,
+                                          &payload_offset,
+                                          &len);
+      mongoc_mutex_unlock (&parallel->mutex);
+
+      if (!found) {
+         break;
+      }
+
+      _mongoc_write_command_init_slice (
+         &slice, command, first_document, n_documents, payload_offset, len);
+      _mongoc_write_result_init (&result);
+      result.counts_only = bulk->result.counts_only;
+
+      server_stream = mongoc_cluster_stream_for_server (
+         &worker->client->cluster, bulk->server_id, true, &result.error);
+
+      if (server_stream) {
+         _mongoc_write_command_execute (&slice,
+                                        worker->client,
+                                        server_stream,
+                                        bulk->database,
+                                        bulk->collection,
+                                        bulk->write_concern,
+                                        0,
+                                        NULL,
+                                        &result);
+         mongoc_server_stream_cleanup (server_stream);
+      } else {
+         result.failed = true;
+         result.must_stop = true;
+      }
+
+      mongoc_mutex_lock (&parallel->mutex);
+      _mongoc_write_result_append (&bulk->result, &result);
+      if (result.must_stop) {
+         parallel->stop = true;
+      }
+      mongoc_mutex_unlock (&parallel->mutex);
+
+      _mongoc_write_result_destroy (&result);
+      _mongoc_write_command_destroy (&slice);
+   }
+
+   return NULL;
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * mongoc_bulk_operation_execute_parallel --
+ *
+ *       Execute an unordered bulk on up to @max_connections clients from
+ *       @pool at once. The bulk's operations are split into batches that
+ *       fit the server's limits, and each client sends the next batch as
+ *       soon as its previous one is acknowledged.
+ *
+ *       Ordered bulks, and bulks in a session, are executed serially.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+uint32_t
+mongoc_bulk_operation_execute_parallel (mongoc_bulk_operation_t *bulk,
+                                        mongoc_client_pool_t *pool,
+                                        uint32_t max_connections,
+                                        bson_t *reply,
+                                        bson_error_t *error)
+{
+   mongoc_bulk_parallel_t parallel = {0};
+   mongoc_bulk_parallel_worker_t *workers;
+   mongoc_server_stream_t *server_stream;
+   mongoc_write_command_t *command;
+   mongoc_client_t *client;
+   int32_t error_api_version;
+   uint32_t n_batches = 0;
+   uint32_t n_workers;
+   uint32_t i;
+   bool ret;
+
+   ENTRY;
+
+   BSON_ASSERT (bulk);
+   BSON_ASSERT (pool);
+
+   if (bulk->flags.ordered || bulk->session || max_connections == 1) {
+      if (bulk->client) {
+         RETURN (mongoc_bulk_operation_execute (bulk, reply, error));
+      }
+
+      bulk->client = mongoc_client_pool_pop (pool);
+      bulk->operation_id = ++bulk->client->cluster.operation_id;
+      ret = (bool) (mongoc_bulk_operation_execute (bulk, reply, error));
+      mongoc_client_pool_push (pool, bulk->client);
+      bulk->client = NULL;
+
+      RETURN (ret ? bulk->server_id : 0);
+   }
+
+   if (reply) {
+      bson_init (reply);
+   }
+
+   if (!_mongoc_bulk_operation_start (bulk, error)) {
+      RETURN (0);
+   }
+
+   if (!max_connections) {
+      max_connections = MONGOC_BULK_PARALLEL_DEFAULT_CONNECTIONS;
+   }
+
+   client = mongoc_client_pool_pop (pool);
+   error_api_version = client->error_api_version;
+
+   if (bulk->server_id) {
+      server_stream = mongoc_cluster_stream_for_server (
+         &client->cluster, bulk->server_id, true, &bulk->result.error);
+   } else {
+      server_stream = mongoc_cluster_stream_for_writes (&client->cluster,
+                                                        &bulk->result.error);
+   }
+
+   if (!server_stream) {
+      mongoc_client_pool_push (pool, client);
+      bulk->result.failed = true;
+      GOTO (done);
+   }
+
+   bulk->server_id = server_stream->sd->id;
+   parallel.bulk = bulk;
+   _mongoc_write_command_batch_limits (
+      server_stream, &parallel.max_batch_size, &parallel.max_batch_bytes);
+   mongoc_server_stream_cleanup (server_stream);
+   mongoc_mutex_init (&parallel.mutex);
+
+   /* no more connections than batches */
+   for (i = 0; i < bulk->commands.len; i++) {
+      command =
+         &_mongoc_array_index (&bulk->commands, mongoc_write_command_t, i);
+      n_batches += (command->n_documents + parallel.max_batch_size - 1) /
+                   parallel.max_batch_size;
+   }
+
+   n_workers = BSON_MAX (1, BSON_MIN (max_connections, n_batches));
+   workers = (mongoc_bulk_parallel_worker_t *) bson_malloc0 (
+      n_workers * sizeof *workers);
+
+   workers[0].parallel = &parallel;
+   workers[0].client = client;
+
+   /* don't wait for clients other threads are using */
+   for (i = 1; i < n_workers; i++) {
+      workers[i].client = mongoc_client_pool_try_pop (pool);
+      if (!workers[i].client) {
+         break;
+      }
+
+      workers[i].parallel = &parallel;
+      if (mongoc_thread_create (&workers[i].thread,
+                                _mongoc_bulk_parallel_worker,
+                                &workers[i]) != 0) {
+         /* this thread sends the batches with the workers that started */
+         mongoc_client_pool_push (pool, workers[i].client);
+         break;
+      }
+   }
+
+   n_workers = i;
+   _mongoc_bulk_parallel_worker (&workers[0]);
+
+   for (i = 1; i < n_workers; i++) {
+      mongoc_thread_join (workers[i].thread);
+   }
+
+   for (i = 0; i < n_workers; i++) {
+      mongoc_client_pool_push (pool, workers[i].client);
+   }
+
+   bson_free (workers);
+   mongoc_mutex_destroy (&parallel.mutex);
+
+   _mongoc_write_result_sort_by_index (&bulk->result);
+
+done:
+   ret = MONGOC_WRITE_RESULT_COMPLETE (&bulk->result,
+                                       error_api_version,
+                                       bulk->write_concern,
+                                       MONGOC_ERROR_COMMAND /* err domain */,
+                                       reply,
+                                       error);
+
+   RETURN (ret ? bulk->server_id : 0);
+}
+
+
 void
 mongoc_bulk_operation_set_write_concern (
    mongoc_bulk_operation_t *bulk, const mongoc_write_concern_t *write_concern)
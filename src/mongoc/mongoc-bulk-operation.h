@@ -33,6 +33,7 @@ BSON_BEGIN_DECLS
 
 /* forward decl */
 struct _mongoc_client_session_t;
+struct _mongoc_client_pool_t;
 
 typedef struct _mongoc_bulk_operation_t mongoc_bulk_operation_t;
 typedef struct _mongoc_bulk_write_flags_t mongoc_bulk_write_flags_t;
@@ -44,6 +45,12 @@ MONGOC_EXPORT (uint32_t)
 mongoc_bulk_operation_execute (mongoc_bulk_operation_t *bulk,
                                bson_t *reply,
                                bson_error_t *error);
+MONGOC_EXPORT (uint32_t)
+mongoc_bulk_operation_execute_parallel (mongoc_bulk_operation_t *bulk,
+                                        struct _mongoc_client_pool_t *pool,
+                                        uint32_t max_connections,
+                                        bson_t *reply,
+                                        bson_error_t *error);
 MONGOC_EXPORT (void)
 mongoc_bulk_operation_delete (mongoc_bulk_operation_t *bulk,
                               const bson_t *selector)
@@ -60,6 +67,14 @@ mongoc_bulk_operation_insert_with_opts (mongoc_bulk_operation_t *bulk,
                                         const bson_t *document,
                                         const bson_t *opts,
                                         bson_error_t *error); /* OUT */
+MONGOC_EXPORT (bool)
+mongoc_bulk_operation_insert_begin (mongoc_bulk_operation_t *bulk,
+                                    const bson_t *opts,
+                                    bson_t **document,
+                                    bson_error_t *error); /* OUT */
+MONGOC_EXPORT (bool)
+mongoc_bulk_operation_insert_end (mongoc_bulk_operation_t *bulk,
+                                  bson_error_t *error); /* OUT */
 MONGOC_EXPORT (void)
 mongoc_bulk_operation_remove (mongoc_bulk_operation_t *bulk,
                               const bson_t *selector);
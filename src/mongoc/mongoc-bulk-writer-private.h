@@ -0,0 +1,73 @@
+/*
+ * Copyright 2018-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef MONGOC_BULK_WRITER_PRIVATE_H
+#define MONGOC_BULK_WRITER_PRIVATE_H
+
+#if !defined(MONGOC_COMPILATION)
+#error "Only <mongoc.h> can be included directly."
+#endif
+
+#include <bson.h>
+
+#include "mongoc-array-private.h"
+#include "mongoc-bulk-writer.h"
+#include "mongoc-thread-private.h"
+#include "mongoc-write-command-private.h"
+
+
+BSON_BEGIN_DECLS
+
+
+struct _mongoc_bulk_writer_t {
+   mongoc_client_t *client;
+   char *database;
+   char *collection;
+   mongoc_write_concern_t *write_concern;
+   mongoc_bulk_write_flags_t flags;
+   int64_t operation_id;
+   /* batches queued or being sent by the thread, 0 to send from the
+    * caller's thread */
+   uint32_t max_in_flight;
+   /* the server's limits, 0 until the first operation is added */
+   int32_t max_batch_size;
+   int32_t max_batch_bytes;
+   uint32_t server_id;
+   /* the batch being filled, and the index of its first operation */
+   mongoc_write_command_t command;
+   bool has_command;
+   uint32_t command_offset;
+   uint32_t n_operations;
+   /* guards queue, stop and closing once the thread is started */
+   mongoc_mutex_t mutex;
+   mongoc_cond_t cond;
+   mongoc_array_t queue;
+   mongoc_thread_t thread;
+   bool has_thread;
+   bool closing;
+   /* a batch failed and no more are sent */
+   bool stop;
+   bool finished;
+   /* written by the thread until it's joined */
+   mongoc_write_result_t result;
+};
+
+
+BSON_END_DECLS
+
+
+#endif /* MONGOC_BULK_WRITER_PRIVATE_H */
@@ -0,0 +1,537 @@
+/*
+ * Copyright 2018-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "mongoc-bulk-writer-private.h"
+#include "mongoc-client-private.h"
+#include "mongoc-collection-private.h"
+#include "mongoc-error.h"
+#include "mongoc-server-stream-private.h"
+#include "mongoc-trace-private.h"
+#include "mongoc-util-private.h"
+#include "mongoc-write-concern-private.h"
+
+#undef MONGOC_LOG_DOMAIN
+#define MONGOC_LOG_DOMAIN "bulk-writer"
+
+
+/* a full batch, and the index of its first operation */
+typedef struct {
+   mongoc_write_command_t command;
+   uint32_t offset;
+} mongoc_bulk_writer_batch_t;
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * mongoc_bulk_writer_new --
+ *
+ *       Create a writer that inserts documents into @collection in
+ *       batches, sending each batch as soon as it's full instead of
+ *       holding every operation until the end like a bulk operation.
+ *
+ *       @opts may contain "ordered", "writeConcern", "resultDetail",
+ *       and "maxInFlight", the number of full batches that may wait for
+ *       or be sent by a background thread while the caller adds more.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+mongoc_bulk_writer_t *
+mongoc_bulk_writer_new (mongoc_collection_t *collection, const bson_t *opts)
+{
+   mongoc_bulk_writer_t *writer;
+   mongoc_write_concern_t *wc = NULL;
+   bson_iter_t iter;
+
+   BSON_ASSERT (collection);
+
+   writer = (mongoc_bulk_writer_t *) bson_malloc0 (sizeof *writer);
+   writer->client = collection->client;
+   writer->database = bson_strdup (collection->db);
+   writer->collection = bson_strdup (collection->collection);
+   writer->flags.ordered = _mongoc_lookup_bool (opts, "ordered", true);
+   writer->flags.bypass_document_validation =
+      MONGOC_BYPASS_DOCUMENT_VALIDATION_DEFAULT;
+   writer->operation_id = ++collection->client->cluster.operation_id;
+   mongoc_mutex_init (&writer->mutex);
+   mongoc_cond_init (&writer->cond);
+   _mongoc_array_init (&writer->queue, sizeof (mongoc_bulk_writer_batch_t));
+   _mongoc_write_result_init (&writer->result);
+
+   if (opts && bson_iter_init_find (&iter, opts, "writeConcern")) {
+      wc = _mongoc_write_concern_new_from_iter (&iter, &writer->result.error);
+   }
+
+   writer->write_concern =
+      mongoc_write_concern_copy (wc ? wc : collection->write_concern);
+   mongoc_write_concern_destroy (wc);
+
+   if (opts && bson_iter_init_find (&iter, opts, "maxInFlight")) {
+      if (BSON_ITER_HOLDS_INT32 (&iter) && bson_iter_int32 (&iter) >= 0) {
+         writer->max_in_flight = (uint32_t) bson_iter_int32 (&iter);
+      } else {
+         bson_set_error (&writer->result.error,
+                         MONGOC_ERROR_COMMAND,
+                         MONGOC_ERROR_COMMAND_INVALID_ARG,
+                         "Invalid maxInFlight, must be a non-negative int32");
+      }
+   }
+
+   _mongoc_write_result_set_detail (&writer->result, opts);
+
+   return writer;
+}
+
+
+/* let the thread finish the queued batches, and join it */
+static void
+_mongoc_bulk_writer_stop_thread (mongoc_bulk_writer_t *writer)
+{
+   if (!writer->has_thread) {
+      return;
+   }
+
+   mongoc_mutex_lock (&writer->mutex);
+   writer->closing = true;
+   mongoc_cond_broadcast (&writer->cond);
+   mongoc_mutex_unlock (&writer->mutex);
+
+   mongoc_thread_join (writer->thread);
+   writer->has_thread = false;
+}
+
+
+void
+mongoc_bulk_writer_destroy (mongoc_bulk_writer_t *writer)
+{
+   size_t i;
+
+   if (!writer) {
+      return;
+   }
+
+   /* don't send batches that are still queued */
+   mongoc_mutex_lock (&writer->mutex);
+   writer->stop = true;
+   mongoc_mutex_unlock (&writer->mutex);
+   _mongoc_bulk_writer_stop_thread (writer);
+
+   for (i = 0; i < writer->queue.len; i++) {
+      _mongoc_write_command_destroy (
+         &_mongoc_array_index (&writer->queue, mongoc_bulk_writer_batch_t, i)
+             .command);
+   }
+
+   if (writer->has_command) {
+      _mongoc_write_command_destroy (&writer->command);
+   }
+
+   _mongoc_array_destroy (&writer->queue);
+   _mongoc_write_result_destroy (&writer->result);
+   mongoc_cond_destroy (&writer->cond);
+   mongoc_mutex_destroy (&writer->mutex);
+   mongoc_write_concern_destroy (writer->write_concern);
+   bson_free (writer->collection);
+   bson_free (writer->database);
+   bson_free (writer);
+}
+
+
+/* send one batch, from the caller's thread or the writer's, and return
+ * whether later batches may be sent */
+static bool
+_mongoc_bulk_writer_send (mongoc_bulk_writer_t *writer,
+                          mongoc_write_command_t *command,
+                          uint32_t offset)
+{
+   mongoc_server_stream_t *server_stream;
+   mongoc_write_result_t *result = &writer->result;
+
+   ENTRY;
+
+   server_stream = mongoc_cluster_stream_for_server (
+      &writer->client->cluster, writer->server_id, true, &result->error);
+
+   if (!server_stream) {
+      result->failed = true;
+      RETURN (false);
+   }
+
+   _mongoc_write_command_execute (command,
+                                  writer->client,
+                                  server_stream,
+                                  writer->database,
+                                  writer->collection,
+                                  writer->write_concern,
+                                  offset,
+                                  NULL /* session */,
+                                  result);
+
+   mongoc_server_stream_cleanup (server_stream);
+
+   RETURN (!result->failed ||
+           (!writer->flags.ordered && !result->must_stop));
+}
+
+
+/* send queued batches in order until the writer is closed */
+static void *
+_mongoc_bulk_writer_thread (void *data)
+{
+   mongoc_bulk_writer_t *writer = (mongoc_bulk_writer_t *) data;
+   mongoc_bulk_writer_batch_t batch;
+   bool ok;
+
+   mongoc_mutex_lock (&writer->mutex);
+
+   for (;;) {
+      while (!writer->queue.len && !writer->closing) {
+         mongoc_cond_wait (&writer->cond, &writer->mutex);
+      }
+
+      if (!writer->queue.len) {
+         break;
+      }
+
+      /* the batch stays in the queue, and counts against maxInFlight, until
+       * it's sent */
+      batch =
+         _mongoc_array_index (&writer->queue, mongoc_bulk_writer_batch_t, 0);
+      ok = !writer->stop;
+      mongoc_mutex_unlock (&writer->mutex);
+
+      if (ok) {
+         ok = _mongoc_bulk_writer_send (writer, &batch.command, batch.offset);
+      }
+
+      _mongoc_write_command_destroy (&batch.command);
+
+      mongoc_mutex_lock (&writer->mutex);
+      memmove (writer->queue.data,
+               (mongoc_bulk_writer_batch_t *) writer->queue.data + 1,
+               (writer->queue.len - 1) * sizeof batch);
+      writer->queue.len--;
+      if (!ok) {
+         writer->stop = true;
+      }
+
+      mongoc_cond_broadcast (&writer->cond);
+   }
+
+   mongoc_mutex_unlock (&writer->mutex);
+
+   return NULL;
+}
+
+
+/* send the batch being filled, or queue it for the thread */
+static void
+_mongoc_bulk_writer_flush (mongoc_bulk_writer_t *writer)
+{
+   mongoc_bulk_writer_batch_t batch;
+
+   ENTRY;
+
+   if (!writer->has_command) {
+      EXIT;
+   }
+
+   writer->has_command = false;
+
+   if (writer->max_in_flight && !writer->has_thread) {
+      writer->has_thread = !mongoc_thread_create (
+         &writer->thread, _mongoc_bulk_writer_thread, writer);
+   }
+
+   /* no thread, or it couldn't be started: send from this one */
+   if (!writer->has_thread) {
+      if (!writer->stop &&
+          !_mongoc_bulk_writer_send (
+             writer, &writer->command, writer->command_offset)) {
+         writer->stop = true;
+      }
+
+      _mongoc_write_command_destroy (&writer->command);
+      EXIT;
+   }
+
+   memcpy (&batch.command, &writer->command, sizeof batch.command);
+   batch.offset = writer->command_offset;
+
+   mongoc_mutex_lock (&writer->mutex);
+
+   /* wait for room, so memory is bounded */
+   while (writer->queue.len >= writer->max_in_flight && !writer->stop) {
+      mongoc_cond_wait (&writer->cond, &writer->mutex);
+   }
+
+   if (writer->stop) {
+      _mongoc_write_command_destroy (&batch.command);
+   } else {
+      _mongoc_array_append_val (&writer->queue, batch);
+      mongoc_cond_broadcast (&writer->cond);
+   }
+
+   mongoc_mutex_unlock (&writer->mutex);
+
+   EXIT;
+}
+
+
+/* whether operations may still be added */
+static bool
+_mongoc_bulk_writer_check (mongoc_bulk_writer_t *writer, bson_error_t *error)
+{
+   bool stop;
+
+   if (writer->finished) {
+      bson_set_error (error,
+                      MONGOC_ERROR_COMMAND,
+                      MONGOC_ERROR_COMMAND_INVALID_ARG,
+                      "mongoc_bulk_writer_finish() has been called.");
+      return false;
+   }
+
+   /* an invalid option, the thread isn't started yet */
+   if (!writer->n_operations && writer->result.error.domain) {
+      bson_set_error (error,
+                      MONGOC_ERROR_COMMAND,
+                      MONGOC_ERROR_COMMAND_INVALID_ARG,
+                      "Bulk writer is invalid from prior error: %s",
+                      writer->result.error.message);
+      return false;
+   }
+
+   mongoc_mutex_lock (&writer->mutex);
+   stop = writer->stop;
+   mongoc_mutex_unlock (&writer->mutex);
+
+   if (stop) {
+      bson_set_error (error,
+                      MONGOC_ERROR_COMMAND,
+                      MONGOC_ERROR_COMMAND_INVALID_ARG,
+                      "Bulk writer stopped by an error, call "
+                      "mongoc_bulk_writer_finish() for the result.");
+      return false;
+   }
+
+   return true;
+}
+
+
+/* learn the server's batch limits before the first batch is filled */
+static bool
+_mongoc_bulk_writer_select_server (mongoc_bulk_writer_t *writer,
+                                   bson_error_t *error)
+{
+   mongoc_server_stream_t *server_stream;
+
+   if (writer->max_batch_size) {
+      return true;
+   }
+
+   server_stream =
+      mongoc_cluster_stream_for_writes (&writer->client->cluster, error);
+
+   if (!server_stream) {
+      return false;
+   }
+
+   writer->server_id = server_stream->sd->id;
+   _mongoc_write_command_batch_limits (
+      server_stream, &writer->max_batch_size, &writer->max_batch_bytes);
+   mongoc_server_stream_cleanup (server_stream);
+
+   return true;
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * mongoc_bulk_writer_insert --
+ *
+ *       Add an insert of @document. If the batch being filled is full, it
+ *       is sent first, or queued for the background thread.
+ *
+ * Returns:
+ *       false if @document is invalid, the server can't be selected, or
+ *       an earlier batch failed and no more operations may be added.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+bool
+mongoc_bulk_writer_insert (mongoc_bulk_writer_t *writer,
+                           const bson_t *document,
+                           bson_error_t *error)
+{
+   ENTRY;
+
+   BSON_ASSERT (writer);
+   BSON_ASSERT (document);
+
+   if (!_mongoc_bulk_writer_check (writer, error) ||
+       !_mongoc_validate_new_document (
+          document, _mongoc_default_insert_vflags, error) ||
+       !_mongoc_bulk_writer_select_server (writer, error)) {
+      RETURN (false);
+   }
+
+   if (writer->has_command &&
+       (writer->command.n_documents >= (uint32_t) writer->max_batch_size ||
+        writer->command.payload.len + document->len >
+           (size_t) writer->max_batch_bytes)) {
+      _mongoc_bulk_writer_flush (writer);
+
+      if (!_mongoc_bulk_writer_check (writer, error)) {
+         RETURN (false);
+      }
+   }
+
+   if (writer->has_command) {
+      _mongoc_write_command_insert_append (&writer->command, document);
+   } else {
+      _mongoc_write_command_init_insert (
+         &writer->command,
+         document,
+         NULL,
+         writer->flags,
+         writer->operation_id,
+         !mongoc_write_concern_is_acknowledged (writer->write_concern));
+      writer->has_command = true;
+      writer->command_offset = writer->n_operations;
+   }
+
+   writer->n_operations++;
+
+   RETURN (true);
+}
+
+
+/* insert every document from @reader */
+bool
+mongoc_bulk_writer_insert_from_reader (mongoc_bulk_writer_t *writer,
+                                       bson_reader_t *reader,
+                                       bson_error_t *error)
+{
+   const bson_t *document;
+   bool eof = false;
+
+   BSON_ASSERT (writer);
+   BSON_ASSERT (reader);
+
+   while ((document = bson_reader_read (reader, &eof))) {
+      if (!mongoc_bulk_writer_insert (writer, document, error)) {
+         return false;
+      }
+   }
+
+   if (!eof) {
+      bson_set_error (error,
+                      MONGOC_ERROR_BSON,
+                      MONGOC_ERROR_BSON_INVALID,
+                      "Corrupt BSON document after %" PRIu32 " operations",
+                      writer->n_operations);
+      return false;
+   }
+
+   return true;
+}
+
+
+/* insert every document from @reader */
+bool
+mongoc_bulk_writer_insert_from_json_reader (mongoc_bulk_writer_t *writer,
+                                            bson_json_reader_t *reader,
+                                            bson_error_t *error)
+{
+   bson_t document = BSON_INITIALIZER;
+   bool ret = true;
+   int r;
+
+   BSON_ASSERT (writer);
+   BSON_ASSERT (reader);
+
+   while ((r = bson_json_reader_read (reader, &document, error)) > 0) {
+      if (!mongoc_bulk_writer_insert (writer, &document, error)) {
+         ret = false;
+         break;
+      }
+
+      bson_reinit (&document);
+   }
+
+   if (r < 0) {
+      ret = false;
+   }
+
+   bson_destroy (&document);
+
+   return ret;
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * mongoc_bulk_writer_finish --
+ *
+ *       Send the last batch, wait for the thread to send queued ones, and
+ *       report the result of all operations, like
+ *       mongoc_bulk_operation_execute.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+bool
+mongoc_bulk_writer_finish (mongoc_bulk_writer_t *writer,
+                           bson_t *reply,
+                           bson_error_t *error)
+{
+   bool ret;
+
+   ENTRY;
+
+   BSON_ASSERT (writer);
+
+   if (reply) {
+      bson_init (reply);
+   }
+
+   if (writer->finished) {
+      bson_set_error (error,
+                      MONGOC_ERROR_COMMAND,
+                      MONGOC_ERROR_COMMAND_INVALID_ARG,
+                      "mongoc_bulk_writer_finish() has been called.");
+      RETURN (false);
+   }
+
+   _mongoc_bulk_writer_flush (writer);
+   _mongoc_bulk_writer_stop_thread (writer);
+   writer->finished = true;
+
+   ret = MONGOC_WRITE_RESULT_COMPLETE (&writer->result,
+                                       writer->client->error_api_version,
+                                       writer->write_concern,
+                                       MONGOC_ERROR_COMMAND /* err domain */,
+                                       reply,
+                                       error);
+
+   RETURN (ret);
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright 2018-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef MONGOC_BULK_WRITER_H
+#define MONGOC_BULK_WRITER_H
+
+#if !defined(MONGOC_INSIDE) && !defined(MONGOC_COMPILATION)
+#error "Only <mongoc.h> can be included directly."
+#endif
+
+#include <bson.h>
+
+#include "mongoc-macros.h"
+#include "mongoc-collection.h"
+
+
+BSON_BEGIN_DECLS
+
+
+typedef struct _mongoc_bulk_writer_t mongoc_bulk_writer_t;
+
+
+MONGOC_EXPORT (mongoc_bulk_writer_t *)
+mongoc_bulk_writer_new (mongoc_collection_t *collection, const bson_t *opts);
+MONGOC_EXPORT (void)
+mongoc_bulk_writer_destroy (mongoc_bulk_writer_t *writer);
+MONGOC_EXPORT (bool)
+mongoc_bulk_writer_insert (mongoc_bulk_writer_t *writer,
+                           const bson_t *document,
+                           bson_error_t *error);
+MONGOC_EXPORT (bool)
+mongoc_bulk_writer_insert_from_reader (mongoc_bulk_writer_t *writer,
+                                       bson_reader_t *reader,
+                                       bson_error_t *error);
+MONGOC_EXPORT (bool)
+mongoc_bulk_writer_insert_from_json_reader (mongoc_bulk_writer_t *writer,
+                                            bson_json_reader_t *reader,
+                                            bson_error_t *error);
+MONGOC_EXPORT (bool)
+mongoc_bulk_writer_finish (mongoc_bulk_writer_t *writer,
+                           bson_t *reply,
+                           bson_error_t *error);
+
+
+BSON_END_DECLS
+
+
+#endif /* MONGOC_BULK_WRITER_H */
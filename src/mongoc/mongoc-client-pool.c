@@ -22,6 +22,7 @@
 #include "mongoc-client-pool.h"
 #include "mongoc-client-private.h"
 #include "mongoc-queue-private.h"
+#include "mongoc-server-stream-private.h"
 #include "mongoc-thread-private.h"
 #include "mongoc-topology-private.h"
 #include "mongoc-trace-private.h"
@@ -30,10 +31,34 @@
 #include "mongoc-ssl-private.h"
 #endif
 
+/* idle clients are striped across shards, each thread prefers its own */
+#define MONGOC_CLIENT_POOL_SHARDS 16
+
+/* how many clients pre-warming connects at once */
+#define MONGOC_CLIENT_POOL_PREWARM_BATCH 16
+
+typedef struct {
+   mongoc_mutex_t mutex;
+   mongoc_queue_t queue;
+   /* queue's length, changed with the mutex held and read atomically */
+   volatile int32_t n_idle;
+} mongoc_client_pool_shard_t;
+
+typedef struct {
+   mongoc_client_pool_t *pool;
+   mongoc_client_t *client;
+   mongoc_thread_t thread;
+   bool started;
+} mongoc_client_pool_prewarm_t;
+
 struct _mongoc_client_pool_t {
+   /* guards size, and waiting for a client when all shards are empty */
    mongoc_mutex_t mutex;
    mongoc_cond_t cond;
-   mongoc_queue_t queue;
+   volatile int32_t n_waiting;
+   /* idle clients in all shards, changed with a shard's mutex held */
+   volatile int32_t n_pushed;
+   mongoc_client_pool_shard_t shards[MONGOC_CLIENT_POOL_SHARDS];
    mongoc_topology_t *topology;
    mongoc_uri_t *uri;
    uint32_t min_pool_size;
@@ -48,6 +73,13 @@ struct _mongoc_client_pool_t {
    void *apm_context;
    int32_t error_api_version;
    bool error_api_set;
+   /* pre-warming, guarded by mutex */
+   bool prewarm;
+   bool prewarm_started;
+   bool prewarm_shutdown;
+   mongoc_thread_t prewarm_thread;
+   mongoc_cond_t prewarm_cond;
+   mongoc_queue_t prewarm_queue;
 };
 
 
@@ -86,6 +118,7 @@ mongoc_client_pool_new (const mongoc_uri_t *uri)
    const bson_t *b;
    bson_iter_t iter;
    const char *appname;
+   int i;
 
 
    ENTRY;
@@ -102,7 +135,14 @@ mongoc_client_pool_new (const mongoc_uri_t *uri)
 
    pool = (mongoc_client_pool_t *) bson_malloc0 (sizeof *pool);
    mongoc_mutex_init (&pool->mutex);
-   _mongoc_queue_init (&pool->queue);
+   mongoc_cond_init (&pool->cond);
+   mongoc_cond_init (&pool->prewarm_cond);
+   _mongoc_queue_init (&pool->prewarm_queue);
+   for (i = 0; i < MONGOC_CLIENT_POOL_SHARDS; i++) {
+      mongoc_mutex_init (&pool->shards[i].mutex);
+      _mongoc_queue_init (&pool->shards[i].queue);
+   }
+
    pool->uri = mongoc_uri_copy (uri);
    pool->min_pool_size = 0;
    pool->max_pool_size = 100;
@@ -157,20 +197,39 @@ void
 mongoc_client_pool_destroy (mongoc_client_pool_t *pool)
 {
    mongoc_client_t *client;
+   int i;
 
    ENTRY;
 
    BSON_ASSERT (pool);
 
+   mongoc_mutex_lock (&pool->mutex);
+   pool->prewarm_shutdown = true;
+   mongoc_cond_signal (&pool->prewarm_cond);
+   mongoc_mutex_unlock (&pool->mutex);
+
+   if (pool->prewarm_started) {
+      mongoc_thread_join (pool->prewarm_thread);
+   }
+
+   while ((client = (mongoc_client_t *) _mongoc_queue_pop_head (
+              &pool->prewarm_queue))) {
+      mongoc_client_destroy (client);
+   }
+
    if (pool->topology->session_pool) {
       client = mongoc_client_pool_pop (pool);
       _mongoc_client_end_sessions (client);
       mongoc_client_pool_push (pool, client);
    }
 
-   while (
-      (client = (mongoc_client_t *) _mongoc_queue_pop_head (&pool->queue))) {
-      mongoc_client_destroy (client);
+   for (i = 0; i < MONGOC_CLIENT_POOL_SHARDS; i++) {
+      while ((client = (mongoc_client_t *) _mongoc_queue_pop_head (
+                 &pool->shards[i].queue))) {
+         mongoc_client_destroy (client);
+      }
+
+      mongoc_mutex_destroy (&pool->shards[i].mutex);
    }
 
    mongoc_topology_destroy (pool->topology);
@@ -178,6 +237,7 @@ mongoc_client_pool_destroy (mongoc_client_pool_t *pool)
    mongoc_uri_destroy (pool->uri);
    mongoc_mutex_destroy (&pool->mutex);
    mongoc_cond_destroy (&pool->cond);
+   mongoc_cond_destroy (&pool->prewarm_cond);
 
 #ifdef MONGOC_ENABLE_SSL
    _mongoc_ssl_opts_cleanup (&pool->ssl_opts);
@@ -206,43 +266,156 @@ _start_scanner_if_needed (mongoc_client_pool_t *pool)
    }
 }
 
+/*
+ *--------------------------------------------------------------------------
+ *
+ * _mongoc_client_pool_home_shard --
+ *
+ *       Choose the shard the calling thread pushes to and pops from
+ *       first. Threads spread across shards so that concurrent pop and
+ *       push rarely contend for the same lock, while a single thread
+ *       always sees its own clients in LIFO order.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+static uint32_t
+_mongoc_client_pool_home_shard (void)
+{
+#ifdef _WIN32
+   DWORD id = GetCurrentThreadId ();
+#else
+   /* opaque, and may be a struct or wider than an integer */
+   pthread_t id = pthread_self ();
+#endif
+   const uint8_t *bytes = (const uint8_t *) &id;
+   uint32_t hash = 2166136261u;
+   size_t i;
+
+   /* FNV-1a over the id's bytes, which are often an aligned address */
+   for (i = 0; i < sizeof id; i++) {
+      hash ^= bytes[i];
+      hash *= 16777619u;
+   }
+
+   return hash % MONGOC_CLIENT_POOL_SHARDS;
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * _mongoc_client_pool_take --
+ *
+ *       Take an idle client, trying the calling thread's home shard
+ *       first and then the others.
+ *
+ * Returns:
+ *       A client, or NULL if every shard is empty.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+static mongoc_client_t *
+_mongoc_client_pool_take (mongoc_client_pool_t *pool, uint32_t home)
+{
+   mongoc_client_pool_shard_t *shard;
+   mongoc_client_t *client;
+   uint32_t i;
+
+   for (i = 0; i < MONGOC_CLIENT_POOL_SHARDS; i++) {
+      shard = &pool->shards[(home + i) % MONGOC_CLIENT_POOL_SHARDS];
+
+      /* an empty shard is not worth the lock */
+      if (!bson_atomic_int_add (&shard->n_idle, 0)) {
+         continue;
+      }
+
+      mongoc_mutex_lock (&shard->mutex);
+      client = (mongoc_client_t *) _mongoc_queue_pop_head (&shard->queue);
+      if (client) {
+         bson_atomic_int_add (&shard->n_idle, -1);
+         bson_atomic_int_add (&pool->n_pushed, -1);
+      }
+
+      mongoc_mutex_unlock (&shard->mutex);
+
+      if (client) {
+         return client;
+      }
+   }
+
+   return NULL;
+}
+
+
+/*
+ * Create a new client for the pool.
+ *
+ * This function assumes the pool's mutex is locked
+ */
+static mongoc_client_t *
+_mongoc_client_pool_new_client (mongoc_client_pool_t *pool)
+{
+   mongoc_client_t *client;
+
+   client = _mongoc_client_new_from_uri (pool->topology);
+
+   /* for tests */
+   mongoc_client_set_stream_initiator (
+      client,
+      pool->topology->scanner->initiator,
+      pool->topology->scanner->initiator_context);
+
+   client->error_api_version = pool->error_api_version;
+   _mongoc_client_set_apm_callbacks_private (
+      client, &pool->apm_callbacks, pool->apm_context);
+#ifdef MONGOC_ENABLE_SSL
+   if (pool->ssl_opts_set) {
+      mongoc_client_set_ssl_opts (client, &pool->ssl_opts);
+   }
+#endif
+   pool->size++;
+
+   return client;
+}
+
+
 mongoc_client_t *
 mongoc_client_pool_pop (mongoc_client_pool_t *pool)
 {
    mongoc_client_t *client;
+   uint32_t home;
 
    ENTRY;
 
    BSON_ASSERT (pool);
 
-   mongoc_mutex_lock (&pool->mutex);
+   home = _mongoc_client_pool_home_shard ();
 
-again:
-   if (!(client = (mongoc_client_t *) _mongoc_queue_pop_head (&pool->queue))) {
-      if (pool->size < pool->max_pool_size) {
-         client = _mongoc_client_new_from_uri (pool->topology);
+   /* fast path: an idle client was pushed by a thread that already started
+    * the scanner, so neither the pool nor the topology mutex is needed */
+   if ((client = _mongoc_client_pool_take (pool, home))) {
+      RETURN (client);
+   }
 
-         /* for tests */
-         mongoc_client_set_stream_initiator (
-            client,
-            pool->topology->scanner->initiator,
-            pool->topology->scanner->initiator_context);
+   mongoc_mutex_lock (&pool->mutex);
 
-         client->error_api_version = pool->error_api_version;
-         _mongoc_client_set_apm_callbacks_private (
-            client, &pool->apm_callbacks, pool->apm_context);
-#ifdef MONGOC_ENABLE_SSL
-         if (pool->ssl_opts_set) {
-            mongoc_client_set_ssl_opts (client, &pool->ssl_opts);
-         }
-#endif
-         pool->size++;
-      } else {
-         mongoc_cond_wait (&pool->cond, &pool->mutex);
-         GOTO (again);
+   /* announce ourselves before the rescan, so a concurrent push either lands
+    * in time for the rescan or sees us waiting and signals */
+   bson_atomic_int_add (&pool->n_waiting, 1);
+
+   while (!(client = _mongoc_client_pool_take (pool, home))) {
+      if (pool->size < pool->max_pool_size) {
+         client = _mongoc_client_pool_new_client (pool);
+         break;
       }
+
+      mongoc_cond_wait (&pool->cond, &pool->mutex);
    }
 
+   bson_atomic_int_add (&pool->n_waiting, -1);
+
    _start_scanner_if_needed (pool);
    mongoc_mutex_unlock (&pool->mutex);
 
@@ -254,22 +427,23 @@ mongoc_client_t *
 mongoc_client_pool_try_pop (mongoc_client_pool_t *pool)
 {
    mongoc_client_t *client;
+   uint32_t home;
 
    ENTRY;
 
    BSON_ASSERT (pool);
 
+   home = _mongoc_client_pool_home_shard ();
+
+   if ((client = _mongoc_client_pool_take (pool, home))) {
+      RETURN (client);
+   }
+
    mongoc_mutex_lock (&pool->mutex);
 
-   if (!(client = (mongoc_client_t *) _mongoc_queue_pop_head (&pool->queue))) {
+   if (!(client = _mongoc_client_pool_take (pool, home))) {
       if (pool->size < pool->max_pool_size) {
-         client = _mongoc_client_new_from_uri (pool->topology);
-#ifdef MONGOC_ENABLE_SSL
-         if (pool->ssl_opts_set) {
-            mongoc_client_set_ssl_opts (client, &pool->ssl_opts);
-         }
-#endif
-         pool->size++;
+         client = _mongoc_client_pool_new_client (pool);
       }
    }
 
@@ -282,6 +456,54 @@ mongoc_client_pool_try_pop (mongoc_client_pool_t *pool)
 }
 
 
+/*
+ * Return a client to the idle shards and wake a waiter, if any.
+ */
+static void
+_mongoc_client_pool_push_idle (mongoc_client_pool_t *pool,
+                               mongoc_client_t *client)
+{
+   mongoc_client_pool_shard_t *shard;
+   mongoc_client_t *old_client = NULL;
+   int32_t n_pushed;
+
+   shard = &pool->shards[_mongoc_client_pool_home_shard ()];
+
+   mongoc_mutex_lock (&shard->mutex);
+   _mongoc_queue_push_head (&shard->queue, client);
+   bson_atomic_int_add (&shard->n_idle, 1);
+   n_pushed = bson_atomic_int_add (&pool->n_pushed, 1);
+
+   /* this shard holds at least the client just pushed */
+   if (pool->min_pool_size && (uint32_t) n_pushed > pool->min_pool_size) {
+      old_client = (mongoc_client_t *) _mongoc_queue_pop_tail (&shard->queue);
+      bson_atomic_int_add (&shard->n_idle, -1);
+      bson_atomic_int_add (&pool->n_pushed, -1);
+   }
+
+   mongoc_mutex_unlock (&shard->mutex);
+
+   if (old_client) {
+      mongoc_client_destroy (old_client);
+      mongoc_mutex_lock (&pool->mutex);
+      pool->size--;
+      mongoc_cond_signal (&pool->cond);
+      mongoc_mutex_unlock (&pool->mutex);
+      return;
+   }
+
+   /* pairs with the increment in mongoc_client_pool_pop: only wake a waiter
+    * if there is one, otherwise the pool mutex is never touched */
+   bson_memory_barrier ();
+
+   if (pool->n_waiting) {
+      mongoc_mutex_lock (&pool->mutex);
+      mongoc_cond_signal (&pool->cond);
+      mongoc_mutex_unlock (&pool->mutex);
+   }
+}
+
+
 void
 mongoc_client_pool_push (mongoc_client_pool_t *pool, mongoc_client_t *client)
 {
@@ -290,23 +512,133 @@ mongoc_client_pool_push (mongoc_client_pool_t *pool, mongoc_client_t *client)
    BSON_ASSERT (pool);
    BSON_ASSERT (client);
 
+   if (pool->prewarm && client->cluster.node_disconnected) {
+      /* reconnect in the background rather than in the next request */
+      mongoc_mutex_lock (&pool->mutex);
+      _mongoc_queue_push_tail (&pool->prewarm_queue, client);
+      mongoc_cond_signal (&pool->prewarm_cond);
+      mongoc_mutex_unlock (&pool->mutex);
+      EXIT;
+   }
+
+   _mongoc_client_pool_push_idle (pool, client);
+
+   EXIT;
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * _mongoc_client_pool_prewarm_worker --
+ *
+ *       Connect, handshake and authenticate one client to the servers it
+ *       would select for writes and for reads, then make it idle.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+static void *
+_mongoc_client_pool_prewarm_worker (void *data)
+{
+   mongoc_client_pool_prewarm_t *prewarm =
+      (mongoc_client_pool_prewarm_t *) data;
+   mongoc_client_t *client = prewarm->client;
+   mongoc_server_stream_t *server_stream;
+   bson_error_t error;
+
+   /* cleared first, a disconnect while connecting sets it again */
+   client->cluster.node_disconnected = false;
+
+   server_stream = mongoc_cluster_stream_for_writes (&client->cluster, &error);
+   if (server_stream) {
+      mongoc_server_stream_cleanup (server_stream);
+   } else {
+      MONGOC_DEBUG ("could not pre-warm client for writes: %s", error.message);
+   }
+
+   server_stream = mongoc_cluster_stream_for_reads (
+      &client->cluster, client->read_prefs, &error);
+   if (server_stream) {
+      mongoc_server_stream_cleanup (server_stream);
+   } else {
+      MONGOC_DEBUG ("could not pre-warm client for reads: %s", error.message);
+   }
+
+   _mongoc_client_pool_push_idle (prewarm->pool, client);
+
+   return NULL;
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * _mongoc_client_pool_prewarm_thread --
+ *
+ *       Background thread that creates clients until the pool owns
+ *       min_pool_size of them, and reconnects clients that were pushed
+ *       after dropping a node. Each batch connects in parallel.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+static void *
+_mongoc_client_pool_prewarm_thread (void *data)
+{
+   mongoc_client_pool_t *pool = (mongoc_client_pool_t *) data;
+   mongoc_client_pool_prewarm_t batch[MONGOC_CLIENT_POOL_PREWARM_BATCH];
+   mongoc_client_t *client;
+   int n;
+   int i;
+
    mongoc_mutex_lock (&pool->mutex);
-   _mongoc_queue_push_head (&pool->queue, client);
-
-   if (pool->min_pool_size &&
-       _mongoc_queue_get_length (&pool->queue) > pool->min_pool_size) {
-      mongoc_client_t *old_client;
-      old_client = (mongoc_client_t *) _mongoc_queue_pop_tail (&pool->queue);
-      if (old_client) {
-         mongoc_client_destroy (old_client);
-         pool->size--;
+
+   while (!pool->prewarm_shutdown) {
+      n = 0;
+
+      while (n < MONGOC_CLIENT_POOL_PREWARM_BATCH && pool->prewarm &&
+             pool->size < pool->min_pool_size) {
+         batch[n++].client = _mongoc_client_pool_new_client (pool);
+      }
+
+      while (n < MONGOC_CLIENT_POOL_PREWARM_BATCH &&
+             (client = (mongoc_client_t *) _mongoc_queue_pop_head (
+                 &pool->prewarm_queue))) {
+         batch[n++].client = client;
+      }
+
+      if (!n) {
+         mongoc_cond_wait (&pool->prewarm_cond, &pool->mutex);
+         continue;
       }
+
+      _start_scanner_if_needed (pool);
+      mongoc_mutex_unlock (&pool->mutex);
+
+      for (i = 0; i < n; i++) {
+         batch[i].pool = pool;
+         batch[i].started = !mongoc_thread_create (
+            &batch[i].thread, _mongoc_client_pool_prewarm_worker, &batch[i]);
+
+         if (!batch[i].started) {
+            /* connect it lazily like any other client */
+            _mongoc_client_pool_push_idle (pool, batch[i].client);
+         }
+      }
+
+      for (i = 0; i < n; i++) {
+         if (batch[i].started) {
+            mongoc_thread_join (batch[i].thread);
+         }
+      }
+
+      mongoc_mutex_lock (&pool->mutex);
    }
 
-   mongoc_cond_signal (&pool->cond);
    mongoc_mutex_unlock (&pool->mutex);
 
-   EXIT;
+   return NULL;
 }
 
 /* for tests */
@@ -338,13 +670,11 @@ mongoc_client_pool_get_size (mongoc_client_pool_t *pool)
 size_t
 mongoc_client_pool_num_pushed (mongoc_client_pool_t *pool)
 {
-   size_t num_pushed = 0;
+   size_t num_pushed;
 
    ENTRY;
 
-   mongoc_mutex_lock (&pool->mutex);
-   num_pushed = pool->queue.length;
-   mongoc_mutex_unlock (&pool->mutex);
+   num_pushed = (size_t) bson_atomic_int_add (&pool->n_pushed, 0);
 
    RETURN (num_pushed);
 }
@@ -449,3 +779,36 @@ mongoc_client_pool_set_appname (mongoc_client_pool_t *pool, const char *appname)
 
    return ret;
 }
+
+void
+mongoc_client_pool_set_prewarm (mongoc_client_pool_t *pool, bool prewarm)
+{
+   int r;
+
+   ENTRY;
+
+   BSON_ASSERT (pool);
+
+   mongoc_mutex_lock (&pool->mutex);
+   pool->prewarm = prewarm;
+
+   if (prewarm && !pool->prewarm_started) {
+      r = mongoc_thread_create (
+         &pool->prewarm_thread, _mongoc_client_pool_prewarm_thread, pool);
+
+      if (r == 0) {
+         pool->prewarm_started = true;
+      } else {
+         /* pre-warming is only an optimization. leave it disabled, so push
+          * doesn't queue clients for a thread that isn't running */
+         MONGOC_WARNING ("could not start pool pre-warm thread: %s",
+                         strerror (r));
+         pool->prewarm = false;
+      }
+   }
+
+   mongoc_cond_signal (&pool->prewarm_cond);
+   mongoc_mutex_unlock (&pool->mutex);
+
+   EXIT;
+}
@@ -69,6 +69,8 @@ mongoc_client_pool_set_error_api (mongoc_client_pool_t *pool, int32_t version);
 MONGOC_EXPORT (bool)
 mongoc_client_pool_set_appname (mongoc_client_pool_t *pool,
                                 const char *appname);
+MONGOC_EXPORT (void)
+mongoc_client_pool_set_prewarm (mongoc_client_pool_t *pool, bool prewarm);
 BSON_END_DECLS
 
 
@@ -69,6 +69,8 @@ BSON_BEGIN_DECLS
 #define WIRE_VERSION_OP_MSG 6
 /* first version to support retryable writes  */
 #define WIRE_VERSION_RETRY_WRITES 6
+/* first version to stream getMore replies with OP_MSG "exhaustAllowed" */
+#define WIRE_VERSION_EXHAUST_OP_MSG 8
 
 
 struct _mongoc_client_t {
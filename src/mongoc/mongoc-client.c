@@ -38,11 +38,12 @@
 #include "mongoc-collection-private.h"
 #include "mongoc-counters-private.h"
 #include "mongoc-database-private.h"
+#include "mongoc-dns-cache-private.h"
 #include "mongoc-gridfs-private.h"
 #include "mongoc-error.h"
 #include "mongoc-log.h"
 #include "mongoc-queue-private.h"
-#include "mongoc-socket.h"
+#include "mongoc-socket-private.h"
 #include "mongoc-stream-buffered.h"
 #include "mongoc-stream-socket.h"
 #include "mongoc-thread-private.h"
@@ -59,6 +60,7 @@
 
 #ifdef MONGOC_ENABLE_SSL
 #include "mongoc-stream-tls.h"
+#include "mongoc-stream-tls-private.h"
 #include "mongoc-ssl-private.h"
 #include "mongoc-cmd-private.h"
 
@@ -502,7 +504,9 @@ _mongoc_client_get_rr (const char *service,
  *       Connect to a host using a TCP socket.
  *
  *       This will be performed synchronously and return a mongoc_stream_t
- *       that can be used to connect with the remote host.
+ *       that can be used to connect with the remote host. If the host
+ *       resolves to several addresses, connections to them are attempted
+ *       concurrently and the first to succeed is used.
  *
  * Returns:
  *       A newly allocated mongoc_stream_t if successful; otherwise
@@ -520,11 +524,10 @@ mongoc_client_connect_tcp (const mongoc_uri_t *uri,
                            bson_error_t *error)
 {
    mongoc_socket_t *sock = NULL;
-   struct addrinfo hints;
-   struct addrinfo *result, *rp;
+   struct addrinfo *result;
    int32_t connecttimeoutms;
+   int32_t dnscachettlms;
    int64_t expire_at;
-   char portstr[8];
    int s;
 
    ENTRY;
@@ -537,18 +540,12 @@ mongoc_client_connect_tcp (const mongoc_uri_t *uri,
 
    BSON_ASSERT (connecttimeoutms);
 
-   bson_snprintf (portstr, sizeof portstr, "%hu", host->port);
+   dnscachettlms = mongoc_uri_get_option_as_int32 (
+      uri, MONGOC_URI_DNSCACHETTLMS, MONGOC_DEFAULT_DNSCACHETTLMS);
 
-   memset (&hints, 0, sizeof hints);
-   hints.ai_family = host->family;
-   hints.ai_socktype = SOCK_STREAM;
-   hints.ai_flags = 0;
-   hints.ai_protocol = 0;
-
-   s = getaddrinfo (host->host, portstr, &hints, &result);
+   s = _mongoc_dns_cache_getaddrinfo (host, dnscachettlms, &result);
 
    if (s != 0) {
-      mongoc_counter_dns_failure_inc ();
       bson_set_error (error,
                       MONGOC_ERROR_STREAM,
                       MONGOC_ERROR_STREAM_NAME_RESOLUTION,
@@ -557,42 +554,23 @@ mongoc_client_connect_tcp (const mongoc_uri_t *uri,
       RETURN (NULL);
    }
 
-   mongoc_counter_dns_success_inc ();
-
-   for (rp = result; rp; rp = rp->ai_next) {
-      /*
-       * Create a new non-blocking socket.
-       */
-      if (!(sock = mongoc_socket_new (
-               rp->ai_family, rp->ai_socktype, rp->ai_protocol))) {
-         continue;
-      }
+   /*
+    * Race non-blocking connects to the resolved addresses.
+    */
+   expire_at = bson_get_monotonic_time () + (connecttimeoutms * 1000L);
+   sock = mongoc_socket_connect_any (
+      result, MONGOC_SOCKET_CONNECT_STAGGER_MSEC, expire_at);
 
-      /*
-       * Try to connect to the peer.
-       */
-      expire_at = bson_get_monotonic_time () + (connecttimeoutms * 1000L);
-      if (0 !=
-          mongoc_socket_connect (
-             sock, rp->ai_addr, (mongoc_socklen_t) rp->ai_addrlen, expire_at)) {
-         char *errmsg;
-         char errmsg_buf[BSON_ERROR_BUFFER_SIZE];
-         char ip[255];
-
-         mongoc_socket_inet_ntop (rp, ip, sizeof ip);
-         errmsg = bson_strerror_r (
-            mongoc_socket_errno (sock), errmsg_buf, sizeof errmsg_buf);
-         MONGOC_WARNING ("Failed to connect to: %s:%d, error: %d, %s\n",
-                         ip,
-                         host->port,
-                         mongoc_socket_errno (sock),
-                         errmsg);
-         mongoc_socket_destroy (sock);
-         sock = NULL;
-         continue;
-      }
+   if (!sock) {
+      char *errmsg;
+      char errmsg_buf[BSON_ERROR_BUFFER_SIZE];
+      int errcode = errno;
 
-      break;
+      errmsg = bson_strerror_r (errcode, errmsg_buf, sizeof errmsg_buf);
+      MONGOC_WARNING ("Failed to connect to: %s, error: %d, %s\n",
+                      host->host_and_port,
+                      errcode,
+                      errmsg);
    }
 
    if (!sock) {
@@ -601,11 +579,11 @@ mongoc_client_connect_tcp (const mongoc_uri_t *uri,
                       MONGOC_ERROR_STREAM_CONNECT,
                       "Failed to connect to target host: %s",
                       host->host_and_port);
-      freeaddrinfo (result);
+      _mongoc_dns_cache_freeaddrinfo (result);
       RETURN (NULL);
    }
 
-   freeaddrinfo (result);
+   _mongoc_dns_cache_freeaddrinfo (result);
 
    return mongoc_stream_socket_new (sock);
 }
@@ -756,8 +734,20 @@ mongoc_client_default_stream_initiator (const mongoc_uri_t *uri,
           (mechanism && (0 == strcmp (mechanism, "MONGODB-X509")))) {
          mongoc_stream_t *original = base_stream;
 
+#ifdef MONGOC_ENABLE_SSL_OPENSSL
+         /* share the SSL_CTX the topology scanner loaded from the same
+          * options, for a pooled client they are the pool's */
+         base_stream = mongoc_stream_tls_new_with_hostname_and_openssl_context (
+            base_stream,
+            host->host,
+            &client->ssl_opts,
+            true,
+            client->topology->scanner->openssl_ctx,
+            host->host_and_port);
+#else
          base_stream = mongoc_stream_tls_new_with_hostname (
             base_stream, host->host, &client->ssl_opts, true);
+#endif
 
          if (!base_stream) {
             mongoc_stream_destroy (original);
@@ -1671,6 +1661,107 @@ mongoc_client_command_simple (mongoc_client_t *client,
 }
 
 
+static void
+_mongoc_client_command_pipeline_fail (size_t n_commands,
+                                      bson_t *replies,
+                                      bson_error_t *errors,
+                                      const bson_error_t *error)
+{
+   size_t i;
+
+   for (i = 0; i < n_commands; i++) {
+      bson_init (&replies[i]);
+      memcpy (&errors[i], error, sizeof (bson_error_t));
+   }
+}
+
+
+bool
+mongoc_client_command_pipeline (mongoc_client_t *client,
+                                const char *db_name,
+                                const bson_t **commands,
+                                size_t n_commands,
+                                const mongoc_read_prefs_t *read_prefs,
+                                bson_t *replies,
+                                bson_error_t *errors)
+{
+   mongoc_server_stream_t *server_stream = NULL;
+   mongoc_cmd_parts_t *parts = NULL;
+   mongoc_cmd_t **cmds = NULL;
+   bson_error_t *errors_local = NULL;
+   bson_error_t error;
+   size_t n_parts = 0;
+   size_t i;
+   bool ret = false;
+
+   ENTRY;
+
+   BSON_ASSERT (client);
+   BSON_ASSERT (db_name);
+   BSON_ASSERT (commands || !n_commands);
+   BSON_ASSERT (replies || !n_commands);
+
+   if (!n_commands) {
+      RETURN (true);
+   }
+
+   if (!errors) {
+      errors = errors_local = bson_malloc0 (n_commands * sizeof (bson_error_t));
+   }
+
+   if (!_mongoc_read_prefs_validate (read_prefs, &error)) {
+      _mongoc_client_command_pipeline_fail (
+         n_commands, replies, errors, &error);
+      GOTO (done);
+   }
+
+   server_stream =
+      mongoc_cluster_stream_for_reads (&client->cluster, read_prefs, &error);
+
+   if (!server_stream) {
+      _mongoc_client_command_pipeline_fail (
+         n_commands, replies, errors, &error);
+      GOTO (done);
+   }
+
+   parts = bson_malloc0 (n_commands * sizeof (mongoc_cmd_parts_t));
+   cmds = bson_malloc0 (n_commands * sizeof (mongoc_cmd_t *));
+
+   /* assemble all commands before sending any, so invalid arguments fail the
+    * whole pipeline instead of leaving it partially executed */
+   for (i = 0; i < n_commands; i++) {
+      mongoc_cmd_parts_init (
+         &parts[i], client, db_name, MONGOC_QUERY_NONE, commands[i]);
+      n_parts++;
+      parts[i].read_prefs = read_prefs;
+      parts[i].assembled.operation_id = ++client->cluster.operation_id;
+
+      if (!mongoc_cmd_parts_assemble (&parts[i], server_stream, &error)) {
+         _mongoc_client_command_pipeline_fail (
+            n_commands, replies, errors, &error);
+         GOTO (done);
+      }
+
+      cmds[i] = &parts[i].assembled;
+   }
+
+   ret = mongoc_cluster_run_command_pipeline (
+      &client->cluster, cmds, n_commands, replies, errors);
+
+done:
+   for (i = 0; i < n_parts; i++) {
+      mongoc_cmd_parts_cleanup (&parts[i]);
+   }
+
+   bson_free (parts);
+   bson_free (cmds);
+   bson_free (errors_local);
+   mongoc_server_stream_cleanup (server_stream);
+
+   RETURN (ret);
+}
+
+
 /*
  *--------------------------------------------------------------------------
  *
@@ -2572,6 +2663,9 @@ mongoc_client_select_server (mongoc_client_t *client,
       return NULL;
    }
 
+   /* server selection may check or rescan this client's connections */
+   mongoc_cluster_read_pending_reply (&client->cluster);
+
    sd = mongoc_topology_select (client->topology, optype, prefs, error);
    if (!sd) {
       return NULL;
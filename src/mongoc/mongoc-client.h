@@ -52,6 +52,11 @@ BSON_BEGIN_DECLS
 #endif
 
 
+#ifndef MONGOC_DEFAULT_DNSCACHETTLMS
+#define MONGOC_DEFAULT_DNSCACHETTLMS (60 * 1000L)
+#endif
+
+
 #ifndef MONGOC_DEFAULT_SOCKETTIMEOUTMS
 /*
  * NOTE: The default socket timeout for connections is 5 minutes. This
@@ -131,6 +136,14 @@ mongoc_client_command_simple (mongoc_client_t *client,
                               bson_t *reply,
                               bson_error_t *error);
 MONGOC_EXPORT (bool)
+mongoc_client_command_pipeline (mongoc_client_t *client,
+                                const char *db_name,
+                                const bson_t **commands,
+                                size_t n_commands,
+                                const mongoc_read_prefs_t *read_prefs,
+                                bson_t *replies,
+                                bson_error_t *errors);
+MONGOC_EXPORT (bool)
 mongoc_client_read_command_with_opts (mongoc_client_t *client,
                                       const char *db_name,
                                       const bson_t *command,
@@ -55,6 +55,12 @@ typedef struct _mongoc_cluster_node_t {
    int64_t timestamp;
 } mongoc_cluster_node_t;
 
+/* called with abandon=false to read a reply that was requested ahead of
+ * time before its connection is reused, or with abandon=true if the
+ * connection is closing and the reply can no longer be read */
+typedef void (*mongoc_cluster_pending_reply_cb_t) (void *ctx, bool abandon);
+
+
 typedef struct _mongoc_cluster_t {
    int64_t operation_id;
    uint32_t request_id;
@@ -66,10 +72,20 @@ typedef struct _mongoc_cluster_t {
    mongoc_uri_t *uri;
    unsigned requires_auth : 1;
 
+   /* set when a pooled client drops a node, so the pool can reconnect it */
+   bool node_disconnected;
+
    mongoc_client_t *client;
 
    mongoc_set_t *nodes;
    mongoc_array_t iov;
+
+   /* at most one unread reply, see mongoc_cluster_set_pending_reply */
+   struct {
+      uint32_t server_id;
+      mongoc_cluster_pending_reply_cb_t cb;
+      void *ctx;
+   } pending_reply;
 } mongoc_cluster_t;
 
 bool
@@ -146,6 +162,61 @@ mongoc_cluster_run_command_parts (mongoc_cluster_t *cluster,
                                   bson_t *reply,
                                   bson_error_t *error);
 
+bool
+mongoc_cluster_run_command_pipeline (mongoc_cluster_t *cluster,
+                                     mongoc_cmd_t **cmds,
+                                     size_t n_cmds,
+                                     bson_t *replies,
+                                     bson_error_t *errors);
+
+bool
+mongoc_cluster_run_command_exhaust (mongoc_cluster_t *cluster,
+                                    mongoc_cmd_t *cmd,
+                                    bson_t *reply,
+                                    bool *more_to_come,
+                                    bson_error_t *error);
+
+bool
+mongoc_cluster_recv_exhaust_reply (mongoc_cluster_t *cluster,
+                                   mongoc_cmd_t *cmd,
+                                   bson_t *reply,
+                                   bool *more_to_come,
+                                   bson_error_t *error);
+
+bool
+mongoc_cluster_send_command_monitored (mongoc_cluster_t *cluster,
+                                       mongoc_cmd_t *cmd,
+                                       int32_t *request_id,
+                                       int64_t *started,
+                                       bson_error_t *error);
+
+bool
+mongoc_cluster_recv_reply_monitored (mongoc_cluster_t *cluster,
+                                     mongoc_cmd_t *cmd,
+                                     int32_t request_id,
+                                     int64_t started,
+                                     bson_t *reply,
+                                     bson_error_t *error);
+
+void
+mongoc_cluster_abandon_reply_monitored (mongoc_cluster_t *cluster,
+                                        mongoc_cmd_t *cmd,
+                                        int32_t request_id,
+                                        int64_t started,
+                                        const bson_error_t *error);
+
+void
+mongoc_cluster_set_pending_reply (mongoc_cluster_t *cluster,
+                                  uint32_t server_id,
+                                  mongoc_cluster_pending_reply_cb_t cb,
+                                  void *ctx);
+
+void
+mongoc_cluster_clear_pending_reply (mongoc_cluster_t *cluster, void *ctx);
+
+void
+mongoc_cluster_read_pending_reply (mongoc_cluster_t *cluster);
+
 bool
 mongoc_cluster_run_command_private (mongoc_cluster_t *cluster,
                                     mongoc_cmd_t *cmd,
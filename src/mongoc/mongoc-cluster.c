@@ -57,6 +57,10 @@
 
 #define CHECK_CLOSED_DURATION_MSEC 1000
 
+/* bound the requests written ahead of their replies, so neither side of a
+ * pipelined connection blocks forever on a full socket buffer */
+#define MONGOC_CLUSTER_PIPELINE_MAX_IN_FLIGHT 16
+
 #define DB_AND_CMD_FROM_COLLECTION(outstr, name)              \
    do {                                                       \
       const char *dot = strchr (name, '.');                   \
@@ -70,6 +74,18 @@
 
 #define IS_NOT_COMMAND(_name) (!!strcasecmp (cmd->command_name, _name))
 
+/* A SCRAM conversation begun in the handshake's speculativeAuthenticate
+ * field. If the server answers it, authentication resumes from its reply
+ * instead of sending saslStart. */
+typedef struct {
+   bool started;
+   bool accepted;
+#ifdef MONGOC_ENABLE_CRYPTO
+   mongoc_scram_t scram;
+#endif
+   bson_t reply;
+} mongoc_cluster_speculative_auth_t;
+
 static mongoc_server_stream_t *
 mongoc_cluster_fetch_stream_single (mongoc_cluster_t *cluster,
                                     uint32_t server_id,
@@ -407,6 +423,90 @@ handle_not_master_error (mongoc_cluster_t *cluster,
    }
 }
 
+/* execute the client's APM callbacks for a command, if they are set */
+static void
+_mongoc_cluster_monitor_started (mongoc_cluster_t *cluster,
+                                 mongoc_cmd_t *cmd,
+                                 int64_t request_id)
+{
+   mongoc_apm_callbacks_t *callbacks;
+   mongoc_apm_command_started_t started_event;
+
+   callbacks = &cluster->client->apm_callbacks;
+   if (!callbacks->started) {
+      return;
+   }
+
+   mongoc_apm_command_started_init_with_cmd (
+      &started_event, cmd, request_id, cluster->client->apm_context);
+
+   callbacks->started (&started_event);
+   mongoc_apm_command_started_cleanup (&started_event);
+}
+
+
+static void
+_mongoc_cluster_monitor_succeeded (mongoc_cluster_t *cluster,
+                                   mongoc_cmd_t *cmd,
+                                   const bson_t *reply,
+                                   int64_t request_id,
+                                   int64_t started)
+{
+   mongoc_apm_callbacks_t *callbacks;
+   mongoc_apm_command_succeeded_t succeeded_event;
+   const mongoc_server_stream_t *server_stream = cmd->server_stream;
+
+   callbacks = &cluster->client->apm_callbacks;
+   if (!callbacks->succeeded) {
+      return;
+   }
+
+   mongoc_apm_command_succeeded_init (&succeeded_event,
+                                      bson_get_monotonic_time () - started,
+                                      reply,
+                                      cmd->command_name,
+                                      request_id,
+                                      cmd->operation_id,
+                                      &server_stream->sd->host,
+                                      server_stream->sd->id,
+                                      cluster->client->apm_context);
+
+   callbacks->succeeded (&succeeded_event);
+   mongoc_apm_command_succeeded_cleanup (&succeeded_event);
+}
+
+
+static void
+_mongoc_cluster_monitor_failed (mongoc_cluster_t *cluster,
+                                mongoc_cmd_t *cmd,
+                                const bson_error_t *error,
+                                int64_t request_id,
+                                int64_t started)
+{
+   mongoc_apm_callbacks_t *callbacks;
+   mongoc_apm_command_failed_t failed_event;
+   const mongoc_server_stream_t *server_stream = cmd->server_stream;
+
+   callbacks = &cluster->client->apm_callbacks;
+   if (!callbacks->failed) {
+      return;
+   }
+
+   mongoc_apm_command_failed_init (&failed_event,
+                                   bson_get_monotonic_time () - started,
+                                   cmd->command_name,
+                                   error,
+                                   request_id,
+                                   cmd->operation_id,
+                                   &server_stream->sd->host,
+                                   server_stream->sd->id,
+                                   cluster->client->apm_context);
+
+   callbacks->failed (&failed_event);
+   mongoc_apm_command_failed_cleanup (&failed_event);
+}
+
+
 /*
  *--------------------------------------------------------------------------
  *
@@ -434,11 +534,7 @@ mongoc_cluster_run_command_monitored (mongoc_cluster_t *cluster,
    bool retval;
    uint32_t request_id = ++cluster->request_id;
    uint32_t server_id;
-   mongoc_apm_callbacks_t *callbacks;
-   mongoc_apm_command_started_t started_event;
-   mongoc_apm_command_succeeded_t succeeded_event;
-   mongoc_apm_command_failed_t failed_event;
-   int64_t started = bson_get_monotonic_time ();
+   int64_t started;
    const mongoc_server_stream_t *server_stream;
    bson_t reply_local;
    bson_error_t error_local;
@@ -448,7 +544,6 @@ mongoc_cluster_run_command_monitored (mongoc_cluster_t *cluster,
    server_id = server_stream->sd->id;
    compressor_id = mongoc_server_description_compressor_id (server_stream->sd);
 
-   callbacks = &cluster->client->apm_callbacks;
    if (!reply) {
       reply = &reply_local;
    }
@@ -456,47 +551,21 @@ mongoc_cluster_run_command_monitored (mongoc_cluster_t *cluster,
       error = &error_local;
    }
 
-   if (callbacks->started) {
-      mongoc_apm_command_started_init_with_cmd (
-         &started_event, cmd, request_id, cluster->client->apm_context);
-
-      callbacks->started (&started_event);
-      mongoc_apm_command_started_cleanup (&started_event);
-   }
+   _mongoc_cluster_monitor_started (cluster, cmd, request_id);
 
+   started = _mongoc_topology_op_started (cluster->client->topology, server_id);
    if (server_stream->sd->max_wire_version >= WIRE_VERSION_OP_MSG) {
       retval = mongoc_cluster_run_opmsg (cluster, cmd, reply, error);
    } else {
       retval = mongoc_cluster_run_command_opquery (
          cluster, cmd, server_stream->stream, compressor_id, reply, error);
    }
-   if (retval && callbacks->succeeded) {
-      mongoc_apm_command_succeeded_init (&succeeded_event,
-                                         bson_get_monotonic_time () - started,
-                                         reply,
-                                         cmd->command_name,
-                                         request_id,
-                                         cmd->operation_id,
-                                         &server_stream->sd->host,
-                                         server_id,
-                                         cluster->client->apm_context);
-
-      callbacks->succeeded (&succeeded_event);
-      mongoc_apm_command_succeeded_cleanup (&succeeded_event);
-   }
-   if (!retval && callbacks->failed) {
-      mongoc_apm_command_failed_init (&failed_event,
-                                      bson_get_monotonic_time () - started,
-                                      cmd->command_name,
-                                      error,
-                                      request_id,
-                                      cmd->operation_id,
-                                      &server_stream->sd->host,
-                                      server_id,
-                                      cluster->client->apm_context);
-
-      callbacks->failed (&failed_event);
-      mongoc_apm_command_failed_cleanup (&failed_event);
+   _mongoc_topology_op_finished (cluster->client->topology, server_id, started);
+   if (retval) {
+      _mongoc_cluster_monitor_succeeded (
+         cluster, cmd, reply, request_id, started);
+   } else {
+      _mongoc_cluster_monitor_failed (cluster, cmd, error, request_id, started);
    }
    if (!retval) {
       handle_not_master_error (cluster, server_id, error);
@@ -539,6 +608,7 @@ mongoc_cluster_run_command_private (mongoc_cluster_t *cluster,
    const mongoc_server_stream_t *server_stream;
    bson_t reply_local;
    bson_error_t error_local;
+   int64_t started;
 
    if (!error) {
       error = &error_local;
@@ -548,12 +618,16 @@ mongoc_cluster_run_command_private (mongoc_cluster_t *cluster,
       reply = &reply_local;
    }
    server_stream = cmd->server_stream;
+   started = _mongoc_topology_op_started (cluster->client->topology,
+                                          server_stream->sd->id);
    if (server_stream->sd->max_wire_version >= WIRE_VERSION_OP_MSG) {
       retval = mongoc_cluster_run_opmsg (cluster, cmd, reply, error);
    } else {
       retval = mongoc_cluster_run_command_opquery (
          cluster, cmd, cmd->server_stream->stream, -1, reply, error);
    }
+   _mongoc_topology_op_finished (
+      cluster->client->topology, server_stream->sd->id, started);
    if (reply == &reply_local) {
       bson_destroy (&reply_local);
    }
@@ -608,6 +682,170 @@ mongoc_cluster_run_command_parts (mongoc_cluster_t *cluster,
    return ret;
 }
 
+static const char *
+_mongoc_cluster_get_auth_source (mongoc_cluster_t *cluster)
+{
+   const char *auth_source;
+
+   if (!(auth_source = mongoc_uri_get_auth_source (cluster->uri)) ||
+       (*auth_source == '\0')) {
+      auth_source = "admin";
+   }
+
+   return auth_source;
+}
+
+
+#ifdef MONGOC_ENABLE_CRYPTO
+static void
+_mongoc_cluster_init_scram (mongoc_cluster_t *cluster, mongoc_scram_t *scram)
+{
+   _mongoc_scram_init (scram);
+
+   _mongoc_scram_set_pass (scram, mongoc_uri_get_password (cluster->uri));
+   _mongoc_scram_set_user (scram, mongoc_uri_get_username (cluster->uri));
+   if (*cluster->scram_client_key) {
+      _mongoc_scram_set_client_key (
+         scram, cluster->scram_client_key, sizeof (cluster->scram_client_key));
+   }
+   if (*cluster->scram_server_key) {
+      _mongoc_scram_set_server_key (
+         scram, cluster->scram_server_key, sizeof (cluster->scram_server_key));
+   }
+   if (*cluster->scram_salted_password) {
+      _mongoc_scram_set_salted_password (
+         scram,
+         cluster->scram_salted_password,
+         sizeof (cluster->scram_salted_password));
+   }
+}
+#endif
+
+
+static void
+_mongoc_cluster_speculative_auth_init (
+   mongoc_cluster_speculative_auth_t *speculative)
+{
+   speculative->started = false;
+   speculative->accepted = false;
+   bson_init (&speculative->reply);
+}
+
+
+static void
+_mongoc_cluster_speculative_auth_destroy (
+   mongoc_cluster_speculative_auth_t *speculative)
+{
+#ifdef MONGOC_ENABLE_CRYPTO
+   if (speculative->started) {
+      _mongoc_scram_destroy (&speculative->scram);
+   }
+#endif
+
+   bson_destroy (&speculative->reply);
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * _mongoc_cluster_speculative_auth_start --
+ *
+ *       If @cluster authenticates with SCRAM-SHA-1, take the first SCRAM
+ *       step and copy @ismaster into @command with the resulting saslStart
+ *       in its speculativeAuthenticate field.
+ *
+ *       The mechanism defaults to SCRAM-SHA-1 when none is configured;
+ *       servers too old for it ignore the field.
+ *
+ * Returns:
+ *       true if @command was built and should be sent instead of @ismaster.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+static bool
+_mongoc_cluster_speculative_auth_start (
+   mongoc_cluster_t *cluster,
+   mongoc_cluster_speculative_auth_t *speculative,
+   const bson_t *ismaster,
+   bson_t *command /* OUT */)
+{
+#ifdef MONGOC_ENABLE_CRYPTO
+   const char *mechanism;
+   uint8_t buf[4096] = {0};
+   uint32_t buflen = 0;
+   bson_error_t error;
+   bson_t doc;
+
+   BSON_ASSERT (!speculative->started);
+
+   if (!cluster->requires_auth) {
+      return false;
+   }
+
+   mechanism = mongoc_uri_get_auth_mechanism (cluster->uri);
+   if (mechanism && strcasecmp (mechanism, "SCRAM-SHA-1") != 0) {
+      return false;
+   }
+
+   _mongoc_cluster_init_scram (cluster, &speculative->scram);
+   speculative->started = true;
+
+   if (!_mongoc_scram_step (&speculative->scram,
+                            buf,
+                            buflen,
+                            buf,
+                            sizeof buf,
+                            &buflen,
+                            &error)) {
+      /* authenticate normally after the handshake, and fail there */
+      return false;
+   }
+
+   bson_destroy (command);
+   bson_copy_to (ismaster, command);
+   BSON_APPEND_DOCUMENT_BEGIN (command, "speculativeAuthenticate", &doc);
+   BSON_APPEND_INT32 (&doc, "saslStart", 1);
+   BSON_APPEND_UTF8 (&doc, "mechanism", "SCRAM-SHA-1");
+   bson_append_binary (&doc, "payload", 7, BSON_SUBTYPE_BINARY, buf, buflen);
+   BSON_APPEND_INT32 (&doc, "autoAuthorize", 1);
+   BSON_APPEND_UTF8 (&doc, "db", _mongoc_cluster_get_auth_source (cluster));
+   bson_append_document_end (command, &doc);
+
+   TRACE ("%s", "SCRAM: speculative authentication in handshake");
+
+   return true;
+#else
+   return false;
+#endif
+}
+
+
+/* Keep the server's reply to speculativeAuthenticate, if it sent one */
+static void
+_mongoc_cluster_speculative_auth_finish (
+   mongoc_cluster_speculative_auth_t *speculative, const bson_t *ismaster)
+{
+   bson_iter_t iter;
+   uint32_t len;
+   const uint8_t *data;
+   bson_t reply;
+
+   if (!speculative->started ||
+       !bson_iter_init_find (&iter, ismaster, "speculativeAuthenticate") ||
+       !BSON_ITER_HOLDS_DOCUMENT (&iter)) {
+      return;
+   }
+
+   bson_iter_document (&iter, &len, &data);
+   BSON_ASSERT (bson_init_static (&reply, data, len));
+   bson_destroy (&speculative->reply);
+   bson_copy_to (&reply, &speculative->reply);
+   speculative->accepted = true;
+}
+
+
 /*
  *--------------------------------------------------------------------------
  *
@@ -626,9 +864,11 @@ _mongoc_stream_run_ismaster (mongoc_cluster_t *cluster,
                              mongoc_stream_t *stream,
                              const char *address,
                              uint32_t server_id,
+                             mongoc_cluster_speculative_auth_t *speculative,
                              bson_error_t *error)
 {
    const bson_t *command;
+   bson_t speculative_command = BSON_INITIALIZER;
    mongoc_cmd_parts_t parts;
    bson_t reply;
    int64_t start;
@@ -641,22 +881,31 @@ _mongoc_stream_run_ismaster (mongoc_cluster_t *cluster,
 
    BSON_ASSERT (cluster);
    BSON_ASSERT (stream);
+   BSON_ASSERT (speculative);
 
    command = _mongoc_topology_scanner_get_ismaster (
       cluster->client->topology->scanner);
 
+   if (_mongoc_cluster_speculative_auth_start (
+          cluster, speculative, command, &speculative_command)) {
+      command = &speculative_command;
+   }
+
    start = bson_get_monotonic_time ();
    server_stream = _mongoc_cluster_create_server_stream (
       cluster->client->topology, server_id, stream, error);
    if (!server_stream) {
+      bson_destroy (&speculative_command);
       RETURN (NULL);
    }
 
    mongoc_cmd_parts_init (
       &parts, cluster->client, "admin", MONGOC_QUERY_SLAVE_OK, command);
    parts.prohibit_lsid = true;
-   if (!mongoc_cluster_run_command_parts (
-          cluster, server_stream, &parts, &reply, error)) {
+   r = mongoc_cluster_run_command_parts (
+      cluster, server_stream, &parts, &reply, error);
+   bson_destroy (&speculative_command);
+   if (!r) {
       bson_destroy (&reply);
       mongoc_server_stream_cleanup (server_stream);
       RETURN (NULL);
@@ -664,6 +913,8 @@ _mongoc_stream_run_ismaster (mongoc_cluster_t *cluster,
 
    rtt_msec = (bson_get_monotonic_time () - start) / 1000;
 
+   _mongoc_cluster_speculative_auth_finish (speculative, &reply);
+
    sd = (mongoc_server_description_t *) bson_malloc0 (
       sizeof (mongoc_server_description_t));
 
@@ -709,6 +960,7 @@ static mongoc_server_description_t *
 _mongoc_cluster_run_ismaster (mongoc_cluster_t *cluster,
                               mongoc_cluster_node_t *node,
                               uint32_t server_id,
+                              mongoc_cluster_speculative_auth_t *speculative,
                               bson_error_t *error /* OUT */)
 {
    mongoc_server_description_t *sd;
@@ -719,8 +971,12 @@ _mongoc_cluster_run_ismaster (mongoc_cluster_t *cluster,
    BSON_ASSERT (node);
    BSON_ASSERT (node->stream);
 
-   sd = _mongoc_stream_run_ismaster (
-      cluster, node->stream, node->connection_address, server_id, error);
+   sd = _mongoc_stream_run_ismaster (cluster,
+                                     node->stream,
+                                     node->connection_address,
+                                     server_id,
+                                     speculative,
+                                     error);
 
    if (sd->type == MONGOC_SERVER_UNKNOWN) {
       memcpy (error, &sd->error, sizeof (bson_error_t));
@@ -1084,62 +1340,130 @@ _mongoc_cluster_auth_node_x509 (mongoc_cluster_t *cluster,
 
 
 #ifdef MONGOC_ENABLE_CRYPTO
+/*
+ *--------------------------------------------------------------------------
+ *
+ * _mongoc_cluster_scram_handle_reply --
+ *
+ *       Parse a reply to saslStart or saslContinue, copying its payload
+ *       into @buf for the next SCRAM step.
+ *
+ * Returns:
+ *       true if the conversation is done or may continue, false on error
+ *       and @error is set.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+static bool
+_mongoc_cluster_scram_handle_reply (const bson_t *reply,
+                                    bool *done,
+                                    int *conv_id,
+                                    uint8_t *buf,
+                                    uint32_t bufmax,
+                                    uint32_t *buflen,
+                                    bson_error_t *error)
+{
+   bson_iter_t iter;
+   bson_subtype_t btype;
+   const char *tmpstr;
+
+   if (bson_iter_init_find (&iter, reply, "done") &&
+       bson_iter_as_bool (&iter)) {
+      *done = true;
+      return true;
+   }
+
+   if (!bson_iter_init_find (&iter, reply, "conversationId") ||
+       !BSON_ITER_HOLDS_INT32 (&iter) ||
+       !(*conv_id = bson_iter_int32 (&iter)) ||
+       !bson_iter_init_find (&iter, reply, "payload") ||
+       !BSON_ITER_HOLDS_BINARY (&iter)) {
+      const char *errmsg = "Received invalid SCRAM reply from MongoDB server.";
+
+      MONGOC_DEBUG ("SCRAM: authentication failed");
+
+      if (bson_iter_init_find (&iter, reply, "errmsg") &&
+          BSON_ITER_HOLDS_UTF8 (&iter)) {
+         errmsg = bson_iter_utf8 (&iter, NULL);
+      }
+
+      bson_set_error (error,
+                      MONGOC_ERROR_CLIENT,
+                      MONGOC_ERROR_CLIENT_AUTHENTICATE,
+                      "%s",
+                      errmsg);
+      return false;
+   }
+
+   bson_iter_binary (&iter, &btype, buflen, (const uint8_t **) &tmpstr);
+
+   if (*buflen > bufmax) {
+      bson_set_error (error,
+                      MONGOC_ERROR_CLIENT,
+                      MONGOC_ERROR_CLIENT_AUTHENTICATE,
+                      "SCRAM reply from MongoDB is too large.");
+      return false;
+   }
+
+   memcpy (buf, tmpstr, *buflen);
+
+   return true;
+}
+
+
 static bool
 _mongoc_cluster_auth_node_scram (mongoc_cluster_t *cluster,
                                  mongoc_stream_t *stream,
                                  mongoc_server_description_t *sd,
+                                 mongoc_cluster_speculative_auth_t *speculative,
                                  bson_error_t *error)
 {
    mongoc_cmd_parts_t parts;
    uint32_t buflen = 0;
-   mongoc_scram_t scram;
-   bson_iter_t iter;
+   mongoc_scram_t local_scram;
+   mongoc_scram_t *scram;
    bool ret = false;
-   const char *tmpstr;
+   bool done = false;
    const char *auth_source;
    uint8_t buf[4096] = {0};
    bson_t cmd;
    bson_t reply;
    int conv_id = 0;
-   bson_subtype_t btype;
    mongoc_server_stream_t *server_stream;
 
    BSON_ASSERT (cluster);
    BSON_ASSERT (stream);
 
-   if (!(auth_source = mongoc_uri_get_auth_source (cluster->uri)) ||
-       (*auth_source == '\0')) {
-      auth_source = "admin";
-   }
-
-   _mongoc_scram_init (&scram);
-
-   _mongoc_scram_set_pass (&scram, mongoc_uri_get_password (cluster->uri));
-   _mongoc_scram_set_user (&scram, mongoc_uri_get_username (cluster->uri));
-   if (*cluster->scram_client_key) {
-      _mongoc_scram_set_client_key (
-         &scram, cluster->scram_client_key, sizeof (cluster->scram_client_key));
-   }
-   if (*cluster->scram_server_key) {
-      _mongoc_scram_set_server_key (
-         &scram, cluster->scram_server_key, sizeof (cluster->scram_server_key));
-   }
-   if (*cluster->scram_salted_password) {
-      _mongoc_scram_set_salted_password (
-         &scram,
-         cluster->scram_salted_password,
-         sizeof (cluster->scram_salted_password));
+   auth_source = _mongoc_cluster_get_auth_source (cluster);
+
+   if (speculative && speculative->accepted) {
+      /* the server answered saslStart in its ismaster reply */
+      TRACE ("%s", "SCRAM: resuming speculative authentication");
+      scram = &speculative->scram;
+      if (!_mongoc_cluster_scram_handle_reply (&speculative->reply,
+                                               &done,
+                                               &conv_id,
+                                               buf,
+                                               sizeof buf,
+                                               &buflen,
+                                               error)) {
+         return false;
+      }
+   } else {
+      scram = &local_scram;
+      _mongoc_cluster_init_scram (cluster, scram);
    }
 
-   for (;;) {
+   while (!done) {
       if (!_mongoc_scram_step (
-             &scram, buf, buflen, buf, sizeof buf, &buflen, error)) {
+             scram, buf, buflen, buf, sizeof buf, &buflen, error)) {
          goto failure;
       }
 
       bson_init (&cmd);
 
-      if (scram.step == 1) {
+      if (scram->step == 1) {
          BSON_APPEND_INT32 (&cmd, "saslStart", 1);
          BSON_APPEND_UTF8 (&cmd, "mechanism", "SCRAM-SHA-1");
          bson_append_binary (
@@ -1152,7 +1476,7 @@ _mongoc_cluster_auth_node_scram (mongoc_cluster_t *cluster,
             &cmd, "payload", 7, BSON_SUBTYPE_BINARY, buf, buflen);
       }
 
-      TRACE ("SCRAM: authenticating (step %d)", scram.step);
+      TRACE ("SCRAM: authenticating (step %d)", scram->step);
 
       mongoc_cmd_parts_init (
          &parts, cluster->client, auth_source, MONGOC_QUERY_SLAVE_OK, &cmd);
@@ -1174,49 +1498,12 @@ _mongoc_cluster_auth_node_scram (mongoc_cluster_t *cluster,
 
       bson_destroy (&cmd);
 
-      if (bson_iter_init_find (&iter, &reply, "done") &&
-          bson_iter_as_bool (&iter)) {
-         bson_destroy (&reply);
-         break;
-      }
-
-      if (!bson_iter_init_find (&iter, &reply, "conversationId") ||
-          !BSON_ITER_HOLDS_INT32 (&iter) ||
-          !(conv_id = bson_iter_int32 (&iter)) ||
-          !bson_iter_init_find (&iter, &reply, "payload") ||
-          !BSON_ITER_HOLDS_BINARY (&iter)) {
-         const char *errmsg =
-            "Received invalid SCRAM reply from MongoDB server.";
-
-         MONGOC_DEBUG ("SCRAM: authentication failed");
-
-         if (bson_iter_init_find (&iter, &reply, "errmsg") &&
-             BSON_ITER_HOLDS_UTF8 (&iter)) {
-            errmsg = bson_iter_utf8 (&iter, NULL);
-         }
-
-         bson_set_error (error,
-                         MONGOC_ERROR_CLIENT,
-                         MONGOC_ERROR_CLIENT_AUTHENTICATE,
-                         "%s",
-                         errmsg);
-         bson_destroy (&reply);
-         goto failure;
-      }
-
-      bson_iter_binary (&iter, &btype, &buflen, (const uint8_t **) &tmpstr);
-
-      if (buflen > sizeof buf) {
-         bson_set_error (error,
-                         MONGOC_ERROR_CLIENT,
-                         MONGOC_ERROR_CLIENT_AUTHENTICATE,
-                         "SCRAM reply from MongoDB is too large.");
+      if (!_mongoc_cluster_scram_handle_reply (
+             &reply, &done, &conv_id, buf, sizeof buf, &buflen, error)) {
          bson_destroy (&reply);
          goto failure;
       }
 
-      memcpy (buf, tmpstr, buflen);
-
       bson_destroy (&reply);
    }
 
@@ -1224,17 +1511,19 @@ _mongoc_cluster_auth_node_scram (mongoc_cluster_t *cluster,
 
    ret = true;
    memcpy (cluster->scram_client_key,
-           scram.client_key,
+           scram->client_key,
            sizeof (cluster->scram_client_key));
    memcpy (cluster->scram_server_key,
-           scram.server_key,
+           scram->server_key,
            sizeof (cluster->scram_server_key));
    memcpy (cluster->scram_salted_password,
-           scram.salted_password,
+           scram->salted_password,
            sizeof (cluster->scram_salted_password));
 
 failure:
-   _mongoc_scram_destroy (&scram);
+   if (scram == &local_scram) {
+      _mongoc_scram_destroy (&local_scram);
+   }
 
    return ret;
 }
@@ -1247,6 +1536,8 @@ failure:
  * _mongoc_cluster_auth_node --
  *
  *       Authenticate a cluster node depending on the required mechanism.
+ *       If the server accepted the SCRAM conversation begun in
+ *       @speculative, it is continued rather than started over.
  *
  * Returns:
  *       true if authenticated. false on failure and @error is set.
@@ -1261,6 +1552,7 @@ static bool
 _mongoc_cluster_auth_node (mongoc_cluster_t *cluster,
                            mongoc_stream_t *stream,
                            mongoc_server_description_t *sd,
+                           mongoc_cluster_speculative_auth_t *speculative,
                            bson_error_t *error)
 {
    bool ret = false;
@@ -1295,7 +1587,8 @@ _mongoc_cluster_auth_node (mongoc_cluster_t *cluster,
 #endif
    } else if (0 == strcasecmp (mechanism, "SCRAM-SHA-1")) {
 #ifdef MONGOC_ENABLE_CRYPTO
-      ret = _mongoc_cluster_auth_node_scram (cluster, stream, sd, error);
+      ret = _mongoc_cluster_auth_node_scram (
+         cluster, stream, sd, speculative, error);
 #else
       bson_set_error (error,
                       MONGOC_ERROR_CLIENT,
@@ -1337,8 +1630,103 @@ _mongoc_cluster_auth_node (mongoc_cluster_t *cluster,
 }
 
 
-/*
- *--------------------------------------------------------------------------
+static void
+_mongoc_cluster_settle_pending_reply (mongoc_cluster_t *cluster, bool abandon)
+{
+   mongoc_cluster_pending_reply_cb_t cb;
+   void *ctx;
+
+   cb = cluster->pending_reply.cb;
+   ctx = cluster->pending_reply.ctx;
+
+   if (!cb) {
+      return;
+   }
+
+   /* clear first, the callback uses the cluster to read the reply */
+   memset (&cluster->pending_reply, 0, sizeof cluster->pending_reply);
+   cb (ctx, abandon);
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * mongoc_cluster_set_pending_reply --
+ *
+ *       Record that a request was sent to @server_id and its reply is
+ *       still unread, e.g. a cursor's getMore sent ahead of time. Before
+ *       the cluster uses any connection again, @cb is called to read the
+ *       reply, so it isn't mistaken for the reply to another request. If
+ *       the server's connection is closed first, @cb is called with
+ *       abandon=true and must not read.
+ *
+ *       Only one reply can be pending: a previous one is read first.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+void
+mongoc_cluster_set_pending_reply (mongoc_cluster_t *cluster,
+                                  uint32_t server_id,
+                                  mongoc_cluster_pending_reply_cb_t cb,
+                                  void *ctx)
+{
+   BSON_ASSERT (cluster);
+   BSON_ASSERT (cb);
+
+   _mongoc_cluster_settle_pending_reply (cluster, false);
+
+   cluster->pending_reply.server_id = server_id;
+   cluster->pending_reply.cb = cb;
+   cluster->pending_reply.ctx = ctx;
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * mongoc_cluster_clear_pending_reply --
+ *
+ *       Forget the pending reply registered with @ctx, if any, because its
+ *       owner has read it.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+void
+mongoc_cluster_clear_pending_reply (mongoc_cluster_t *cluster, void *ctx)
+{
+   BSON_ASSERT (cluster);
+
+   if (cluster->pending_reply.cb && cluster->pending_reply.ctx == ctx) {
+      memset (&cluster->pending_reply, 0, sizeof cluster->pending_reply);
+   }
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * mongoc_cluster_read_pending_reply --
+ *
+ *       Read the pending reply, if any, so its connection can be reused.
+ *       Called before every operation that selects a server or stream.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+void
+mongoc_cluster_read_pending_reply (mongoc_cluster_t *cluster)
+{
+   BSON_ASSERT (cluster);
+
+   _mongoc_cluster_settle_pending_reply (cluster, false);
+}
+
+
+/*
+ *--------------------------------------------------------------------------
  *
  * mongoc_cluster_disconnect_node --
  *
@@ -1370,6 +1758,11 @@ mongoc_cluster_disconnect_node (mongoc_cluster_t *cluster,
 
    ENTRY;
 
+   if (cluster->pending_reply.cb &&
+       cluster->pending_reply.server_id == server_id) {
+      _mongoc_cluster_settle_pending_reply (cluster, true /* abandon */);
+   }
+
    if (topology->single_threaded) {
       mongoc_topology_scanner_node_t *scanner_node;
 
@@ -1382,6 +1775,7 @@ mongoc_cluster_disconnect_node (mongoc_cluster_t *cluster,
       }
    } else {
       mongoc_set_rm (cluster->nodes, server_id);
+      cluster->node_disconnected = true;
    }
 
    if (invalidate) {
@@ -1461,12 +1855,15 @@ _mongoc_cluster_add_node (mongoc_cluster_t *cluster,
    mongoc_cluster_node_t *cluster_node = NULL;
    mongoc_stream_t *stream;
    mongoc_server_description_t *sd;
+   mongoc_cluster_speculative_auth_t speculative;
 
    ENTRY;
 
    BSON_ASSERT (cluster);
    BSON_ASSERT (!cluster->client->topology->single_threaded);
 
+   _mongoc_cluster_speculative_auth_init (&speculative);
+
    host =
       _mongoc_topology_host_by_id (cluster->client->topology, server_id, error);
 
@@ -1487,14 +1884,15 @@ _mongoc_cluster_add_node (mongoc_cluster_t *cluster,
    /* take critical fields from a fresh ismaster */
    cluster_node = _mongoc_cluster_node_new (stream, host->host_and_port);
 
-   sd = _mongoc_cluster_run_ismaster (cluster, cluster_node, server_id, error);
+   sd = _mongoc_cluster_run_ismaster (
+      cluster, cluster_node, server_id, &speculative, error);
    if (!sd) {
       GOTO (error);
    }
 
    if (cluster->requires_auth) {
       if (!_mongoc_cluster_auth_node (
-             cluster, cluster_node->stream, sd, error)) {
+             cluster, cluster_node->stream, sd, &speculative, error)) {
          MONGOC_WARNING ("Failed authentication to %s (%s)",
                          host->host_and_port,
                          error->message);
@@ -1506,11 +1904,13 @@ _mongoc_cluster_add_node (mongoc_cluster_t *cluster,
 
    mongoc_set_add (cluster->nodes, server_id, cluster_node);
    _mongoc_host_list_destroy_all (host);
+   _mongoc_cluster_speculative_auth_destroy (&speculative);
 
    RETURN (stream);
 
 error:
    _mongoc_host_list_destroy_all (host); /* null ok */
+   _mongoc_cluster_speculative_auth_destroy (&speculative);
 
    if (cluster_node) {
       _mongoc_cluster_node_destroy (cluster_node); /* also destroys stream */
@@ -1656,6 +2056,8 @@ mongoc_cluster_stream_for_server (mongoc_cluster_t *cluster,
       error = &err_local;
    }
 
+   mongoc_cluster_read_pending_reply (cluster);
+
    server_stream = _mongoc_cluster_stream_for_server (
       cluster, server_id, reconnect_ok, error);
 
@@ -1678,7 +2080,9 @@ mongoc_cluster_fetch_stream_single (mongoc_cluster_t *cluster,
    mongoc_server_description_t *sd;
    mongoc_stream_t *stream;
    mongoc_topology_scanner_node_t *scanner_node;
+   mongoc_cluster_speculative_auth_t speculative;
    int64_t expire_at;
+   mongoc_server_stream_t *server_stream = NULL;
 
    topology = cluster->client->topology;
    scanner_node =
@@ -1686,21 +2090,23 @@ mongoc_cluster_fetch_stream_single (mongoc_cluster_t *cluster,
    BSON_ASSERT (scanner_node && !scanner_node->retired);
    stream = scanner_node->stream;
 
+   _mongoc_cluster_speculative_auth_init (&speculative);
+
    if (stream) {
       sd = mongoc_topology_server_by_id (topology, server_id, error);
 
       if (!sd) {
-         return NULL;
+         goto done;
       }
    } else {
       if (!reconnect_ok) {
          stream_not_found (
             topology, server_id, scanner_node->host.host_and_port, error);
-         return NULL;
+         goto done;
       }
 
       if (!mongoc_topology_scanner_node_setup (scanner_node, error)) {
-         return NULL;
+         goto done;
       }
       stream = scanner_node->stream;
 
@@ -1712,7 +2118,7 @@ mongoc_cluster_fetch_stream_single (mongoc_cluster_t *cluster,
                          MONGOC_ERROR_STREAM_CONNECT,
                          "Failed to connect to target host: '%s'",
                          scanner_node->host.host_and_port);
-         return NULL;
+         goto done;
       }
 
 #ifdef MONGOC_ENABLE_SSL
@@ -1732,37 +2138,47 @@ mongoc_cluster_fetch_stream_single (mongoc_cluster_t *cluster,
 
          if (!r) {
             mongoc_topology_scanner_node_disconnect (scanner_node, true);
-            return NULL;
+            goto done;
          }
       }
 #endif
 
-      sd = _mongoc_stream_run_ismaster (
-         cluster, stream, scanner_node->host.host_and_port, server_id, error);
+      sd = _mongoc_stream_run_ismaster (cluster,
+                                        stream,
+                                        scanner_node->host.host_and_port,
+                                        server_id,
+                                        &speculative,
+                                        error);
 
       if (!sd) {
-         return NULL;
+         goto done;
       }
    }
 
    if (sd->type == MONGOC_SERVER_UNKNOWN) {
       memcpy (error, &sd->error, sizeof *error);
       mongoc_server_description_destroy (sd);
-      return NULL;
+      goto done;
    }
 
    /* stream open but not auth'ed: first use since connect or reconnect */
    if (cluster->requires_auth && !scanner_node->has_auth) {
-      if (!_mongoc_cluster_auth_node (cluster, stream, sd, &sd->error)) {
+      if (!_mongoc_cluster_auth_node (
+             cluster, stream, sd, &speculative, &sd->error)) {
          memcpy (error, &sd->error, sizeof *error);
          mongoc_server_description_destroy (sd);
-         return NULL;
+         goto done;
       }
 
       scanner_node->has_auth = true;
    }
 
-   return mongoc_server_stream_new (&topology->description, sd, stream);
+   server_stream = mongoc_server_stream_new (&topology->description, sd, stream);
+
+done:
+   _mongoc_cluster_speculative_auth_destroy (&speculative);
+
+   return server_stream;
 }
 
 
@@ -1775,6 +2191,17 @@ _mongoc_cluster_create_server_stream (mongoc_topology_t *topology,
    mongoc_server_description_t *sd;
    mongoc_server_stream_t *server_stream = NULL;
 
+   if (!topology->single_threaded) {
+      server_stream = _mongoc_topology_server_stream_new (
+         topology, server_id, stream, NULL);
+
+      if (server_stream) {
+         return server_stream;
+      }
+
+      /* not in the snapshot, confirm under the lock below */
+   }
+
    /* can't just use mongoc_topology_server_by_id(), since we must hold the
     * lock while copying topology->description.logical_time below */
    mongoc_mutex_lock (&topology->mutex);
@@ -1918,6 +2345,8 @@ mongoc_cluster_destroy (mongoc_cluster_t *cluster) /* INOUT */
 
    BSON_ASSERT (cluster);
 
+   _mongoc_cluster_settle_pending_reply (cluster, true /* abandon */);
+
    mongoc_uri_destroy (cluster->uri);
 
    mongoc_set_destroy (cluster->nodes);
@@ -1960,6 +2389,9 @@ _mongoc_cluster_stream_for_optype (mongoc_cluster_t *cluster,
 
    BSON_ASSERT (cluster);
 
+   /* server selection may check or rescan this client's connections */
+   mongoc_cluster_read_pending_reply (cluster);
+
    server_id =
       mongoc_topology_select_server_id (topology, optype, read_prefs, error);
 
@@ -2492,18 +2924,33 @@ mongoc_cluster_try_recv (mongoc_cluster_t *cluster,
    RETURN (true);
 }
 
+/*
+ *--------------------------------------------------------------------------
+ *
+ * _mongoc_cluster_send_opmsg --
+ *
+ *       Gather @cmd into an OP_MSG with the given @flags and @request_id
+ *       and write it to the command's stream. Does not wait for a reply.
+ *
+ * Returns:
+ *       true if the message was written, otherwise false and @error is set.
+ *
+ * Side effects:
+ *       If the write fails the cluster disconnects from the server.
+ *
+ *--------------------------------------------------------------------------
+ */
+
 static bool
-mongoc_cluster_run_opmsg (mongoc_cluster_t *cluster,
-                          mongoc_cmd_t *cmd,
-                          bson_t *reply,
-                          bson_error_t *error)
+_mongoc_cluster_send_opmsg (mongoc_cluster_t *cluster,
+                            mongoc_cmd_t *cmd,
+                            uint32_t flags,
+                            int32_t request_id,
+                            bson_error_t *error)
 {
    mongoc_rpc_section_t section[2];
-   mongoc_buffer_t buffer;
-   bson_t reply_local; /* only statically initialized */
    char *output = NULL;
    mongoc_rpc_t rpc;
-   int32_t msg_len;
    bool ok;
    const mongoc_server_stream_t *server_stream;
 
@@ -2513,7 +2960,6 @@ mongoc_cluster_run_opmsg (mongoc_cluster_t *cluster,
                       MONGOC_ERROR_COMMAND,
                       MONGOC_ERROR_COMMAND_INVALID_ARG,
                       "Empty command document");
-      _mongoc_bson_init_if_set (reply);
       return false;
    }
    if (cluster->client->in_exhaust) {
@@ -2521,18 +2967,16 @@ mongoc_cluster_run_opmsg (mongoc_cluster_t *cluster,
                       MONGOC_ERROR_CLIENT,
                       MONGOC_ERROR_CLIENT_IN_EXHAUST,
                       "A cursor derived from this client is in exhaust.");
-      _mongoc_bson_init_if_set (reply);
       return false;
    }
 
    _mongoc_array_clear (&cluster->iov);
-   _mongoc_buffer_init (&buffer, NULL, 0, NULL, NULL);
 
    rpc.header.msg_len = 0;
-   rpc.header.request_id = ++cluster->request_id;
+   rpc.header.request_id = request_id;
    rpc.header.response_to = 0;
    rpc.header.opcode = MONGOC_OPCODE_MSG;
-   rpc.msg.flags = 0;
+   rpc.msg.flags = flags;
    rpc.msg.n_sections = 1;
 
    section[0].payload_type = 0;
@@ -2562,12 +3006,11 @@ mongoc_cluster_run_opmsg (mongoc_cluster_t *cluster,
       if (compressor_id != -1) {
          output = _mongoc_rpc_compress (cluster, compressor_id, &rpc, error);
          if (output == NULL) {
-            _mongoc_bson_init_if_set (reply);
-            _mongoc_buffer_destroy (&buffer);
             return false;
          }
       }
    }
+
    ok = _mongoc_stream_writev_full (server_stream->stream,
                                     (mongoc_iovec_t *) cluster->iov.data,
                                     cluster->iov.len,
@@ -2576,25 +3019,58 @@ mongoc_cluster_run_opmsg (mongoc_cluster_t *cluster,
    if (!ok) {
       mongoc_cluster_disconnect_node (
          cluster, server_stream->sd->id, true, error);
-      bson_free (output);
-      _mongoc_bson_init_if_set (reply);
-      _mongoc_buffer_destroy (&buffer);
-      return false;
    }
 
+   bson_free (output);
+
+   return ok;
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * _mongoc_cluster_recv_opmsg --
+ *
+ *       Read the next OP_MSG from @server_stream into @buffer and scatter
+ *       it into @rpc. A compressed message is decompressed into
+ *       @decompressed, which the caller must free.
+ *
+ * Returns:
+ *       true if successful, otherwise false and @error is set.
+ *
+ * Side effects:
+ *       On success @reply is statically initialized with the message's
+ *       body document; it is valid as long as @buffer and @decompressed.
+ *       If the stream fails the cluster disconnects from the server.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+static bool
+_mongoc_cluster_recv_opmsg (mongoc_cluster_t *cluster,
+                            const mongoc_server_stream_t *server_stream,
+                            mongoc_buffer_t *buffer,
+                            mongoc_rpc_t *rpc,
+                            char **decompressed,
+                            bson_t *reply,
+                            bson_error_t *error)
+{
+   int32_t msg_len;
+   bool ok;
+
+   _mongoc_buffer_clear (buffer, false);
+
    ok = _mongoc_buffer_append_from_stream (
-      &buffer, server_stream->stream, 4, cluster->sockettimeoutms, error);
+      buffer, server_stream->stream, 4, cluster->sockettimeoutms, error);
    if (!ok) {
       mongoc_cluster_disconnect_node (
          cluster, server_stream->sd->id, true, error);
-      bson_free (output);
-      _mongoc_bson_init_if_set (reply);
-      _mongoc_buffer_destroy (&buffer);
       return false;
    }
 
-   BSON_ASSERT (buffer.len == 4);
-   memcpy (&msg_len, buffer.data, 4);
+   BSON_ASSERT (buffer->len == 4);
+   memcpy (&msg_len, buffer->data, 4);
    msg_len = BSON_UINT32_FROM_LE (msg_len);
    if ((msg_len < 16) || (msg_len > server_stream->sd->max_msg_size)) {
       bson_set_error (
@@ -2606,13 +3082,10 @@ mongoc_cluster_run_opmsg (mongoc_cluster_t *cluster,
          server_stream->sd->max_msg_size);
       mongoc_cluster_disconnect_node (
          cluster, server_stream->sd->id, true, error);
-      bson_free (output);
-      _mongoc_bson_init_if_set (reply);
-      _mongoc_buffer_destroy (&buffer);
       return false;
    }
 
-   ok = _mongoc_buffer_append_from_stream (&buffer,
+   ok = _mongoc_buffer_append_from_stream (buffer,
                                            server_stream->stream,
                                            (size_t) msg_len - 4,
                                            cluster->sockettimeoutms,
@@ -2620,60 +3093,155 @@ mongoc_cluster_run_opmsg (mongoc_cluster_t *cluster,
    if (!ok) {
       mongoc_cluster_disconnect_node (
          cluster, server_stream->sd->id, true, error);
-      bson_free (output);
-      _mongoc_bson_init_if_set (reply);
-      _mongoc_buffer_destroy (&buffer);
       return false;
    }
 
-   ok = _mongoc_rpc_scatter (&rpc, buffer.data, buffer.len);
+   ok = _mongoc_rpc_scatter (rpc, buffer->data, buffer->len);
    if (!ok) {
       bson_set_error (error,
                       MONGOC_ERROR_PROTOCOL,
                       MONGOC_ERROR_PROTOCOL_INVALID_REPLY,
                       "Malformed message from server");
-      bson_free (output);
-      _mongoc_bson_init_if_set (reply);
-      _mongoc_buffer_destroy (&buffer);
+      mongoc_cluster_disconnect_node (
+         cluster, server_stream->sd->id, true, error);
       return false;
    }
-   if (BSON_UINT32_FROM_LE (rpc.header.opcode) == MONGOC_OPCODE_COMPRESSED) {
-      size_t len = BSON_UINT32_FROM_LE (rpc.compressed.uncompressed_size) +
+   if (BSON_UINT32_FROM_LE (rpc->header.opcode) == MONGOC_OPCODE_COMPRESSED) {
+      size_t len = BSON_UINT32_FROM_LE (rpc->compressed.uncompressed_size) +
                    sizeof (mongoc_rpc_header_t);
 
-      output = bson_realloc (output, len);
-      if (!_mongoc_rpc_decompress (&rpc, (uint8_t *) output, len)) {
+      *decompressed = bson_realloc (*decompressed, len);
+      if (!_mongoc_rpc_decompress (rpc, (uint8_t *) *decompressed, len)) {
          bson_set_error (error,
                          MONGOC_ERROR_PROTOCOL,
                          MONGOC_ERROR_PROTOCOL_INVALID_REPLY,
                          "Could not decompress message from server");
          mongoc_cluster_disconnect_node (
             cluster, server_stream->sd->id, true, error);
-         bson_free (output);
-         _mongoc_bson_init_if_set (reply);
-         _mongoc_buffer_destroy (&buffer);
          return false;
       }
    }
-   _mongoc_rpc_swab_from_le (&rpc);
+   _mongoc_rpc_swab_from_le (rpc);
 
-   memcpy (&msg_len, rpc.msg.sections[0].payload.bson_document, 4);
+   memcpy (&msg_len, rpc->msg.sections[0].payload.bson_document, 4);
    msg_len = BSON_UINT32_FROM_LE (msg_len);
    bson_init_static (
-      &reply_local, rpc.msg.sections[0].payload.bson_document, msg_len);
+      reply, rpc->msg.sections[0].payload.bson_document, msg_len);
+
+   return true;
+}
+
+
+/* process the reply to @cmd: gossip $clusterTime, update the session, and
+ * check the "ok" field. @reply is optional and always initialized */
+static bool
+_mongoc_cluster_handle_opmsg_reply (mongoc_cluster_t *cluster,
+                                    mongoc_cmd_t *cmd,
+                                    const bson_t *reply_local,
+                                    bson_t *reply,
+                                    bson_error_t *error)
+{
+   bool ok;
 
    _mongoc_topology_update_cluster_time (cluster->client->topology,
-                                         &reply_local);
+                                         reply_local);
    ok = _mongoc_cmd_check_ok (
-      &reply_local, cluster->client->error_api_version, error);
+      reply_local, cluster->client->error_api_version, error);
 
    if (cmd->session) {
       _mongoc_client_session_handle_reply (
-         cmd->session, cmd->is_acknowledged, &reply_local);
+         cmd->session, cmd->is_acknowledged, reply_local);
    }
 
    if (reply) {
-      bson_copy_to (&reply_local, reply);
+      bson_copy_to (reply_local, reply);
+   }
+
+   return ok;
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * _mongoc_cluster_send_unacknowledged_opmsg --
+ *
+ *       Send an unacknowledged write with the "moreToCome" flag. The server
+ *       sends no reply, so this returns as soon as the message is written
+ *       and the connection is immediately ready for the next operation.
+ *       If the server fails the write it closes the connection, and the
+ *       error surfaces on the next acknowledged operation.
+ *
+ * Returns:
+ *       true if the message was written, otherwise false and @error is set.
+ *
+ * Side effects:
+ *       @reply is optional, and set to {ok: 1} on success, as the Command
+ *       Monitoring Spec requires for unacknowledged writes.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+static bool
+_mongoc_cluster_send_unacknowledged_opmsg (mongoc_cluster_t *cluster,
+                                           mongoc_cmd_t *cmd,
+                                           int32_t request_id,
+                                           bson_t *reply,
+                                           bson_error_t *error)
+{
+   bool ok;
+
+   ok = _mongoc_cluster_send_opmsg (
+      cluster, cmd, MONGOC_MSG_MORE_TO_COME, request_id, error);
+
+   if (reply) {
+      bson_init (reply);
+      if (ok) {
+         BSON_APPEND_INT32 (reply, "ok", 1);
+      }
+   }
+
+   return ok;
+}
+
+
+static bool
+mongoc_cluster_run_opmsg (mongoc_cluster_t *cluster,
+                          mongoc_cmd_t *cmd,
+                          bson_t *reply,
+                          bson_error_t *error)
+{
+   mongoc_buffer_t buffer;
+   bson_t reply_local; /* only statically initialized */
+   char *output = NULL;
+   mongoc_rpc_t rpc;
+   bool ok;
+
+   if (mongoc_cmd_is_unacknowledged_write (cmd)) {
+      return _mongoc_cluster_send_unacknowledged_opmsg (
+         cluster, cmd, ++cluster->request_id, reply, error);
+   }
+
+   if (!_mongoc_cluster_send_opmsg (
+          cluster, cmd, MONGOC_MSG_NONE, ++cluster->request_id, error)) {
+      _mongoc_bson_init_if_set (reply);
+      return false;
+   }
+
+   _mongoc_buffer_init (&buffer, NULL, 0, NULL, NULL);
+
+   ok = _mongoc_cluster_recv_opmsg (cluster,
+                                    cmd->server_stream,
+                                    &buffer,
+                                    &rpc,
+                                    &output,
+                                    &reply_local,
+                                    error);
+   if (ok) {
+      ok = _mongoc_cluster_handle_opmsg_reply (
+         cluster, cmd, &reply_local, reply, error);
+   } else {
+      _mongoc_bson_init_if_set (reply);
    }
 
    _mongoc_buffer_destroy (&buffer);
@@ -2681,3 +3249,531 @@ mongoc_cluster_run_opmsg (mongoc_cluster_t *cluster,
 
    return ok;
 }
+
+
+static bool
+_mongoc_cluster_run_exhaust_opmsg (mongoc_cluster_t *cluster,
+                                   mongoc_cmd_t *cmd,
+                                   bool send,
+                                   bson_t *reply,
+                                   bool *more_to_come,
+                                   bson_error_t *error)
+{
+   const mongoc_server_stream_t *server_stream;
+   mongoc_buffer_t buffer;
+   bson_t reply_local; /* only statically initialized */
+   bson_error_t error_local;
+   char *output = NULL;
+   mongoc_rpc_t rpc;
+   uint32_t request_id;
+   int64_t started;
+   bool ok;
+
+   ENTRY;
+
+   BSON_ASSERT (cluster);
+   BSON_ASSERT (cmd);
+   BSON_ASSERT (more_to_come);
+
+   server_stream = cmd->server_stream;
+   started = bson_get_monotonic_time ();
+   *more_to_come = false;
+
+   if (!error) {
+      error = &error_local;
+   }
+
+   /* while the server streams replies, nothing else is sent on this client,
+    * so the last request id is still the one that enabled exhaust */
+   request_id = send ? ++cluster->request_id : cluster->request_id;
+
+   _mongoc_cluster_monitor_started (cluster, cmd, request_id);
+   _mongoc_buffer_init (&buffer, NULL, 0, NULL, NULL);
+
+   if (send && !_mongoc_cluster_send_opmsg (cluster,
+                                            cmd,
+                                            MONGOC_MSG_EXHAUST_ALLOWED,
+                                            request_id,
+                                            error)) {
+      _mongoc_bson_init_if_set (reply);
+      ok = false;
+   } else if (!_mongoc_cluster_recv_opmsg (cluster,
+                                           server_stream,
+                                           &buffer,
+                                           &rpc,
+                                           &output,
+                                           &reply_local,
+                                           error)) {
+      _mongoc_bson_init_if_set (reply);
+      ok = false;
+   } else {
+      *more_to_come = (rpc.msg.flags & MONGOC_MSG_MORE_TO_COME) != 0;
+      ok = _mongoc_cluster_handle_opmsg_reply (
+         cluster, cmd, &reply_local, reply, error);
+
+      if (!ok && *more_to_come) {
+         /* can't leave the rest of the stream unread on a pooled socket */
+         mongoc_cluster_disconnect_node (
+            cluster, server_stream->sd->id, true, error);
+         *more_to_come = false;
+      }
+   }
+
+   if (ok) {
+      _mongoc_cluster_monitor_succeeded (
+         cluster, cmd, reply ? reply : &reply_local, request_id, started);
+   } else {
+      _mongoc_cluster_monitor_failed (cluster, cmd, error, request_id, started);
+      handle_not_master_error (cluster, server_stream->sd->id, error);
+   }
+
+   _mongoc_topology_update_last_used (cluster->client->topology,
+                                      server_stream->sd->id);
+
+   _mongoc_buffer_destroy (&buffer);
+   bson_free (output);
+
+   RETURN (ok);
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * mongoc_cluster_run_command_exhaust --
+ *
+ *       Send a "getMore" command with the OP_MSG "exhaustAllowed" flag and
+ *       read the first reply. If the server sets "moreToCome" on its reply
+ *       it streams each following batch without waiting for another
+ *       getMore; read them with mongoc_cluster_recv_exhaust_reply. The
+ *       server must support OP_MSG exhaust, see WIRE_VERSION_EXHAUST_OP_MSG.
+ *
+ *       The client's APM callbacks are executed.
+ *
+ * Returns:
+ *       true if successful, otherwise false and @error is set.
+ *
+ * Side effects:
+ *       @reply is optional, and always initialized if not NULL.
+ *       @more_to_come is set to true if the server will send more replies.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+bool
+mongoc_cluster_run_command_exhaust (mongoc_cluster_t *cluster,
+                                    mongoc_cmd_t *cmd,
+                                    bson_t *reply,
+                                    bool *more_to_come,
+                                    bson_error_t *error)
+{
+   return _mongoc_cluster_run_exhaust_opmsg (
+      cluster, cmd, true /* send */, reply, more_to_come, error);
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * mongoc_cluster_recv_exhaust_reply --
+ *
+ *       Read the next reply the server streams after
+ *       mongoc_cluster_run_command_exhaust set @more_to_come. Nothing is
+ *       sent; @cmd is the getMore that began the stream, used for APM.
+ *
+ *       The client's APM callbacks are executed.
+ *
+ * Returns:
+ *       true if successful, otherwise false and @error is set.
+ *
+ * Side effects:
+ *       @reply is optional, and always initialized if not NULL.
+ *       @more_to_come is set to true if the server will send more replies.
+ *       If the stream fails the cluster disconnects from the server.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+bool
+mongoc_cluster_recv_exhaust_reply (mongoc_cluster_t *cluster,
+                                   mongoc_cmd_t *cmd,
+                                   bson_t *reply,
+                                   bool *more_to_come,
+                                   bson_error_t *error)
+{
+   return _mongoc_cluster_run_exhaust_opmsg (
+      cluster, cmd, false /* send */, reply, more_to_come, error);
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * mongoc_cluster_send_command_monitored --
+ *
+ *       Send @cmd with OP_MSG without waiting for the reply. Read it later
+ *       with mongoc_cluster_recv_reply_monitored, passing the same @cmd,
+ *       @request_id and @started, before anything else is sent to this
+ *       server; see mongoc_cluster_set_pending_reply.
+ *
+ *       The client's APM callbacks are executed.
+ *
+ * Returns:
+ *       true if the command was sent, otherwise false and @error is set.
+ *
+ * Side effects:
+ *       Sets @request_id and @started.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+bool
+mongoc_cluster_send_command_monitored (mongoc_cluster_t *cluster,
+                                       mongoc_cmd_t *cmd,
+                                       int32_t *request_id,
+                                       int64_t *started,
+                                       bson_error_t *error)
+{
+   BSON_ASSERT (cluster);
+   BSON_ASSERT (cmd);
+   BSON_ASSERT (cmd->server_stream->sd->max_wire_version >=
+                WIRE_VERSION_OP_MSG);
+
+   *request_id = ++cluster->request_id;
+   *started = bson_get_monotonic_time ();
+
+   _mongoc_cluster_monitor_started (cluster, cmd, *request_id);
+
+   if (!_mongoc_cluster_send_opmsg (
+          cluster, cmd, MONGOC_MSG_NONE, *request_id, error)) {
+      _mongoc_cluster_monitor_failed (
+         cluster, cmd, error, *request_id, *started);
+      return false;
+   }
+
+   return true;
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * mongoc_cluster_recv_reply_monitored --
+ *
+ *       Read the reply to a command sent with
+ *       mongoc_cluster_send_command_monitored.
+ *
+ *       The client's APM callbacks are executed.
+ *
+ * Returns:
+ *       true if successful, otherwise false and @error is set.
+ *
+ * Side effects:
+ *       @reply is optional, and always initialized if not NULL.
+ *       If the stream fails the cluster disconnects from the server.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+bool
+mongoc_cluster_recv_reply_monitored (mongoc_cluster_t *cluster,
+                                     mongoc_cmd_t *cmd,
+                                     int32_t request_id,
+                                     int64_t started,
+                                     bson_t *reply,
+                                     bson_error_t *error)
+{
+   const mongoc_server_stream_t *server_stream;
+   mongoc_buffer_t buffer;
+   bson_t reply_local; /* only statically initialized */
+   bson_error_t error_local;
+   char *output = NULL;
+   mongoc_rpc_t rpc;
+   bool ok;
+
+   BSON_ASSERT (cluster);
+   BSON_ASSERT (cmd);
+
+   server_stream = cmd->server_stream;
+
+   if (!error) {
+      error = &error_local;
+   }
+
+   _mongoc_buffer_init (&buffer, NULL, 0, NULL, NULL);
+
+   ok = _mongoc_cluster_recv_opmsg (cluster,
+                                    server_stream,
+                                    &buffer,
+                                    &rpc,
+                                    &output,
+                                    &reply_local,
+                                    error);
+
+   if (ok && rpc.header.response_to != request_id) {
+      bson_set_error (error,
+                      MONGOC_ERROR_PROTOCOL,
+                      MONGOC_ERROR_PROTOCOL_INVALID_REPLY,
+                      "Invalid responseTo. Expected %d, got %d.",
+                      request_id,
+                      rpc.header.response_to);
+      mongoc_cluster_disconnect_node (
+         cluster, server_stream->sd->id, true, error);
+      ok = false;
+   }
+
+   if (ok) {
+      ok = _mongoc_cluster_handle_opmsg_reply (
+         cluster, cmd, &reply_local, reply, error);
+   } else {
+      _mongoc_bson_init_if_set (reply);
+   }
+
+   if (ok) {
+      _mongoc_cluster_monitor_succeeded (
+         cluster, cmd, reply ? reply : &reply_local, request_id, started);
+   } else {
+      _mongoc_cluster_monitor_failed (cluster, cmd, error, request_id, started);
+      handle_not_master_error (cluster, server_stream->sd->id, error);
+   }
+
+   _mongoc_topology_update_last_used (cluster->client->topology,
+                                      server_stream->sd->id);
+
+   _mongoc_buffer_destroy (&buffer);
+   bson_free (output);
+
+   return ok;
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * mongoc_cluster_abandon_reply_monitored --
+ *
+ *       Report that the reply to a command sent with
+ *       mongoc_cluster_send_command_monitored will never be read, because
+ *       its connection closed first.
+ *
+ *       The client's APM callbacks are executed.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+void
+mongoc_cluster_abandon_reply_monitored (mongoc_cluster_t *cluster,
+                                        mongoc_cmd_t *cmd,
+                                        int32_t request_id,
+                                        int64_t started,
+                                        const bson_error_t *error)
+{
+   _mongoc_cluster_monitor_failed (cluster, cmd, error, request_id, started);
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * mongoc_cluster_run_command_pipeline --
+ *
+ *       Run @n_cmds commands on their common server stream, keeping up to
+ *       MONGOC_CLUSTER_PIPELINE_MAX_IN_FLIGHT of them in flight at once.
+ *       Replies are matched to requests by their "responseTo" field and
+ *       stored in @replies in the order of @cmds, regardless of the order
+ *       in which the server answers. Servers older than MongoDB 3.6 do not
+ *       speak OP_MSG; their commands are run one at a time.
+ *
+ *       The client's APM callbacks are executed for each command.
+ *
+ * Returns:
+ *       true if all commands succeeded, otherwise false.
+ *
+ * Side effects:
+ *       Each of @replies is initialized and must be destroyed. Each of
+ *       @errors is set if its command failed. A network error fails every
+ *       command that has not received its reply yet.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+bool
+mongoc_cluster_run_command_pipeline (mongoc_cluster_t *cluster,
+                                     mongoc_cmd_t **cmds,
+                                     size_t n_cmds,
+                                     bson_t *replies,
+                                     bson_error_t *errors)
+{
+   const mongoc_server_stream_t *server_stream;
+   mongoc_buffer_t buffer;
+   bson_t reply_local; /* only statically initialized */
+   bson_error_t error;
+   char *output = NULL;
+   mongoc_rpc_t rpc;
+   int32_t *request_ids;
+   int64_t *started;
+   bool *done;
+   size_t n_sent = 0;
+   size_t n_done = 0;
+   size_t in_flight = 0;
+   size_t i;
+   bool ret = true;
+
+   ENTRY;
+
+   BSON_ASSERT (cluster);
+   BSON_ASSERT (cmds);
+   BSON_ASSERT (replies);
+   BSON_ASSERT (errors);
+
+   if (!n_cmds) {
+      RETURN (true);
+   }
+
+   server_stream = cmds[0]->server_stream;
+   for (i = 1; i < n_cmds; i++) {
+      BSON_ASSERT (cmds[i]->server_stream == server_stream);
+   }
+
+   if (server_stream->sd->max_wire_version < WIRE_VERSION_OP_MSG) {
+      for (i = 0; i < n_cmds; i++) {
+         if (!mongoc_cluster_run_command_monitored (
+                cluster, cmds[i], &replies[i], &errors[i])) {
+            ret = false;
+         }
+      }
+
+      RETURN (ret);
+   }
+
+   request_ids = bson_malloc (n_cmds * sizeof (int32_t));
+   started = bson_malloc (n_cmds * sizeof (int64_t));
+   done = bson_malloc0 (n_cmds * sizeof (bool));
+   _mongoc_buffer_init (&buffer, NULL, 0, NULL, NULL);
+
+   for (i = 0; i < n_cmds; i++) {
+      bson_init (&replies[i]);
+   }
+
+   while (n_done < n_cmds) {
+      /* keep the window full */
+      while (n_sent < n_cmds &&
+             in_flight < MONGOC_CLUSTER_PIPELINE_MAX_IN_FLIGHT) {
+         request_ids[n_sent] = ++cluster->request_id;
+         started[n_sent] = bson_get_monotonic_time ();
+         _mongoc_cluster_monitor_started (
+            cluster, cmds[n_sent], request_ids[n_sent]);
+
+         if (mongoc_cmd_is_unacknowledged_write (cmds[n_sent])) {
+            /* no reply will come, the command is done once it is sent */
+            bson_destroy (&replies[n_sent]);
+            if (!_mongoc_cluster_send_unacknowledged_opmsg (cluster,
+                                                            cmds[n_sent],
+                                                            request_ids[n_sent],
+                                                            &replies[n_sent],
+                                                            &error)) {
+               n_sent++;
+               GOTO (fail_remaining);
+            }
+
+            _mongoc_cluster_monitor_succeeded (cluster,
+                                               cmds[n_sent],
+                                               &replies[n_sent],
+                                               request_ids[n_sent],
+                                               started[n_sent]);
+            done[n_sent] = true;
+            n_done++;
+            n_sent++;
+            continue;
+         }
+
+         if (!_mongoc_cluster_send_opmsg (cluster,
+                                          cmds[n_sent],
+                                          MONGOC_MSG_NONE,
+                                          request_ids[n_sent],
+                                          &error)) {
+            /* the command was announced, fail it with the others below */
+            n_sent++;
+            GOTO (fail_remaining);
+         }
+
+         n_sent++;
+         in_flight++;
+      }
+
+      if (n_done == n_cmds) {
+         break;
+      }
+
+      if (!_mongoc_cluster_recv_opmsg (cluster,
+                                       server_stream,
+                                       &buffer,
+                                       &rpc,
+                                       &output,
+                                       &reply_local,
+                                       &error)) {
+         GOTO (fail_remaining);
+      }
+
+      for (i = 0; i < n_sent; i++) {
+         if (!done[i] && request_ids[i] == rpc.header.response_to) {
+            break;
+         }
+      }
+
+      if (i == n_sent) {
+         bson_set_error (&error,
+                         MONGOC_ERROR_PROTOCOL,
+                         MONGOC_ERROR_PROTOCOL_INVALID_REPLY,
+                         "Received reply to unknown request %d",
+                         rpc.header.response_to);
+         mongoc_cluster_disconnect_node (
+            cluster, server_stream->sd->id, true, &error);
+         GOTO (fail_remaining);
+      }
+
+      bson_destroy (&replies[i]);
+      if (!_mongoc_cluster_handle_opmsg_reply (
+             cluster, cmds[i], &reply_local, &replies[i], &errors[i])) {
+         ret = false;
+         _mongoc_cluster_monitor_failed (
+            cluster, cmds[i], &errors[i], request_ids[i], started[i]);
+         handle_not_master_error (cluster, server_stream->sd->id, &errors[i]);
+      } else {
+         _mongoc_cluster_monitor_succeeded (
+            cluster, cmds[i], &replies[i], request_ids[i], started[i]);
+      }
+
+      done[i] = true;
+      n_done++;
+      in_flight--;
+   }
+
+   GOTO (done);
+
+fail_remaining:
+   ret = false;
+   for (i = 0; i < n_cmds; i++) {
+      if (done[i]) {
+         continue;
+      }
+
+      memcpy (&errors[i], &error, sizeof (bson_error_t));
+      if (i < n_sent) {
+         _mongoc_cluster_monitor_failed (
+            cluster, cmds[i], &errors[i], request_ids[i], started[i]);
+      }
+   }
+
+done:
+   _mongoc_topology_update_last_used (cluster->client->topology,
+                                      server_stream->sd->id);
+
+   _mongoc_buffer_destroy (&buffer);
+   bson_free (output);
+   bson_free (request_ids);
+   bson_free (started);
+   bson_free (done);
+
+   RETURN (ret);
+}
@@ -101,6 +101,9 @@ mongoc_cmd_parts_assemble (mongoc_cmd_parts_t *parts,
 bool
 mongoc_cmd_is_compressible (mongoc_cmd_t *cmd);
 
+bool
+mongoc_cmd_is_unacknowledged_write (const mongoc_cmd_t *cmd);
+
 void
 mongoc_cmd_parts_cleanup (mongoc_cmd_parts_t *op);
 
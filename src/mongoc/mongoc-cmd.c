@@ -746,3 +746,30 @@ mongoc_cmd_is_compressible (mongoc_cmd_t *cmd)
           !!strcasecmp (cmd->command_name, "copydbsaslstart") &&
           !!strcasecmp (cmd->command_name, "copydbgetnonce");
 }
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * mongoc_cmd_is_unacknowledged_write --
+ *
+ *       True if @cmd is an insert, update, or delete with an unacknowledged
+ *       write concern. Such a command can be sent with the OP_MSG
+ *       "moreToCome" flag, and the server will not reply to it.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+bool
+mongoc_cmd_is_unacknowledged_write (const mongoc_cmd_t *cmd)
+{
+   BSON_ASSERT (cmd);
+
+   if (cmd->is_acknowledged || !cmd->command_name) {
+      return false;
+   }
+
+   return !strcmp (cmd->command_name, "insert") ||
+          !strcmp (cmd->command_name, "update") ||
+          !strcmp (cmd->command_name, "delete");
+}
@@ -2838,6 +2838,8 @@ mongoc_collection_create_bulk_operation_with_opts (
          collection->client, &iter, &bulk->session, &bulk->result.error);
    }
 
+   _mongoc_write_result_set_detail (&bulk->result, opts);
+
    if (wc_invalid.domain) {
       /* _mongoc_write_concern_new_from_iter failed, above */
       memcpy (&bulk->result.error, &wc_invalid, sizeof (bson_error_t));
@@ -29,12 +29,35 @@
 BSON_BEGIN_DECLS
 
 
+typedef enum {
+   MONGOC_CURSOR_PREFETCH_NONE,
+   MONGOC_CURSOR_PREFETCH_SENT,
+   MONGOC_CURSOR_PREFETCH_RECEIVED,
+} mongoc_cursor_prefetch_state_t;
+
+
 typedef struct {
    bson_t array;
    bool in_batch;
    bool in_reader;
    bson_iter_t batch_iter;
+   bson_t batch; /* the reply's firstBatch or nextBatch array */
+   bool batch_started;
    bson_t current_doc;
+
+   /* with the "prefetch" option, the next getMore is sent while the
+    * application reads the current batch */
+   mongoc_cursor_prefetch_state_t prefetch_state;
+   bson_t prefetch_cmd;
+   mongoc_cmd_parts_t prefetch_parts;
+   char prefetch_db[MONGOC_NAMESPACE_MAX];
+   mongoc_server_stream_t *prefetch_stream;
+   mongoc_read_prefs_t *prefetch_prefs;
+   int32_t prefetch_request_id;
+   int64_t prefetch_started;
+   bson_t prefetch_reply;
+   bool prefetch_ok;
+   bson_error_t prefetch_error;
 } mongoc_cursor_cursorid_t;
 
 
@@ -45,6 +45,10 @@ _mongoc_cursor_cursorid_new (void)
 }
 
 
+static bool
+_mongoc_cursor_cursorid_take_prefetched (mongoc_cursor_t *cursor);
+
+
 static void
 _mongoc_cursor_cursorid_destroy (mongoc_cursor_t *cursor)
 {
@@ -55,6 +59,11 @@ _mongoc_cursor_cursorid_destroy (mongoc_cursor_t *cursor)
    cid = (mongoc_cursor_cursorid_t *) cursor->iface_data;
    BSON_ASSERT (cid);
 
+   if (cid->prefetch_state != MONGOC_CURSOR_PREFETCH_NONE) {
+      /* learn the latest cursor id, so _mongoc_cursor_destroy kills it */
+      _mongoc_cursor_cursorid_take_prefetched (cursor);
+   }
+
    bson_destroy (&cid->array);
    bson_free (cid);
    _mongoc_cursor_destroy (cursor);
@@ -76,6 +85,8 @@ _mongoc_cursor_cursorid_start_batch (mongoc_cursor_t *cursor)
    bson_iter_t child;
    const char *ns;
    uint32_t nslen;
+   const uint8_t *data;
+   uint32_t data_len;
 
    cid = (mongoc_cursor_cursorid_t *) cursor->iface_data;
 
@@ -93,6 +104,9 @@ _mongoc_cursor_cursorid_start_batch (mongoc_cursor_t *cursor)
                     BSON_ITER_IS_KEY (&child, "nextBatch")) {
             if (BSON_ITER_HOLDS_ARRAY (&child) &&
                 bson_iter_recurse (&child, &cid->batch_iter)) {
+               bson_iter_array (&child, &data_len, &data);
+               bson_init_static (&cid->batch, data, data_len);
+               cid->batch_started = false;
                cid->in_batch = true;
             }
          }
@@ -152,6 +166,8 @@ _mongoc_cursor_cursorid_read_from_batch (mongoc_cursor_t *cursor,
    cid = (mongoc_cursor_cursorid_t *) cursor->iface_data;
    BSON_ASSERT (cid);
 
+   cid->batch_started = true;
+
    if (bson_iter_next (&cid->batch_iter) &&
        BSON_ITER_HOLDS_DOCUMENT (&cid->batch_iter)) {
       bson_iter_document (&cid->batch_iter, &data_len, &data);
@@ -181,8 +197,25 @@ _mongoc_cursor_cursorid_prime (mongoc_cursor_t *cursor)
 
    /* `find` does not have a cursor field */
    if (cursor->is_find) {
-      return _mongoc_cursor_cursorid_refresh_from_command (
-         cursor, &cursor->filter, &cursor->opts);
+      if (!bson_has_field (&cursor->opts, MONGOC_CURSOR_EXHAUST) &&
+          !bson_has_field (&cursor->opts, MONGOC_CURSOR_PREFETCH)) {
+         return _mongoc_cursor_cursorid_refresh_from_command (
+            cursor, &cursor->filter, &cursor->opts);
+      }
+
+      /* "exhaust" is an OP_MSG flag on the getMores, not a find option, and
+       * "prefetch" is handled by the driver */
+      bson_init (&copied_opts);
+      bson_copy_to_excluding_noinit (&cursor->opts,
+                                     &copied_opts,
+                                     MONGOC_CURSOR_EXHAUST,
+                                     MONGOC_CURSOR_PREFETCH,
+                                     NULL);
+      return_value = _mongoc_cursor_cursorid_refresh_from_command (
+         cursor, &cursor->filter, &copied_opts);
+
+      bson_destroy (&copied_opts);
+      return return_value;
    } else {
       /* commands like `aggregate` have a cursor field so we
        * have to copy over opts without "batchSize" */
@@ -252,6 +285,213 @@ _mongoc_cursor_prepare_getmore_command (mongoc_cursor_t *cursor,
 }
 
 
+static void
+_mongoc_cursor_cursorid_prefetch_cleanup (mongoc_cursor_cursorid_t *cid)
+{
+   mongoc_cmd_parts_cleanup (&cid->prefetch_parts);
+   mongoc_server_stream_cleanup (cid->prefetch_stream);
+   mongoc_read_prefs_destroy (cid->prefetch_prefs);
+   bson_destroy (&cid->prefetch_cmd);
+   cid->prefetch_stream = NULL;
+   cid->prefetch_prefs = NULL;
+}
+
+
+/* read the reply to a prefetched getMore before the cluster reuses the
+ * connection, or give up on it if the connection is closing */
+static void
+_mongoc_cursor_cursorid_prefetch_cb (void *ctx, bool abandon)
+{
+   mongoc_cursor_t *cursor;
+   mongoc_cursor_cursorid_t *cid;
+   mongoc_cluster_t *cluster;
+
+   ENTRY;
+
+   cursor = (mongoc_cursor_t *) ctx;
+   cid = (mongoc_cursor_cursorid_t *) cursor->iface_data;
+   BSON_ASSERT (cid);
+   BSON_ASSERT (cid->prefetch_state == MONGOC_CURSOR_PREFETCH_SENT);
+
+   cluster = &cursor->client->cluster;
+
+   if (abandon) {
+      bson_set_error (&cid->prefetch_error,
+                      MONGOC_ERROR_STREAM,
+                      MONGOC_ERROR_STREAM_SOCKET,
+                      "Connection closed before the getMore reply was read");
+      mongoc_cluster_abandon_reply_monitored (cluster,
+                                              &cid->prefetch_parts.assembled,
+                                              cid->prefetch_request_id,
+                                              cid->prefetch_started,
+                                              &cid->prefetch_error);
+      bson_init (&cid->prefetch_reply);
+      cid->prefetch_ok = false;
+   } else {
+      cid->prefetch_ok =
+         mongoc_cluster_recv_reply_monitored (cluster,
+                                              &cid->prefetch_parts.assembled,
+                                              cid->prefetch_request_id,
+                                              cid->prefetch_started,
+                                              &cid->prefetch_reply,
+                                              &cid->prefetch_error);
+   }
+
+   _mongoc_cursor_cursorid_prefetch_cleanup (cid);
+   cid->prefetch_state = MONGOC_CURSOR_PREFETCH_RECEIVED;
+
+   EXIT;
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * _mongoc_cursor_cursorid_prefetch --
+ *
+ *       If the cursor was created with the "prefetch" option, send the
+ *       getMore for the next batch now, while the application is still
+ *       reading the batch just received. The reply is left unread until
+ *       the cursor needs it or the client uses the connection for
+ *       something else; see mongoc_cluster_set_pending_reply.
+ *
+ *       Tailable and exhaust cursors are not prefetched, nor is the last
+ *       batch of a cursor with a limit.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+static void
+_mongoc_cursor_cursorid_prefetch (mongoc_cursor_t *cursor)
+{
+   mongoc_cursor_cursorid_t *cid;
+   mongoc_cluster_t *cluster;
+   bson_iter_t iter;
+   int64_t limit;
+   int64_t unread = 0;
+
+   ENTRY;
+
+   cid = (mongoc_cursor_cursorid_t *) cursor->iface_data;
+   BSON_ASSERT (cid);
+
+   if (!cursor->is_find || !cid->in_batch || cursor->error.domain ||
+       cursor->in_exhaust || !mongoc_cursor_get_id (cursor) ||
+       cid->prefetch_state != MONGOC_CURSOR_PREFETCH_NONE ||
+       !_mongoc_cursor_get_opt_bool (cursor, MONGOC_CURSOR_PREFETCH) ||
+       _mongoc_cursor_get_opt_bool (cursor, MONGOC_CURSOR_TAILABLE) ||
+       _mongoc_cursor_get_opt_bool (cursor, MONGOC_CURSOR_EXHAUST)) {
+      EXIT;
+   }
+
+   memcpy (&iter, &cid->batch_iter, sizeof iter);
+   while (bson_iter_next (&iter)) {
+      unread++;
+   }
+
+   limit = mongoc_cursor_get_limit (cursor);
+   if (limit > 0 && cursor->count + unread >= limit) {
+      EXIT;
+   }
+
+   /* size the getMore's batch as if the current batch was already read */
+   cursor->count += unread;
+   _mongoc_cursor_prepare_getmore_command (cursor, &cid->prefetch_cmd);
+   cursor->count -= unread;
+
+   if (!_mongoc_cursor_prepare_command_parts (cursor,
+                                              &cid->prefetch_cmd,
+                                              NULL /* opts */,
+                                              cid->prefetch_db,
+                                              &cid->prefetch_parts,
+                                              &cid->prefetch_stream,
+                                              &cid->prefetch_prefs)) {
+      /* report the error once the application reaches the next batch */
+      memcpy (&cid->prefetch_error, &cursor->error, sizeof (bson_error_t));
+      memset (&cursor->error, 0, sizeof (bson_error_t));
+      bson_init (&cid->prefetch_reply);
+      cid->prefetch_ok = false;
+      cid->prefetch_state = MONGOC_CURSOR_PREFETCH_RECEIVED;
+      _mongoc_cursor_cursorid_prefetch_cleanup (cid);
+      EXIT;
+   }
+
+   if (cid->prefetch_stream->sd->max_wire_version < WIRE_VERSION_OP_MSG) {
+      /* legacy servers can't reply with OP_MSG, send getMore when needed */
+      _mongoc_cursor_cursorid_prefetch_cleanup (cid);
+      EXIT;
+   }
+
+   cluster = &cursor->client->cluster;
+
+   if (!mongoc_cluster_send_command_monitored (cluster,
+                                               &cid->prefetch_parts.assembled,
+                                               &cid->prefetch_request_id,
+                                               &cid->prefetch_started,
+                                               &cid->prefetch_error)) {
+      bson_init (&cid->prefetch_reply);
+      cid->prefetch_ok = false;
+      cid->prefetch_state = MONGOC_CURSOR_PREFETCH_RECEIVED;
+      _mongoc_cursor_cursorid_prefetch_cleanup (cid);
+      EXIT;
+   }
+
+   cid->prefetch_state = MONGOC_CURSOR_PREFETCH_SENT;
+   mongoc_cluster_set_pending_reply (cluster,
+                                     cid->prefetch_stream->sd->id,
+                                     _mongoc_cursor_cursorid_prefetch_cb,
+                                     cursor);
+
+   EXIT;
+}
+
+
+/* use the reply to a prefetched getMore as the next batch */
+static bool
+_mongoc_cursor_cursorid_take_prefetched (mongoc_cursor_t *cursor)
+{
+   mongoc_cursor_cursorid_t *cid;
+
+   ENTRY;
+
+   cid = (mongoc_cursor_cursorid_t *) cursor->iface_data;
+   BSON_ASSERT (cid);
+
+   if (cid->prefetch_state == MONGOC_CURSOR_PREFETCH_SENT) {
+      mongoc_cluster_clear_pending_reply (&cursor->client->cluster, cursor);
+      _mongoc_cursor_cursorid_prefetch_cb (cursor, false /* abandon */);
+   }
+
+   BSON_ASSERT (cid->prefetch_state == MONGOC_CURSOR_PREFETCH_RECEIVED);
+   cid->prefetch_state = MONGOC_CURSOR_PREFETCH_NONE;
+
+   bson_destroy (&cid->array);
+   if (!bson_steal (&cid->array, &cid->prefetch_reply)) {
+      bson_destroy (&cid->array);
+      bson_copy_to (&cid->prefetch_reply, &cid->array);
+      bson_destroy (&cid->prefetch_reply);
+   }
+
+   if (cid->prefetch_ok && _mongoc_cursor_cursorid_start_batch (cursor)) {
+      RETURN (true);
+   }
+
+   bson_destroy (&cursor->reply);
+   bson_copy_to (&cid->array, &cursor->reply);
+
+   if (cid->prefetch_error.domain) {
+      memcpy (&cursor->error, &cid->prefetch_error, sizeof (bson_error_t));
+   } else {
+      bson_set_error (&cursor->error,
+                      MONGOC_ERROR_PROTOCOL,
+                      MONGOC_ERROR_PROTOCOL_INVALID_REPLY,
+                      "Invalid reply to getMore command.");
+   }
+
+   RETURN (false);
+}
+
+
 static bool
 _mongoc_cursor_cursorid_get_more (mongoc_cursor_t *cursor)
 {
@@ -265,6 +505,10 @@ _mongoc_cursor_cursorid_get_more (mongoc_cursor_t *cursor)
    cid = (mongoc_cursor_cursorid_t *) cursor->iface_data;
    BSON_ASSERT (cid);
 
+   if (cid->prefetch_state != MONGOC_CURSOR_PREFETCH_NONE) {
+      RETURN (_mongoc_cursor_cursorid_take_prefetched (cursor));
+   }
+
    server_stream = _mongoc_cursor_fetch_stream (cursor);
 
    if (!server_stream) {
@@ -309,6 +553,8 @@ _mongoc_cursor_cursorid_next (mongoc_cursor_t *cursor, const bson_t **bson)
       if (!_mongoc_cursor_cursorid_prime (cursor)) {
          GOTO (done);
       }
+
+      _mongoc_cursor_cursorid_prefetch (cursor);
    }
 
 again:
@@ -341,6 +587,7 @@ again:
          GOTO (done);
       }
 
+      _mongoc_cursor_cursorid_prefetch (cursor);
       refreshed = true;
       GOTO (again);
    }
@@ -354,6 +601,96 @@ done:
 }
 
 
+/* hand out the current batch whole, or get the next one */
+static bool
+_mongoc_cursor_cursorid_next_batch (mongoc_cursor_t *cursor,
+                                    const bson_t **batch,
+                                    uint32_t *n_docs)
+{
+   mongoc_cursor_cursorid_t *cid;
+   const bson_t *doc;
+   bool refreshed = false;
+
+   ENTRY;
+
+   cid = (mongoc_cursor_cursorid_t *) cursor->iface_data;
+   BSON_ASSERT (cid);
+
+   if (!cursor->sent) {
+      if (!_mongoc_cursor_cursorid_prime (cursor)) {
+         GOTO (done);
+      }
+
+      _mongoc_cursor_cursorid_prefetch (cursor);
+   }
+
+again:
+
+   if (cid->in_batch) {
+      if (!cid->batch_started) {
+         /* no copy, the array is in the reply */
+         *batch = &cid->batch;
+         *n_docs = bson_count_keys (&cid->batch);
+      } else {
+         /* mongoc_cursor_next has read part of the batch, copy the rest */
+         bson_reinit (&cursor->batch);
+         *batch = &cursor->batch;
+
+         for (;;) {
+            doc = NULL;
+            _mongoc_cursor_cursorid_read_from_batch (cursor, &doc);
+            if (!doc) {
+               break;
+            }
+
+            _mongoc_cursor_append_to_batch (cursor, doc, n_docs);
+         }
+      }
+
+      cid->in_batch = false;
+   } else if (cid->in_reader) {
+      /* OP_GETMORE reply to a command cursor on MongoDB 3.0 */
+      bson_reinit (&cursor->batch);
+      *batch = &cursor->batch;
+
+      while (_mongoc_read_from_buffer (cursor, &doc)) {
+         _mongoc_cursor_append_to_batch (cursor, doc, n_docs);
+      }
+
+      cid->in_reader = false;
+   }
+
+   if (*n_docs) {
+      GOTO (done);
+   }
+
+   if (!refreshed && mongoc_cursor_get_id (cursor)) {
+      if (!_mongoc_cursor_cursorid_get_more (cursor)) {
+         GOTO (done);
+      }
+
+      _mongoc_cursor_cursorid_prefetch (cursor);
+      refreshed = true;
+      GOTO (again);
+   }
+
+done:
+   /* the whole batch is consumed */
+   cursor->end_of_event = true;
+   cursor->count += *n_docs;
+
+   if (!*n_docs) {
+      *batch = NULL;
+
+      if (mongoc_cursor_get_id (cursor) == 0) {
+         cursor->done = 1;
+      }
+   }
+
+   RETURN (*n_docs > 0);
+}
+
+
 static mongoc_cursor_t *
 _mongoc_cursor_cursorid_clone (const mongoc_cursor_t *cursor)
 {
@@ -373,6 +710,9 @@ static mongoc_cursor_interface_t gMongocCursorCursorid = {
    _mongoc_cursor_cursorid_destroy,
    NULL,
    _mongoc_cursor_cursorid_next,
+   NULL,
+   NULL,
+   _mongoc_cursor_cursorid_next_batch,
 };
 
 
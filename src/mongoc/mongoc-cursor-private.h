@@ -25,6 +25,7 @@
 
 #include "mongoc-client.h"
 #include "mongoc-buffer-private.h"
+#include "mongoc-cmd-private.h"
 #include "mongoc-rpc-private.h"
 #include "mongoc-server-stream-private.h"
 
@@ -43,6 +44,9 @@ struct _mongoc_cursor_interface_t {
                            bson_error_t *error,
                            const bson_t **doc);
    void (*get_host) (mongoc_cursor_t *cursor, mongoc_host_list_t *host);
+   bool (*next_batch) (mongoc_cursor_t *cursor,
+                       const bson_t **batch,
+                       uint32_t *n_docs);
 };
 
 #define MONGOC_CURSOR_ALLOW_PARTIAL_RESULTS "allowPartialResults"
@@ -81,6 +85,8 @@ struct _mongoc_cursor_interface_t {
 #define MONGOC_CURSOR_OPLOG_REPLAY_LEN 11
 #define MONGOC_CURSOR_ORDERBY "orderby"
 #define MONGOC_CURSOR_ORDERBY_LEN 7
+#define MONGOC_CURSOR_PREFETCH "prefetch"
+#define MONGOC_CURSOR_PREFETCH_LEN 8
 #define MONGOC_CURSOR_PROJECTION "projection"
 #define MONGOC_CURSOR_PROJECTION_LEN 10
 #define MONGOC_CURSOR_QUERY "query"
@@ -122,6 +128,7 @@ struct _mongoc_cursor_t {
    bson_t filter;
    bson_t opts;
    bson_t reply;
+   bson_t batch; /* documents copied by mongoc_cursor_next_batch */
 
    mongoc_read_concern_t *read_concern;
    mongoc_read_prefs_t *read_prefs;
@@ -197,6 +204,14 @@ bool
 _mongoc_cursor_op_getmore (mongoc_cursor_t *cursor,
                            mongoc_server_stream_t *server_stream);
 bool
+_mongoc_cursor_prepare_command_parts (mongoc_cursor_t *cursor,
+                                      const bson_t *command,
+                                      const bson_t *opts,
+                                      char *db,
+                                      mongoc_cmd_parts_t *parts,
+                                      mongoc_server_stream_t **server_stream,
+                                      mongoc_read_prefs_t **prefs);
+bool
 _mongoc_cursor_run_command (mongoc_cursor_t *cursor,
                             const bson_t *command,
                             const bson_t *opts,
@@ -205,6 +220,14 @@ bool
 _mongoc_cursor_more (mongoc_cursor_t *cursor);
 bool
 _mongoc_cursor_next (mongoc_cursor_t *cursor, const bson_t **bson);
+void
+_mongoc_cursor_append_to_batch (mongoc_cursor_t *cursor,
+                                const bson_t *doc,
+                                uint32_t *n_docs);
+bool
+_mongoc_cursor_next_batch (mongoc_cursor_t *cursor,
+                           const bson_t **batch,
+                           uint32_t *n_docs);
 bool
 _mongoc_cursor_error_document (mongoc_cursor_t *cursor,
                                bson_error_t *error,
@@ -234,6 +234,7 @@ _mongoc_cursor_new_with_opts (mongoc_client_t *client,
    bson_init (&cursor->filter);
    bson_init (&cursor->opts);
    bson_init (&cursor->reply);
+   bson_init (&cursor->batch);
 
    if (filter) {
       if (!bson_validate_with_error (
@@ -569,6 +570,7 @@ _mongoc_cursor_destroy (mongoc_cursor_t *cursor)
    bson_destroy (&cursor->filter);
    bson_destroy (&cursor->opts);
    bson_destroy (&cursor->reply);
+   bson_destroy (&cursor->batch);
    bson_free (cursor);
 
    mongoc_counter_cursors_active_dec ();
@@ -604,6 +606,17 @@ _mongoc_cursor_fetch_stream (mongoc_cursor_t *cursor)
 }
 
 
+/* MongoDB 4.2+ streams "getMore" replies to an OP_MSG with "exhaustAllowed",
+ * older servers only support exhaust with legacy OP_QUERY */
+static bool
+_use_op_msg_exhaust (const mongoc_cursor_t *cursor,
+                     const mongoc_server_stream_t *server_stream)
+{
+   return server_stream->sd->max_wire_version >= WIRE_VERSION_EXHAUST_OP_MSG &&
+          _mongoc_cursor_get_opt_bool (cursor, MONGOC_CURSOR_EXHAUST);
+}
+
+
 bool
 _use_find_command (const mongoc_cursor_t *cursor,
                    const mongoc_server_stream_t *server_stream)
@@ -613,7 +626,8 @@ _use_find_command (const mongoc_cursor_t *cursor,
     * exhaust flag."
     */
    return server_stream->sd->max_wire_version >= WIRE_VERSION_FIND_CMD &&
-          !_mongoc_cursor_get_opt_bool (cursor, MONGOC_CURSOR_EXHAUST);
+          (!_mongoc_cursor_get_opt_bool (cursor, MONGOC_CURSOR_EXHAUST) ||
+           _use_op_msg_exhaust (cursor, server_stream));
 }
 
 
@@ -622,7 +636,8 @@ _use_getmore_command (const mongoc_cursor_t *cursor,
                       const mongoc_server_stream_t *server_stream)
 {
    return server_stream->sd->max_wire_version >= WIRE_VERSION_FIND_CMD &&
-          !_mongoc_cursor_get_opt_bool (cursor, MONGOC_CURSOR_EXHAUST);
+          (!_mongoc_cursor_get_opt_bool (cursor, MONGOC_CURSOR_EXHAUST) ||
+           _use_op_msg_exhaust (cursor, server_stream));
 }
 
 
@@ -1113,12 +1128,14 @@ _mongoc_cursor_parse_opts_for_op_query (mongoc_cursor_t *cursor,
       /* singleBatch limit and batchSize are handled in _mongoc_n_return,
        * exhaust noCursorTimeout oplogReplay tailable in _mongoc_cursor_flags
        * maxAwaitTimeMS is handled in _mongoc_cursor_prepare_getmore_command
+       * prefetch only applies to the getMore command
        * sessionId is used to retrieve the mongoc_client_session_t
        */
       else if (strcmp (key, MONGOC_CURSOR_SINGLE_BATCH) &&
                strcmp (key, MONGOC_CURSOR_LIMIT) &&
                strcmp (key, MONGOC_CURSOR_BATCH_SIZE) &&
                strcmp (key, MONGOC_CURSOR_EXHAUST) &&
+               strcmp (key, MONGOC_CURSOR_PREFETCH) &&
                strcmp (key, MONGOC_CURSOR_NO_CURSOR_TIMEOUT) &&
                strcmp (key, MONGOC_CURSOR_OPLOG_REPLAY) &&
                strcmp (key, MONGOC_CURSOR_TAILABLE) &&
@@ -1292,70 +1309,86 @@ done:
 }
 
 
+/*
+ *--------------------------------------------------------------------------
+ *
+ * _mongoc_cursor_prepare_command_parts --
+ *
+ *       Select the cursor's server and assemble @command with @opts, the
+ *       cursor's session, read concern, and read preference. @db must be
+ *       a buffer of MONGOC_NAMESPACE_MAX bytes. On success the caller
+ *       runs @parts->assembled; in all cases the caller then calls
+ *       mongoc_cmd_parts_cleanup on @parts, mongoc_server_stream_cleanup
+ *       on @server_stream, and mongoc_read_prefs_destroy on @prefs.
+ *
+ * Returns:
+ *       true if successful, otherwise false and cursor->error is set.
+ *
+ * Side effects:
+ *       @parts is initialized, @server_stream and @prefs are set or NULL.
+ *
+ *--------------------------------------------------------------------------
+ */
+
 bool
-_mongoc_cursor_run_command (mongoc_cursor_t *cursor,
-                            const bson_t *command,
-                            const bson_t *opts,
-                            bson_t *reply)
+_mongoc_cursor_prepare_command_parts (mongoc_cursor_t *cursor,
+                                      const bson_t *command,
+                                      const bson_t *opts,
+                                      char *db,
+                                      mongoc_cmd_parts_t *parts,
+                                      mongoc_server_stream_t **server_stream,
+                                      mongoc_read_prefs_t **prefs)
 {
-   mongoc_cluster_t *cluster;
-   mongoc_server_stream_t *server_stream;
    bson_iter_t iter;
-   mongoc_cmd_parts_t parts;
    const char *cmd_name;
    bool is_primary;
-   mongoc_read_prefs_t *prefs = NULL;
-   char db[MONGOC_NAMESPACE_MAX];
-   bool ret = false;
 
    ENTRY;
 
-   cluster = &cursor->client->cluster;
    mongoc_cmd_parts_init (
-      &parts, cursor->client, db, MONGOC_QUERY_NONE, command);
-   parts.is_read_command = true;
-   parts.read_prefs = cursor->read_prefs;
-   parts.assembled.operation_id = cursor->operation_id;
-   server_stream = _mongoc_cursor_fetch_stream (cursor);
-
-   if (!server_stream) {
-      _mongoc_bson_init_if_set (reply);
-      GOTO (done);
+      parts, cursor->client, db, MONGOC_QUERY_NONE, command);
+   parts->is_read_command = true;
+   parts->read_prefs = cursor->read_prefs;
+   parts->assembled.operation_id = cursor->operation_id;
+   *prefs = NULL;
+   *server_stream = _mongoc_cursor_fetch_stream (cursor);
+
+   if (!*server_stream) {
+      RETURN (false);
    }
 
    if (!opts || !bson_has_field (opts, "sessionId")) {
       /* use the cursor's explicit session if any */
-      mongoc_cmd_parts_set_session (&parts, cursor->client_session);
+      mongoc_cmd_parts_set_session (parts, cursor->client_session);
    }
 
    if (opts) {
       bson_iter_init (&iter, opts);
-      if (!mongoc_cmd_parts_append_opts (&parts,
+      if (!mongoc_cmd_parts_append_opts (parts,
                                          &iter,
-                                         server_stream->sd->max_wire_version,
+                                         (*server_stream)->sd->max_wire_version,
                                          &cursor->error)) {
-         _mongoc_bson_init_if_set (reply);
-         GOTO (done);
+         RETURN (false);
       }
    }
 
-   if (!cursor->client_session && parts.assembled.session) {
+   if (!cursor->client_session && parts->assembled.session) {
       /* opts contains "sessionId" */
-      cursor->client_session = parts.assembled.session;
+      cursor->client_session = parts->assembled.session;
       cursor->explicit_session = 1;
    }
 
    if (cursor->read_concern->level) {
-      bson_concat (&parts.read_concern_document,
+      bson_concat (&parts->read_concern_document,
                    _mongoc_read_concern_get_bson (cursor->read_concern));
    }
 
    bson_strncpy (db, cursor->ns, cursor->dblen + 1);
-   parts.assembled.db_name = db;
+   parts->assembled.db_name = db;
 
-   if (!_mongoc_cursor_flags (cursor, server_stream, &parts.user_query_flags)) {
-      _mongoc_bson_init_if_set (reply);
-      GOTO (done);
+   if (!_mongoc_cursor_flags (
+          cursor, *server_stream, &parts->user_query_flags)) {
+      RETURN (false);
    }
 
    /* we might use mongoc_cursor_set_hint to target a secondary but have no
@@ -1368,27 +1401,63 @@ _mongoc_cursor_run_command (mongoc_cursor_t *cursor,
       !cursor->read_prefs || cursor->read_prefs->mode == MONGOC_READ_PRIMARY;
 
    if (strcmp (cmd_name, "getMore") != 0 &&
-       server_stream->sd->max_wire_version >= WIRE_VERSION_OP_MSG &&
-       is_primary && parts.user_query_flags & MONGOC_QUERY_SLAVE_OK) {
-      parts.read_prefs = prefs =
+       (*server_stream)->sd->max_wire_version >= WIRE_VERSION_OP_MSG &&
+       is_primary && parts->user_query_flags & MONGOC_QUERY_SLAVE_OK) {
+      parts->read_prefs = *prefs =
          mongoc_read_prefs_new (MONGOC_READ_PRIMARY_PREFERRED);
    } else {
-      parts.read_prefs = cursor->read_prefs;
+      parts->read_prefs = cursor->read_prefs;
    }
 
    if (cursor->write_concern &&
        !mongoc_write_concern_is_default (cursor->write_concern) &&
-       server_stream->sd->max_wire_version >= WIRE_VERSION_CMD_WRITE_CONCERN) {
-      mongoc_write_concern_append (cursor->write_concern, &parts.extra);
+       (*server_stream)->sd->max_wire_version >=
+          WIRE_VERSION_CMD_WRITE_CONCERN) {
+      mongoc_write_concern_append (cursor->write_concern, &parts->extra);
    }
 
-   if (!mongoc_cmd_parts_assemble (&parts, server_stream, &cursor->error)) {
+   RETURN (mongoc_cmd_parts_assemble (parts, *server_stream, &cursor->error));
+}
+
+
+bool
+_mongoc_cursor_run_command (mongoc_cursor_t *cursor,
+                            const bson_t *command,
+                            const bson_t *opts,
+                            bson_t *reply)
+{
+   mongoc_cluster_t *cluster;
+   mongoc_server_stream_t *server_stream;
+   mongoc_cmd_parts_t parts;
+   mongoc_read_prefs_t *prefs;
+   char db[MONGOC_NAMESPACE_MAX];
+   bool more_to_come;
+   bool ret = false;
+
+   ENTRY;
+
+   cluster = &cursor->client->cluster;
+
+   if (!_mongoc_cursor_prepare_command_parts (
+          cursor, command, opts, db, &parts, &server_stream, &prefs)) {
       _mongoc_bson_init_if_set (reply);
       GOTO (done);
    }
 
-   ret = mongoc_cluster_run_command_monitored (
-      cluster, &parts.assembled, reply, &cursor->error);
+   if (cursor->in_exhaust) {
+      /* the server is streaming batches, read the next without a getMore */
+      ret = mongoc_cluster_recv_exhaust_reply (
+         cluster, &parts.assembled, reply, &more_to_come, &cursor->error);
+      cursor->in_exhaust = cursor->client->in_exhaust = more_to_come;
+   } else if (!strcmp (parts.assembled.command_name, "getMore") &&
+              _use_op_msg_exhaust (cursor, server_stream)) {
+      ret = mongoc_cluster_run_command_exhaust (
+         cluster, &parts.assembled, reply, &more_to_come, &cursor->error);
+      cursor->in_exhaust = cursor->client->in_exhaust = more_to_come;
+   } else {
+      ret = mongoc_cluster_run_command_monitored (
+         cluster, &parts.assembled, reply, &cursor->error);
+   }
 
    /* Read and Write Concern Spec: "Drivers SHOULD parse server replies for a
     * "writeConcernError" field and report the error only in command-specific
@@ -1496,25 +1565,41 @@ _mongoc_cursor_prepare_find_command (mongoc_cursor_t *cursor, bson_t *command)
 }
 
 
-static const bson_t *
-_mongoc_cursor_find_command (mongoc_cursor_t *cursor,
-                             mongoc_server_stream_t *server_stream)
+/* switch to the cursorid implementation, which sends "find" when iterated */
+static bool
+_mongoc_cursor_init_find_command (mongoc_cursor_t *cursor)
 {
    bson_t command = BSON_INITIALIZER;
-   const bson_t *bson = NULL;
+   bool ret;
 
    ENTRY;
 
    /* cursors created by mongoc_client_command don't use this function */
    BSON_ASSERT (cursor->is_find);
 
-   if (!_mongoc_cursor_prepare_find_command (cursor, &command)) {
-      RETURN (NULL);
+   ret = _mongoc_cursor_prepare_find_command (cursor, &command);
+   if (ret) {
+      _mongoc_cursor_cursorid_init (cursor, &command);
    }
 
-   _mongoc_cursor_cursorid_init (cursor, &command);
    bson_destroy (&command);
 
+   RETURN (ret);
+}
+
+
+static const bson_t *
+_mongoc_cursor_find_command (mongoc_cursor_t *cursor,
+                             mongoc_server_stream_t *server_stream)
+{
+   const bson_t *bson = NULL;
+
+   ENTRY;
+
+   if (!_mongoc_cursor_init_find_command (cursor)) {
+      RETURN (NULL);
+   }
+
    BSON_ASSERT (cursor->iface.next);
    _mongoc_cursor_cursorid_next (cursor, &bson);
 
@@ -1829,6 +1914,161 @@ mongoc_cursor_next (mongoc_cursor_t *cursor, const bson_t **bson)
 }
 
 
+/*
+ *--------------------------------------------------------------------------
+ *
+ * mongoc_cursor_next_batch --
+ *
+ *       Iterate the cursor a whole batch at a time. @batch is set to a
+ *       BSON array of the @n_docs documents in the next batch. When the
+ *       server sent the batch as a "firstBatch" or "nextBatch" array and
+ *       none of it was read with mongoc_cursor_next, @batch is that array
+ *       in the reply buffer, not a copy.
+ *
+ * Returns:
+ *       true if a batch with at least one document was read, otherwise
+ *       false if there was an error or the cursor was exhausted.
+ *
+ * Side effects:
+ *       @batch is valid until the next call to mongoc_cursor_next,
+ *       mongoc_cursor_next_batch, or mongoc_cursor_destroy.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+bool
+mongoc_cursor_next_batch (mongoc_cursor_t *cursor,
+                          const bson_t **batch,
+                          uint32_t *n_docs)
+{
+   bool ret;
+
+   ENTRY;
+
+   BSON_ASSERT (cursor);
+   BSON_ASSERT (batch);
+   BSON_ASSERT (n_docs);
+
+   *batch = NULL;
+   *n_docs = 0;
+
+   if (CURSOR_FAILED (cursor)) {
+      RETURN (false);
+   }
+
+   if (cursor->done) {
+      bson_set_error (&cursor->error,
+                      MONGOC_ERROR_CURSOR,
+                      MONGOC_ERROR_CURSOR_INVALID_CURSOR,
+                      "Cannot advance a completed or failed cursor.");
+      RETURN (false);
+   }
+
+   if (cursor->client->in_exhaust && !cursor->in_exhaust) {
+      bson_set_error (&cursor->error,
+                      MONGOC_ERROR_CLIENT,
+                      MONGOC_ERROR_CLIENT_IN_EXHAUST,
+                      "Another cursor derived from this client is in exhaust.");
+      RETURN (false);
+   }
+
+   if (cursor->iface.next_batch) {
+      ret = cursor->iface.next_batch (cursor, batch, n_docs);
+   } else {
+      ret = _mongoc_cursor_next_batch (cursor, batch, n_docs);
+   }
+
+   cursor->current = NULL;
+
+   RETURN (ret);
+}
+
+
+void
+_mongoc_cursor_append_to_batch (mongoc_cursor_t *cursor,
+                                const bson_t *doc,
+                                uint32_t *n_docs)
+{
+   const char *key;
+   char buf[16];
+   size_t key_len;
+
+   key_len = bson_uint32_to_string (*n_docs, &key, buf, sizeof buf);
+   bson_append_document (&cursor->batch, key, (int) key_len, doc);
+   (*n_docs)++;
+}
+
+
+/* copy documents into cursor->batch: the rest of the OP_QUERY or OP_GETMORE
+ * reply, or for cursors that produce documents one at a time, such as the
+ * array cursor, all of them */
+bool
+_mongoc_cursor_next_batch (mongoc_cursor_t *cursor,
+                           const bson_t **batch,
+                           uint32_t *n_docs)
+{
+   mongoc_server_stream_t *server_stream;
+   const bson_t *doc;
+   int64_t limit;
+   bool use_find_command;
+   bool ok;
+
+   ENTRY;
+
+   if (cursor->is_find && !cursor->sent && !cursor->iface.next) {
+      server_stream = _mongoc_cursor_fetch_stream (cursor);
+      if (!server_stream) {
+         RETURN (false);
+      }
+
+      use_find_command = _use_find_command (cursor, server_stream);
+      mongoc_server_stream_cleanup (server_stream);
+
+      /* the cursorid cursor returns the "firstBatch" array without copying */
+      if (use_find_command) {
+         if (!_mongoc_cursor_init_find_command (cursor)) {
+            RETURN (false);
+         }
+
+         BSON_ASSERT (cursor->iface.next_batch);
+         RETURN (cursor->iface.next_batch (cursor, batch, n_docs));
+      }
+   }
+
+   bson_reinit (&cursor->batch);
+
+   if (cursor->iface.next) {
+      while (cursor->iface.next (cursor, &doc)) {
+         _mongoc_cursor_append_to_batch (cursor, doc, n_docs);
+         cursor->count++;
+      }
+   } else {
+      /* this may send the query or a getMore */
+      ok = _mongoc_cursor_next (cursor, &doc);
+      limit = cursor->is_find ? mongoc_cursor_get_limit (cursor) : 1;
+
+      while (ok) {
+         _mongoc_cursor_append_to_batch (cursor, doc, n_docs);
+         cursor->count++;
+
+         if (limit && cursor->count >= llabs (limit)) {
+            break;
+         }
+
+         ok = _mongoc_read_from_buffer (cursor, &doc);
+      }
+   }
+
+   if (CURSOR_FAILED (cursor) || !*n_docs) {
+      RETURN (false);
+   }
+
+   *batch = &cursor->batch;
+
+   RETURN (true);
+}
+
+
 bool
 _mongoc_read_from_buffer (mongoc_cursor_t *cursor, const bson_t **bson)
 {
@@ -2035,6 +2275,7 @@ _mongoc_cursor_clone (const mongoc_cursor_t *cursor)
    bson_copy_to (&cursor->filter, &_clone->filter);
    bson_copy_to (&cursor->opts, &_clone->opts);
    bson_copy_to (&cursor->reply, &_clone->reply);
+   bson_init (&_clone->batch);
 
    bson_strncpy (_clone->ns, cursor->ns, sizeof _clone->ns);
 
@@ -45,6 +45,10 @@ mongoc_cursor_more (mongoc_cursor_t *cursor);
 MONGOC_EXPORT (bool)
 mongoc_cursor_next (mongoc_cursor_t *cursor, const bson_t **bson);
 MONGOC_EXPORT (bool)
+mongoc_cursor_next_batch (mongoc_cursor_t *cursor,
+                          const bson_t **batch,
+                          uint32_t *n_docs);
+MONGOC_EXPORT (bool)
 mongoc_cursor_error (mongoc_cursor_t *cursor, bson_error_t *error);
 MONGOC_EXPORT (bool)
 mongoc_cursor_error_document (mongoc_cursor_t *cursor,
@@ -0,0 +1,65 @@
+/*
+ * Copyright 2018-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MONGOC_DNS_CACHE_PRIVATE_H
+#define MONGOC_DNS_CACHE_PRIVATE_H
+
+#if !defined(MONGOC_COMPILATION)
+#error "Only <mongoc.h> can be included directly."
+#endif
+
+#include <bson.h>
+
+#include "mongoc-host-list.h"
+#include "mongoc-socket.h"
+
+BSON_BEGIN_DECLS
+
+/* failed lookups are remembered for at most this long */
+#define MONGOC_DNS_CACHE_NEGATIVE_TTL_MSEC 1000
+
+/* same contract as getaddrinfo (), results are freed with freeaddrinfo () */
+typedef int (*mongoc_dns_resolver_t) (const char *node,
+                                      const char *service,
+                                      const struct addrinfo *hints,
+                                      struct addrinfo **res);
+
+typedef void (*mongoc_dns_resolver_free_t) (struct addrinfo *res);
+
+void
+_mongoc_dns_cache_init (void);
+
+void
+_mongoc_dns_cache_cleanup (void);
+
+void
+_mongoc_dns_cache_clear (void);
+
+void
+_mongoc_dns_cache_set_resolver (mongoc_dns_resolver_t resolver,
+                                mongoc_dns_resolver_free_t resolver_free);
+
+int
+_mongoc_dns_cache_getaddrinfo (const mongoc_host_list_t *host,
+                               int64_t ttl_msec,
+                               struct addrinfo **result);
+
+void
+_mongoc_dns_cache_freeaddrinfo (struct addrinfo *result);
+
+BSON_END_DECLS
+
+#endif /* MONGOC_DNS_CACHE_PRIVATE_H */
@@ -0,0 +1,368 @@
+/*
+ * Copyright 2018-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+
+#include "mongoc-array-private.h"
+#include "mongoc-counters-private.h"
+#include "mongoc-dns-cache-private.h"
+#include "mongoc-thread-private.h"
+#include "mongoc-trace-private.h"
+
+#undef MONGOC_LOG_DOMAIN
+#define MONGOC_LOG_DOMAIN "dns-cache"
+
+#define MONGOC_DNS_CACHE_MAX_ENTRIES 256
+
+
+/* the outcome of resolving one host, port, and address family */
+typedef struct {
+   char *host;
+   uint16_t port;
+   int family;
+   int status;
+   struct addrinfo *results;
+   int64_t resolved_at;
+} mongoc_dns_cache_entry_t;
+
+
+static mongoc_mutex_t gDnsCacheMutex;
+static mongoc_array_t gDnsCache;
+static mongoc_dns_resolver_t gDnsResolver;
+static mongoc_dns_resolver_free_t gDnsResolverFree;
+
+
+static void
+_mongoc_dns_cache_entry_destroy (mongoc_dns_cache_entry_t *entry)
+{
+   bson_free (entry->host);
+   _mongoc_dns_cache_freeaddrinfo (entry->results);
+}
+
+
+void
+_mongoc_dns_cache_init (void)
+{
+   mongoc_mutex_init (&gDnsCacheMutex);
+   _mongoc_array_init (&gDnsCache, sizeof (mongoc_dns_cache_entry_t));
+   gDnsResolver = NULL;
+   gDnsResolverFree = NULL;
+}
+
+
+void
+_mongoc_dns_cache_clear (void)
+{
+   size_t i;
+
+   mongoc_mutex_lock (&gDnsCacheMutex);
+   for (i = 0; i < gDnsCache.len; i++) {
+      _mongoc_dns_cache_entry_destroy (
+         &_mongoc_array_index (&gDnsCache, mongoc_dns_cache_entry_t, i));
+   }
+
+   _mongoc_array_clear (&gDnsCache);
+   mongoc_mutex_unlock (&gDnsCacheMutex);
+}
+
+
+void
+_mongoc_dns_cache_cleanup (void)
+{
+   _mongoc_dns_cache_clear ();
+   _mongoc_array_destroy (&gDnsCache);
+   mongoc_mutex_destroy (&gDnsCacheMutex);
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * _mongoc_dns_cache_set_resolver --
+ *
+ *       Resolve hosts with @resolver instead of getaddrinfo (), and free
+ *       its results with @resolver_free. Pass NULL to restore the
+ *       defaults. Clears the cache.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+void
+_mongoc_dns_cache_set_resolver (mongoc_dns_resolver_t resolver,
+                                mongoc_dns_resolver_free_t resolver_free)
+{
+   _mongoc_dns_cache_clear ();
+
+   mongoc_mutex_lock (&gDnsCacheMutex);
+   gDnsResolver = resolver;
+   gDnsResolverFree = resolver_free;
+   mongoc_mutex_unlock (&gDnsCacheMutex);
+}
+
+
+/* copy a resolver's results into memory the cache owns */
+static struct addrinfo *
+_mongoc_dns_cache_copy_addrinfo (const struct addrinfo *src)
+{
+   struct addrinfo *head = NULL;
+   struct addrinfo **tail = &head;
+   struct addrinfo *ai;
+
+   for (; src; src = src->ai_next) {
+      ai = (struct addrinfo *) bson_malloc0 (sizeof *ai + src->ai_addrlen);
+      ai->ai_flags = src->ai_flags;
+      ai->ai_family = src->ai_family;
+      ai->ai_socktype = src->ai_socktype;
+      ai->ai_protocol = src->ai_protocol;
+      ai->ai_addrlen = src->ai_addrlen;
+      ai->ai_addr = (struct sockaddr *) (ai + 1);
+      memcpy (ai->ai_addr, src->ai_addr, src->ai_addrlen);
+
+      *tail = ai;
+      tail = &ai->ai_next;
+   }
+
+   return head;
+}
+
+
+void
+_mongoc_dns_cache_freeaddrinfo (struct addrinfo *result)
+{
+   struct addrinfo *next;
+
+   while (result) {
+      next = result->ai_next;
+      bson_free (result);
+      result = next;
+   }
+}
+
+
+static mongoc_dns_cache_entry_t *
+_mongoc_dns_cache_find (const mongoc_host_list_t *host)
+{
+   mongoc_dns_cache_entry_t *entry;
+   size_t i;
+
+   for (i = 0; i < gDnsCache.len; i++) {
+      entry = &_mongoc_array_index (&gDnsCache, mongoc_dns_cache_entry_t, i);
+      if (entry->port == host->port && entry->family == host->family &&
+          !strcasecmp (entry->host, host->host)) {
+         return entry;
+      }
+   }
+
+   return NULL;
+}
+
+
+/* remove an entry by moving the last one into its place */
+static void
+_mongoc_dns_cache_remove (mongoc_dns_cache_entry_t *entry)
+{
+   mongoc_dns_cache_entry_t *last;
+
+   last = &_mongoc_array_index (
+      &gDnsCache, mongoc_dns_cache_entry_t, gDnsCache.len - 1);
+
+   _mongoc_dns_cache_entry_destroy (entry);
+   if (entry != last) {
+      *entry = *last;
+   }
+
+   gDnsCache.len--;
+}
+
+
+static void
+_mongoc_dns_cache_store (const mongoc_host_list_t *host,
+                         int status,
+                         struct addrinfo *results,
+                         int64_t resolved_at)
+{
+   mongoc_dns_cache_entry_t *entry;
+   mongoc_dns_cache_entry_t *oldest;
+   mongoc_dns_cache_entry_t new_entry;
+   size_t i;
+
+   mongoc_mutex_lock (&gDnsCacheMutex);
+
+   /* another thread may have refreshed this host meanwhile, keep the
+    * newer answer */
+   if ((entry = _mongoc_dns_cache_find (host))) {
+      if (entry->resolved_at > resolved_at) {
+         mongoc_mutex_unlock (&gDnsCacheMutex);
+         _mongoc_dns_cache_freeaddrinfo (results);
+         return;
+      }
+
+      _mongoc_dns_cache_remove (entry);
+   }
+
+   if (gDnsCache.len >= MONGOC_DNS_CACHE_MAX_ENTRIES) {
+      oldest = NULL;
+      for (i = 0; i < gDnsCache.len; i++) {
+         entry =
+            &_mongoc_array_index (&gDnsCache, mongoc_dns_cache_entry_t, i);
+         if (!oldest || entry->resolved_at < oldest->resolved_at) {
+            oldest = entry;
+         }
+      }
+
+      _mongoc_dns_cache_remove (oldest);
+   }
+
+   new_entry.host = bson_strdup (host->host);
+   new_entry.port = host->port;
+   new_entry.family = host->family;
+   new_entry.status = status;
+   new_entry.results = results;
+   new_entry.resolved_at = resolved_at;
+   _mongoc_array_append_val (&gDnsCache, new_entry);
+
+   mongoc_mutex_unlock (&gDnsCacheMutex);
+}
+
+
+/* the default resolver. getaddrinfo and freeaddrinfo are WSAAPI on Windows,
+ * a calling convention that doesn't match the resolver typedefs */
+static int
+_mongoc_dns_cache_system_resolver (const char *node,
+                                   const char *service,
+                                   const struct addrinfo *hints,
+                                   struct addrinfo **res)
+{
+   return getaddrinfo (node, service, hints, res);
+}
+
+
+static void
+_mongoc_dns_cache_system_resolver_free (struct addrinfo *res)
+{
+   freeaddrinfo (res);
+}
+
+
+/* resolve @host with the current resolver */
+static int
+_mongoc_dns_cache_resolve (const mongoc_host_list_t *host,
+                           struct addrinfo **result)
+{
+   mongoc_dns_resolver_t resolver;
+   mongoc_dns_resolver_free_t resolver_free;
+   struct addrinfo hints;
+   struct addrinfo *resolved = NULL;
+   char portstr[8];
+   int s;
+
+   mongoc_mutex_lock (&gDnsCacheMutex);
+   resolver = gDnsResolver ? gDnsResolver : _mongoc_dns_cache_system_resolver;
+   resolver_free = gDnsResolverFree ? gDnsResolverFree
+                                    : _mongoc_dns_cache_system_resolver_free;
+   mongoc_mutex_unlock (&gDnsCacheMutex);
+
+   bson_snprintf (portstr, sizeof portstr, "%hu", host->port);
+
+   memset (&hints, 0, sizeof hints);
+   hints.ai_family = host->family;
+   hints.ai_socktype = SOCK_STREAM;
+   hints.ai_flags = 0;
+   hints.ai_protocol = 0;
+
+   s = resolver (host->host, portstr, &hints, &resolved);
+
+   if (s != 0) {
+      mongoc_counter_dns_failure_inc ();
+      *result = NULL;
+      return s;
+   }
+
+   mongoc_counter_dns_success_inc ();
+   *result = _mongoc_dns_cache_copy_addrinfo (resolved);
+   resolver_free (resolved);
+
+   return 0;
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * _mongoc_dns_cache_getaddrinfo --
+ *
+ *       Resolve @host, or reuse the answer from a resolution less than
+ *       @ttl_msec ago. Failures are reused for at most
+ *       MONGOC_DNS_CACHE_NEGATIVE_TTL_MSEC. A negative @ttl_msec bypasses
+ *       the cache.
+ *
+ *       The resolver runs without the cache locked, so a slow lookup does
+ *       not hold up other hosts.
+ *
+ * Returns:
+ *       0 and @result is set to a list that must be freed with
+ *       _mongoc_dns_cache_freeaddrinfo (), otherwise the resolver's error
+ *       code.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+int
+_mongoc_dns_cache_getaddrinfo (const mongoc_host_list_t *host,
+                               int64_t ttl_msec,
+                               struct addrinfo **result)
+{
+   mongoc_dns_cache_entry_t *entry;
+   int64_t now;
+   int64_t ttl_usec;
+   int status;
+
+   ENTRY;
+
+   BSON_ASSERT (host);
+   BSON_ASSERT (result);
+
+   if (ttl_msec < 0) {
+      RETURN (_mongoc_dns_cache_resolve (host, result));
+   }
+
+   now = bson_get_monotonic_time ();
+
+   mongoc_mutex_lock (&gDnsCacheMutex);
+   if ((entry = _mongoc_dns_cache_find (host))) {
+      ttl_usec = 1000 * (entry->status == 0
+                            ? ttl_msec
+                            : BSON_MIN (ttl_msec,
+                                        MONGOC_DNS_CACHE_NEGATIVE_TTL_MSEC));
+
+      if (now - entry->resolved_at < ttl_usec) {
+         status = entry->status;
+         *result = _mongoc_dns_cache_copy_addrinfo (entry->results);
+         mongoc_mutex_unlock (&gDnsCacheMutex);
+
+         TRACE ("reusing resolution of %s", host->host_and_port);
+         mongoc_counter_dns_cache_hits_inc ();
+         RETURN (status);
+      }
+   }
+   mongoc_mutex_unlock (&gDnsCacheMutex);
+
+   status = _mongoc_dns_cache_resolve (host, result);
+   _mongoc_dns_cache_store (
+      host, status, _mongoc_dns_cache_copy_addrinfo (*result), now);
+
+   RETURN (status);
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright 2018-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MONGOC_GRIDFS_CHUNK_CACHE_PRIVATE_H
+#define MONGOC_GRIDFS_CHUNK_CACHE_PRIVATE_H
+
+#if !defined(MONGOC_COMPILATION)
+#error "Only <mongoc.h> can be included directly."
+#endif
+
+#include <bson.h>
+
+#include "mongoc-gridfs-chunk-cache.h"
+#include "mongoc-thread-private.h"
+
+
+BSON_BEGIN_DECLS
+
+
+typedef struct _mongoc_gridfs_chunk_cache_entry_t
+   mongoc_gridfs_chunk_cache_entry_t;
+
+
+struct _mongoc_gridfs_chunk_cache_t {
+   mongoc_mutex_t mutex;
+   size_t max_bytes;
+   size_t bytes;
+   mongoc_gridfs_chunk_cache_entry_t **buckets;
+   size_t n_buckets;
+   size_t n_entries;
+   mongoc_gridfs_chunk_cache_entry_t *newest;
+   mongoc_gridfs_chunk_cache_entry_t *oldest;
+};
+
+
+bool
+_mongoc_gridfs_chunk_cache_get (mongoc_gridfs_chunk_cache_t *cache,
+                                const char *ns,
+                                const bson_value_t *files_id,
+                                int32_t n,
+                                uint8_t *buf,
+                                uint32_t buf_len,
+                                uint32_t *len);
+void
+_mongoc_gridfs_chunk_cache_put (mongoc_gridfs_chunk_cache_t *cache,
+                                const char *ns,
+                                const bson_value_t *files_id,
+                                int32_t n,
+                                const uint8_t *data,
+                                uint32_t len);
+void
+_mongoc_gridfs_chunk_cache_remove (mongoc_gridfs_chunk_cache_t *cache,
+                                   const char *ns,
+                                   const bson_value_t *files_id,
+                                   int32_t n);
+
+
+BSON_END_DECLS
+
+
+#endif /* MONGOC_GRIDFS_CHUNK_CACHE_PRIVATE_H */
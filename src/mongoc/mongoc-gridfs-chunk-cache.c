@@ -0,0 +1,424 @@
+/*
+ * Copyright 2018-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+
+#include "mongoc-counters-private.h"
+#include "mongoc-gridfs-chunk-cache-private.h"
+#include "mongoc-trace-private.h"
+
+#undef MONGOC_LOG_DOMAIN
+#define MONGOC_LOG_DOMAIN "gridfs-chunk-cache"
+
+#define MONGOC_GRIDFS_CHUNK_CACHE_MIN_BUCKETS 64
+
+
+/* one chunk, in a hash bucket's chain and in the list of entries from most
+ * to least recently used */
+struct _mongoc_gridfs_chunk_cache_entry_t {
+   uint32_t hash;
+   uint8_t *key; /* BSON document {"": chunks namespace, "": files_id} */
+   uint32_t key_len;
+   int32_t n;
+   uint8_t *data;
+   uint32_t len;
+   mongoc_gridfs_chunk_cache_entry_t *chain;
+   mongoc_gridfs_chunk_cache_entry_t *newer;
+   mongoc_gridfs_chunk_cache_entry_t *older;
+};
+
+
+/* a GridFS files_id and the namespace of its chunks collection, encoded so
+ * that it can be hashed and compared: files in different buckets can have
+ * the same id */
+typedef struct {
+   bson_t bson;
+   uint32_t hash;
+} mongoc_gridfs_chunk_cache_key_t;
+
+
+static void
+_mongoc_gridfs_chunk_cache_key_init (mongoc_gridfs_chunk_cache_key_t *key,
+                                     const char *ns,
+                                     const bson_value_t *files_id)
+{
+   const uint8_t *data;
+   uint32_t i;
+
+   bson_init (&key->bson);
+   bson_append_utf8 (&key->bson, "", 0, ns, -1);
+   bson_append_value (&key->bson, "", 0, files_id);
+
+   /* FNV-1a */
+   data = bson_get_data (&key->bson);
+   key->hash = 2166136261u;
+   for (i = 0; i < key->bson.len; i++) {
+      key->hash = (key->hash ^ data[i]) * 16777619u;
+   }
+}
+
+
+static uint32_t
+_mongoc_gridfs_chunk_cache_hash (const mongoc_gridfs_chunk_cache_key_t *key,
+                                 int32_t n)
+{
+   return (key->hash ^ (uint32_t) n) * 16777619u;
+}
+
+
+static size_t
+_mongoc_gridfs_chunk_cache_entry_size (mongoc_gridfs_chunk_cache_entry_t *entry)
+{
+   return sizeof *entry + entry->key_len + entry->len;
+}
+
+
+static bool
+_mongoc_gridfs_chunk_cache_entry_matches (
+   const mongoc_gridfs_chunk_cache_entry_t *entry,
+   const mongoc_gridfs_chunk_cache_key_t *key)
+{
+   return entry->key_len == key->bson.len &&
+          !memcmp (entry->key, bson_get_data (&key->bson), key->bson.len);
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * mongoc_gridfs_chunk_cache_new --
+ *
+ *       Create a cache of up to @max_bytes of GridFS chunks, which any
+ *       number of files can share with mongoc_gridfs_file_set_chunk_cache.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+mongoc_gridfs_chunk_cache_t *
+mongoc_gridfs_chunk_cache_new (size_t max_bytes)
+{
+   mongoc_gridfs_chunk_cache_t *cache;
+
+   cache = (mongoc_gridfs_chunk_cache_t *) bson_malloc0 (sizeof *cache);
+   mongoc_mutex_init (&cache->mutex);
+   cache->max_bytes = max_bytes;
+   cache->n_buckets = MONGOC_GRIDFS_CHUNK_CACHE_MIN_BUCKETS;
+   cache->buckets = (mongoc_gridfs_chunk_cache_entry_t **) bson_malloc0 (
+      cache->n_buckets * sizeof *cache->buckets);
+
+   return cache;
+}
+
+
+void
+mongoc_gridfs_chunk_cache_destroy (mongoc_gridfs_chunk_cache_t *cache)
+{
+   mongoc_gridfs_chunk_cache_entry_t *entry;
+   mongoc_gridfs_chunk_cache_entry_t *older;
+
+   if (!cache) {
+      return;
+   }
+
+   for (entry = cache->newest; entry; entry = older) {
+      older = entry->older;
+      bson_free (entry->key);
+      bson_free (entry->data);
+      bson_free (entry);
+   }
+
+   bson_free (cache->buckets);
+   mongoc_mutex_destroy (&cache->mutex);
+   bson_free (cache);
+}
+
+
+static mongoc_gridfs_chunk_cache_entry_t *
+_mongoc_gridfs_chunk_cache_find (mongoc_gridfs_chunk_cache_t *cache,
+                                 const mongoc_gridfs_chunk_cache_key_t *key,
+                                 int32_t n,
+                                 uint32_t hash)
+{
+   mongoc_gridfs_chunk_cache_entry_t *entry;
+
+   for (entry = cache->buckets[hash % cache->n_buckets]; entry;
+        entry = entry->chain) {
+      if (entry->hash == hash && entry->n == n &&
+          _mongoc_gridfs_chunk_cache_entry_matches (entry, key)) {
+         return entry;
+      }
+   }
+
+   return NULL;
+}
+
+
+static void
+_mongoc_gridfs_chunk_cache_unlink (mongoc_gridfs_chunk_cache_t *cache,
+                                   mongoc_gridfs_chunk_cache_entry_t *entry)
+{
+   if (entry->newer) {
+      entry->newer->older = entry->older;
+   } else {
+      cache->newest = entry->older;
+   }
+
+   if (entry->older) {
+      entry->older->newer = entry->newer;
+   } else {
+      cache->oldest = entry->newer;
+   }
+
+   entry->newer = entry->older = NULL;
+}
+
+
+static void
+_mongoc_gridfs_chunk_cache_link_newest (
+   mongoc_gridfs_chunk_cache_t *cache, mongoc_gridfs_chunk_cache_entry_t *entry)
+{
+   entry->older = cache->newest;
+   entry->newer = NULL;
+
+   if (cache->newest) {
+      cache->newest->newer = entry;
+   } else {
+      cache->oldest = entry;
+   }
+
+   cache->newest = entry;
+}
+
+
+static void
+_mongoc_gridfs_chunk_cache_evict (mongoc_gridfs_chunk_cache_t *cache,
+                                  mongoc_gridfs_chunk_cache_entry_t *entry)
+{
+   mongoc_gridfs_chunk_cache_entry_t **link;
+
+   link = &cache->buckets[entry->hash % cache->n_buckets];
+   while (*link != entry) {
+      link = &(*link)->chain;
+   }
+
+   *link = entry->chain;
+   _mongoc_gridfs_chunk_cache_unlink (cache, entry);
+
+   cache->bytes -= _mongoc_gridfs_chunk_cache_entry_size (entry);
+   cache->n_entries--;
+
+   bson_free (entry->key);
+   bson_free (entry->data);
+   bson_free (entry);
+}
+
+
+/* keep chains short as the cache fills up */
+static void
+_mongoc_gridfs_chunk_cache_grow (mongoc_gridfs_chunk_cache_t *cache)
+{
+   mongoc_gridfs_chunk_cache_entry_t **buckets;
+   mongoc_gridfs_chunk_cache_entry_t *entry;
+   size_t n_buckets;
+
+   n_buckets = cache->n_buckets * 2;
+   buckets = (mongoc_gridfs_chunk_cache_entry_t **) bson_malloc0 (
+      n_buckets * sizeof *buckets);
+
+   for (entry = cache->newest; entry; entry = entry->older) {
+      entry->chain = buckets[entry->hash % n_buckets];
+      buckets[entry->hash % n_buckets] = entry;
+   }
+
+   bson_free (cache->buckets);
+   cache->buckets = buckets;
+   cache->n_buckets = n_buckets;
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * _mongoc_gridfs_chunk_cache_get --
+ *
+ *       Copy chunk @n of the file @files_id, whose chunks are in the
+ *       collection @ns, into @buf, which has room for
+ *       @buf_len bytes, and mark it most recently used.
+ *
+ * Returns:
+ *       True and sets @len if the chunk was cached.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+bool
+_mongoc_gridfs_chunk_cache_get (mongoc_gridfs_chunk_cache_t *cache,
+                                const char *ns,
+                                const bson_value_t *files_id,
+                                int32_t n,
+                                uint8_t *buf,
+                                uint32_t buf_len,
+                                uint32_t *len)
+{
+   mongoc_gridfs_chunk_cache_key_t key;
+   mongoc_gridfs_chunk_cache_entry_t *entry;
+   bool found = false;
+
+   _mongoc_gridfs_chunk_cache_key_init (&key, ns, files_id);
+
+   mongoc_mutex_lock (&cache->mutex);
+   entry = _mongoc_gridfs_chunk_cache_find (
+      cache, &key, n, _mongoc_gridfs_chunk_cache_hash (&key, n));
+
+   if (entry && entry->len <= buf_len) {
+      memcpy (buf, entry->data, entry->len);
+      *len = entry->len;
+      _mongoc_gridfs_chunk_cache_unlink (cache, entry);
+      _mongoc_gridfs_chunk_cache_link_newest (cache, entry);
+      found = true;
+   }
+
+   mongoc_mutex_unlock (&cache->mutex);
+   bson_destroy (&key.bson);
+
+   if (found) {
+      mongoc_counter_gridfs_chunk_cache_hits_inc ();
+   }
+
+   return found;
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * _mongoc_gridfs_chunk_cache_put --
+ *
+ *       Cache a copy of chunk @n of the file @files_id in @ns, replacing any
+ *       cached copy, then evict the least recently used chunks until the
+ *       cache is within its size.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+void
+_mongoc_gridfs_chunk_cache_put (mongoc_gridfs_chunk_cache_t *cache,
+                                const char *ns,
+                                const bson_value_t *files_id,
+                                int32_t n,
+                                const uint8_t *data,
+                                uint32_t len)
+{
+   mongoc_gridfs_chunk_cache_key_t key;
+   mongoc_gridfs_chunk_cache_entry_t *entry;
+   mongoc_gridfs_chunk_cache_entry_t *stale;
+   uint32_t hash;
+   size_t bucket;
+
+   _mongoc_gridfs_chunk_cache_key_init (&key, ns, files_id);
+
+   /* too large to cache at all */
+   if (sizeof *entry + key.bson.len + len > cache->max_bytes) {
+      bson_destroy (&key.bson);
+      _mongoc_gridfs_chunk_cache_remove (cache, ns, files_id, n);
+      return;
+   }
+
+   hash = _mongoc_gridfs_chunk_cache_hash (&key, n);
+
+   /* copy the chunk outside the lock */
+   entry = (mongoc_gridfs_chunk_cache_entry_t *) bson_malloc0 (sizeof *entry);
+   entry->hash = hash;
+   entry->key_len = key.bson.len;
+   entry->key = (uint8_t *) bson_malloc (key.bson.len);
+   memcpy (entry->key, bson_get_data (&key.bson), key.bson.len);
+   entry->n = n;
+   entry->len = len;
+   entry->data = (uint8_t *) bson_malloc (BSON_MAX (len, 1));
+   memcpy (entry->data, data, len);
+
+   mongoc_mutex_lock (&cache->mutex);
+
+   if (cache->n_entries >= cache->n_buckets) {
+      _mongoc_gridfs_chunk_cache_grow (cache);
+   }
+
+   stale = _mongoc_gridfs_chunk_cache_find (cache, &key, n, hash);
+   if (stale) {
+      _mongoc_gridfs_chunk_cache_evict (cache, stale);
+   }
+
+   bucket = hash % cache->n_buckets;
+   entry->chain = cache->buckets[bucket];
+   cache->buckets[bucket] = entry;
+   _mongoc_gridfs_chunk_cache_link_newest (cache, entry);
+   cache->bytes += _mongoc_gridfs_chunk_cache_entry_size (entry);
+   cache->n_entries++;
+
+   while (cache->bytes > cache->max_bytes) {
+      _mongoc_gridfs_chunk_cache_evict (cache, cache->oldest);
+   }
+
+   mongoc_mutex_unlock (&cache->mutex);
+   bson_destroy (&key.bson);
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * _mongoc_gridfs_chunk_cache_remove --
+ *
+ *       Forget chunk @n of the file @files_id in @ns, or all of its chunks
+ *       if @n is negative.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+void
+_mongoc_gridfs_chunk_cache_remove (mongoc_gridfs_chunk_cache_t *cache,
+                                   const char *ns,
+                                   const bson_value_t *files_id,
+                                   int32_t n)
+{
+   mongoc_gridfs_chunk_cache_key_t key;
+   mongoc_gridfs_chunk_cache_entry_t *entry;
+   mongoc_gridfs_chunk_cache_entry_t *older;
+
+   _mongoc_gridfs_chunk_cache_key_init (&key, ns, files_id);
+
+   mongoc_mutex_lock (&cache->mutex);
+
+   if (n >= 0) {
+      entry = _mongoc_gridfs_chunk_cache_find (
+         cache, &key, n, _mongoc_gridfs_chunk_cache_hash (&key, n));
+
+      if (entry) {
+         _mongoc_gridfs_chunk_cache_evict (cache, entry);
+      }
+   } else {
+      for (entry = cache->newest; entry; entry = older) {
+         older = entry->older;
+
+         if (_mongoc_gridfs_chunk_cache_entry_matches (entry, &key)) {
+            _mongoc_gridfs_chunk_cache_evict (cache, entry);
+         }
+      }
+   }
+
+   mongoc_mutex_unlock (&cache->mutex);
+   bson_destroy (&key.bson);
+}
@@ -0,0 +1,44 @@
+/*
+ * Copyright 2018-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MONGOC_GRIDFS_CHUNK_CACHE_H
+#define MONGOC_GRIDFS_CHUNK_CACHE_H
+
+#if !defined(MONGOC_INSIDE) && !defined(MONGOC_COMPILATION)
+#error "Only <mongoc.h> can be included directly."
+#endif
+
+#include <bson.h>
+
+#include "mongoc-macros.h"
+
+
+BSON_BEGIN_DECLS
+
+
+typedef struct _mongoc_gridfs_chunk_cache_t mongoc_gridfs_chunk_cache_t;
+
+
+MONGOC_EXPORT (mongoc_gridfs_chunk_cache_t *)
+mongoc_gridfs_chunk_cache_new (size_t max_bytes);
+MONGOC_EXPORT (void)
+mongoc_gridfs_chunk_cache_destroy (mongoc_gridfs_chunk_cache_t *cache);
+
+
+BSON_END_DECLS
+
+
+#endif /* MONGOC_GRIDFS_CHUNK_CACHE_H */
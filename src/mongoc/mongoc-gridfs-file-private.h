@@ -24,14 +24,59 @@
 #include <bson.h>
 
 #include "mongoc-gridfs.h"
+#include "mongoc-gridfs-chunk-cache.h"
 #include "mongoc-gridfs-file.h"
 #include "mongoc-gridfs-file-page.h"
 #include "mongoc-cursor.h"
+#include "mongoc-cmd-private.h"
+#include "mongoc-server-stream-private.h"
+#include "mongoc-write-command-private.h"
 
 
 BSON_BEGIN_DECLS
 
 
+/* chunk inserts of a sequential upload, see _mongoc_gridfs_file_begin_upload.
+ * while "batch" is filled, the previous batch may be in flight in "sent" */
+typedef struct _mongoc_gridfs_file_upload_t {
+   int32_t max_batch_size;
+   int32_t max_batch_bytes;
+   mongoc_write_command_t batch;
+   mongoc_write_command_t sent;
+   bool in_flight;
+   bson_t cmd;
+   mongoc_cmd_parts_t parts;
+   mongoc_server_stream_t *server_stream;
+   int32_t request_id;
+   int64_t started;
+   uint32_t offset;
+   mongoc_write_result_t result;
+} mongoc_gridfs_file_upload_t;
+
+
+/* finds of chunk ranges that a sequential download pipelines at once */
+#define MONGOC_GRIDFS_DOWNLOAD_WINDOW 4
+
+
+typedef struct _mongoc_gridfs_file_download_chunk_t {
+   const uint8_t *data;
+   uint32_t len;
+} mongoc_gridfs_file_download_chunk_t;
+
+
+/* chunks fetched ahead by a sequential download, see
+ * _mongoc_gridfs_file_download. the data points into the find replies */
+typedef struct _mongoc_gridfs_file_download_t {
+   int32_t next_n;
+   int32_t first_n;
+   int32_t n_chunks;
+   bson_t replies[MONGOC_GRIDFS_DOWNLOAD_WINDOW];
+   size_t n_replies;
+   mongoc_gridfs_file_download_chunk_t *chunks;
+   size_t chunks_len;
+} mongoc_gridfs_file_download_t;
+
+
 struct _mongoc_gridfs_file_t {
    mongoc_gridfs_t *gridfs;
    bson_t bson;
@@ -42,6 +87,10 @@ struct _mongoc_gridfs_file_t {
    mongoc_cursor_t *cursor;
    uint32_t cursor_range[2]; /* current chunk, # of chunks */
    bool is_dirty;
+   mongoc_gridfs_file_upload_t *upload;
+   mongoc_gridfs_file_download_t download;
+   mongoc_gridfs_chunk_cache_t *chunk_cache;
+   uint8_t *chunk_cache_buf; /* the current page's data, if cached */
 
    bson_value_t files_id;
    int64_t length;
@@ -66,6 +115,8 @@ _mongoc_gridfs_file_new_from_bson (mongoc_gridfs_t *gridfs, const bson_t *data);
 mongoc_gridfs_file_t *
 _mongoc_gridfs_file_new (mongoc_gridfs_t *gridfs,
                          mongoc_gridfs_file_opt_t *opt);
+bool
+_mongoc_gridfs_file_begin_upload (mongoc_gridfs_file_t *file);
 
 
 BSON_END_DECLS
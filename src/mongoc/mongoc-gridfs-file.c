@@ -22,16 +22,21 @@
 #include <time.h>
 #include <errno.h>
 
+#include "mongoc-client-private.h"
+#include "mongoc-cluster-private.h"
 #include "mongoc-cursor.h"
 #include "mongoc-cursor-private.h"
 #include "mongoc-collection.h"
+#include "mongoc-collection-private.h"
 #include "mongoc-gridfs.h"
 #include "mongoc-gridfs-private.h"
+#include "mongoc-gridfs-chunk-cache-private.h"
 #include "mongoc-gridfs-file.h"
 #include "mongoc-gridfs-file-private.h"
 #include "mongoc-gridfs-file-page.h"
 #include "mongoc-gridfs-file-page-private.h"
 #include "mongoc-iovec.h"
+#include "mongoc-read-concern-private.h"
 #include "mongoc-trace-private.h"
 #include "mongoc-error.h"
 
@@ -41,6 +46,18 @@ _mongoc_gridfs_file_refresh_page (mongoc_gridfs_file_t *file);
 static bool
 _mongoc_gridfs_file_flush_page (mongoc_gridfs_file_t *file);
 
+static bool
+_mongoc_gridfs_file_upload_page (mongoc_gridfs_file_t *file);
+
+static bool
+_mongoc_gridfs_file_end_upload (mongoc_gridfs_file_t *file);
+
+static void
+_mongoc_gridfs_file_upload_destroy (mongoc_gridfs_file_t *file);
+
+static void
+_mongoc_gridfs_file_download_reset (mongoc_gridfs_file_download_t *download);
+
 static ssize_t
 _mongoc_gridfs_file_extend (mongoc_gridfs_file_t *file);
 
@@ -137,7 +154,11 @@ mongoc_gridfs_file_save (mongoc_gridfs_file_t *file)
       return 1;
    }
 
-   if (file->page && _mongoc_gridfs_file_page_is_dirty (file->page)) {
+   if (file->upload) {
+      if (!_mongoc_gridfs_file_end_upload (file)) {
+         RETURN (false);
+      }
+   } else if (file->page && _mongoc_gridfs_file_page_is_dirty (file->page)) {
       _mongoc_gridfs_file_flush_page (file);
    }
 
@@ -364,10 +385,18 @@ mongoc_gridfs_file_destroy (mongoc_gridfs_file_t *file)
 
    BSON_ASSERT (file);
 
+   if (file->upload) {
+      _mongoc_gridfs_file_upload_destroy (file);
+   }
+
    if (file->page) {
       _mongoc_gridfs_file_page_destroy (file->page);
    }
 
+   _mongoc_gridfs_file_download_reset (&file->download);
+   bson_free (file->download.chunks);
+   bson_free (file->chunk_cache_buf);
+
    if (file->bson.len) {
       bson_destroy (&file->bson);
    }
@@ -609,7 +638,8 @@ _mongoc_gridfs_file_extend (mongoc_gridfs_file_t *file)
  * _mongoc_gridfs_file_flush_page:
  *
  *    Unconditionally flushes the file's current page to the database.
- *    The page to flush is determined by page->n.
+ *    The page to flush is determined by page->n. During a sequential upload
+ *    the page is added to the next batch of chunk inserts instead.
  *
  * Side Effects:
  *
@@ -631,6 +661,10 @@ _mongoc_gridfs_file_flush_page (mongoc_gridfs_file_t *file)
    BSON_ASSERT (file);
    BSON_ASSERT (file->page);
 
+   if (file->upload) {
+      RETURN (_mongoc_gridfs_file_upload_page (file));
+   }
+
    buf = _mongoc_gridfs_file_page_get_data (file->page);
    len = _mongoc_gridfs_file_page_get_len (file->page);
 
@@ -658,6 +692,14 @@ _mongoc_gridfs_file_flush_page (mongoc_gridfs_file_t *file)
    if (r) {
       _mongoc_gridfs_file_page_destroy (file->page);
       file->page = NULL;
+      /* chunks fetched ahead or cached may be stale now */
+      _mongoc_gridfs_file_download_reset (&file->download);
+      if (file->chunk_cache) {
+         _mongoc_gridfs_chunk_cache_remove (file->chunk_cache,
+                                            file->gridfs->chunks->ns,
+                                            &file->files_id,
+                                            file->n);
+      }
       r = mongoc_gridfs_file_save (file);
    }
 
@@ -665,6 +707,386 @@ _mongoc_gridfs_file_flush_page (mongoc_gridfs_file_t *file)
 }
 
 
+/**
+ * _mongoc_gridfs_file_begin_upload:
+ *
+ *    Start a sequential upload to a new, empty file. Instead of upserting
+ *    each chunk and then the files document, full chunks are inserted in
+ *    batches of up to maxWriteBatchSize chunks and maxMessageSizeBytes.
+ *    One batch is in flight while the next is filled, and the files
+ *    document is written once by mongoc_gridfs_file_save.
+ *
+ *    The file must only be written sequentially until it is saved.
+ *
+ * Returns:
+ *
+ *    True if the upload started. False if the file isn't new, the chunks
+ *    collection's write concern is unacknowledged, or the server is older
+ *    than MongoDB 3.6; the file then writes chunks one at a time.
+ */
+bool
+_mongoc_gridfs_file_begin_upload (mongoc_gridfs_file_t *file)
+{
+   mongoc_bulk_write_flags_t flags = MONGOC_BULK_WRITE_FLAGS_INIT;
+   mongoc_collection_t *chunks;
+   mongoc_server_stream_t *server_stream;
+   mongoc_gridfs_file_upload_t *upload;
+   bson_error_t error;
+
+   ENTRY;
+
+   BSON_ASSERT (file);
+
+   chunks = file->gridfs->chunks;
+
+   if (file->upload || file->length || file->pos ||
+       !mongoc_write_concern_is_acknowledged (chunks->write_concern)) {
+      RETURN (false);
+   }
+
+   /* if no server is available, the first chunk reports the error */
+   server_stream =
+      mongoc_cluster_stream_for_writes (&chunks->client->cluster, &error);
+
+   if (!server_stream) {
+      RETURN (false);
+   }
+
+   if (server_stream->sd->max_wire_version < WIRE_VERSION_OP_MSG) {
+      mongoc_server_stream_cleanup (server_stream);
+      RETURN (false);
+   }
+
+   upload = (mongoc_gridfs_file_upload_t *) bson_malloc0 (sizeof *upload);
+   _mongoc_write_command_batch_limits (
+      server_stream, &upload->max_batch_size, &upload->max_batch_bytes);
+
+   _mongoc_write_command_init_insert (&upload->batch,
+                                      NULL,
+                                      NULL,
+                                      flags,
+                                      ++chunks->client->cluster.operation_id,
+                                      false);
+   _mongoc_write_result_init (&upload->result);
+
+   mongoc_server_stream_cleanup (server_stream);
+
+   file->upload = upload;
+
+   RETURN (true);
+}
+
+
+/* free the insert that was in flight */
+static void
+_mongoc_gridfs_file_upload_reset (mongoc_gridfs_file_upload_t *upload)
+{
+   mongoc_cmd_parts_cleanup (&upload->parts);
+   bson_destroy (&upload->cmd);
+   mongoc_server_stream_cleanup (upload->server_stream);
+   _mongoc_write_command_destroy (&upload->sent);
+   upload->server_stream = NULL;
+   upload->in_flight = false;
+}
+
+
+/* read the reply to the insert in flight before the cluster reuses the
+ * connection, or give up on it if the connection is closing */
+static void
+_mongoc_gridfs_file_upload_cb (void *ctx, bool abandon)
+{
+   mongoc_gridfs_file_t *file;
+   mongoc_gridfs_file_upload_t *upload;
+   mongoc_cluster_t *cluster;
+   bson_error_t error;
+   bson_t reply;
+   bool ok;
+
+   ENTRY;
+
+   file = (mongoc_gridfs_file_t *) ctx;
+   upload = file->upload;
+   BSON_ASSERT (upload);
+   BSON_ASSERT (upload->in_flight);
+
+   cluster = &file->gridfs->client->cluster;
+
+   if (abandon) {
+      bson_set_error (&error,
+                      MONGOC_ERROR_STREAM,
+                      MONGOC_ERROR_STREAM_SOCKET,
+                      "Connection closed before the insert reply was read");
+      mongoc_cluster_abandon_reply_monitored (cluster,
+                                              &upload->parts.assembled,
+                                              upload->request_id,
+                                              upload->started,
+                                              &error);
+      bson_init (&reply);
+      ok = false;
+   } else {
+      ok = mongoc_cluster_recv_reply_monitored (cluster,
+                                                &upload->parts.assembled,
+                                                upload->request_id,
+                                                upload->started,
+                                                &reply,
+                                                &error);
+   }
+
+   if (!ok) {
+      upload->result.failed = true;
+      memcpy (&upload->result.error, &error, sizeof (bson_error_t));
+   }
+
+   _mongoc_write_result_merge (
+      &upload->result, &upload->sent, &reply, upload->offset);
+   upload->offset += upload->sent.n_documents;
+
+   bson_destroy (&reply);
+   _mongoc_gridfs_file_upload_reset (upload);
+
+   EXIT;
+}
+
+
+/* read the reply to the insert in flight, if any. returns false and sets
+ * file->error if any insert so far has failed */
+static bool
+_mongoc_gridfs_file_upload_wait (mongoc_gridfs_file_t *file)
+{
+   mongoc_gridfs_file_upload_t *upload;
+   mongoc_client_t *client;
+
+   ENTRY;
+
+   upload = file->upload;
+   client = file->gridfs->client;
+
+   if (upload->in_flight) {
+      mongoc_cluster_clear_pending_reply (&client->cluster, file);
+      _mongoc_gridfs_file_upload_cb (file, false /* abandon */);
+   }
+
+   RETURN (MONGOC_WRITE_RESULT_COMPLETE (&upload->result,
+                                         client->error_api_version,
+                                         file->gridfs->chunks->write_concern,
+                                         /* no error domain override */
+                                         (mongoc_error_domain_t) 0,
+                                         NULL,
+                                         &file->error));
+}
+
+
+/**
+ * _mongoc_gridfs_file_upload_send:
+ *
+ *    Wait for the insert in flight, then send the batch of chunks being
+ *    filled without waiting for its reply. The reply is read when the next
+ *    batch is sent, when the upload ends, or when the client needs the
+ *    connection; see mongoc_cluster_set_pending_reply.
+ *
+ * Returns:
+ *
+ *    True on success; false otherwise and file->error is set.
+ */
+static bool
+_mongoc_gridfs_file_upload_send (mongoc_gridfs_file_t *file)
+{
+   mongoc_bulk_write_flags_t flags = MONGOC_BULK_WRITE_FLAGS_INIT;
+   mongoc_gridfs_file_upload_t *upload;
+   mongoc_collection_t *chunks;
+   mongoc_client_t *client;
+   mongoc_server_stream_t *server_stream;
+
+   ENTRY;
+
+   upload = file->upload;
+   chunks = file->gridfs->chunks;
+   client = chunks->client;
+
+   if (!_mongoc_gridfs_file_upload_wait (file)) {
+      RETURN (false);
+   }
+
+   if (!upload->batch.n_documents) {
+      RETURN (true);
+   }
+
+   server_stream =
+      mongoc_cluster_stream_for_writes (&client->cluster, &file->error);
+
+   if (!server_stream) {
+      RETURN (false);
+   }
+
+   memcpy (&upload->sent, &upload->batch, sizeof (mongoc_write_command_t));
+   _mongoc_write_command_init_insert (
+      &upload->batch, NULL, NULL, flags, upload->sent.operation_id, false);
+
+   if (server_stream->sd->max_wire_version < WIRE_VERSION_OP_MSG) {
+      /* the primary changed to an older server, insert synchronously */
+      _mongoc_write_command_execute (&upload->sent,
+                                     client,
+                                     server_stream,
+                                     chunks->db,
+                                     chunks->collection,
+                                     chunks->write_concern,
+                                     upload->offset,
+                                     NULL,
+                                     &upload->result);
+      upload->offset += upload->sent.n_documents;
+      _mongoc_write_command_destroy (&upload->sent);
+      mongoc_server_stream_cleanup (server_stream);
+      RETURN (_mongoc_gridfs_file_upload_wait (file));
+   }
+
+   upload->server_stream = server_stream;
+   upload->in_flight = true;
+
+   bson_init (&upload->cmd);
+   _mongoc_write_command_init (
+      &upload->cmd, &upload->sent, chunks->collection, chunks->write_concern);
+   mongoc_cmd_parts_init (
+      &upload->parts, client, chunks->db, MONGOC_QUERY_NONE, &upload->cmd);
+   upload->parts.assembled.operation_id = upload->sent.operation_id;
+   upload->parts.is_write_command = true;
+   upload->parts.assembled.is_acknowledged = true;
+   upload->parts.allow_txn_number = MONGOC_CMD_PARTS_ALLOW_TXN_NUMBER_NO;
+
+   if (!mongoc_cmd_parts_assemble (
+          &upload->parts, server_stream, &upload->result.error)) {
+      GOTO (fail);
+   }
+
+   upload->parts.assembled.payload = upload->sent.payload.data;
+   upload->parts.assembled.payload_size = (int32_t) upload->sent.payload.len;
+   upload->parts.assembled.payload_identifier = "documents";
+
+   if (!mongoc_cluster_send_command_monitored (&client->cluster,
+                                               &upload->parts.assembled,
+                                               &upload->request_id,
+                                               &upload->started,
+                                               &upload->result.error)) {
+      GOTO (fail);
+   }
+
+   mongoc_cluster_set_pending_reply (&client->cluster,
+                                     server_stream->sd->id,
+                                     _mongoc_gridfs_file_upload_cb,
+                                     file);
+
+   RETURN (true);
+
+fail:
+   upload->result.failed = true;
+   _mongoc_gridfs_file_upload_reset (upload);
+
+   RETURN (_mongoc_gridfs_file_upload_wait (file));
+}
+
+
+/**
+ * _mongoc_gridfs_file_upload_page:
+ *
+ *    Add the current page to the batch of chunk inserts, and send the batch
+ *    once another chunk wouldn't fit in it.
+ *
+ * Side Effects:
+ *
+ *    On success, file->page is properly destroyed and set to NULL.
+ *
+ * Returns:
+ *
+ *    True on success; false otherwise.
+ */
+static bool
+_mongoc_gridfs_file_upload_page (mongoc_gridfs_file_t *file)
+{
+   mongoc_gridfs_file_upload_t *upload;
+   bson_t *chunk;
+   bson_oid_t oid;
+   uint32_t chunk_len;
+
+   ENTRY;
+
+   upload = file->upload;
+
+   /* generate the _id here, else the command copies the chunk to add it */
+   chunk = bson_sized_new (file->chunk_size + 100);
+   bson_oid_init (&oid, NULL);
+   bson_append_oid (chunk, "_id", -1, &oid);
+   bson_append_value (chunk, "files_id", -1, &file->files_id);
+   bson_append_int32 (chunk, "n", -1, file->n);
+   bson_append_binary (chunk,
+                       "data",
+                       -1,
+                       BSON_SUBTYPE_BINARY,
+                       _mongoc_gridfs_file_page_get_data (file->page),
+                       _mongoc_gridfs_file_page_get_len (file->page));
+
+   _mongoc_write_command_insert_append (&upload->batch, chunk);
+   chunk_len = chunk->len;
+   bson_destroy (chunk);
+
+   _mongoc_gridfs_file_page_destroy (file->page);
+   file->page = NULL;
+
+   /* no later chunk is larger than this one */
+   if (upload->batch.n_documents >= (uint32_t) upload->max_batch_size ||
+       upload->batch.payload.len + chunk_len >
+          (size_t) upload->max_batch_bytes) {
+      RETURN (_mongoc_gridfs_file_upload_send (file));
+   }
+
+   RETURN (true);
+}
+
+
+/* insert the remaining chunks and wait for all replies */
+static bool
+_mongoc_gridfs_file_end_upload (mongoc_gridfs_file_t *file)
+{
+   bool r = true;
+
+   ENTRY;
+
+   if (file->page && _mongoc_gridfs_file_page_is_dirty (file->page)) {
+      r = _mongoc_gridfs_file_upload_page (file);
+   }
+
+   r = r && _mongoc_gridfs_file_upload_send (file) &&
+       _mongoc_gridfs_file_upload_wait (file);
+
+   _mongoc_gridfs_file_upload_destroy (file);
+
+   RETURN (r);
+}
+
+
+static void
+_mongoc_gridfs_file_upload_destroy (mongoc_gridfs_file_t *file)
+{
+   mongoc_gridfs_file_upload_t *upload;
+
+   ENTRY;
+
+   upload = file->upload;
+
+   /* read the reply so the connection can be reused */
+   if (upload->in_flight) {
+      mongoc_cluster_clear_pending_reply (&file->gridfs->client->cluster,
+                                          file);
+      _mongoc_gridfs_file_upload_cb (file, false /* abandon */);
+   }
+
+   _mongoc_write_command_destroy (&upload->batch);
+   _mongoc_write_result_destroy (&upload->result);
+   bson_free (upload);
+   file->upload = NULL;
+
+   EXIT;
+}
+
+
 /**
  * _mongoc_gridfs_file_keep_cursor:
  *
@@ -726,6 +1148,273 @@ missing_chunk (mongoc_gridfs_file_t *file)
 }
 
 
+/* fetch ranges of up to about the server's default 4 MB find batch */
+#define MONGOC_GRIDFS_DOWNLOAD_RANGE_BYTES (4 * 1024 * 1024)
+
+
+static void
+_mongoc_gridfs_file_download_reset (mongoc_gridfs_file_download_t *download)
+{
+   size_t i;
+
+   for (i = 0; i < download->n_replies; i++) {
+      bson_destroy (&download->replies[i]);
+   }
+
+   download->n_replies = 0;
+   download->n_chunks = 0;
+}
+
+
+/* the command to find chunks [start, end) in a single batch */
+static void
+_mongoc_gridfs_file_download_range (mongoc_gridfs_file_t *file,
+                                    int32_t start,
+                                    int32_t end,
+                                    bson_t *cmd)
+{
+   mongoc_collection_t *chunks;
+   bson_t child;
+   bson_t grandchild;
+
+   chunks = file->gridfs->chunks;
+
+   bson_init (cmd);
+   BSON_APPEND_UTF8 (cmd, "find", chunks->collection);
+   BSON_APPEND_DOCUMENT_BEGIN (cmd, "filter", &child);
+   BSON_APPEND_VALUE (&child, "files_id", &file->files_id);
+   BSON_APPEND_DOCUMENT_BEGIN (&child, "n", &grandchild);
+   BSON_APPEND_INT32 (&grandchild, "$gte", start);
+   BSON_APPEND_INT32 (&grandchild, "$lt", end);
+   bson_append_document_end (&child, &grandchild);
+   bson_append_document_end (cmd, &child);
+
+   BSON_APPEND_DOCUMENT_BEGIN (cmd, "sort", &child);
+   BSON_APPEND_INT32 (&child, "n", 1);
+   bson_append_document_end (cmd, &child);
+
+   BSON_APPEND_DOCUMENT_BEGIN (cmd, "projection", &child);
+   BSON_APPEND_INT32 (&child, "n", 1);
+   BSON_APPEND_INT32 (&child, "data", 1);
+   BSON_APPEND_INT32 (&child, "_id", 0);
+   bson_append_document_end (cmd, &child);
+
+   BSON_APPEND_INT32 (cmd, "batchSize", end - start);
+   BSON_APPEND_BOOL (cmd, "singleBatch", true);
+
+   if (!mongoc_read_concern_is_default (chunks->read_concern)) {
+      BSON_APPEND_DOCUMENT (
+         cmd, "readConcern", _mongoc_read_concern_get_bson (chunks->read_concern));
+   }
+}
+
+
+/* append the chunks in a find reply that follow the buffered ones, returns
+ * the number appended */
+static int32_t
+_mongoc_gridfs_file_download_append (mongoc_gridfs_file_download_t *download,
+                                     const bson_t *reply)
+{
+   mongoc_gridfs_file_download_chunk_t *chunk;
+   bson_iter_t iter;
+   bson_iter_t batch;
+   bson_iter_t child;
+   int32_t appended = 0;
+   bool has_n;
+
+   if (!bson_iter_init (&iter, reply) ||
+       !bson_iter_find_descendant (&iter, "cursor.firstBatch", &batch) ||
+       !BSON_ITER_HOLDS_ARRAY (&batch) || !bson_iter_recurse (&batch, &iter)) {
+      return 0;
+   }
+
+   while (bson_iter_next (&iter)) {
+      if (!BSON_ITER_HOLDS_DOCUMENT (&iter) ||
+          !bson_iter_recurse (&iter, &child) ||
+          (size_t) download->n_chunks == download->chunks_len) {
+         break;
+      }
+
+      chunk = &download->chunks[download->n_chunks];
+      chunk->data = NULL;
+      has_n = false;
+
+      while (bson_iter_next (&child)) {
+         if (!strcmp (bson_iter_key (&child), "n")) {
+            has_n = BSON_ITER_HOLDS_INT32 (&child) &&
+                    bson_iter_int32 (&child) ==
+                       download->first_n + download->n_chunks;
+         } else if (!strcmp (bson_iter_key (&child), "data") &&
+                    BSON_ITER_HOLDS_BINARY (&child)) {
+            bson_iter_binary (&child, NULL, &chunk->len, &chunk->data);
+         }
+      }
+
+      /* stop at a missing or corrupt chunk */
+      if (!has_n || !chunk->data) {
+         break;
+      }
+
+      download->n_chunks++;
+      appended++;
+   }
+
+   return appended;
+}
+
+
+/**
+ * _mongoc_gridfs_file_download:
+ *
+ *    Get chunk file->n from the chunks fetched ahead for a sequential
+ *    download, fetching more if needed. A download splits the chunks that
+ *    follow file->n into ranges of about 4 MB, and pipelines up to
+ *    MONGOC_GRIDFS_DOWNLOAD_WINDOW finds of them on one connection, so
+ *    reading a large file costs one round trip per window instead of per
+ *    cursor batch. The chunks are kept in order up to the first one
+ *    missing.
+ *
+ *    Random access, small files, and servers older than MongoDB 3.6 use a
+ *    cursor instead.
+ *
+ * Returns:
+ *
+ *    1 if @data and @len are set, 0 if the caller should use a cursor, or
+ *    -1 if the chunk couldn't be read and file->error is set.
+ */
+static int
+_mongoc_gridfs_file_download (mongoc_gridfs_file_t *file,
+                              const uint8_t **data,
+                              uint32_t *len)
+{
+   mongoc_gridfs_file_download_t *download;
+   mongoc_collection_t *chunks;
+   mongoc_server_stream_t *server_stream;
+   bson_t cmds[MONGOC_GRIDFS_DOWNLOAD_WINDOW];
+   const bson_t *commands[MONGOC_GRIDFS_DOWNLOAD_WINDOW];
+   int32_t ends[MONGOC_GRIDFS_DOWNLOAD_WINDOW];
+   bson_error_t errors[MONGOC_GRIDFS_DOWNLOAD_WINDOW];
+   bson_error_t error;
+   int64_t n_total;
+   int32_t range;
+   int32_t start;
+   int32_t max_wire_version;
+   size_t n_cmds = 0;
+   size_t i;
+
+   ENTRY;
+
+   download = &file->download;
+   chunks = file->gridfs->chunks;
+
+   if (file->n >= download->first_n &&
+       file->n < download->first_n + download->n_chunks) {
+      GOTO (found);
+   }
+
+   /* an open cursor that follows the reader serves as well */
+   if (file->n != download->next_n ||
+       (file->cursor && _mongoc_gridfs_file_keep_cursor (file))) {
+      RETURN (0);
+   }
+
+   range = BSON_MAX (1, MONGOC_GRIDFS_DOWNLOAD_RANGE_BYTES / file->chunk_size);
+   n_total = divide_round_up (file->length, file->chunk_size);
+
+   if (n_total <= range) {
+      RETURN (0);
+   }
+
+   /* if server selection fails, the cursor reports the error */
+   server_stream = mongoc_cluster_stream_for_reads (
+      &chunks->client->cluster, chunks->read_prefs, &error);
+
+   if (!server_stream) {
+      RETURN (0);
+   }
+
+   max_wire_version = server_stream->sd->max_wire_version;
+   mongoc_server_stream_cleanup (server_stream);
+
+   if (max_wire_version < WIRE_VERSION_OP_MSG) {
+      RETURN (0);
+   }
+
+   _mongoc_gridfs_file_download_reset (download);
+
+   if (download->chunks_len < (size_t) range * MONGOC_GRIDFS_DOWNLOAD_WINDOW) {
+      download->chunks_len = (size_t) range * MONGOC_GRIDFS_DOWNLOAD_WINDOW;
+      download->chunks = (mongoc_gridfs_file_download_chunk_t *) bson_realloc (
+         download->chunks, download->chunks_len * sizeof *download->chunks);
+   }
+
+   for (start = file->n;
+        start < n_total && n_cmds < MONGOC_GRIDFS_DOWNLOAD_WINDOW;
+        start = ends[n_cmds++]) {
+      ends[n_cmds] = (int32_t) BSON_MIN (n_total, (int64_t) start + range);
+      _mongoc_gridfs_file_download_range (
+         file, start, ends[n_cmds], &cmds[n_cmds]);
+      commands[n_cmds] = &cmds[n_cmds];
+   }
+
+   memset (errors, 0, sizeof errors);
+   mongoc_client_command_pipeline (chunks->client,
+                                   chunks->db,
+                                   commands,
+                                   n_cmds,
+                                   chunks->read_prefs,
+                                   download->replies,
+                                   errors);
+
+   download->n_replies = n_cmds;
+   download->first_n = file->n;
+
+   for (i = 0; i < n_cmds; i++) {
+      bson_destroy (&cmds[i]);
+   }
+
+   /* reassemble the ranges in order, up to the first failed or short one */
+   for (i = 0; i < n_cmds; i++) {
+      if (errors[i].domain) {
+         break;
+      }
+
+      _mongoc_gridfs_file_download_append (download, &download->replies[i]);
+
+      if (download->first_n + download->n_chunks != ends[i]) {
+         break;
+      }
+   }
+
+   if (file->chunk_cache) {
+      for (i = 0; i < (size_t) download->n_chunks; i++) {
+         _mongoc_gridfs_chunk_cache_put (file->chunk_cache,
+                                         file->gridfs->chunks->ns,
+                                         &file->files_id,
+                                         download->first_n + (int32_t) i,
+                                         download->chunks[i].data,
+                                         download->chunks[i].len);
+      }
+   }
+
+   if (!download->n_chunks) {
+      if (errors[0].domain) {
+         memcpy (&file->error, &errors[0], sizeof (bson_error_t));
+      } else {
+         missing_chunk (file);
+      }
+
+      RETURN (-1);
+   }
+
+found:
+   *data = download->chunks[file->n - download->first_n].data;
+   *len = download->chunks[file->n - download->first_n].len;
+
+   RETURN (1);
+}
+
+
 /**
  * _mongoc_gridfs_file_refresh_page:
  *
@@ -735,6 +1424,8 @@ missing_chunk (mongoc_gridfs_file_t *file)
  *
  *    Note that this fetch is unconditional and the page is queried from the
  *    database even if the current page covers the same theoretical chunk.
+ *    If the file has a chunk cache, a cached copy of the chunk is used
+ *    instead, and chunks fetched from the database are added to the cache.
  *
  *
  * Side Effects:
@@ -758,6 +1449,7 @@ _mongoc_gridfs_file_refresh_page (mongoc_gridfs_file_t *file)
    bson_iter_t iter;
    int64_t existing_chunks;
    int64_t required_chunks;
+   int r;
 
    const uint8_t *data = NULL;
    uint32_t len;
@@ -780,6 +1472,19 @@ _mongoc_gridfs_file_refresh_page (mongoc_gridfs_file_t *file)
    if (required_chunks > existing_chunks) {
       data = (uint8_t *) "";
       len = 0;
+   } else if (file->chunk_cache &&
+              _mongoc_gridfs_chunk_cache_get (file->chunk_cache,
+                                              file->gridfs->chunks->ns,
+                                              &file->files_id,
+                                              file->n,
+                                              file->chunk_cache_buf,
+                                              (uint32_t) file->chunk_size,
+                                              &len)) {
+      data = file->chunk_cache_buf;
+   } else if ((r = _mongoc_gridfs_file_download (file, &data, &len))) {
+      if (r < 0) {
+         RETURN (0);
+      }
    } else {
       /* if we have a cursor, but the cursor doesn't have the chunk we're going
        * to need, destroy it (we'll grab a new one immediately there after) */
@@ -856,6 +1561,15 @@ _mongoc_gridfs_file_refresh_page (mongoc_gridfs_file_t *file)
       if (file->n != file->pos / file->chunk_size) {
          return 0;
       }
+
+      if (file->chunk_cache && data) {
+         _mongoc_gridfs_chunk_cache_put (file->chunk_cache,
+                                         file->gridfs->chunks->ns,
+                                         &file->files_id,
+                                         file->n,
+                                         data,
+                                         len);
+      }
    }
 
    if (!data) {
@@ -867,6 +1581,7 @@ _mongoc_gridfs_file_refresh_page (mongoc_gridfs_file_t *file)
       RETURN (0);
    }
 
+   file->download.next_n = file->n + 1;
    file->page = _mongoc_gridfs_file_page_new (data, len, file->chunk_size);
 
    /* seek in the page towards wherever we're supposed to be */
@@ -1040,6 +1755,11 @@ mongoc_gridfs_file_remove (mongoc_gridfs_file_t *file, bson_error_t *error)
       goto cleanup;
    }
 
+   if (file->chunk_cache) {
+      _mongoc_gridfs_chunk_cache_remove (
+         file->chunk_cache, file->gridfs->chunks->ns, &file->files_id, -1);
+   }
+
    ret = true;
 
 cleanup:
@@ -1047,3 +1767,24 @@ cleanup:
 
    return ret;
 }
+
+
+/**
+ * mongoc_gridfs_file_set_chunk_cache:
+ *
+ *    Read chunks through @cache, or stop if @cache is NULL. Chunks the
+ *    file reads from the server are added to the cache, and chunks it
+ *    writes or removes are dropped from it.
+ */
+void
+mongoc_gridfs_file_set_chunk_cache (mongoc_gridfs_file_t *file,
+                                    mongoc_gridfs_chunk_cache_t *cache)
+{
+   BSON_ASSERT (file);
+
+   file->chunk_cache = cache;
+
+   if (cache && !file->chunk_cache_buf) {
+      file->chunk_cache_buf = (uint8_t *) bson_malloc (file->chunk_size);
+   }
+}
@@ -25,6 +25,7 @@
 
 #include "mongoc-macros.h"
 #include "mongoc-socket.h"
+#include "mongoc-gridfs-chunk-cache.h"
 
 BSON_BEGIN_DECLS
 
@@ -111,6 +112,10 @@ mongoc_gridfs_file_error (mongoc_gridfs_file_t *file, bson_error_t *error);
 MONGOC_EXPORT (bool)
 mongoc_gridfs_file_remove (mongoc_gridfs_file_t *file, bson_error_t *error);
 
+MONGOC_EXPORT (void)
+mongoc_gridfs_file_set_chunk_cache (mongoc_gridfs_file_t *file,
+                                    mongoc_gridfs_chunk_cache_t *cache);
+
 BSON_END_DECLS
 
 #endif /* MONGOC_GRIDFS_FILE_H */
@@ -279,7 +279,8 @@ mongoc_gridfs_find_one_by_filename (mongoc_gridfs_t *gridfs,
 
 /** create a gridfs file from a stream
  *
- * The stream is fully consumed in creating the file
+ * The stream is fully consumed in creating the file. Chunks are inserted in
+ * batches, see _mongoc_gridfs_file_begin_upload, and the file is saved.
  */
 mongoc_gridfs_file_t *
 mongoc_gridfs_create_file_from_stream (mongoc_gridfs_t *gridfs,
@@ -303,13 +304,18 @@ mongoc_gridfs_create_file_from_stream (mongoc_gridfs_t *gridfs,
    file = _mongoc_gridfs_file_new (gridfs, opt);
    timeout = gridfs->client->cluster.sockettimeoutms;
 
+   /* if the upload can't be batched, chunks are upserted one at a time */
+   _mongoc_gridfs_file_begin_upload (file);
+
    for (;;) {
       r = mongoc_stream_read (
          stream, iov.iov_base, MONGOC_GRIDFS_STREAM_CHUNK, 0, timeout);
 
       if (r > 0) {
          iov.iov_len = r;
-         mongoc_gridfs_file_writev (file, &iov, 1, timeout);
+         if (mongoc_gridfs_file_writev (file, &iov, 1, timeout) < 0) {
+            break;
+         }
       } else if (r == 0) {
          break;
       } else {
@@ -320,6 +326,12 @@ mongoc_gridfs_create_file_from_stream (mongoc_gridfs_t *gridfs,
 
    mongoc_stream_failed (stream);
 
+   /* r > 0 if writing a chunk failed */
+   if (r > 0 || (file->upload && !mongoc_gridfs_file_save (file))) {
+      mongoc_gridfs_file_destroy (file);
+      RETURN (NULL);
+   }
+
    mongoc_gridfs_file_seek (file, 0, SEEK_SET);
 
    RETURN (file);
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2018-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef MONGOC_IMPORTER_PRIVATE_H
+#define MONGOC_IMPORTER_PRIVATE_H
+
+#if !defined(MONGOC_COMPILATION)
+#error "Only <mongoc.h> can be included directly."
+#endif
+
+#include <bson.h>
+
+#include "mongoc-array-private.h"
+#include "mongoc-buffer-private.h"
+#include "mongoc-importer.h"
+#include "mongoc-thread-private.h"
+#include "mongoc-write-command-private.h"
+
+
+BSON_BEGIN_DECLS
+
+
+#define MONGOC_IMPORTER_DEFAULT_WORKERS 2
+#define MONGOC_IMPORTER_DEFAULT_CONNECTIONS 4
+#define MONGOC_IMPORTER_DEFAULT_QUEUE_SIZE 4
+
+
+/* documents parsed from the input, concatenated, not yet validated */
+typedef struct {
+   mongoc_buffer_t data;
+   uint32_t n_documents;
+   /* index of the first document among all imported ones */
+   uint32_t offset;
+   /* position in the input, senders of an ordered import follow it */
+   uint32_t seq;
+} mongoc_importer_chunk_t;
+
+
+/* an insert command built from a chunk, ready to send */
+typedef struct {
+   mongoc_write_command_t command;
+   uint32_t offset;
+   uint32_t seq;
+   /* write errors for the chunk's invalid documents, reported when the
+    * batch's turn to be sent comes, or NULL */
+   mongoc_write_result_t *invalid;
+} mongoc_importer_batch_t;
+
+
+struct _mongoc_importer_t {
+   mongoc_client_pool_t *pool;
+   char *database;
+   char *collection;
+   /* NULL to use the write concern of the pool's URI */
+   mongoc_write_concern_t *write_concern;
+   mongoc_bulk_write_flags_t flags;
+   uint32_t n_workers;
+   uint32_t n_connections;
+   uint32_t queue_size;
+   bool counts_only;
+   /* an invalid option, reported by each import */
+   bson_error_t opts_error;
+
+   /* the state of one import, guarded by mutex while threads run */
+   mongoc_mutex_t mutex;
+   mongoc_cond_t cond;
+   int64_t operation_id;
+   const mongoc_write_concern_t *import_write_concern;
+   uint32_t server_id;
+   int32_t max_batch_size;
+   int32_t max_batch_bytes;
+   mongoc_array_t chunks;
+   mongoc_array_t batches;
+   bool parsed_all;
+   uint32_t n_preparing;
+   uint32_t next_seq;
+   bool stop;
+   /* a parsing error or a failure to start, rather than a write error */
+   bson_error_t error;
+   uint32_t n_documents;
+   int64_t n_bytes;
+   uint32_t n_chunks;
+   mongoc_write_result_t result;
+};
+
+
+BSON_END_DECLS
+
+
+#endif /* MONGOC_IMPORTER_PRIVATE_H */
@@ -0,0 +1,800 @@
+/*
+ * Copyright 2018-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+
+#include "mongoc-client-pool-private.h"
+#include "mongoc-client-private.h"
+#include "mongoc-error.h"
+#include "mongoc-importer-private.h"
+#include "mongoc-server-stream-private.h"
+#include "mongoc-trace-private.h"
+#include "mongoc-util-private.h"
+#include "mongoc-write-concern-private.h"
+
+#undef MONGOC_LOG_DOMAIN
+#define MONGOC_LOG_DOMAIN "importer"
+
+
+/* a thread that sends batches on one of the pool's clients */
+typedef struct {
+   mongoc_importer_t *importer;
+   mongoc_client_t *client;
+   mongoc_thread_t thread;
+} mongoc_importer_sender_t;
+
+
+/* parse a positive int32 option, keeping the first invalid one */
+static void
+_mongoc_importer_opt_count (mongoc_importer_t *importer,
+                            const bson_t *opts,
+                            const char *key,
+                            uint32_t default_value,
+                            uint32_t *value)
+{
+   bson_iter_t iter;
+
+   *value = default_value;
+
+   if (!opts || !bson_iter_init_find (&iter, opts, key)) {
+      return;
+   }
+
+   if (BSON_ITER_HOLDS_INT32 (&iter) && bson_iter_int32 (&iter) > 0) {
+      *value = (uint32_t) bson_iter_int32 (&iter);
+   } else if (!importer->opts_error.domain) {
+      bson_set_error (&importer->opts_error,
+                      MONGOC_ERROR_COMMAND,
+                      MONGOC_ERROR_COMMAND_INVALID_ARG,
+                      "Invalid %s, must be a positive int32",
+                      key);
+   }
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * mongoc_importer_new --
+ *
+ *       Create an importer that inserts documents into @db.@collection on
+ *       clients from @pool. Each import runs as a pipeline: the caller's
+ *       thread parses documents, "workers" threads validate them and
+ *       build insert commands, and up to "connections" threads send the
+ *       commands. Queues between the stages hold up to "queueSize"
+ *       batches.
+ *
+ *       @opts may also contain "ordered", "writeConcern" and
+ *       "resultDetail".
+ *
+ *--------------------------------------------------------------------------
+ */
+
+mongoc_importer_t *
+mongoc_importer_new (mongoc_client_pool_t *pool,
+                     const char *db,
+                     const char *collection,
+                     const bson_t *opts)
+{
+   mongoc_importer_t *importer;
+   mongoc_write_result_t result;
+   bson_iter_t iter;
+
+   BSON_ASSERT (pool);
+   BSON_ASSERT (db);
+   BSON_ASSERT (collection);
+
+   importer = (mongoc_importer_t *) bson_malloc0 (sizeof *importer);
+   importer->pool = pool;
+   importer->database = bson_strdup (db);
+   importer->collection = bson_strdup (collection);
+   importer->flags.ordered = _mongoc_lookup_bool (opts, "ordered", true);
+   importer->flags.bypass_document_validation =
+      MONGOC_BYPASS_DOCUMENT_VALIDATION_DEFAULT;
+   mongoc_mutex_init (&importer->mutex);
+   mongoc_cond_init (&importer->cond);
+
+   if (opts && bson_iter_init_find (&iter, opts, "writeConcern")) {
+      importer->write_concern =
+         _mongoc_write_concern_new_from_iter (&iter, &importer->opts_error);
+   }
+
+   _mongoc_importer_opt_count (importer,
+                               opts,
+                               "workers",
+                               MONGOC_IMPORTER_DEFAULT_WORKERS,
+                               &importer->n_workers);
+   _mongoc_importer_opt_count (importer,
+                               opts,
+                               "connections",
+                               MONGOC_IMPORTER_DEFAULT_CONNECTIONS,
+                               &importer->n_connections);
+   _mongoc_importer_opt_count (importer,
+                               opts,
+                               "queueSize",
+                               MONGOC_IMPORTER_DEFAULT_QUEUE_SIZE,
+                               &importer->queue_size);
+
+   /* an ordered import sends one batch at a time */
+   if (importer->flags.ordered) {
+      importer->n_connections = 1;
+   }
+
+   _mongoc_write_result_init (&result);
+   _mongoc_write_result_set_detail (&result, opts);
+   importer->counts_only = result.counts_only;
+   if (result.error.domain && !importer->opts_error.domain) {
+      memcpy (&importer->opts_error, &result.error, sizeof result.error);
+   }
+
+   _mongoc_write_result_destroy (&result);
+
+   return importer;
+}
+
+
+void
+mongoc_importer_destroy (mongoc_importer_t *importer)
+{
+   if (!importer) {
+      return;
+   }
+
+   mongoc_cond_destroy (&importer->cond);
+   mongoc_mutex_destroy (&importer->mutex);
+   mongoc_write_concern_destroy (importer->write_concern);
+   bson_free (importer->collection);
+   bson_free (importer->database);
+   bson_free (importer);
+}
+
+
+/* stop every stage after an error, the caller holds the lock */
+static void
+_mongoc_importer_fail (mongoc_importer_t *importer, const bson_error_t *error)
+{
+   if (!importer->error.domain) {
+      memcpy (&importer->error, error, sizeof *error);
+   }
+
+   importer->stop = true;
+   mongoc_cond_broadcast (&importer->cond);
+}
+
+
+/* remove the element at @i from @array and copy it to @element */
+static void
+_mongoc_importer_shift (mongoc_array_t *array, size_t i, void *element)
+{
+   uint8_t *data = (uint8_t *) array->data;
+
+   memcpy (element, data + i * array->element_size, array->element_size);
+   memmove (data + i * array->element_size,
+            data + (i + 1) * array->element_size,
+            (array->len - i - 1) * array->element_size);
+   array->len--;
+}
+
+
+/* pass a full chunk to the workers, waiting for room in their queue, and
+ * return whether the import continues */
+static bool
+_mongoc_importer_push_chunk (mongoc_importer_t *importer,
+                             mongoc_importer_chunk_t *chunk)
+{
+   bool ret;
+
+   mongoc_mutex_lock (&importer->mutex);
+
+   while (importer->chunks.len >= importer->queue_size && !importer->stop) {
+      mongoc_cond_wait (&importer->cond, &importer->mutex);
+   }
+
+   ret = !importer->stop;
+   if (ret) {
+      _mongoc_array_append_val (&importer->chunks, *chunk);
+      mongoc_cond_broadcast (&importer->cond);
+   } else {
+      _mongoc_buffer_destroy (&chunk->data);
+   }
+
+   mongoc_mutex_unlock (&importer->mutex);
+
+   return ret;
+}
+
+
+static void
+_mongoc_importer_chunk_init (mongoc_importer_t *importer,
+                             mongoc_importer_chunk_t *chunk)
+{
+   _mongoc_buffer_init (&chunk->data, NULL, 0, NULL, NULL);
+   chunk->n_documents = 0;
+   chunk->offset = importer->n_documents;
+   chunk->seq = importer->n_chunks++;
+}
+
+
+/* the parsing stage: read documents on the caller's thread and group them
+ * into chunks that fit in one insert command, counting generated _ids */
+static void
+_mongoc_importer_parse (mongoc_importer_t *importer,
+                        bson_reader_t *reader,
+                        bson_json_reader_t *json_reader)
+{
+   mongoc_importer_chunk_t chunk;
+   bson_t json_document = BSON_INITIALIZER;
+   const bson_t *document;
+   bson_error_t error;
+   bool eof = false;
+   bool ok = true;
+   int r;
+
+   ENTRY;
+
+   _mongoc_importer_chunk_init (importer, &chunk);
+
+   for (;;) {
+      if (reader) {
+         document = bson_reader_read (reader, &eof);
+         if (!document && !eof) {
+            bson_set_error (&error,
+                            MONGOC_ERROR_BSON,
+                            MONGOC_ERROR_BSON_INVALID,
+                            "Corrupt BSON document after %" PRIu32
+                            " documents",
+                            importer->n_documents);
+            ok = false;
+         }
+      } else {
+         bson_reinit (&json_document);
+         r = bson_json_reader_read (json_reader, &json_document, &error);
+         document = r > 0 ? &json_document : NULL;
+         ok = r >= 0;
+      }
+
+      if (!document) {
+         break;
+      }
+
+      if (chunk.n_documents &&
+          (chunk.n_documents >= (uint32_t) importer->max_batch_size ||
+           chunk.data.len + document->len + MONGOC_WRITE_COMMAND_ID_LEN >
+              (size_t) importer->max_batch_bytes)) {
+         if (!_mongoc_importer_push_chunk (importer, &chunk)) {
+            bson_destroy (&json_document);
+            EXIT;
+         }
+
+         _mongoc_importer_chunk_init (importer, &chunk);
+      }
+
+      _mongoc_buffer_append (
+         &chunk.data, bson_get_data (document), document->len);
+      chunk.n_documents++;
+      importer->n_documents++;
+      importer->n_bytes += document->len;
+   }
+
+   bson_destroy (&json_document);
+
+   if (chunk.n_documents) {
+      _mongoc_importer_push_chunk (importer, &chunk);
+   } else {
+      _mongoc_buffer_destroy (&chunk.data);
+      importer->n_chunks--;
+   }
+
+   /* a parsing error ends the input, documents before it are imported */
+   mongoc_mutex_lock (&importer->mutex);
+   if (!ok && !importer->error.domain) {
+      memcpy (&importer->error, &error, sizeof error);
+   }
+
+   importer->parsed_all = true;
+   mongoc_cond_broadcast (&importer->cond);
+   mongoc_mutex_unlock (&importer->mutex);
+
+   EXIT;
+}
+
+
+static void
+_mongoc_importer_batch_destroy (mongoc_importer_batch_t *batch)
+{
+   _mongoc_write_command_destroy (&batch->command);
+   if (batch->invalid) {
+      _mongoc_write_result_destroy (batch->invalid);
+      bson_free (batch->invalid);
+   }
+}
+
+
+/* record an invalid document as a write error at @index */
+static void
+_mongoc_importer_invalid (mongoc_importer_batch_t *batch,
+                          uint32_t index,
+                          const bson_error_t *error)
+{
+   mongoc_write_result_t *result;
+   bson_t child;
+   const char *key;
+   char str[16];
+
+   /* batches are copied through the queues, a write result's bson_t
+    * arrays can't be */
+   if (!batch->invalid) {
+      batch->invalid =
+         (mongoc_write_result_t *) bson_malloc (sizeof *batch->invalid);
+      _mongoc_write_result_init (batch->invalid);
+   }
+
+   result = batch->invalid;
+   bson_uint32_to_string (result->n_writeErrors, &key, str, sizeof str);
+   BSON_APPEND_DOCUMENT_BEGIN (&result->writeErrors, key, &child);
+   BSON_APPEND_INT32 (&child, "index", (int32_t) index);
+   BSON_APPEND_INT32 (&child, "code", (int32_t) error->code);
+   BSON_APPEND_UTF8 (&child, "errmsg", error->message);
+   bson_append_document_end (&result->writeErrors, &child);
+
+   result->n_writeErrors++;
+   result->failed = true;
+}
+
+
+/* validate a chunk's documents and build an insert command from the valid
+ * ones, generating missing _ids. an ordered import's batch ends at the first
+ * invalid document, an unordered import's batch skips them */
+static void
+_mongoc_importer_prepare (mongoc_importer_t *importer,
+                          mongoc_importer_chunk_t *chunk,
+                          mongoc_importer_batch_t *batch)
+{
+   bson_reader_t *reader;
+   const bson_t *document;
+   bson_error_t error;
+   bool skipped = false;
+   uint32_t i;
+   uint32_t j;
+   uint32_t idx;
+
+   _mongoc_write_command_init_insert (
+      &batch->command,
+      NULL,
+      NULL,
+      importer->flags,
+      importer->operation_id,
+      !mongoc_write_concern_is_acknowledged (importer->import_write_concern));
+   batch->invalid = NULL;
+   batch->offset = chunk->offset;
+   batch->seq = chunk->seq;
+
+   reader = bson_reader_new_from_data (chunk->data.data, chunk->data.len);
+
+   for (i = 0; (document = bson_reader_read (reader, NULL)); i++) {
+      if (!_mongoc_validate_new_document (
+             document, _mongoc_default_insert_vflags, &error)) {
+         _mongoc_importer_invalid (batch, chunk->offset + i, &error);
+         if (importer->flags.ordered) {
+            break;
+         }
+
+         /* the documents after this one no longer follow the offset, map
+          * each document in the command to its index */
+         if (!skipped) {
+            for (j = 0; j < i; j++) {
+               idx = chunk->offset + j;
+               _mongoc_array_append_val (&batch->command.indexes, idx);
+            }
+
+            skipped = true;
+         }
+
+         continue;
+      }
+
+      _mongoc_write_command_insert_append (&batch->command, document);
+      if (skipped) {
+         idx = chunk->offset + i;
+         _mongoc_array_append_val (&batch->command.indexes, idx);
+      }
+   }
+
+   bson_reader_destroy (reader);
+}
+
+
+/* the preparing stage, run by "workers" threads */
+static void *
+_mongoc_importer_worker (void *data)
+{
+   mongoc_importer_t *importer = (mongoc_importer_t *) data;
+   mongoc_importer_chunk_t chunk;
+   mongoc_importer_batch_t batch;
+
+   mongoc_mutex_lock (&importer->mutex);
+
+   for (;;) {
+      while (!importer->chunks.len && !importer->parsed_all &&
+             !importer->stop) {
+         mongoc_cond_wait (&importer->cond, &importer->mutex);
+      }
+
+      if (importer->stop || !importer->chunks.len) {
+         break;
+      }
+
+      _mongoc_importer_shift (&importer->chunks, 0, &chunk);
+      mongoc_cond_broadcast (&importer->cond);
+      mongoc_mutex_unlock (&importer->mutex);
+
+      _mongoc_importer_prepare (importer, &chunk, &batch);
+      _mongoc_buffer_destroy (&chunk.data);
+
+      mongoc_mutex_lock (&importer->mutex);
+
+      /* an ordered import's sender waits for the next batch in sequence,
+       * let it through even if the queue is full */
+      while (importer->batches.len >= importer->queue_size &&
+             !(importer->flags.ordered && batch.seq == importer->next_seq) &&
+             !importer->stop) {
+         mongoc_cond_wait (&importer->cond, &importer->mutex);
+      }
+
+      if (importer->stop) {
+         _mongoc_importer_batch_destroy (&batch);
+         break;
+      }
+
+      _mongoc_array_append_val (&importer->batches, batch);
+      mongoc_cond_broadcast (&importer->cond);
+   }
+
+   importer->n_preparing--;
+   mongoc_cond_broadcast (&importer->cond);
+   mongoc_mutex_unlock (&importer->mutex);
+
+   return NULL;
+}
+
+
+/* the index of the next batch to send, or -1, the caller holds the lock */
+static ssize_t
+_mongoc_importer_next_batch (mongoc_importer_t *importer)
+{
+   size_t i;
+
+   if (!importer->flags.ordered) {
+      return importer->batches.len ? 0 : -1;
+   }
+
+   for (i = 0; i < importer->batches.len; i++) {
+      if (_mongoc_array_index (&importer->batches, mongoc_importer_batch_t, i)
+             .seq == importer->next_seq) {
+         return (ssize_t) i;
+      }
+   }
+
+   return -1;
+}
+
+
+/* the sending stage, run by up to "connections" threads */
+static void *
+_mongoc_importer_sender (void *data)
+{
+   mongoc_importer_sender_t *sender = (mongoc_importer_sender_t *) data;
+   mongoc_importer_t *importer = sender->importer;
+   mongoc_importer_batch_t batch;
+   mongoc_server_stream_t *server_stream;
+   mongoc_write_result_t result;
+   ssize_t i;
+
+   mongoc_mutex_lock (&importer->mutex);
+
+   while (!importer->stop) {
+      i = _mongoc_importer_next_batch (importer);
+      if (i < 0) {
+         if (importer->parsed_all && !importer->n_preparing) {
+            break;
+         }
+
+         mongoc_cond_wait (&importer->cond, &importer->mutex);
+         continue;
+      }
+
+      _mongoc_importer_shift (&importer->batches, (size_t) i, &batch);
+      mongoc_cond_broadcast (&importer->cond);
+      mongoc_mutex_unlock (&importer->mutex);
+
+      _mongoc_write_result_init (&result);
+      result.counts_only = importer->counts_only;
+
+      /* a chunk may have had no valid documents */
+      if (batch.command.n_documents) {
+         server_stream =
+            mongoc_cluster_stream_for_server (&sender->client->cluster,
+                                              importer->server_id,
+                                              true,
+                                              &result.error);
+
+         if (server_stream) {
+            /* a batch that skipped invalid documents maps the rest to their
+             * indexes */
+            _mongoc_write_command_execute (
+               &batch.command,
+               sender->client,
+               server_stream,
+               importer->database,
+               importer->collection,
+               importer->import_write_concern,
+               batch.command.indexes.len ? 0 : batch.offset,
+               NULL /* session */,
+               &result);
+            mongoc_server_stream_cleanup (server_stream);
+         } else {
+            result.failed = true;
+            result.must_stop = true;
+         }
+      }
+
+      /* an ordered batch's invalid document comes after the documents sent,
+       * don't report it if the server already rejected one of those */
+      if (batch.invalid && !(importer->flags.ordered && result.failed)) {
+         _mongoc_write_result_append (&result, batch.invalid);
+      }
+
+      _mongoc_importer_batch_destroy (&batch);
+
+      mongoc_mutex_lock (&importer->mutex);
+      _mongoc_write_result_append (&importer->result, &result);
+      if (result.must_stop || (importer->flags.ordered && result.failed)) {
+         importer->stop = true;
+      }
+
+      importer->next_seq++;
+      mongoc_cond_broadcast (&importer->cond);
+      _mongoc_write_result_destroy (&result);
+   }
+
+   mongoc_mutex_unlock (&importer->mutex);
+
+   return NULL;
+}
+
+
+/* start the workers and senders, parse on this thread, and wait for the
+ * other stages to finish */
+static void
+_mongoc_importer_run (mongoc_importer_t *importer,
+                      mongoc_client_t *client,
+                      bson_reader_t *reader,
+                      bson_json_reader_t *json_reader)
+{
+   mongoc_importer_sender_t *senders;
+   mongoc_thread_t *workers;
+   uint32_t n_workers;
+   uint32_t n_senders;
+   uint32_t i;
+   bson_error_t error;
+   int r = 0;
+
+   workers = (mongoc_thread_t *) bson_malloc0 (importer->n_workers *
+                                               sizeof (mongoc_thread_t));
+   senders = (mongoc_importer_sender_t *) bson_malloc0 (
+      importer->n_connections * sizeof *senders);
+
+   importer->n_preparing = importer->n_workers;
+   for (i = 0; i < importer->n_workers; i++) {
+      r = mongoc_thread_create (&workers[i], _mongoc_importer_worker, importer);
+      if (r != 0) {
+         break;
+      }
+   }
+
+   n_workers = i;
+
+   /* don't wait for clients other threads are using */
+   for (i = 0; i < importer->n_connections && n_workers; i++) {
+      senders[i].client = i ? mongoc_client_pool_try_pop (importer->pool)
+                            : client;
+      if (!senders[i].client) {
+         break;
+      }
+
+      senders[i].importer = importer;
+      r = mongoc_thread_create (
+         &senders[i].thread, _mongoc_importer_sender, &senders[i]);
+      if (r != 0) {
+         if (i) {
+            mongoc_client_pool_push (importer->pool, senders[i].client);
+         }
+
+         break;
+      }
+   }
+
+   n_senders = i;
+
+   mongoc_mutex_lock (&importer->mutex);
+
+   /* go on with fewer threads, but the import needs one of each */
+   importer->n_preparing -= importer->n_workers - n_workers;
+   if (!n_workers || !n_senders) {
+      bson_set_error (&error,
+                      MONGOC_ERROR_CLIENT,
+                      MONGOC_ERROR_CLIENT_NOT_READY,
+                      "Could not start import threads: %s",
+                      strerror (r));
+      _mongoc_importer_fail (importer, &error);
+   }
+
+   mongoc_cond_broadcast (&importer->cond);
+   mongoc_mutex_unlock (&importer->mutex);
+
+   _mongoc_importer_parse (importer, reader, json_reader);
+
+   for (i = 0; i < n_workers; i++) {
+      mongoc_thread_join (workers[i]);
+   }
+
+   for (i = 0; i < n_senders; i++) {
+      mongoc_thread_join (senders[i].thread);
+      if (i) {
+         mongoc_client_pool_push (importer->pool, senders[i].client);
+      }
+   }
+
+   bson_free (senders);
+   bson_free (workers);
+}
+
+
+/* import documents from @reader or @json_reader */
+static bool
+_mongoc_importer_import (mongoc_importer_t *importer,
+                         bson_reader_t *reader,
+                         bson_json_reader_t *json_reader,
+                         bson_t *reply,
+                         bson_error_t *error)
+{
+   mongoc_server_stream_t *server_stream;
+   mongoc_client_t *client;
+   mongoc_importer_chunk_t chunk;
+   mongoc_importer_batch_t batch;
+   int32_t error_api_version;
+   int64_t start;
+   bool ret;
+
+   ENTRY;
+
+   if (reply) {
+      bson_init (reply);
+   }
+
+   if (importer->opts_error.domain) {
+      if (error) {
+         memcpy (error, &importer->opts_error, sizeof *error);
+      }
+
+      RETURN (false);
+   }
+
+   start = bson_get_monotonic_time ();
+
+   _mongoc_array_init (&importer->chunks, sizeof (mongoc_importer_chunk_t));
+   _mongoc_array_init (&importer->batches, sizeof (mongoc_importer_batch_t));
+   _mongoc_write_result_init (&importer->result);
+   importer->result.counts_only = importer->counts_only;
+   memset (&importer->error, 0, sizeof importer->error);
+   importer->parsed_all = false;
+   importer->stop = false;
+   importer->next_seq = 0;
+   importer->n_documents = 0;
+   importer->n_bytes = 0;
+   importer->n_chunks = 0;
+
+   client = mongoc_client_pool_pop (importer->pool);
+   error_api_version = client->error_api_version;
+   importer->operation_id = ++client->cluster.operation_id;
+   importer->import_write_concern = importer->write_concern
+                                       ? importer->write_concern
+                                       : client->write_concern;
+
+   server_stream = mongoc_cluster_stream_for_writes (&client->cluster,
+                                                     &importer->result.error);
+
+   if (server_stream) {
+      importer->server_id = server_stream->sd->id;
+      _mongoc_write_command_batch_limits (server_stream,
+                                          &importer->max_batch_size,
+                                          &importer->max_batch_bytes);
+      mongoc_server_stream_cleanup (server_stream);
+
+      _mongoc_importer_run (importer, client, reader, json_reader);
+      _mongoc_write_result_sort_by_index (&importer->result);
+   } else {
+      importer->result.failed = true;
+   }
+
+   /* batches left after an error */
+   while (importer->chunks.len) {
+      _mongoc_importer_shift (&importer->chunks, 0, &chunk);
+      _mongoc_buffer_destroy (&chunk.data);
+   }
+
+   while (importer->batches.len) {
+      _mongoc_importer_shift (&importer->batches, 0, &batch);
+      _mongoc_importer_batch_destroy (&batch);
+   }
+
+   ret = MONGOC_WRITE_RESULT_COMPLETE (&importer->result,
+                                       error_api_version,
+                                       importer->import_write_concern,
+                                       MONGOC_ERROR_COMMAND /* err domain */,
+                                       reply,
+                                       error);
+
+   if (importer->error.domain) {
+      if (error) {
+         memcpy (error, &importer->error, sizeof *error);
+      }
+
+      ret = false;
+   }
+
+   /* throughput */
+   if (reply) {
+      BSON_APPEND_INT32 (reply, "nDocuments", (int32_t) importer->n_documents);
+      BSON_APPEND_INT64 (reply, "nBytes", importer->n_bytes);
+      BSON_APPEND_INT32 (reply, "nBatches", (int32_t) importer->next_seq);
+      BSON_APPEND_INT64 (
+         reply, "elapsedMS", (bson_get_monotonic_time () - start) / 1000);
+   }
+
+   mongoc_client_pool_push (importer->pool, client);
+   _mongoc_write_result_destroy (&importer->result);
+   _mongoc_array_destroy (&importer->batches);
+   _mongoc_array_destroy (&importer->chunks);
+
+   RETURN (ret);
+}
+
+
+bool
+mongoc_importer_import_reader (mongoc_importer_t *importer,
+                               bson_reader_t *reader,
+                               bson_t *reply,
+                               bson_error_t *error)
+{
+   BSON_ASSERT (importer);
+   BSON_ASSERT (reader);
+
+   return _mongoc_importer_import (importer, reader, NULL, reply, error);
+}
+
+
+bool
+mongoc_importer_import_json_reader (mongoc_importer_t *importer,
+                                    bson_json_reader_t *reader,
+                                    bson_t *reply,
+                                    bson_error_t *error)
+{
+   BSON_ASSERT (importer);
+   BSON_ASSERT (reader);
+
+   return _mongoc_importer_import (importer, NULL, reader, reply, error);
+}
@@ -0,0 +1,59 @@
+/*
+ * Copyright 2018-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef MONGOC_IMPORTER_H
+#define MONGOC_IMPORTER_H
+
+#if !defined(MONGOC_INSIDE) && !defined(MONGOC_COMPILATION)
+#error "Only <mongoc.h> can be included directly."
+#endif
+
+#include <bson.h>
+
+#include "mongoc-macros.h"
+#include "mongoc-client-pool.h"
+
+
+BSON_BEGIN_DECLS
+
+
+typedef struct _mongoc_importer_t mongoc_importer_t;
+
+
+MONGOC_EXPORT (mongoc_importer_t *)
+mongoc_importer_new (mongoc_client_pool_t *pool,
+                     const char *db,
+                     const char *collection,
+                     const bson_t *opts);
+MONGOC_EXPORT (void)
+mongoc_importer_destroy (mongoc_importer_t *importer);
+MONGOC_EXPORT (bool)
+mongoc_importer_import_reader (mongoc_importer_t *importer,
+                               bson_reader_t *reader,
+                               bson_t *reply,
+                               bson_error_t *error);
+MONGOC_EXPORT (bool)
+mongoc_importer_import_json_reader (mongoc_importer_t *importer,
+                                    bson_json_reader_t *reader,
+                                    bson_t *reply,
+                                    bson_error_t *error);
+
+
+BSON_END_DECLS
+
+
+#endif /* MONGOC_IMPORTER_H */
@@ -30,6 +30,8 @@
 #endif
 #include "mongoc-thread-private.h"
 #include "mongoc-b64-private.h"
+#include "mongoc-scram-private.h"
+#include "mongoc-dns-cache-private.h"
 
 #ifndef MONGOC_NO_AUTOMATIC_GLOBALS
 #pragma message( \
@@ -126,6 +128,12 @@ static MONGOC_ONCE_FUN (_mongoc_do_init)
 
    _mongoc_handshake_init ();
 
+   _mongoc_dns_cache_init ();
+
+#ifdef MONGOC_ENABLE_CRYPTO
+   _mongoc_scram_cache_init ();
+#endif
+
    MONGOC_ONCE_RETURN;
 }
 
@@ -159,6 +167,12 @@ static MONGOC_ONCE_FUN (_mongoc_do_cleanup)
 
    _mongoc_handshake_cleanup ();
 
+   _mongoc_dns_cache_cleanup ();
+
+#ifdef MONGOC_ENABLE_CRYPTO
+   _mongoc_scram_cache_cleanup ();
+#endif
+
    MONGOC_ONCE_RETURN;
 }
 
@@ -38,6 +38,12 @@ _mongoc_openssl_check_cert (SSL *ssl,
                             bool allow_invalid_hostname);
 SSL_CTX *
 _mongoc_openssl_ctx_new (mongoc_ssl_opt_t *opt);
+void
+_mongoc_openssl_ctx_enable_session_cache (SSL_CTX *ctx);
+void
+_mongoc_openssl_session_cache_resume (SSL *ssl, const char *key);
+void
+_mongoc_openssl_session_cache_remove (SSL *ssl);
 char *
 _mongoc_openssl_extract_subject (const char *filename, const char *passphrase);
 void
@@ -28,6 +28,8 @@
 
 #include <string.h>
 
+#include "mongoc-array-private.h"
+#include "mongoc-counters-private.h"
 #include "mongoc-init.h"
 #include "mongoc-socket.h"
 #include "mongoc-ssl.h"
@@ -52,6 +54,29 @@ _mongoc_openssl_thread_cleanup (void);
 #define ASN1_STRING_get0_data ASN1_STRING_data
 #endif
 
+/* the last session negotiated with each host, for resumption */
+typedef struct {
+   char *key;
+   SSL_SESSION *session;
+} mongoc_openssl_session_t;
+
+typedef struct {
+   mongoc_mutex_t mutex;
+   mongoc_array_t sessions;
+} mongoc_openssl_session_cache_t;
+
+/* an SSL_CTX's session cache, if enabled, and an SSL's cache key */
+static int gMongocOpenSslCtxSessionCacheIdx = -1;
+static int gMongocOpenSslSessionKeyIdx = -1;
+
+static void
+_mongoc_openssl_session_cache_free (void *parent,
+                                    void *ptr,
+                                    CRYPTO_EX_DATA *ad,
+                                    int idx,
+                                    long argl,
+                                    void *argp);
+
 /**
  * _mongoc_openssl_init:
  *
@@ -79,6 +104,11 @@ _mongoc_openssl_init (void)
    }
 
    SSL_CTX_free (ctx);
+
+   gMongocOpenSslCtxSessionCacheIdx = SSL_CTX_get_ex_new_index (
+      0, NULL, NULL, NULL, _mongoc_openssl_session_cache_free);
+   gMongocOpenSslSessionKeyIdx =
+      SSL_get_ex_new_index (0, NULL, NULL, NULL, NULL);
 }
 
 void
@@ -459,6 +489,9 @@ _mongoc_openssl_setup_pem_file (SSL_CTX *ctx,
  *
  * The opt.pem_pwd parameter, if passed, must exist for the life of this
  * context object (for storing and loading the associated pem file)
+ *
+ * The context holds no per-host settings, so one context can be shared by
+ * every stream created with the same options.
  */
 SSL_CTX *
 _mongoc_openssl_ctx_new (mongoc_ssl_opt_t *opt)
@@ -540,10 +573,199 @@ _mongoc_openssl_ctx_new (mongoc_ssl_opt_t *opt)
       return NULL;
    }
 
+   if (opt->weak_cert_validation) {
+      SSL_CTX_set_verify (ctx, SSL_VERIFY_NONE, NULL);
+   } else {
+      SSL_CTX_set_verify (ctx, SSL_VERIFY_PEER, NULL);
+   }
+
+   mongoc_counter_ssl_contexts_created_inc ();
+
    return ctx;
 }
 
 
+static void
+_mongoc_openssl_session_cache_free (void *parent,
+                                    void *ptr,
+                                    CRYPTO_EX_DATA *ad,
+                                    int idx,
+                                    long argl,
+                                    void *argp)
+{
+   mongoc_openssl_session_cache_t *cache;
+   mongoc_openssl_session_t *entry;
+   size_t i;
+
+   cache = (mongoc_openssl_session_cache_t *) ptr;
+   if (!cache) {
+      return;
+   }
+
+   for (i = 0; i < cache->sessions.len; i++) {
+      entry = &_mongoc_array_index (
+         &cache->sessions, mongoc_openssl_session_t, i);
+      bson_free (entry->key);
+      SSL_SESSION_free (entry->session);
+   }
+
+   _mongoc_array_destroy (&cache->sessions);
+   mongoc_mutex_destroy (&cache->mutex);
+   bson_free (cache);
+}
+
+
+/* find @key's entry, the caller holds the cache's mutex */
+static mongoc_openssl_session_t *
+_mongoc_openssl_session_cache_find (mongoc_openssl_session_cache_t *cache,
+                                    const char *key)
+{
+   mongoc_openssl_session_t *entry;
+   size_t i;
+
+   for (i = 0; i < cache->sessions.len; i++) {
+      entry = &_mongoc_array_index (
+         &cache->sessions, mongoc_openssl_session_t, i);
+      if (!strcmp (entry->key, key)) {
+         return entry;
+      }
+   }
+
+   return NULL;
+}
+
+
+/* OpenSSL calls this when it negotiates a session, or with TLS 1.3 when it
+ * receives a session ticket after the handshake */
+static int
+_mongoc_openssl_session_cache_new_cb (SSL *ssl, SSL_SESSION *session)
+{
+   mongoc_openssl_session_cache_t *cache;
+   mongoc_openssl_session_t *entry;
+   mongoc_openssl_session_t new_entry;
+   const char *key;
+
+   cache = (mongoc_openssl_session_cache_t *) SSL_CTX_get_ex_data (
+      SSL_get_SSL_CTX (ssl), gMongocOpenSslCtxSessionCacheIdx);
+   key = (const char *) SSL_get_ex_data (ssl, gMongocOpenSslSessionKeyIdx);
+
+   if (!cache || !key) {
+      return 0;
+   }
+
+   mongoc_mutex_lock (&cache->mutex);
+   entry = _mongoc_openssl_session_cache_find (cache, key);
+   if (entry) {
+      SSL_SESSION_free (entry->session);
+      entry->session = session;
+   } else {
+      new_entry.key = bson_strdup (key);
+      new_entry.session = session;
+      _mongoc_array_append_val (&cache->sessions, new_entry);
+   }
+   mongoc_mutex_unlock (&cache->mutex);
+
+   /* we keep the reference OpenSSL passed */
+   return 1;
+}
+
+
+/**
+ * _mongoc_openssl_ctx_enable_session_cache:
+ *
+ * Remember the last session negotiated with each host by streams using
+ * @ctx, and offer it when they connect again. See
+ * _mongoc_openssl_session_cache_resume.
+ */
+void
+_mongoc_openssl_ctx_enable_session_cache (SSL_CTX *ctx)
+{
+   mongoc_openssl_session_cache_t *cache;
+
+   if (SSL_CTX_get_ex_data (ctx, gMongocOpenSslCtxSessionCacheIdx)) {
+      return;
+   }
+
+   cache = (mongoc_openssl_session_cache_t *) bson_malloc0 (sizeof *cache);
+   mongoc_mutex_init (&cache->mutex);
+   _mongoc_array_init (&cache->sessions, sizeof (mongoc_openssl_session_t));
+   SSL_CTX_set_ex_data (ctx, gMongocOpenSslCtxSessionCacheIdx, cache);
+
+   /* OpenSSL doesn't look up client sessions itself, only reports them */
+   SSL_CTX_set_session_cache_mode (
+      ctx, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+   SSL_CTX_sess_set_new_cb (ctx, _mongoc_openssl_session_cache_new_cb);
+}
+
+
+/**
+ * _mongoc_openssl_session_cache_resume:
+ *
+ * Offer the session last negotiated with @key, usually a "host:port", on
+ * @ssl, and remember sessions @ssl negotiates under @key. Does nothing if
+ * @ssl's context has no session cache.
+ *
+ * @key must outlive @ssl.
+ */
+void
+_mongoc_openssl_session_cache_resume (SSL *ssl, const char *key)
+{
+   mongoc_openssl_session_cache_t *cache;
+   mongoc_openssl_session_t *entry;
+
+   cache = (mongoc_openssl_session_cache_t *) SSL_CTX_get_ex_data (
+      SSL_get_SSL_CTX (ssl), gMongocOpenSslCtxSessionCacheIdx);
+
+   if (!cache) {
+      return;
+   }
+
+   SSL_set_ex_data (ssl, gMongocOpenSslSessionKeyIdx, (void *) key);
+
+   mongoc_mutex_lock (&cache->mutex);
+   entry = _mongoc_openssl_session_cache_find (cache, key);
+   if (entry) {
+      SSL_set_session (ssl, entry->session);
+   }
+   mongoc_mutex_unlock (&cache->mutex);
+}
+
+
+/**
+ * _mongoc_openssl_session_cache_remove:
+ *
+ * Forget the session for @ssl's key, after a failed handshake.
+ */
+void
+_mongoc_openssl_session_cache_remove (SSL *ssl)
+{
+   mongoc_openssl_session_cache_t *cache;
+   mongoc_openssl_session_t *entry;
+   mongoc_openssl_session_t *last;
+   const char *key;
+
+   cache = (mongoc_openssl_session_cache_t *) SSL_CTX_get_ex_data (
+      SSL_get_SSL_CTX (ssl), gMongocOpenSslCtxSessionCacheIdx);
+   key = (const char *) SSL_get_ex_data (ssl, gMongocOpenSslSessionKeyIdx);
+
+   if (!cache || !key) {
+      return;
+   }
+
+   mongoc_mutex_lock (&cache->mutex);
+   entry = _mongoc_openssl_session_cache_find (cache, key);
+   if (entry) {
+      last = &_mongoc_array_index (
+         &cache->sessions, mongoc_openssl_session_t, cache->sessions.len - 1);
+      bson_free (entry->key);
+      SSL_SESSION_free (entry->session);
+      *entry = *last;
+      cache->sessions.len--;
+   }
+   mongoc_mutex_unlock (&cache->mutex);
+}
+
+
 char *
 _mongoc_openssl_extract_subject (const char *filename, const char *passphrase)
 {
@@ -34,6 +34,14 @@ struct _mongoc_cluster_t;
 
 BSON_BEGIN_DECLS
 
+/* flagBits of an OP_MSG */
+typedef enum {
+   MONGOC_MSG_NONE = 0,
+   MONGOC_MSG_CHECKSUM_PRESENT = 1 << 0,
+   MONGOC_MSG_MORE_TO_COME = 1 << 1,
+   MONGOC_MSG_EXHAUST_ALLOWED = 1 << 16,
+} mongoc_msg_flags_t;
+
 typedef struct _mongoc_rpc_section_t {
    uint8_t payload_type;
    union {
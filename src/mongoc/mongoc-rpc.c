@@ -521,20 +521,36 @@
    rpc->n_##_name = 1;                        \
    buf = NULL;                                \
    buflen = 0;
-#define SECTION_ARRAY_FIELD(_name)                                 \
-   do {                                                            \
-      uint32_t __l;                                                \
-      mongoc_rpc_section_t *section = &rpc->_name[rpc->n_##_name]; \
-      section->payload_type = buf[0];                              \
-      buf++;                                                       \
-      buflen -= 1;                                                 \
-      memcpy (&__l, buf, 4);                                       \
-      __l = BSON_UINT32_FROM_LE (__l);                             \
-      section->payload.bson_document = (uint8_t *) buf;            \
-      buf += __l;                                                  \
-      buflen -= __l;                                               \
-   } while (0);                                                    \
-   rpc->n_##_name++;
+#define SECTION_ARRAY_FIELD(_name)                                     \
+   do {                                                                \
+      uint32_t __l;                                                    \
+      const char *__id;                                                \
+      mongoc_rpc_section_t *section = &rpc->_name[rpc->n_##_name];     \
+      if (buflen < 5) {                                                \
+         return false;                                                 \
+      }                                                                \
+      section->payload_type = buf[0];                                  \
+      buf++;                                                           \
+      buflen -= 1;                                                     \
+      memcpy (&__l, buf, 4);                                           \
+      __l = BSON_UINT32_FROM_LE (__l);                                 \
+      if (__l < 5 || __l > buflen) {                                   \
+         return false;                                                 \
+      }                                                                \
+      if (section->payload_type == 1) {                                \
+         /* size, identifier, then a sequence of documents */          \
+         __id = (const char *) buf + 4;                                \
+         section->payload.sequence.size = (int32_t) __l;               \
+         section->payload.sequence.identifier = __id;                  \
+         section->payload.sequence.bson_documents =                    \
+            (const uint8_t *) __id + bson_strnlen (__id, __l - 4) + 1; \
+      } else {                                                         \
+         section->payload.bson_document = (uint8_t *) buf;             \
+      }                                                                \
+      buf += __l;                                                      \
+      buflen -= __l;                                                   \
+      rpc->n_##_name++;                                                \
+   } while (buflen > 4 && rpc->n_##_name < 2);
 #define RAW_BUFFER_FIELD(_name)         \
    rpc->_name = (void *) buf;           \
    rpc->_name##_len = (int32_t) buflen; \
@@ -86,6 +86,18 @@ _mongoc_scram_step (mongoc_scram_t *scram,
                     uint32_t *outbuflen,
                     bson_error_t *error);
 
+void
+_mongoc_scram_cache_init (void);
+
+void
+_mongoc_scram_cache_cleanup (void);
+
+void
+_mongoc_scram_cache_clear (void);
+
+int
+_mongoc_scram_cache_count (void);
+
 BSON_END_DECLS
 
 
@@ -24,6 +24,8 @@
 #include "mongoc-rand-private.h"
 #include "mongoc-util-private.h"
 #include "mongoc-trace-private.h"
+#include "mongoc-thread-private.h"
+#include "mongoc-counters-private.h"
 
 #include "mongoc-crypto-private.h"
 #include "mongoc-b64-private.h"
@@ -38,6 +40,26 @@
 #define MONGOC_SCRAM_B64_HASH_SIZE \
    MONGOC_SCRAM_B64_ENCODED_SIZE (MONGOC_SCRAM_HASH_SIZE)
 
+#define MONGOC_SCRAM_CACHE_SIZE 64
+
+
+/* A salted password derived with PBKDF2, and the client and server keys
+ * computed from it. Entries are identified by an HMAC of the salt and
+ * iteration count keyed with the hashed password, so the password itself
+ * is never kept in the cache. */
+typedef struct {
+   bool in_use;
+   uint64_t last_used;
+   uint8_t id[MONGOC_SCRAM_HASH_SIZE];
+   uint8_t salted_password[MONGOC_SCRAM_HASH_SIZE];
+   uint8_t client_key[MONGOC_SCRAM_HASH_SIZE];
+   uint8_t server_key[MONGOC_SCRAM_HASH_SIZE];
+} mongoc_scram_cache_entry_t;
+
+static mongoc_mutex_t gScramCacheMutex;
+static mongoc_scram_cache_entry_t gScramCache[MONGOC_SCRAM_CACHE_SIZE];
+static uint64_t gScramCacheTick;
+
 
 void
 _mongoc_scram_set_pass (mongoc_scram_t *scram, const char *pass)
@@ -342,6 +364,203 @@ _mongoc_scram_salt_password (mongoc_scram_t *scram,
 }
 
 
+/* Compute whichever of ClientKey and ServerKey are not yet known */
+static void
+_mongoc_scram_derive_keys (mongoc_scram_t *scram)
+{
+   if (!*scram->client_key) {
+      /* ClientKey := HMAC(saltedPassword, "Client Key") */
+      mongoc_crypto_hmac_sha1 (&scram->crypto,
+                               scram->salted_password,
+                               MONGOC_SCRAM_HASH_SIZE,
+                               (uint8_t *) MONGOC_SCRAM_CLIENT_KEY,
+                               strlen (MONGOC_SCRAM_CLIENT_KEY),
+                               scram->client_key);
+   }
+   if (!*scram->server_key) {
+      /* ServerKey := HMAC(SaltedPassword, "Server Key") */
+      mongoc_crypto_hmac_sha1 (&scram->crypto,
+                               scram->salted_password,
+                               MONGOC_SCRAM_HASH_SIZE,
+                               (uint8_t *) MONGOC_SCRAM_SERVER_KEY,
+                               strlen (MONGOC_SCRAM_SERVER_KEY),
+                               scram->server_key);
+   }
+}
+
+
+/* memset () that the compiler may not optimize away */
+static void
+_mongoc_scram_zero (void *mem, size_t len)
+{
+   volatile uint8_t *p = (volatile uint8_t *) mem;
+
+   while (len--) {
+      *p++ = 0;
+   }
+}
+
+
+void
+_mongoc_scram_cache_init (void)
+{
+   mongoc_mutex_init (&gScramCacheMutex);
+}
+
+
+void
+_mongoc_scram_cache_clear (void)
+{
+   mongoc_mutex_lock (&gScramCacheMutex);
+   _mongoc_scram_zero (gScramCache, sizeof gScramCache);
+   gScramCacheTick = 0;
+   mongoc_mutex_unlock (&gScramCacheMutex);
+}
+
+
+void
+_mongoc_scram_cache_cleanup (void)
+{
+   _mongoc_scram_cache_clear ();
+   mongoc_mutex_destroy (&gScramCacheMutex);
+}
+
+
+int
+_mongoc_scram_cache_count (void)
+{
+   int i;
+   int count = 0;
+
+   mongoc_mutex_lock (&gScramCacheMutex);
+   for (i = 0; i < MONGOC_SCRAM_CACHE_SIZE; i++) {
+      if (gScramCache[i].in_use) {
+         count++;
+      }
+   }
+   mongoc_mutex_unlock (&gScramCacheMutex);
+
+   return count;
+}
+
+
+/* id := HMAC(hashed_password, salt || big-endian iterations) */
+static void
+_mongoc_scram_cache_id (mongoc_scram_t *scram,
+                        const char *password,
+                        uint32_t password_len,
+                        const uint8_t *salt,
+                        uint32_t salt_len,
+                        uint32_t iterations,
+                        uint8_t *id)
+{
+   uint8_t data[MONGOC_SCRAM_HASH_SIZE + 4];
+
+   BSON_ASSERT (salt_len <= MONGOC_SCRAM_HASH_SIZE);
+
+   memcpy (data, salt, salt_len);
+   data[salt_len] = (uint8_t) (iterations >> 24);
+   data[salt_len + 1] = (uint8_t) (iterations >> 16);
+   data[salt_len + 2] = (uint8_t) (iterations >> 8);
+   data[salt_len + 3] = (uint8_t) iterations;
+
+   mongoc_crypto_hmac_sha1 (
+      &scram->crypto, password, password_len, data, salt_len + 4, id);
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * _mongoc_scram_cache_lookup --
+ *
+ *       Copy the salted password, client key, and server key cached for
+ *       @id into @scram.
+ *
+ * Returns:
+ *       true if @id was found.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+static bool
+_mongoc_scram_cache_lookup (mongoc_scram_t *scram, const uint8_t *id)
+{
+   mongoc_scram_cache_entry_t *entry;
+   bool found = false;
+   int i;
+
+   mongoc_mutex_lock (&gScramCacheMutex);
+   for (i = 0; i < MONGOC_SCRAM_CACHE_SIZE; i++) {
+      entry = &gScramCache[i];
+      if (entry->in_use &&
+          mongoc_memcmp (entry->id, id, MONGOC_SCRAM_HASH_SIZE) == 0) {
+         memcpy (scram->salted_password,
+                 entry->salted_password,
+                 MONGOC_SCRAM_HASH_SIZE);
+         memcpy (scram->client_key, entry->client_key, MONGOC_SCRAM_HASH_SIZE);
+         memcpy (scram->server_key, entry->server_key, MONGOC_SCRAM_HASH_SIZE);
+         entry->last_used = ++gScramCacheTick;
+         found = true;
+         break;
+      }
+   }
+   mongoc_mutex_unlock (&gScramCacheMutex);
+
+   return found;
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * _mongoc_scram_cache_insert --
+ *
+ *       Remember the keys derived in @scram under @id, evicting the least
+ *       recently used entry if the cache is full. Evicted entries are
+ *       zeroed before they are reused.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+static void
+_mongoc_scram_cache_insert (mongoc_scram_t *scram, const uint8_t *id)
+{
+   mongoc_scram_cache_entry_t *entry;
+   mongoc_scram_cache_entry_t *victim = NULL;
+   int i;
+
+   mongoc_mutex_lock (&gScramCacheMutex);
+   for (i = 0; i < MONGOC_SCRAM_CACHE_SIZE; i++) {
+      entry = &gScramCache[i];
+      if (!entry->in_use) {
+         victim = entry;
+         break;
+      }
+
+      if (mongoc_memcmp (entry->id, id, MONGOC_SCRAM_HASH_SIZE) == 0) {
+         /* another connection derived the same keys concurrently */
+         victim = entry;
+         break;
+      }
+
+      if (!victim || entry->last_used < victim->last_used) {
+         victim = entry;
+      }
+   }
+
+   _mongoc_scram_zero (victim, sizeof *victim);
+   victim->in_use = true;
+   victim->last_used = ++gScramCacheTick;
+   memcpy (victim->id, id, MONGOC_SCRAM_HASH_SIZE);
+   memcpy (
+      victim->salted_password, scram->salted_password, MONGOC_SCRAM_HASH_SIZE);
+   memcpy (victim->client_key, scram->client_key, MONGOC_SCRAM_HASH_SIZE);
+   memcpy (victim->server_key, scram->server_key, MONGOC_SCRAM_HASH_SIZE);
+   mongoc_mutex_unlock (&gScramCacheMutex);
+}
+
+
 static bool
 _mongoc_scram_generate_client_proof (mongoc_scram_t *scram,
                                      uint8_t *outbuf,
@@ -354,15 +573,7 @@ _mongoc_scram_generate_client_proof (mongoc_scram_t *scram,
    int i;
    int r = 0;
 
-   if (!*scram->client_key) {
-      /* ClientKey := HMAC(saltedPassword, "Client Key") */
-      mongoc_crypto_hmac_sha1 (&scram->crypto,
-                               scram->salted_password,
-                               MONGOC_SCRAM_HASH_SIZE,
-                               (uint8_t *) MONGOC_SCRAM_CLIENT_KEY,
-                               strlen (MONGOC_SCRAM_CLIENT_KEY),
-                               scram->client_key);
-   }
+   _mongoc_scram_derive_keys (scram);
 
    /* StoredKey := H(client_key) */
    mongoc_crypto_sha1 (
@@ -429,6 +640,7 @@ _mongoc_scram_step2 (mongoc_scram_t *scram,
    char *hashed_password;
 
    uint8_t decoded_salt[MONGOC_SCRAM_B64_HASH_SIZE];
+   uint8_t cache_id[MONGOC_SCRAM_HASH_SIZE];
    int32_t decoded_salt_len;
    bool rval = true;
 
@@ -613,12 +825,26 @@ _mongoc_scram_step2 (mongoc_scram_t *scram,
    }
 
    if (!*scram->salted_password) {
-      _mongoc_scram_salt_password (scram,
-                                   hashed_password,
-                                   (uint32_t) strlen (hashed_password),
-                                   decoded_salt,
-                                   decoded_salt_len,
-                                   iterations);
+      _mongoc_scram_cache_id (scram,
+                              hashed_password,
+                              (uint32_t) strlen (hashed_password),
+                              decoded_salt,
+                              decoded_salt_len,
+                              iterations,
+                              cache_id);
+
+      if (_mongoc_scram_cache_lookup (scram, cache_id)) {
+         mongoc_counter_auth_scram_cache_hits_inc ();
+      } else {
+         _mongoc_scram_salt_password (scram,
+                                      hashed_password,
+                                      (uint32_t) strlen (hashed_password),
+                                      decoded_salt,
+                                      decoded_salt_len,
+                                      iterations);
+         _mongoc_scram_derive_keys (scram);
+         _mongoc_scram_cache_insert (scram, cache_id);
+      }
    }
 
    _mongoc_scram_generate_client_proof (scram, outbuf, outbufmax, outbuflen);
@@ -667,15 +893,7 @@ _mongoc_scram_verify_server_signature (mongoc_scram_t *scram,
    int32_t encoded_server_signature_len;
    uint8_t server_signature[MONGOC_SCRAM_HASH_SIZE];
 
-   if (!*scram->server_key) {
-      /* ServerKey := HMAC(SaltedPassword, "Server Key") */
-      mongoc_crypto_hmac_sha1 (&scram->crypto,
-                               scram->salted_password,
-                               MONGOC_SCRAM_HASH_SIZE,
-                               (uint8_t *) MONGOC_SCRAM_SERVER_KEY,
-                               strlen (MONGOC_SCRAM_SERVER_KEY),
-                               scram->server_key);
-   }
+   _mongoc_scram_derive_keys (scram);
 
    /* ServerSignature := HMAC(ServerKey, AuthMessage) */
    mongoc_crypto_hmac_sha1 (&scram->crypto,
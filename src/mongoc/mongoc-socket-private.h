@@ -25,6 +25,9 @@
 
 BSON_BEGIN_DECLS
 
+/* delay between connection attempts to successive addresses of one host */
+#define MONGOC_SOCKET_CONNECT_STAGGER_MSEC 250
+
 struct _mongoc_socket_t {
 #ifdef _WIN32
    SOCKET sd;
@@ -41,6 +44,11 @@ mongoc_socket_accept_ex (mongoc_socket_t *sock,
                          int64_t expire_at,
                          uint16_t *port);
 
+mongoc_socket_t *
+mongoc_socket_connect_any (struct addrinfo *addrs,
+                           int32_t stagger_msec,
+                           int64_t expire_at);
+
 BSON_END_DECLS
 
 #endif /* MONGOC_SOCKET_PRIVATE_H */
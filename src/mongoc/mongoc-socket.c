@@ -876,6 +876,158 @@ mongoc_socket_connect (mongoc_socket_t *sock,       /* IN */
 }
 
 
+/*
+ *--------------------------------------------------------------------------
+ *
+ * mongoc_socket_connect_any --
+ *
+ *       Connect to whichever of @addrs accepts first. A non-blocking
+ *       connect to the next address begins every @stagger_msec, or as
+ *       soon as every attempt in flight has failed, so an address whose
+ *       packets are dropped does not hold up the rest ("happy eyeballs",
+ *       RFC 8305). Fails if @expire_at is reached by the monotonic clock.
+ *
+ * Returns:
+ *       A connected socket, otherwise NULL and errno is set from the last
+ *       failed attempt.
+ *
+ * Side effects:
+ *       Sockets for the attempts that did not win are closed.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+mongoc_socket_t *
+mongoc_socket_connect_any (struct addrinfo *addrs, /* IN */
+                           int32_t stagger_msec,   /* IN */
+                           int64_t expire_at)      /* IN */
+{
+   mongoc_socket_poll_t *sds;
+   mongoc_socket_t *sock;
+   mongoc_socket_t *winner = NULL;
+   struct addrinfo *rp;
+   size_t n_addrs = 0;
+   size_t n_pending = 0;
+   size_t i;
+   int64_t now;
+   int64_t next_start;
+   int64_t deadline;
+   int last_errno = ECONNREFUSED;
+   int optval;
+   mongoc_socklen_t optlen;
+   int ret;
+
+   ENTRY;
+
+   BSON_ASSERT (addrs);
+
+   for (rp = addrs; rp; rp = rp->ai_next) {
+      n_addrs++;
+   }
+
+   sds = (mongoc_socket_poll_t *) bson_malloc0 (n_addrs * sizeof *sds);
+   rp = addrs;
+   next_start = bson_get_monotonic_time ();
+
+   while (!winner) {
+      now = bson_get_monotonic_time ();
+
+      if (rp && (n_pending == 0 || now >= next_start)) {
+         next_start = now + 1000 * (int64_t) stagger_msec;
+         sock = mongoc_socket_new (
+            rp->ai_family, rp->ai_socktype, rp->ai_protocol);
+
+         if (!sock) {
+            last_errno = errno;
+            rp = rp->ai_next;
+            continue;
+         }
+
+         ret = connect (
+            sock->sd, rp->ai_addr, (mongoc_socklen_t) rp->ai_addrlen);
+         rp = rp->ai_next;
+
+#ifdef _WIN32
+         if (ret == SOCKET_ERROR) {
+#else
+         if (ret == -1) {
+#endif
+            _mongoc_socket_capture_errno (sock);
+            if (!_mongoc_socket_errno_is_again (sock)) {
+               last_errno = sock->errno_;
+               mongoc_socket_destroy (sock);
+               continue;
+            }
+
+            sds[n_pending].socket = sock;
+            sds[n_pending].events = POLLOUT;
+            sds[n_pending].revents = 0;
+            n_pending++;
+            continue;
+         }
+
+         winner = sock;
+         break;
+      }
+
+      if (n_pending == 0) {
+         /* every address failed */
+         break;
+      }
+
+      if (now >= expire_at) {
+         last_errno = ETIMEDOUT;
+         break;
+      }
+
+      deadline = rp ? BSON_MIN (next_start, expire_at) : expire_at;
+      if (mongoc_socket_poll (
+             sds, n_pending, (int32_t) ((deadline - now + 999) / 1000)) < 0) {
+         if (errno == EINTR) {
+            /* interrupted by a signal, the attempts are still pending */
+            continue;
+         }
+
+         last_errno = errno;
+         break;
+      }
+
+      for (i = 0; i < n_pending;) {
+         if (!sds[i].revents) {
+            i++;
+            continue;
+         }
+
+         sock = sds[i].socket;
+         sds[i] = sds[--n_pending];
+
+         optval = -1;
+         optlen = (mongoc_socklen_t) sizeof optval;
+         ret = getsockopt (
+            sock->sd, SOL_SOCKET, SO_ERROR, (char *) &optval, &optlen);
+         if (ret == 0 && optval == 0) {
+            winner = sock;
+            break;
+         }
+
+         last_errno = ret == 0 ? optval : errno;
+         mongoc_socket_destroy (sock);
+      }
+   }
+
+   for (i = 0; i < n_pending; i++) {
+      mongoc_socket_destroy (sds[i].socket);
+   }
+
+   bson_free (sds);
+
+   if (!winner) {
+      errno = last_errno;
+   }
+
+   RETURN (winner);
+}
+
 /*
  *--------------------------------------------------------------------------
  *
@@ -23,6 +23,10 @@
 
 #ifdef MONGOC_ENABLE_SSL_OPENSSL
 #include <bson.h>
+#include <openssl/ssl.h>
+
+#include "mongoc-ssl.h"
+#include "mongoc-stream.h"
 
 BSON_BEGIN_DECLS
 
@@ -36,9 +40,22 @@ typedef struct {
    BIO *bio;
    BIO_METHOD *meth;
    SSL_CTX *ctx;
+   char *session_key;
 } mongoc_stream_tls_openssl_t;
 
 
+SSL_CTX *
+mongoc_stream_tls_openssl_server_ctx_new (mongoc_ssl_opt_t *opt);
+
+mongoc_stream_t *
+mongoc_stream_tls_openssl_new_with_context (mongoc_stream_t *base_stream,
+                                            const char *host,
+                                            mongoc_ssl_opt_t *opt,
+                                            int client,
+                                            SSL_CTX *ssl_ctx,
+                                            const char *session_key);
+
+
 BSON_END_DECLS
 
 #endif /* MONGOC_ENABLE_SSL_OPENSSL */
@@ -53,6 +53,15 @@ BIO_meth_free (BIO_METHOD *meth)
 }
 #endif
 
+#if OPENSSL_VERSION_NUMBER < 0x10100000L && !defined(LIBRESSL_VERSION_NUMBER)
+static int
+SSL_CTX_up_ref (SSL_CTX *ctx)
+{
+   CRYPTO_add (&ctx->references, 1, CRYPTO_LOCK_SSL_CTX);
+   return 1;
+}
+#endif
+
 
 /*
  *--------------------------------------------------------------------------
@@ -93,6 +102,7 @@ _mongoc_stream_tls_openssl_destroy (mongoc_stream_t *stream)
    SSL_CTX_free (openssl->ctx);
    openssl->ctx = NULL;
 
+   bson_free (openssl->session_key);
    bson_free (openssl);
    bson_free (stream);
 
@@ -560,9 +570,14 @@ mongoc_stream_tls_openssl_handshake (mongoc_stream_t *stream,
    if (BIO_do_handshake (openssl->bio) == 1) {
       if (_mongoc_openssl_check_cert (
              ssl, host, tls->ssl_opts.allow_invalid_hostname)) {
+         if (SSL_session_reused (ssl)) {
+            mongoc_counter_ssl_sessions_resumed_inc ();
+         }
+
          RETURN (true);
       }
 
+      _mongoc_openssl_session_cache_remove (ssl);
       *events = 0;
       bson_set_error (error,
                       MONGOC_ERROR_STREAM,
@@ -585,6 +600,7 @@ mongoc_stream_tls_openssl_handshake (mongoc_stream_t *stream,
 #endif
    }
 
+   _mongoc_openssl_session_cache_remove (ssl);
 
    *events = 0;
    bson_set_error (error,
@@ -655,10 +671,74 @@ mongoc_stream_tls_openssl_new (mongoc_stream_t *base_stream,
                                const char *host,
                                mongoc_ssl_opt_t *opt,
                                int client)
+{
+   return mongoc_stream_tls_openssl_new_with_context (
+      base_stream, host, opt, client, NULL, NULL);
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * mongoc_stream_tls_openssl_server_ctx_new --
+ *
+ *       Like _mongoc_openssl_ctx_new, for the server side of streams.
+ *       Only used by the mock server, which may share the context among
+ *       its connections.
+ *
+ * Returns:
+ *       NULL on failure, otherwise an SSL_CTX the caller must free.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+SSL_CTX *
+mongoc_stream_tls_openssl_server_ctx_new (mongoc_ssl_opt_t *opt)
+{
+   SSL_CTX *ssl_ctx;
+
+   ssl_ctx = _mongoc_openssl_ctx_new (opt);
+
+   if (ssl_ctx) {
+      /* Set a callback to get the SNI, if provided */
+      SSL_CTX_set_tlsext_servername_callback (ssl_ctx,
+                                              _mongoc_stream_tls_openssl_sni);
+   }
+
+   return ssl_ctx;
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * mongoc_stream_tls_openssl_new_with_context --
+ *
+ *       Like mongoc_stream_tls_openssl_new, but takes a reference to
+ *       @ssl_ctx rather than loading certificates into a new SSL_CTX.
+ *       @ssl_ctx must have been created by _mongoc_openssl_ctx_new from
+ *       @opt. If @ssl_ctx is NULL, creates an SSL_CTX for this stream.
+ *
+ *       If @session_key is not NULL, offers to resume the session that
+ *       @ssl_ctx's session cache holds for it, if any.
+ *
+ * Returns:
+ *       NULL on failure, otherwise a mongoc_stream_t.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+mongoc_stream_t *
+mongoc_stream_tls_openssl_new_with_context (mongoc_stream_t *base_stream,
+                                            const char *host,
+                                            mongoc_ssl_opt_t *opt,
+                                            int client,
+                                            SSL_CTX *ssl_ctx,
+                                            const char *session_key)
 {
    mongoc_stream_tls_t *tls;
    mongoc_stream_tls_openssl_t *openssl;
-   SSL_CTX *ssl_ctx = NULL;
+   SSL *ssl;
    BIO *bio_ssl = NULL;
    BIO *bio_mongoc_shim = NULL;
    BIO_METHOD *meth;
@@ -667,16 +747,30 @@ mongoc_stream_tls_openssl_new (mongoc_stream_t *base_stream,
    BSON_ASSERT (opt);
    ENTRY;
 
-   ssl_ctx = _mongoc_openssl_ctx_new (opt);
+   if (ssl_ctx) {
+      SSL_CTX_up_ref (ssl_ctx);
+   } else {
+      ssl_ctx = client ? _mongoc_openssl_ctx_new (opt)
+                       : mongoc_stream_tls_openssl_server_ctx_new (opt);
 
-   if (!ssl_ctx) {
+      if (!ssl_ctx) {
+         RETURN (NULL);
+      }
+   }
+
+   bio_ssl = BIO_new_ssl (ssl_ctx, client);
+   if (!bio_ssl) {
+      SSL_CTX_free (ssl_ctx);
       RETURN (NULL);
    }
 
+   BIO_get_ssl (bio_ssl, &ssl);
+
+/* the context may be shared, so verify the hostname per connection */
 #if OPENSSL_VERSION_NUMBER >= 0x10002000L && !defined(LIBRESSL_VERSION_NUMBER)
    if (!opt->allow_invalid_hostname) {
       struct in_addr addr;
-      X509_VERIFY_PARAM *param = X509_VERIFY_PARAM_new ();
+      X509_VERIFY_PARAM *param = SSL_get0_param (ssl);
 
       X509_VERIFY_PARAM_set_hostflags (param,
                                        X509_CHECK_FLAG_NO_PARTIAL_WILDCARDS);
@@ -686,43 +780,22 @@ mongoc_stream_tls_openssl_new (mongoc_stream_t *base_stream,
       } else {
          X509_VERIFY_PARAM_set1_host (param, host, 0);
       }
-      SSL_CTX_set1_param (ssl_ctx, param);
-      X509_VERIFY_PARAM_free (param);
    }
 #endif
 
-   if (!client) {
-      /* Only usd by the Mock Server.
-       * Set a callback to get the SNI, if provided */
-      SSL_CTX_set_tlsext_servername_callback (ssl_ctx,
-                                              _mongoc_stream_tls_openssl_sni);
-   }
-
-   if (opt->weak_cert_validation) {
-      SSL_CTX_set_verify (ssl_ctx, SSL_VERIFY_NONE, NULL);
-   } else {
-      SSL_CTX_set_verify (ssl_ctx, SSL_VERIFY_PEER, NULL);
-   }
-
-   bio_ssl = BIO_new_ssl (ssl_ctx, client);
-   if (!bio_ssl) {
-      SSL_CTX_free (ssl_ctx);
-      RETURN (NULL);
-   }
    meth = mongoc_stream_tls_openssl_bio_meth_new ();
    bio_mongoc_shim = BIO_new (meth);
    if (!bio_mongoc_shim) {
       BIO_free_all (bio_ssl);
       BIO_meth_free (meth);
+      SSL_CTX_free (ssl_ctx);
       RETURN (NULL);
    }
 
 /* Added in OpenSSL 0.9.8f, as a build time option */
 #ifdef SSL_CTRL_SET_TLSEXT_HOSTNAME
    if (client) {
-      SSL *ssl;
       /* Set the SNI hostname we are expecting certificate for */
-      BIO_get_ssl (bio_ssl, &ssl);
       SSL_set_tlsext_host_name (ssl, host);
 #endif
    }
@@ -735,6 +808,11 @@ mongoc_stream_tls_openssl_new (mongoc_stream_t *base_stream,
    openssl->meth = meth;
    openssl->ctx = ssl_ctx;
 
+   if (client && session_key) {
+      openssl->session_key = bson_strdup (session_key);
+      _mongoc_openssl_session_cache_resume (ssl, openssl->session_key);
+   }
+
    tls = (mongoc_stream_tls_t *) bson_malloc0 (sizeof *tls);
    tls->parent.type = MONGOC_STREAM_TLS;
    tls->parent.destroy = _mongoc_stream_tls_openssl_destroy;
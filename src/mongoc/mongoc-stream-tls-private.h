@@ -26,6 +26,10 @@
 #include "mongoc-ssl.h"
 #include "mongoc-stream.h"
 
+#ifdef MONGOC_ENABLE_SSL_OPENSSL
+#include <openssl/ssl.h>
+#endif
+
 BSON_BEGIN_DECLS
 
 /**
@@ -48,6 +52,18 @@ struct _mongoc_stream_tls_t {
 };
 
 
+#ifdef MONGOC_ENABLE_SSL_OPENSSL
+mongoc_stream_t *
+mongoc_stream_tls_new_with_hostname_and_openssl_context (
+   mongoc_stream_t *base_stream,
+   const char *host,
+   mongoc_ssl_opt_t *opt,
+   int client,
+   SSL_CTX *ssl_ctx,
+   const char *session_key);
+#endif
+
+
 BSON_END_DECLS
 
 #endif /* MONGOC_STREAM_TLS_PRIVATE_H */
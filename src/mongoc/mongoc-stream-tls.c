@@ -30,6 +30,7 @@
 #include "mongoc-stream-private.h"
 #if defined(MONGOC_ENABLE_SSL_OPENSSL)
 #include "mongoc-stream-tls-openssl.h"
+#include "mongoc-stream-tls-openssl-private.h"
 #include "mongoc-openssl-private.h"
 #elif defined(MONGOC_ENABLE_SSL_LIBRESSL)
 #include "mongoc-libressl-private.h"
@@ -195,14 +196,11 @@ mongoc_stream_tls_check_cert (mongoc_stream_t *stream, const char *host)
  *--------------------------------------------------------------------------
  */
 
-mongoc_stream_t *
-mongoc_stream_tls_new_with_hostname (mongoc_stream_t *base_stream,
-                                     const char *host,
-                                     mongoc_ssl_opt_t *opt,
-                                     int client)
+static void
+_mongoc_stream_tls_check_hostname_opt (const char *host,
+                                       mongoc_ssl_opt_t *opt,
+                                       int client)
 {
-   BSON_ASSERT (base_stream);
-
    /* !client is only used for testing,
     * when the streams are pretending to be the server */
    if (!client || opt->weak_cert_validation) {
@@ -215,6 +213,17 @@ mongoc_stream_tls_new_with_hostname (mongoc_stream_t *base_stream,
       opt->allow_invalid_hostname = true;
    }
 #endif
+}
+
+mongoc_stream_t *
+mongoc_stream_tls_new_with_hostname (mongoc_stream_t *base_stream,
+                                     const char *host,
+                                     mongoc_ssl_opt_t *opt,
+                                     int client)
+{
+   BSON_ASSERT (base_stream);
+
+   _mongoc_stream_tls_check_hostname_opt (host, opt, client);
 
 #if defined(MONGOC_ENABLE_SSL_OPENSSL)
    return mongoc_stream_tls_openssl_new (base_stream, host, opt, client);
@@ -230,6 +239,43 @@ mongoc_stream_tls_new_with_hostname (mongoc_stream_t *base_stream,
 #endif
 }
 
+#if defined(MONGOC_ENABLE_SSL_OPENSSL)
+/*
+ *--------------------------------------------------------------------------
+ *
+ * mongoc_stream_tls_new_with_hostname_and_openssl_context --
+ *
+ *       Like mongoc_stream_tls_new_with_hostname, but uses @ssl_ctx,
+ *       which must have been created from @opt, instead of creating an
+ *       SSL_CTX for this stream alone. If @ssl_ctx is NULL, creates one.
+ *
+ *       If @session_key is not NULL and @ssl_ctx has a session cache,
+ *       offers to resume the last session negotiated under @session_key.
+ *
+ * Returns:
+ *       NULL on failure, otherwise a mongoc_stream_t.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+mongoc_stream_t *
+mongoc_stream_tls_new_with_hostname_and_openssl_context (
+   mongoc_stream_t *base_stream,
+   const char *host,
+   mongoc_ssl_opt_t *opt,
+   int client,
+   SSL_CTX *ssl_ctx,
+   const char *session_key)
+{
+   BSON_ASSERT (base_stream);
+
+   _mongoc_stream_tls_check_hostname_opt (host, opt, client);
+
+   return mongoc_stream_tls_openssl_new_with_context (
+      base_stream, host, opt, client, ssl_ctx, session_key);
+}
+#endif
+
 mongoc_stream_t *
 mongoc_stream_tls_new (mongoc_stream_t *base_stream,
                        mongoc_ssl_opt_t *opt,
@@ -33,6 +33,19 @@ typedef enum {
    MONGOC_TOPOLOGY_DESCRIPTION_TYPES
 } mongoc_topology_description_type_t;
 
+/* client-side load on a server, tracked by the owning topology. servers
+ * share a slot if their ids are equal modulo MONGOC_SERVER_LOAD_SLOTS, which
+ * only blurs a heuristic */
+#define MONGOC_SERVER_LOAD_SLOTS 64
+
+typedef struct _mongoc_server_load_t {
+   volatile int32_t in_flight;
+   /* exponentially weighted moving average of operation latency */
+   volatile int32_t latency_ewma_usec;
+   /* when latency_ewma_usec was last updated, in wrapping milliseconds */
+   volatile int32_t updated_msec;
+} mongoc_server_load_t;
+
 struct _mongoc_topology_description_t {
    bson_oid_t topology_id;
    bool opened;
@@ -57,6 +70,10 @@ struct _mongoc_topology_description_t {
 
    mongoc_apm_callbacks_t apm_callbacks;
    void *apm_context;
+
+   /* if set, select with power of two choices using the owning topology's
+    * MONGOC_SERVER_LOAD_SLOTS load slots, otherwise at random */
+   const mongoc_server_load_t *server_load;
 };
 
 typedef enum { MONGOC_SS_READ, MONGOC_SS_WRITE } mongoc_ss_optype_t;
@@ -87,6 +104,14 @@ mongoc_topology_description_select (mongoc_topology_description_t *description,
                                     const mongoc_read_prefs_t *read_pref,
                                     int64_t local_threshold_ms);
 
+mongoc_server_description_t *
+_mongoc_topology_description_select_with_seed (
+   mongoc_topology_description_t *description,
+   mongoc_ss_optype_t optype,
+   const mongoc_read_prefs_t *read_pref,
+   int64_t local_threshold_ms,
+   unsigned int *seed);
+
 mongoc_server_description_t *
 mongoc_topology_description_server_by_id (
    mongoc_topology_description_t *description,
@@ -152,6 +152,7 @@ _mongoc_topology_description_copy_to (const mongoc_topology_description_t *src,
            sizeof (mongoc_apm_callbacks_t));
 
    dst->apm_context = src->apm_context;
+   dst->server_load = src->server_load;
 
    bson_copy_to (&src->cluster_time, &dst->cluster_time);
 
@@ -762,6 +763,42 @@ mongoc_topology_description_has_data_node (mongoc_topology_description_t *td)
    return false;
 }
 
+/*
+ *-------------------------------------------------------------------------
+ *
+ * _mongoc_server_load_cost --
+ *
+ *      The expected cost of sending one more operation to server @id: its
+ *      recent latency times the operations already in flight to it. The
+ *      latency halves for every MONGOC_SERVER_LOAD_DECAY_MS without a new
+ *      sample, so a server that was slow is tried again eventually.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#define MONGOC_SERVER_LOAD_DECAY_MS 1000
+
+static int64_t
+_mongoc_server_load_cost (const mongoc_server_load_t *server_load,
+                          uint32_t id,
+                          int32_t now_msec)
+{
+   const mongoc_server_load_t *load;
+   int64_t latency;
+   int64_t in_flight;
+   uint32_t idle_msec;
+
+   load = &server_load[id % MONGOC_SERVER_LOAD_SLOTS];
+   latency = load->latency_ewma_usec;
+   in_flight = BSON_MAX (load->in_flight, 0);
+   idle_msec = (uint32_t) now_msec - (uint32_t) load->updated_msec;
+
+   latency >>= BSON_MIN (idle_msec / MONGOC_SERVER_LOAD_DECAY_MS, 31);
+
+   return (latency + 1) * (in_flight + 1);
+}
+
+
 /*
  *-------------------------------------------------------------------------
  *
@@ -780,7 +817,7 @@ mongoc_topology_description_has_data_node (mongoc_topology_description_t *td)
  *      Selected server description, or NULL upon failure.
  *
  * Side effects:
- *      None.
+ *      Advances @topology's rand_seed.
  *
  *-------------------------------------------------------------------------
  */
@@ -790,9 +827,37 @@ mongoc_topology_description_select (mongoc_topology_description_t *topology,
                                     mongoc_ss_optype_t optype,
                                     const mongoc_read_prefs_t *read_pref,
                                     int64_t local_threshold_ms)
+{
+   return _mongoc_topology_description_select_with_seed (
+      topology, optype, read_pref, local_threshold_ms, &topology->rand_seed);
+}
+
+
+/*
+ *-------------------------------------------------------------------------
+ *
+ * _mongoc_topology_description_select_with_seed --
+ *
+ *      Like mongoc_topology_description_select, but draws random numbers
+ *      from the caller's @seed and doesn't modify @topology. Threads may
+ *      select concurrently from a description no thread modifies, such
+ *      as a topology snapshot, each with its own seed.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+mongoc_server_description_t *
+_mongoc_topology_description_select_with_seed (
+   mongoc_topology_description_t *topology,
+   mongoc_ss_optype_t optype,
+   const mongoc_read_prefs_t *read_pref,
+   int64_t local_threshold_ms,
+   unsigned int *seed)
 {
    mongoc_array_t suitable_servers;
    mongoc_server_description_t *sd = NULL;
+   mongoc_server_description_t *other;
+   int32_t now_msec;
    int rand_n;
 
    ENTRY;
@@ -815,12 +880,30 @@ mongoc_topology_description_select (mongoc_topology_description_t *topology,
    mongoc_topology_description_suitable_servers (
       &suitable_servers, optype, topology, read_pref, local_threshold_ms);
    if (suitable_servers.len != 0) {
-      rand_n = _mongoc_rand_simple (&topology->rand_seed);
+      rand_n = _mongoc_rand_simple (seed);
       sd = _mongoc_array_index (&suitable_servers,
                                 mongoc_server_description_t *,
                                 rand_n % suitable_servers.len);
    }
 
+   if (topology->server_load && suitable_servers.len > 1) {
+      /* power of two choices: draw a second, distinct candidate and keep
+       * whichever is less loaded */
+      now_msec = (int32_t) (bson_get_monotonic_time () / 1000);
+      other = _mongoc_array_index (
+         &suitable_servers,
+         mongoc_server_description_t *,
+         (rand_n + 1 + _mongoc_rand_simple (seed) %
+                          (suitable_servers.len - 1)) %
+            suitable_servers.len);
+
+      if (_mongoc_server_load_cost (
+             topology->server_load, other->id, now_msec) <
+          _mongoc_server_load_cost (topology->server_load, sd->id, now_msec)) {
+         sd = other;
+      }
+   }
+
    _mongoc_array_destroy (&suitable_servers);
 
    if (sd) {
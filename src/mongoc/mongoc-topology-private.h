@@ -19,6 +19,7 @@
 
 #include "mongoc-topology-scanner-private.h"
 #include "mongoc-server-description-private.h"
+#include "mongoc-server-stream-private.h"
 #include "mongoc-topology-description-private.h"
 #include "mongoc-thread-private.h"
 #include "mongoc-uri.h"
@@ -39,6 +40,22 @@ typedef enum {
    MONGOC_TOPOLOGY_SCANNER_SINGLE_THREADED,
 } mongoc_topology_scanner_state_t;
 
+/* an immutable, reference-counted copy of the topology description, see
+ * _mongoc_topology_get_snapshot. its cluster_time is always empty: the
+ * $clusterTime advances with nearly every reply, so it is published
+ * separately as a mongoc_topology_cluster_time_t */
+typedef struct _mongoc_topology_snapshot_t {
+   volatile int32_t refcount;
+   /* varies the seed of each selection from the shared description */
+   volatile int32_t n_selects;
+   mongoc_topology_description_t description;
+} mongoc_topology_snapshot_t;
+
+typedef struct _mongoc_topology_cluster_time_t {
+   volatile int32_t refcount;
+   bson_t cluster_time;
+} mongoc_topology_cluster_time_t;
+
 typedef struct _mongoc_topology_t {
    mongoc_topology_description_t description;
    mongoc_uri_t *uri;
@@ -62,6 +79,16 @@ typedef struct _mongoc_topology_t {
    bool stale;
 
    mongoc_server_session_t *session_pool;
+
+   /* pooled only: copies of description for readers that must not wait on
+    * mutex. snapshot_mutex is held only to swap or take a reference */
+   mongoc_mutex_t snapshot_mutex;
+   mongoc_topology_snapshot_t *snapshot;
+   mongoc_topology_cluster_time_t *cluster_time;
+
+   /* in-flight operations and latency per server, see
+    * _mongoc_topology_op_started */
+   mongoc_server_load_t server_load[MONGOC_SERVER_LOAD_SLOTS];
 } mongoc_topology_t;
 
 mongoc_topology_t *
@@ -131,6 +158,33 @@ void
 _mongoc_topology_update_cluster_time (mongoc_topology_t *topology,
                                       const bson_t *reply);
 
+int64_t
+_mongoc_topology_op_started (mongoc_topology_t *topology, uint32_t server_id);
+
+void
+_mongoc_topology_op_finished (mongoc_topology_t *topology,
+                              uint32_t server_id,
+                              int64_t started);
+
+mongoc_topology_snapshot_t *
+_mongoc_topology_get_snapshot (mongoc_topology_t *topology);
+
+void
+_mongoc_topology_snapshot_release (mongoc_topology_snapshot_t *snapshot);
+
+mongoc_topology_cluster_time_t *
+_mongoc_topology_get_cluster_time (mongoc_topology_t *topology);
+
+void
+_mongoc_topology_cluster_time_release (
+   mongoc_topology_cluster_time_t *cluster_time);
+
+mongoc_server_stream_t *
+_mongoc_topology_server_stream_new (mongoc_topology_t *topology,
+                                    uint32_t server_id,
+                                    mongoc_stream_t *stream,
+                                    bson_error_t *error);
+
 mongoc_server_session_t *
 _mongoc_topology_pop_server_session (mongoc_topology_t *topology,
                                      bson_error_t *error);
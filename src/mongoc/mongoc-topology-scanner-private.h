@@ -33,6 +33,10 @@
 #include "mongoc-ssl.h"
 #endif
 
+#ifdef MONGOC_ENABLE_SSL_OPENSSL
+#include <openssl/ssl.h>
+#endif
+
 BSON_BEGIN_DECLS
 
 typedef void (*mongoc_topology_scanner_setup_err_cb_t) (
@@ -49,7 +53,6 @@ struct mongoc_topology_scanner;
 
 typedef struct mongoc_topology_scanner_node {
    uint32_t id;
-   mongoc_async_cmd_t *cmd;
    mongoc_stream_t *stream;
    int64_t timestamp;
    int64_t last_used;
@@ -90,6 +93,11 @@ typedef struct mongoc_topology_scanner {
    mongoc_ssl_opt_t *ssl_opts;
 #endif
 
+#ifdef MONGOC_ENABLE_SSL_OPENSSL
+   /* created from ssl_opts, shared by the scanner's and clients' streams */
+   SSL_CTX *openssl_ctx;
+#endif
+
    mongoc_apm_callbacks_t apm_callbacks;
    void *apm_context;
 } mongoc_topology_scanner_t;
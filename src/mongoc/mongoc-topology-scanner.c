@@ -21,6 +21,7 @@
 #include "mongoc-error.h"
 #include "mongoc-trace-private.h"
 #include "mongoc-topology-scanner-private.h"
+#include "mongoc-socket-private.h"
 #include "mongoc-stream-socket.h"
 
 #include "mongoc-handshake.h"
@@ -28,9 +29,15 @@
 
 #ifdef MONGOC_ENABLE_SSL
 #include "mongoc-stream-tls.h"
+#include "mongoc-stream-tls-private.h"
+#endif
+
+#ifdef MONGOC_ENABLE_SSL_OPENSSL
+#include "mongoc-openssl-private.h"
 #endif
 
 #include "mongoc-counters-private.h"
+#include "mongoc-dns-cache-private.h"
 #include "utlist.h"
 #include "mongoc-topology-private.h"
 #include "mongoc-host-list-private.h"
@@ -41,16 +48,24 @@
 /* forward declarations */
 static void
 mongoc_topology_scanner_ismaster_handler (
+   mongoc_async_cmd_t *acmd,
    mongoc_async_cmd_result_t async_status,
    const bson_t *ismaster_response,
    int64_t rtt_msec,
    void *data,
    bson_error_t *error);
 
+static mongoc_stream_t *
+_mongoc_topology_scanner_tcp_initiate (mongoc_async_cmd_t *acmd);
+
 static void
 _mongoc_topology_scanner_monitor_heartbeat_started (
    const mongoc_topology_scanner_t *ts, const mongoc_host_list_t *host);
 
+static bool
+_mongoc_topology_scanner_node_begin (mongoc_topology_scanner_node_t *node,
+                                     bson_error_t *error);
+
 static void
 _mongoc_topology_scanner_monitor_heartbeat_succeeded (
    const mongoc_topology_scanner_t *ts,
@@ -132,6 +147,8 @@ _begin_ismaster_cmd (mongoc_topology_scanner_t *ts,
                      int64_t timeout_msec)
 {
    bson_t cmd;
+   struct addrinfo *rp;
+   int64_t delay_msec = 0;
 
    if (node->last_used != -1 && node->last_failed == -1) {
       /* The node's been used before and not failed recently */
@@ -144,15 +161,37 @@ _begin_ismaster_cmd (mongoc_topology_scanner_t *ts,
       bson_append_document (&cmd, "$clusterTime", 12, &ts->cluster_time);
    }
 
-   node->cmd = mongoc_async_cmd_new (ts->async,
-                                     node->stream,
-                                     ts->setup,
-                                     node->host.host,
-                                     "admin",
-                                     &cmd,
-                                     &mongoc_topology_scanner_ismaster_handler,
-                                     node,
-                                     timeout_msec);
+   if (node->stream) {
+      mongoc_async_cmd_new (ts->async,
+                            node->stream,
+                            ts->setup,
+                            node->host.host,
+                            "admin",
+                            &cmd,
+                            &mongoc_topology_scanner_ismaster_handler,
+                            node,
+                            timeout_msec);
+   } else {
+      /* several addresses: connect to each a stagger after the one before,
+       * rather than waiting out a connectTimeoutMS on each one that drops
+       * our packets. the first to answer ismaster wins. */
+      for (rp = node->current_dns_result; rp; rp = rp->ai_next) {
+         mongoc_async_cmd_new_delayed (
+            ts->async,
+            &_mongoc_topology_scanner_tcp_initiate,
+            rp,
+            delay_msec,
+            ts->setup,
+            node->host.host,
+            "admin",
+            &cmd,
+            &mongoc_topology_scanner_ismaster_handler,
+            node,
+            timeout_msec);
+
+         delay_msec += MONGOC_SOCKET_CONNECT_STAGGER_MSEC;
+      }
+   }
 
    bson_destroy (&cmd);
 }
@@ -192,6 +231,19 @@ mongoc_topology_scanner_set_ssl_opts (mongoc_topology_scanner_t *ts,
 {
    ts->ssl_opts = opts;
    ts->setup = mongoc_async_cmd_tls_setup;
+
+#ifdef MONGOC_ENABLE_SSL_OPENSSL
+   /* load certificates once, not for each connection. if this fails each
+    * connection tries again and reports the error */
+   SSL_CTX_free (ts->openssl_ctx);
+   ts->openssl_ctx = _mongoc_openssl_ctx_new (opts);
+
+   if (ts->openssl_ctx &&
+       (!ts->uri || mongoc_uri_get_option_as_bool (
+                       ts->uri, MONGOC_URI_SSLSESSIONRESUMPTION, true))) {
+      _mongoc_openssl_ctx_enable_session_cache (ts->openssl_ctx);
+   }
+#endif
 }
 #endif
 
@@ -223,6 +275,10 @@ mongoc_topology_scanner_destroy (mongoc_topology_scanner_t *ts)
    /* This field can be set by a mongoc_client */
    bson_free ((char *) ts->appname);
 
+#ifdef MONGOC_ENABLE_SSL_OPENSSL
+   SSL_CTX_free (ts->openssl_ctx);
+#endif
+
    bson_free (ts);
 }
 
@@ -265,19 +321,32 @@ mongoc_topology_scanner_scan (mongoc_topology_scanner_t *ts,
    node = mongoc_topology_scanner_get_node (ts, id);
 
    /* begin non-blocking connection, don't wait for success */
-   if (node && mongoc_topology_scanner_node_setup (node, &node->last_error)) {
+   if (node && _mongoc_topology_scanner_node_begin (node, &node->last_error)) {
       _begin_ismaster_cmd (ts, node, timeout_msec);
    }
 
    /* if setup fails the node stays in the scanner. destroyed after the scan. */
 }
 
+/* cancel the node's async cmds, except "keep" */
+static void
+_mongoc_topology_scanner_node_cancel_cmds (mongoc_topology_scanner_node_t *node,
+                                           mongoc_async_cmd_t *keep)
+{
+   mongoc_async_cmd_t *acmd;
+
+   DL_FOREACH (node->ts->async->cmds, acmd)
+   {
+      if (acmd->data == node && acmd != keep) {
+         acmd->state = MONGOC_ASYNC_CMD_CANCELED_STATE;
+      }
+   }
+}
+
 void
 mongoc_topology_scanner_node_retire (mongoc_topology_scanner_node_t *node)
 {
-   if (node->cmd) {
-      node->cmd->state = MONGOC_ASYNC_CMD_CANCELED_STATE;
-   }
+   _mongoc_topology_scanner_node_cancel_cmds (node, NULL);
 
    node->retired = true;
 }
@@ -286,17 +355,22 @@ void
 mongoc_topology_scanner_node_disconnect (mongoc_topology_scanner_node_t *node,
                                          bool failed)
 {
+   mongoc_async_cmd_t *acmd, *tmp;
+
+   /* destroy the cmds before the addresses they may be connecting to */
+   DL_FOREACH_SAFE (node->ts->async->cmds, acmd, tmp)
+   {
+      if (acmd->data == node) {
+         mongoc_async_cmd_destroy (acmd);
+      }
+   }
+
    if (node->dns_results) {
-      freeaddrinfo (node->dns_results);
+      _mongoc_dns_cache_freeaddrinfo (node->dns_results);
       node->dns_results = NULL;
       node->current_dns_result = NULL;
    }
 
-   if (node->cmd) {
-      mongoc_async_cmd_destroy (node->cmd);
-      node->cmd = NULL;
-   }
-
    if (node->stream) {
       if (failed) {
          mongoc_stream_failed (node->stream);
@@ -381,6 +455,7 @@ mongoc_topology_scanner_has_node_for_host (mongoc_topology_scanner_t *ts,
 
 static void
 mongoc_topology_scanner_ismaster_handler (
+   mongoc_async_cmd_t *acmd,
    mongoc_async_cmd_result_t async_status,
    const bson_t *ismaster_response,
    int64_t rtt_msec,
@@ -389,6 +464,8 @@ mongoc_topology_scanner_ismaster_handler (
 {
    mongoc_topology_scanner_node_t *node;
    mongoc_topology_scanner_t *ts;
+   mongoc_async_cmd_t *other;
+   bool others_pending = false;
    int64_t now;
    const char *message;
 
@@ -396,19 +473,61 @@ mongoc_topology_scanner_ismaster_handler (
 
    node = (mongoc_topology_scanner_node_t *) data;
    ts = node->ts;
-   node->cmd = NULL;
 
-   if (node->retired) {
+   if (node->retired || async_status == MONGOC_ASYNC_CMD_CANCELED) {
       return;
    }
 
    now = bson_get_monotonic_time ();
 
+   if (acmd->initiator) {
+      /* one of several connects racing to this node's addresses */
+      if (node->stream) {
+         /* another address won */
+         return;
+      }
+
+      if (async_status == MONGOC_ASYNC_CMD_SUCCESS) {
+         /* keep the winner's stream, the async cmd destroys the others */
+         node->stream = acmd->stream;
+         node->has_auth = false;
+         node->timestamp = now;
+         acmd->stream = NULL;
+         _mongoc_topology_scanner_node_cancel_cmds (node, acmd);
+      } else {
+         DL_FOREACH (ts->async->cmds, other)
+         {
+            if (other->data == node && other != acmd &&
+                other->state != MONGOC_ASYNC_CMD_CANCELED_STATE) {
+               others_pending = true;
+               break;
+            }
+         }
+
+         if (others_pending) {
+            /* don't make the next address wait out its stagger */
+            DL_FOREACH (ts->async->cmds, other)
+            {
+               if (other->data == node &&
+                   other->state == MONGOC_ASYNC_CMD_INITIATE) {
+                  other->initiate_delay_msec = 0;
+                  break;
+               }
+            }
+
+            return;
+         }
+      }
+   }
+
    /* if no ismaster response, async cmd had an error or timed out */
    if (!ismaster_response || async_status == MONGOC_ASYNC_CMD_ERROR ||
        async_status == MONGOC_ASYNC_CMD_TIMEOUT) {
-      mongoc_stream_failed (node->stream);
-      node->stream = NULL;
+      if (node->stream) {
+         mongoc_stream_failed (node->stream);
+         node->stream = NULL;
+      }
+
       node->last_failed = now;
       if (error->code) {
          message = error->message;
@@ -440,13 +559,54 @@ mongoc_topology_scanner_ismaster_handler (
 }
 
 
+/* look up the node's addresses unless it already has them */
+static bool
+_mongoc_topology_scanner_node_resolve (mongoc_topology_scanner_node_t *node,
+                                       bson_error_t *error)
+{
+   mongoc_host_list_t *host;
+   int32_t dnscachettlms = MONGOC_DEFAULT_DNSCACHETTLMS;
+   int s;
+
+   if (node->dns_results) {
+      return true;
+   }
+
+   host = &node->host;
+
+   if (node->ts->uri) {
+      dnscachettlms = mongoc_uri_get_option_as_int32 (
+         node->ts->uri, MONGOC_URI_DNSCACHETTLMS, MONGOC_DEFAULT_DNSCACHETTLMS);
+   }
+
+   /* shared with the other nodes and clients in this process */
+   s = _mongoc_dns_cache_getaddrinfo (host, dnscachettlms, &node->dns_results);
+
+   if (s != 0) {
+      bson_set_error (error,
+                      MONGOC_ERROR_STREAM,
+                      MONGOC_ERROR_STREAM_NAME_RESOLUTION,
+                      "Failed to resolve '%s'",
+                      host->host);
+      return false;
+   }
+
+   node->current_dns_result = node->dns_results;
+
+   return true;
+}
+
+
 /*
  *--------------------------------------------------------------------------
  *
  * mongoc_topology_scanner_node_connect_tcp --
  *
  *      Create a socket stream for this node, begin a non-blocking
- *      connect and return.
+ *      connect and return. If the host has several addresses, wait for
+ *      the first of them to accept a connection: the scanner races them
+ *      with async cmds instead, this is for a client that needs a stream
+ *      now.
  *
  * Returns:
  *      A stream. On failure, return NULL and fill out the error.
@@ -459,58 +619,41 @@ mongoc_topology_scanner_node_connect_tcp (mongoc_topology_scanner_node_t *node,
                                           bson_error_t *error)
 {
    mongoc_socket_t *sock = NULL;
-   struct addrinfo hints;
    struct addrinfo *rp;
-   char portstr[8];
-   mongoc_host_list_t *host;
-   int s;
+   int32_t connecttimeoutms;
 
    ENTRY;
 
-   host = &node->host;
-
-   if (!node->dns_results) {
-      bson_snprintf (portstr, sizeof portstr, "%hu", host->port);
-
-      memset (&hints, 0, sizeof hints);
-      hints.ai_family = host->family;
-      hints.ai_socktype = SOCK_STREAM;
-      hints.ai_flags = 0;
-      hints.ai_protocol = 0;
-
-      s = getaddrinfo (host->host, portstr, &hints, &node->dns_results);
-
-      if (s != 0) {
-         mongoc_counter_dns_failure_inc ();
-         bson_set_error (error,
-                         MONGOC_ERROR_STREAM,
-                         MONGOC_ERROR_STREAM_NAME_RESOLUTION,
-                         "Failed to resolve '%s'",
-                         host->host);
-         RETURN (NULL);
-      }
-
-      node->current_dns_result = node->dns_results;
-
-      mongoc_counter_dns_success_inc ();
+   if (!_mongoc_topology_scanner_node_resolve (node, error)) {
+      RETURN (NULL);
    }
 
-   for (; node->current_dns_result;
-        node->current_dns_result = node->current_dns_result->ai_next) {
-      rp = node->current_dns_result;
+   rp = node->current_dns_result;
 
+   if (rp && rp->ai_next) {
+      connecttimeoutms = MONGOC_DEFAULT_CONNECTTIMEOUTMS;
+      if (node->ts->uri) {
+         connecttimeoutms =
+            mongoc_uri_get_option_as_int32 (node->ts->uri,
+                                            MONGOC_URI_CONNECTTIMEOUTMS,
+                                            MONGOC_DEFAULT_CONNECTTIMEOUTMS);
+      }
+
+      sock = mongoc_socket_connect_any (
+         rp,
+         MONGOC_SOCKET_CONNECT_STAGGER_MSEC,
+         bson_get_monotonic_time () + 1000 * (int64_t) connecttimeoutms);
+   } else if (rp) {
       /*
-       * Create a new non-blocking socket.
+       * Create a new non-blocking socket, the async ismaster waits for
+       * the connection.
        */
-      if (!(sock = mongoc_socket_new (
-               rp->ai_family, rp->ai_socktype, rp->ai_protocol))) {
-         continue;
+      sock =
+         mongoc_socket_new (rp->ai_family, rp->ai_socktype, rp->ai_protocol);
+      if (sock) {
+         mongoc_socket_connect (
+            sock, rp->ai_addr, (mongoc_socklen_t) rp->ai_addrlen, 0);
       }
-
-      mongoc_socket_connect (
-         sock, rp->ai_addr, (mongoc_socklen_t) rp->ai_addrlen, 0);
-
-      break;
    }
 
    if (!sock) {
@@ -518,8 +661,8 @@ mongoc_topology_scanner_node_connect_tcp (mongoc_topology_scanner_node_t *node,
                       MONGOC_ERROR_STREAM,
                       MONGOC_ERROR_STREAM_CONNECT,
                       "Failed to connect to target host: '%s'",
-                      host->host_and_port);
-      freeaddrinfo (node->dns_results);
+                      node->host.host_and_port);
+      _mongoc_dns_cache_freeaddrinfo (node->dns_results);
       node->dns_results = NULL;
       node->current_dns_result = NULL;
       RETURN (NULL);
@@ -528,6 +671,84 @@ mongoc_topology_scanner_node_connect_tcp (mongoc_topology_scanner_node_t *node,
    return mongoc_stream_socket_new (sock);
 }
 
+/* wrap a socket stream in TLS if the scanner uses it, or destroy it */
+static mongoc_stream_t *
+_mongoc_topology_scanner_node_wrap_tls (mongoc_topology_scanner_node_t *node,
+                                        mongoc_stream_t *sock_stream)
+{
+#ifdef MONGOC_ENABLE_SSL
+   mongoc_stream_t *tls_stream;
+
+   if (node->ts->ssl_opts) {
+#ifdef MONGOC_ENABLE_SSL_OPENSSL
+      tls_stream = mongoc_stream_tls_new_with_hostname_and_openssl_context (
+         sock_stream,
+         node->host.host,
+         node->ts->ssl_opts,
+         1,
+         node->ts->openssl_ctx,
+         node->host.host_and_port);
+#else
+      tls_stream = mongoc_stream_tls_new_with_hostname (
+         sock_stream, node->host.host, node->ts->ssl_opts, 1);
+#endif
+      if (!tls_stream) {
+         mongoc_stream_destroy (sock_stream);
+      }
+
+      return tls_stream;
+   }
+#endif
+
+   return sock_stream;
+}
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * _mongoc_topology_scanner_tcp_initiate --
+ *
+ *      Async cmd initiator: begin a non-blocking connect to the address
+ *      in acmd->initiate_ctx, one of the node's several addresses.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+static mongoc_stream_t *
+_mongoc_topology_scanner_tcp_initiate (mongoc_async_cmd_t *acmd)
+{
+   mongoc_topology_scanner_node_t *node;
+   struct addrinfo *rp;
+   mongoc_socket_t *sock;
+   mongoc_stream_t *stream;
+
+   node = (mongoc_topology_scanner_node_t *) acmd->data;
+   rp = (struct addrinfo *) acmd->initiate_ctx;
+
+   sock = mongoc_socket_new (rp->ai_family, rp->ai_socktype, rp->ai_protocol);
+   if (!sock) {
+      bson_set_error (&acmd->error,
+                      MONGOC_ERROR_STREAM,
+                      MONGOC_ERROR_STREAM_SOCKET,
+                      "Failed to create socket.");
+      return NULL;
+   }
+
+   mongoc_socket_connect (
+      sock, rp->ai_addr, (mongoc_socklen_t) rp->ai_addrlen, 0);
+
+   stream = _mongoc_topology_scanner_node_wrap_tls (
+      node, mongoc_stream_socket_new (sock));
+   if (!stream) {
+      bson_set_error (&acmd->error,
+                      MONGOC_ERROR_STREAM,
+                      MONGOC_ERROR_STREAM_SOCKET,
+                      "Failed to initialize TLS state.");
+   }
+
+   return stream;
+}
+
 static mongoc_stream_t *
 mongoc_topology_scanner_node_connect_unix (mongoc_topology_scanner_node_t *node,
                                            bson_error_t *error)
@@ -623,17 +844,10 @@ mongoc_topology_scanner_node_setup (mongoc_topology_scanner_node_t *node,
          sock_stream = mongoc_topology_scanner_node_connect_tcp (node, error);
       }
 
-#ifdef MONGOC_ENABLE_SSL
-      if (sock_stream && node->ts->ssl_opts) {
-         mongoc_stream_t *original = sock_stream;
-
-         sock_stream = mongoc_stream_tls_new_with_hostname (
-            sock_stream, node->host.host, node->ts->ssl_opts, 1);
-         if (!sock_stream) {
-            mongoc_stream_destroy (original);
-         }
+      if (sock_stream) {
+         sock_stream =
+            _mongoc_topology_scanner_node_wrap_tls (node, sock_stream);
       }
-#endif
    }
 
    if (!sock_stream) {
@@ -651,6 +865,51 @@ mongoc_topology_scanner_node_setup (mongoc_topology_scanner_node_t *node,
    return true;
 }
 
+/*
+ *--------------------------------------------------------------------------
+ *
+ * _mongoc_topology_scanner_node_begin --
+ *
+ *      Like mongoc_topology_scanner_node_setup, but if the host has
+ *      several addresses leave node->stream NULL: _begin_ismaster_cmd
+ *      races connects to them instead of blocking the scan.
+ *
+ * Returns:
+ *      true on success, or false and error is set.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+static bool
+_mongoc_topology_scanner_node_begin (mongoc_topology_scanner_node_t *node,
+                                     bson_error_t *error)
+{
+   if (node->stream || node->ts->initiator ||
+       node->host.family == AF_UNIX) {
+      return mongoc_topology_scanner_node_setup (node, error);
+   }
+
+   BSON_ASSERT (!node->retired);
+
+   if (!_mongoc_topology_scanner_node_resolve (node, error)) {
+      _mongoc_topology_scanner_monitor_heartbeat_started (node->ts,
+                                                          &node->host);
+      _mongoc_topology_scanner_monitor_heartbeat_failed (
+         node->ts, &node->host, error);
+
+      node->ts->setup_err_cb (node->id, node->ts->cb_data, error);
+      return false;
+   }
+
+   if (node->current_dns_result && node->current_dns_result->ai_next) {
+      _mongoc_topology_scanner_monitor_heartbeat_started (node->ts,
+                                                          &node->host);
+      return true;
+   }
+
+   return mongoc_topology_scanner_node_setup (node, error);
+}
+
 /*
  *--------------------------------------------------------------------------
  *
@@ -699,8 +958,7 @@ mongoc_topology_scanner_start (mongoc_topology_scanner_t *ts,
    {
       /* check node if it last failed before current cooldown period began */
       if (node->last_failed < cooldown) {
-         if (mongoc_topology_scanner_node_setup (node, &node->last_error)) {
-            BSON_ASSERT (!node->cmd);
+         if (_mongoc_topology_scanner_node_begin (node, &node->last_error)) {
             _begin_ismaster_cmd (ts, node, timeout_msec);
          }
       }
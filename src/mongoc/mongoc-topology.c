@@ -103,6 +103,165 @@ _mongoc_topology_update_no_lock (uint32_t id,
 }
 
 
+/*
+ *--------------------------------------------------------------------------
+ *
+ * _mongoc_topology_publish_snapshot --
+ *
+ *       Replace the published copy of topology->description. Call after
+ *       changing the description, while still holding the lock.
+ *       Single-threaded topologies have no concurrent readers and do not
+ *       publish.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+static void
+_mongoc_topology_publish_snapshot (mongoc_topology_t *topology)
+{
+   mongoc_topology_snapshot_t *snapshot;
+   mongoc_topology_snapshot_t *old;
+
+   if (topology->single_threaded) {
+      return;
+   }
+
+   snapshot = (mongoc_topology_snapshot_t *) bson_malloc0 (sizeof *snapshot);
+   snapshot->refcount = 1;
+   _mongoc_topology_description_copy_to (&topology->description,
+                                         &snapshot->description);
+   bson_reinit (&snapshot->description.cluster_time);
+   /* readers never modify the description, each selection derives its own
+    * seed from this one */
+   snapshot->description.rand_seed = topology->description.rand_seed;
+
+   mongoc_mutex_lock (&topology->snapshot_mutex);
+   old = topology->snapshot;
+   topology->snapshot = snapshot;
+   mongoc_mutex_unlock (&topology->snapshot_mutex);
+
+   _mongoc_topology_snapshot_release (old);
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * _mongoc_topology_get_snapshot --
+ *
+ *       Take a reference to the latest copy of the topology description,
+ *       without waiting for the topology mutex. Only for pooled topologies.
+ *
+ * Returns:
+ *       A snapshot, release it with _mongoc_topology_snapshot_release.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+mongoc_topology_snapshot_t *
+_mongoc_topology_get_snapshot (mongoc_topology_t *topology)
+{
+   mongoc_topology_snapshot_t *snapshot;
+
+   BSON_ASSERT (!topology->single_threaded);
+
+   mongoc_mutex_lock (&topology->snapshot_mutex);
+   snapshot = topology->snapshot;
+   bson_atomic_int_add (&snapshot->refcount, 1);
+   mongoc_mutex_unlock (&topology->snapshot_mutex);
+
+   return snapshot;
+}
+
+
+void
+_mongoc_topology_snapshot_release (mongoc_topology_snapshot_t *snapshot)
+{
+   if (snapshot && bson_atomic_int_add (&snapshot->refcount, -1) == 0) {
+      mongoc_topology_description_destroy (&snapshot->description);
+      bson_free (snapshot);
+   }
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * _mongoc_topology_publish_cluster_time --
+ *
+ *       Replace the published copy of topology->description.cluster_time.
+ *       Call after it advances, while still holding the lock.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+static void
+_mongoc_topology_publish_cluster_time (mongoc_topology_t *topology)
+{
+   mongoc_topology_cluster_time_t *cluster_time;
+   mongoc_topology_cluster_time_t *old;
+
+   if (topology->single_threaded) {
+      return;
+   }
+
+   cluster_time =
+      (mongoc_topology_cluster_time_t *) bson_malloc0 (sizeof *cluster_time);
+   cluster_time->refcount = 1;
+   bson_copy_to (&topology->description.cluster_time,
+                 &cluster_time->cluster_time);
+
+   mongoc_mutex_lock (&topology->snapshot_mutex);
+   old = topology->cluster_time;
+   topology->cluster_time = cluster_time;
+   mongoc_mutex_unlock (&topology->snapshot_mutex);
+
+   _mongoc_topology_cluster_time_release (old);
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * _mongoc_topology_get_cluster_time --
+ *
+ *       Take a reference to the highest $clusterTime seen, without waiting
+ *       for the topology mutex. Only for pooled topologies.
+ *
+ * Returns:
+ *       Release it with _mongoc_topology_cluster_time_release.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+mongoc_topology_cluster_time_t *
+_mongoc_topology_get_cluster_time (mongoc_topology_t *topology)
+{
+   mongoc_topology_cluster_time_t *cluster_time;
+
+   BSON_ASSERT (!topology->single_threaded);
+
+   mongoc_mutex_lock (&topology->snapshot_mutex);
+   cluster_time = topology->cluster_time;
+   bson_atomic_int_add (&cluster_time->refcount, 1);
+   mongoc_mutex_unlock (&topology->snapshot_mutex);
+
+   return cluster_time;
+}
+
+
+void
+_mongoc_topology_cluster_time_release (
+   mongoc_topology_cluster_time_t *cluster_time)
+{
+   if (cluster_time &&
+       bson_atomic_int_add (&cluster_time->refcount, -1) == 0) {
+      bson_destroy (&cluster_time->cluster_time);
+      bson_free (cluster_time);
+   }
+}
+
+
 /*
  *-------------------------------------------------------------------------
  *
@@ -130,6 +289,8 @@ _mongoc_topology_scanner_setup_err_cb (uint32_t id,
                                                 NULL /* ismaster reply */,
                                                 -1 /* rtt_msec */,
                                                 error);
+
+   _mongoc_topology_publish_snapshot (topology);
 }
 
 
@@ -182,6 +343,7 @@ _mongoc_topology_scanner_cb (uint32_t id,
       mongoc_cond_broadcast (&topology->cond_client);
    }
 
+   _mongoc_topology_publish_snapshot (topology);
    mongoc_mutex_unlock (&topology->mutex);
 }
 
@@ -212,6 +374,7 @@ mongoc_topology_new (const mongoc_uri_t *uri, bool single_threaded)
    char *prefixed_service;
    uint32_t id;
    const mongoc_host_list_t *hl;
+   const char *policy;
 
    BSON_ASSERT (uri);
 
@@ -262,6 +425,12 @@ mongoc_topology_new (const mongoc_uri_t *uri, bool single_threaded)
    topology->local_threshold_msec =
       mongoc_uri_get_local_threshold_option (topology->uri);
 
+   policy = mongoc_uri_get_option_as_utf8 (
+      topology->uri, MONGOC_URI_SERVERSELECTIONPOLICY, "random");
+   if (!strcasecmp (policy, "powerOfTwoChoices")) {
+      topology->description.server_load = topology->server_load;
+   }
+
    /* Total time allowed to check a server is connectTimeoutMS.
     * Server Discovery And Monitoring Spec:
     *
@@ -275,6 +444,7 @@ mongoc_topology_new (const mongoc_uri_t *uri, bool single_threaded)
                                       MONGOC_DEFAULT_CONNECTTIMEOUTMS);
 
    mongoc_mutex_init (&topology->mutex);
+   mongoc_mutex_init (&topology->snapshot_mutex);
    mongoc_cond_init (&topology->cond_client);
    mongoc_cond_init (&topology->cond_server);
 
@@ -318,6 +488,8 @@ mongoc_topology_new (const mongoc_uri_t *uri, bool single_threaded)
 
    if (!topology_valid) {
       /* add no nodes */
+      _mongoc_topology_publish_snapshot (topology);
+      _mongoc_topology_publish_cluster_time (topology);
       return topology;
    }
 
@@ -329,6 +501,9 @@ mongoc_topology_new (const mongoc_uri_t *uri, bool single_threaded)
       hl = hl->next;
    }
 
+   _mongoc_topology_publish_snapshot (topology);
+   _mongoc_topology_publish_cluster_time (topology);
+
    return topology;
 }
 /*
@@ -394,9 +569,13 @@ mongoc_topology_destroy (mongoc_topology_t *topology)
       _mongoc_server_session_destroy (ss);
    }
 
+   _mongoc_topology_snapshot_release (topology->snapshot);
+   _mongoc_topology_cluster_time_release (topology->cluster_time);
+
    mongoc_cond_destroy (&topology->cond_client);
    mongoc_cond_destroy (&topology->cond_server);
    mongoc_mutex_destroy (&topology->mutex);
+   mongoc_mutex_destroy (&topology->snapshot_mutex);
 
    bson_free (topology);
 }
@@ -589,6 +768,8 @@ mongoc_topology_select_server_id (mongoc_topology_t *topology,
    bson_error_t scanner_error = {0};
    int64_t heartbeat_msec;
    uint32_t server_id;
+   mongoc_topology_snapshot_t *snapshot;
+   unsigned int seed;
 
    /* These names come from the Server Selection Spec pseudocode */
    int64_t loop_start;  /* when we entered this function */
@@ -693,6 +874,29 @@ mongoc_topology_select_server_id (mongoc_topology_t *topology,
    }
 
    /* With background thread */
+   /* usually a server is available: select from the published snapshot
+    * without contending with the scanner for the topology mutex */
+   snapshot = _mongoc_topology_get_snapshot (topology);
+   if (!mongoc_topology_compatible (&snapshot->description, read_prefs, NULL)) {
+      server_id = 0;
+   } else {
+      seed = snapshot->description.rand_seed +
+             (unsigned int) bson_atomic_int_add (&snapshot->n_selects, 1);
+      selected_server = _mongoc_topology_description_select_with_seed (
+         &snapshot->description,
+         optype,
+         read_prefs,
+         local_threshold_ms,
+         &seed);
+      server_id = selected_server ? selected_server->id : 0;
+   }
+
+   _mongoc_topology_snapshot_release (snapshot);
+
+   if (server_id) {
+      return server_id;
+   }
+
    /* we break out when we've found a server or timed out */
    for (;;) {
       mongoc_mutex_lock (&topology->mutex);
@@ -779,6 +983,21 @@ mongoc_topology_server_by_id (mongoc_topology_t *topology,
                               bson_error_t *error)
 {
    mongoc_server_description_t *sd;
+   mongoc_topology_snapshot_t *snapshot;
+
+   if (!topology->single_threaded) {
+      snapshot = _mongoc_topology_get_snapshot (topology);
+      sd = mongoc_server_description_new_copy (
+         mongoc_topology_description_server_by_id (
+            &snapshot->description, id, NULL));
+      _mongoc_topology_snapshot_release (snapshot);
+
+      if (sd) {
+         return sd;
+      }
+
+      /* not found, confirm under the lock below */
+   }
 
    mongoc_mutex_lock (&topology->mutex);
 
@@ -821,6 +1040,26 @@ _mongoc_topology_host_by_id (mongoc_topology_t *topology,
 {
    mongoc_server_description_t *sd;
    mongoc_host_list_t *host = NULL;
+   mongoc_topology_snapshot_t *snapshot;
+
+   if (!topology->single_threaded) {
+      snapshot = _mongoc_topology_get_snapshot (topology);
+      sd = mongoc_topology_description_server_by_id (
+         &snapshot->description, id, NULL);
+
+      if (sd) {
+         host = bson_malloc0 (sizeof (mongoc_host_list_t));
+         memcpy (host, &sd->host, sizeof (mongoc_host_list_t));
+      }
+
+      _mongoc_topology_snapshot_release (snapshot);
+
+      if (host) {
+         return host;
+      }
+
+      /* not found, confirm under the lock below */
+   }
 
    mongoc_mutex_lock (&topology->mutex);
 
@@ -878,6 +1117,7 @@ mongoc_topology_invalidate_server (mongoc_topology_t *topology,
    mongoc_mutex_lock (&topology->mutex);
    mongoc_topology_description_invalidate_server (
       &topology->description, id, error);
+   _mongoc_topology_publish_snapshot (topology);
    mongoc_mutex_unlock (&topology->mutex);
 }
 
@@ -917,6 +1157,8 @@ _mongoc_topology_update_from_handshake (mongoc_topology_t *topology,
    _mongoc_topology_scanner_set_cluster_time (
       topology->scanner, &topology->description.cluster_time);
 
+   _mongoc_topology_publish_snapshot (topology);
+
    /* return false if server was removed from topology */
    has_server = mongoc_topology_description_server_by_id (
                    &topology->description, sd->id, NULL) != NULL;
@@ -1007,6 +1249,15 @@ mongoc_topology_description_type_t
 _mongoc_topology_get_type (mongoc_topology_t *topology)
 {
    mongoc_topology_description_type_t td_type;
+   mongoc_topology_snapshot_t *snapshot;
+
+   if (!topology->single_threaded) {
+      snapshot = _mongoc_topology_get_snapshot (topology);
+      td_type = snapshot->description.type;
+      _mongoc_topology_snapshot_release (snapshot);
+
+      return td_type;
+   }
 
    mongoc_mutex_lock (&topology->mutex);
 
@@ -1257,15 +1508,157 @@ void
 _mongoc_topology_update_cluster_time (mongoc_topology_t *topology,
                                       const bson_t *reply)
 {
+   bson_iter_t iter;
+   const uint8_t *data;
+   uint32_t size;
+   bson_t reply_cluster_time;
+   mongoc_topology_cluster_time_t *cluster_time;
+   bool greater;
+
+   if (!reply || !bson_iter_init_find (&iter, reply, "$clusterTime")) {
+      return;
+   }
+
+   if (!topology->single_threaded && BSON_ITER_HOLDS_DOCUMENT (&iter)) {
+      /* most replies carry a $clusterTime we have already seen: compare
+       * with the published one and skip the lock */
+      bson_iter_document (&iter, &size, &data);
+      bson_init_static (&reply_cluster_time, data, (size_t) size);
+
+      cluster_time = _mongoc_topology_get_cluster_time (topology);
+      greater = bson_empty (&cluster_time->cluster_time) ||
+                _mongoc_cluster_time_greater (&reply_cluster_time,
+                                              &cluster_time->cluster_time);
+      _mongoc_topology_cluster_time_release (cluster_time);
+
+      if (!greater) {
+         return;
+      }
+   }
+
    mongoc_mutex_lock (&topology->mutex);
    mongoc_topology_description_update_cluster_time (&topology->description,
                                                     reply);
    _mongoc_topology_scanner_set_cluster_time (
       topology->scanner, &topology->description.cluster_time);
+   _mongoc_topology_publish_cluster_time (topology);
    mongoc_mutex_unlock (&topology->mutex);
 }
 
 
+/*
+ *--------------------------------------------------------------------------
+ *
+ * _mongoc_topology_op_started --
+ *
+ *       Count an operation in flight to @server_id, for load-aware server
+ *       selection. Pair with _mongoc_topology_op_finished.
+ *
+ * Returns:
+ *       The start time, to pass to _mongoc_topology_op_finished.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+int64_t
+_mongoc_topology_op_started (mongoc_topology_t *topology, uint32_t server_id)
+{
+   bson_atomic_int_add (
+      &topology->server_load[server_id % MONGOC_SERVER_LOAD_SLOTS].in_flight,
+      1);
+
+   return bson_get_monotonic_time ();
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * _mongoc_topology_op_finished --
+ *
+ *       Count an operation to @server_id as done and fold its latency into
+ *       the server's moving average, weighting the new sample 1/8.
+ *       Concurrent updates may lose a sample, which only blurs the
+ *       average.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+void
+_mongoc_topology_op_finished (mongoc_topology_t *topology,
+                              uint32_t server_id,
+                              int64_t started)
+{
+   mongoc_server_load_t *load;
+   int64_t now;
+   int64_t sample;
+   int64_t ewma;
+
+   load = &topology->server_load[server_id % MONGOC_SERVER_LOAD_SLOTS];
+   now = bson_get_monotonic_time ();
+   sample = BSON_MIN (now - started, INT32_MAX);
+   ewma = load->latency_ewma_usec;
+
+   if (ewma) {
+      ewma += (sample - ewma) / 8;
+   } else {
+      ewma = sample;
+   }
+
+   load->latency_ewma_usec = (int32_t) BSON_MAX (ewma, 1);
+   load->updated_msec = (int32_t) (now / 1000);
+   bson_atomic_int_add (&load->in_flight, -1);
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * _mongoc_topology_server_stream_new --
+ *
+ *       Create a server stream for @server_id from the published snapshot
+ *       and $clusterTime, without waiting for the topology mutex. Only for
+ *       pooled topologies.
+ *
+ * Returns:
+ *       A server stream, or NULL if @server_id is not in the snapshot.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+mongoc_server_stream_t *
+_mongoc_topology_server_stream_new (mongoc_topology_t *topology,
+                                    uint32_t server_id,
+                                    mongoc_stream_t *stream,
+                                    bson_error_t *error)
+{
+   mongoc_topology_snapshot_t *snapshot;
+   mongoc_topology_cluster_time_t *cluster_time;
+   mongoc_server_description_t *sd;
+   mongoc_server_stream_t *server_stream = NULL;
+
+   snapshot = _mongoc_topology_get_snapshot (topology);
+   sd = mongoc_server_description_new_copy (
+      mongoc_topology_description_server_by_id (
+         &snapshot->description, server_id, error));
+
+   if (sd) {
+      /* the snapshot's cluster_time is empty, this copies nothing */
+      server_stream =
+         mongoc_server_stream_new (&snapshot->description, sd, stream);
+
+      cluster_time = _mongoc_topology_get_cluster_time (topology);
+      bson_destroy (&server_stream->cluster_time);
+      bson_copy_to (&cluster_time->cluster_time, &server_stream->cluster_time);
+      _mongoc_topology_cluster_time_release (cluster_time);
+   }
+
+   _mongoc_topology_snapshot_release (snapshot);
+
+   return server_stream;
+}
+
+
 /*
  *--------------------------------------------------------------------------
  *
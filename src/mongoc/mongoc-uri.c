@@ -734,6 +734,7 @@ bool
 mongoc_uri_option_is_int32 (const char *key)
 {
    return !strcasecmp (key, MONGOC_URI_CONNECTTIMEOUTMS) ||
+          !strcasecmp (key, MONGOC_URI_DNSCACHETTLMS) ||
           !strcasecmp (key, MONGOC_URI_HEARTBEATFREQUENCYMS) ||
           !strcasecmp (key, MONGOC_URI_SERVERSELECTIONTIMEOUTMS) ||
           !strcasecmp (key, MONGOC_URI_SOCKETCHECKINTERVALMS) ||
@@ -760,7 +761,8 @@ mongoc_uri_option_is_bool (const char *key)
           !strcasecmp (key, MONGOC_URI_SLAVEOK) ||
           !strcasecmp (key, MONGOC_URI_SSL) ||
           !strcasecmp (key, MONGOC_URI_SSLALLOWINVALIDCERTIFICATES) ||
-          !strcasecmp (key, MONGOC_URI_SSLALLOWINVALIDHOSTNAMES);
+          !strcasecmp (key, MONGOC_URI_SSLALLOWINVALIDHOSTNAMES) ||
+          !strcasecmp (key, MONGOC_URI_SSLSESSIONRESUMPTION);
 }
 
 bool
@@ -769,6 +771,7 @@ mongoc_uri_option_is_utf8 (const char *key)
    return !strcasecmp (key, MONGOC_URI_APPNAME) ||
           !strcasecmp (key, MONGOC_URI_REPLICASET) ||
           !strcasecmp (key, MONGOC_URI_READPREFERENCE) ||
+          !strcasecmp (key, MONGOC_URI_SERVERSELECTIONPOLICY) ||
           !strcasecmp (key, MONGOC_URI_SSLCLIENTCERTIFICATEKEYFILE) ||
           !strcasecmp (key, MONGOC_URI_SSLCLIENTCERTIFICATEKEYPASSWORD) ||
           !strcasecmp (key, MONGOC_URI_SSLCERTIFICATEAUTHORITYFILE);
@@ -963,6 +966,13 @@ mongoc_uri_parse_option (mongoc_uri_t *uri,
       if (!mongoc_uri_set_compressors (uri, value)) {
          goto UNSUPPORTED_VALUE;
       }
+   } else if (!strcmp (lkey, MONGOC_URI_SERVERSELECTIONPOLICY)) {
+      if (strcasecmp (value, "random") &&
+          strcasecmp (value, "powerOfTwoChoices")) {
+         goto UNSUPPORTED_VALUE;
+      }
+
+      mongoc_uri_bson_append_or_replace_key (&uri->options, lkey, value);
    } else if (mongoc_uri_option_is_utf8 (lkey)) {
       mongoc_uri_bson_append_or_replace_key (&uri->options, lkey, value);
    } else {
@@ -0,0 +1,56 @@
+/*
+ * Copyright 2018-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef MONGOC_WRITE_COMBINER_PRIVATE_H
+#define MONGOC_WRITE_COMBINER_PRIVATE_H
+
+#if !defined(MONGOC_COMPILATION)
+#error "Only <mongoc.h> can be included directly."
+#endif
+
+#include <bson.h>
+
+#include "mongoc-array-private.h"
+#include "mongoc-thread-private.h"
+#include "mongoc-write-combiner.h"
+
+
+BSON_BEGIN_DECLS
+
+
+#define MONGOC_WRITE_COMBINER_DEFAULT_BATCH_SIZE 1000
+
+
+struct _mongoc_write_combiner_t {
+   mongoc_client_pool_t *pool;
+   char *db;
+   char *collection;
+   uint32_t max_batch_size;
+   uint32_t max_wait_ms;
+   mongoc_mutex_t mutex;
+   mongoc_cond_t cond;
+   /* operations waiting to be sent, as mongoc_write_combiner_op_t pointers */
+   mongoc_array_t pending;
+   /* whether a caller is waiting to send the pending operations */
+   bool has_leader;
+};
+
+
+BSON_END_DECLS
+
+
+#endif /* MONGOC_WRITE_COMBINER_PRIVATE_H */
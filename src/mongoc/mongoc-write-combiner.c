@@ -0,0 +1,356 @@
+/*
+ * Copyright 2018-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "mongoc-client-private.h"
+#include "mongoc-cluster-private.h"
+#include "mongoc-trace-private.h"
+#include "mongoc-util-private.h"
+#include "mongoc-write-combiner-private.h"
+#include "mongoc-write-command-private.h"
+
+#undef MONGOC_LOG_DOMAIN
+#define MONGOC_LOG_DOMAIN "write-combiner"
+
+
+/* one caller's operation, on the caller's stack until it's done */
+typedef struct {
+   const bson_t *document;
+   bson_t *reply;
+   bson_error_t *error;
+   bool ret;
+   bool done;
+} mongoc_write_combiner_op_t;
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * mongoc_write_combiner_new --
+ *
+ *       Create a combiner that sends the inserts of concurrent callers to
+ *       @db.@collection together, in one insert command per batch of up
+ *       to @max_batch_size documents. A batch is sent when it's full or
+ *       @max_wait_ms after its first operation, on a client from @pool.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+mongoc_write_combiner_t *
+mongoc_write_combiner_new (mongoc_client_pool_t *pool,
+                           const char *db,
+                           const char *collection,
+                           uint32_t max_batch_size,
+                           uint32_t max_wait_ms)
+{
+   mongoc_write_combiner_t *combiner;
+
+   BSON_ASSERT (pool);
+   BSON_ASSERT (db);
+   BSON_ASSERT (collection);
+
+   combiner = (mongoc_write_combiner_t *) bson_malloc0 (sizeof *combiner);
+   combiner->pool = pool;
+   combiner->db = bson_strdup (db);
+   combiner->collection = bson_strdup (collection);
+   combiner->max_batch_size =
+      max_batch_size ? max_batch_size
+                     : MONGOC_WRITE_COMBINER_DEFAULT_BATCH_SIZE;
+   combiner->max_wait_ms = max_wait_ms;
+   mongoc_mutex_init (&combiner->mutex);
+   mongoc_cond_init (&combiner->cond);
+   _mongoc_array_init (&combiner->pending,
+                       sizeof (mongoc_write_combiner_op_t *));
+
+   return combiner;
+}
+
+
+void
+mongoc_write_combiner_destroy (mongoc_write_combiner_t *combiner)
+{
+   if (!combiner) {
+      return;
+   }
+
+   BSON_ASSERT (!combiner->pending.len);
+
+   _mongoc_array_destroy (&combiner->pending);
+   mongoc_cond_destroy (&combiner->cond);
+   mongoc_mutex_destroy (&combiner->mutex);
+   bson_free (combiner->collection);
+   bson_free (combiner->db);
+   bson_free (combiner);
+}
+
+
+/* if a write error in @write_errors is for the operation at @index, append
+ * it to @dest as the error of an operation sent alone */
+static bool
+_mongoc_write_combiner_find_error (const bson_t *write_errors,
+                                   uint32_t index,
+                                   bson_t *dest)
+{
+   bson_iter_t iter;
+   bson_iter_t child;
+   bson_t write_error;
+
+   if (!bson_iter_init (&iter, write_errors)) {
+      return false;
+   }
+
+   while (bson_iter_next (&iter)) {
+      if (!BSON_ITER_HOLDS_DOCUMENT (&iter) ||
+          !bson_iter_recurse (&iter, &child) ||
+          !bson_iter_find (&child, "index") ||
+          !BSON_ITER_HOLDS_INT32 (&child) ||
+          (uint32_t) bson_iter_int32 (&child) != index) {
+         continue;
+      }
+
+      BSON_APPEND_DOCUMENT_BEGIN (dest, "0", &write_error);
+      BSON_APPEND_INT32 (&write_error, "index", 0);
+      bson_iter_recurse (&iter, &child);
+      while (bson_iter_next (&child)) {
+         if (!BSON_ITER_IS_KEY (&child, "index")) {
+            BSON_APPEND_VALUE (
+               &write_error, bson_iter_key (&child), bson_iter_value (&child));
+         }
+      }
+
+      bson_append_document_end (dest, &write_error);
+
+      return true;
+   }
+
+   return false;
+}
+
+
+/* send @batch's operations in one insert command, and complete each one
+ * with its own reply and error */
+static void
+_mongoc_write_combiner_execute (mongoc_write_combiner_t *combiner,
+                                mongoc_array_t *batch)
+{
+   mongoc_bulk_write_flags_t flags = MONGOC_BULK_WRITE_FLAGS_INIT;
+   mongoc_write_combiner_op_t *op;
+   mongoc_server_stream_t *server_stream;
+   mongoc_write_command_t command;
+   mongoc_write_result_t result;
+   mongoc_write_result_t op_result;
+   mongoc_client_t *client;
+   bool acknowledged;
+   bool accounted;
+   size_t i;
+
+   ENTRY;
+
+   client = mongoc_client_pool_pop (combiner->pool);
+
+   /* one failed insert doesn't keep the others from being attempted */
+   flags.ordered = false;
+
+   for (i = 0; i < batch->len; i++) {
+      op = _mongoc_array_index (batch, mongoc_write_combiner_op_t *, i);
+      if (i == 0) {
+         _mongoc_write_command_init_insert (&command,
+                                            op->document,
+                                            NULL,
+                                            flags,
+                                            ++client->cluster.operation_id,
+                                            false);
+      } else {
+         _mongoc_write_command_insert_append (&command, op->document);
+      }
+   }
+
+   _mongoc_write_result_init (&result);
+
+   server_stream =
+      mongoc_cluster_stream_for_writes (&client->cluster, &result.error);
+
+   if (server_stream) {
+      _mongoc_write_command_execute (&command,
+                                     client,
+                                     server_stream,
+                                     combiner->db,
+                                     combiner->collection,
+                                     NULL /* client's write concern */,
+                                     0 /* offset */,
+                                     NULL /* session */,
+                                     &result);
+      mongoc_server_stream_cleanup (server_stream);
+   } else {
+      result.failed = true;
+   }
+
+   acknowledged = mongoc_write_concern_is_acknowledged (client->write_concern);
+
+   /* unless every insert succeeded or has a write error, as after a network
+    * error, it's unknown which ones succeeded */
+   accounted = (size_t) result.nInserted +
+                  bson_count_keys (&result.writeErrors) ==
+               batch->len;
+
+   for (i = 0; i < batch->len; i++) {
+      op = _mongoc_array_index (batch, mongoc_write_combiner_op_t *, i);
+
+      _mongoc_write_result_init (&op_result);
+
+      if (!_mongoc_write_combiner_find_error (
+             &result.writeErrors, (uint32_t) i, &op_result.writeErrors)) {
+         /* with w:0 there's no reply: like mongoc_collection_insert_one,
+          * the insert succeeded if it was sent */
+         if (accounted) {
+            op_result.nInserted = 1;
+         } else if (acknowledged || result.failed) {
+            memcpy (&op_result.error, &result.error, sizeof (bson_error_t));
+            op_result.failed = true;
+         }
+      }
+
+      bson_concat (&op_result.writeConcernErrors, &result.writeConcernErrors);
+      op_result.n_writeConcernErrors = result.n_writeConcernErrors;
+
+      op->ret =
+         MONGOC_WRITE_RESULT_COMPLETE (&op_result,
+                                       client->error_api_version,
+                                       client->write_concern,
+                                       /* no error domain override */
+                                       (mongoc_error_domain_t) 0,
+                                       op->reply,
+                                       op->error,
+                                       "insertedCount");
+
+      _mongoc_write_result_destroy (&op_result);
+   }
+
+   _mongoc_write_result_destroy (&result);
+   _mongoc_write_command_destroy (&command);
+   mongoc_client_pool_push (combiner->pool, client);
+
+   EXIT;
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * mongoc_write_combiner_insert_one --
+ *
+ *       Insert @document together with other callers' documents, and
+ *       block until the insert command that includes it completes.
+ *
+ *       The first caller to add an operation to a batch waits for the
+ *       batch to fill or for the combiner's wait to expire, then sends
+ *       it and completes the operations of the callers waiting on it.
+ *
+ * Returns:
+ *       true if the document was inserted; otherwise false and @error is
+ *       set. @reply is like mongoc_collection_insert_one's.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+bool
+mongoc_write_combiner_insert_one (mongoc_write_combiner_t *combiner,
+                                  const bson_t *document,
+                                  bson_t *reply,
+                                  bson_error_t *error)
+{
+   mongoc_write_combiner_op_t op = {0};
+   mongoc_write_combiner_op_t *op_ptr = &op;
+   mongoc_array_t batch;
+   int64_t deadline;
+   int64_t remaining_ms;
+   size_t i;
+
+   ENTRY;
+
+   BSON_ASSERT (combiner);
+   BSON_ASSERT (document);
+
+   _mongoc_bson_init_if_set (reply);
+
+   if (!_mongoc_validate_new_document (
+          document, _mongoc_default_insert_vflags, error)) {
+      RETURN (false);
+   }
+
+   op.document = document;
+   op.reply = reply;
+   op.error = error;
+
+   mongoc_mutex_lock (&combiner->mutex);
+
+   /* wait for the leader to take a full batch */
+   while (combiner->pending.len >= combiner->max_batch_size) {
+      mongoc_cond_wait (&combiner->cond, &combiner->mutex);
+   }
+
+   _mongoc_array_append_val (&combiner->pending, op_ptr);
+
+   if (combiner->has_leader) {
+      if (combiner->pending.len == combiner->max_batch_size) {
+         mongoc_cond_broadcast (&combiner->cond);
+      }
+
+      while (!op.done) {
+         mongoc_cond_wait (&combiner->cond, &combiner->mutex);
+      }
+
+      mongoc_mutex_unlock (&combiner->mutex);
+
+      RETURN (op.ret);
+   }
+
+   combiner->has_leader = true;
+   deadline =
+      bson_get_monotonic_time () + (int64_t) combiner->max_wait_ms * 1000;
+
+   while (combiner->pending.len < combiner->max_batch_size) {
+      remaining_ms = (deadline - bson_get_monotonic_time ()) / 1000;
+      if (remaining_ms <= 0) {
+         break;
+      }
+
+      mongoc_cond_timedwait (&combiner->cond, &combiner->mutex, remaining_ms);
+   }
+
+   /* take the batch, and let the next caller lead a new one */
+   memcpy (&batch, &combiner->pending, sizeof batch);
+   _mongoc_array_init (&combiner->pending,
+                       sizeof (mongoc_write_combiner_op_t *));
+   combiner->has_leader = false;
+   mongoc_cond_broadcast (&combiner->cond);
+   mongoc_mutex_unlock (&combiner->mutex);
+
+   _mongoc_write_combiner_execute (combiner, &batch);
+
+   mongoc_mutex_lock (&combiner->mutex);
+   for (i = 0; i < batch.len; i++) {
+      _mongoc_array_index (&batch, mongoc_write_combiner_op_t *, i)->done =
+         true;
+   }
+
+   mongoc_cond_broadcast (&combiner->cond);
+   mongoc_mutex_unlock (&combiner->mutex);
+
+   _mongoc_array_destroy (&batch);
+
+   RETURN (op.ret);
+}
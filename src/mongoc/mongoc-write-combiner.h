@@ -0,0 +1,55 @@
+/*
+ * Copyright 2018-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef MONGOC_WRITE_COMBINER_H
+#define MONGOC_WRITE_COMBINER_H
+
+#if !defined(MONGOC_INSIDE) && !defined(MONGOC_COMPILATION)
+#error "Only <mongoc.h> can be included directly."
+#endif
+
+#include <bson.h>
+
+#include "mongoc-macros.h"
+#include "mongoc-client-pool.h"
+
+
+BSON_BEGIN_DECLS
+
+
+typedef struct _mongoc_write_combiner_t mongoc_write_combiner_t;
+
+
+MONGOC_EXPORT (mongoc_write_combiner_t *)
+mongoc_write_combiner_new (mongoc_client_pool_t *pool,
+                           const char *db,
+                           const char *collection,
+                           uint32_t max_batch_size,
+                           uint32_t max_wait_ms);
+MONGOC_EXPORT (void)
+mongoc_write_combiner_destroy (mongoc_write_combiner_t *combiner);
+MONGOC_EXPORT (bool)
+mongoc_write_combiner_insert_one (mongoc_write_combiner_t *combiner,
+                                  const bson_t *document,
+                                  bson_t *reply,
+                                  bson_error_t *error);
+
+
+BSON_END_DECLS
+
+
+#endif /* MONGOC_WRITE_COMBINER_H */
@@ -23,6 +23,7 @@
 
 #include <bson.h>
 
+#include "mongoc-array-private.h"
 #include "mongoc-client.h"
 #include "mongoc-error.h"
 #include "mongoc-write-concern.h"
@@ -37,6 +38,13 @@ BSON_BEGIN_DECLS
 #define MONGOC_WRITE_COMMAND_INSERT 1
 #define MONGOC_WRITE_COMMAND_UPDATE 2
 
+/* an _id element with an ObjectId: type, "_id\0", and 12 bytes */
+#define MONGOC_WRITE_COMMAND_ID_LEN 17
+
+/* room for the OP_MSG header and the write command's body, including lsid,
+ * $clusterTime and writeConcern, in a message of client-side batches */
+#define MONGOC_WRITE_COMMAND_OVERHEAD (16 * 1024)
+
 
 typedef enum {
    MONGOC_BYPASS_DOCUMENT_VALIDATION_FALSE = 0,
@@ -49,6 +57,7 @@ struct _mongoc_bulk_write_flags_t {
    mongoc_write_bypass_document_validation_t bypass_document_validation;
    bool has_collation;
    bool has_multi_write;
+   bool has_array_filters;
 };
 
 
@@ -59,6 +68,10 @@ typedef struct {
    mongoc_bulk_write_flags_t flags;
    int64_t operation_id;
    bson_t cmd_opts;
+   /* index in an unordered bulk of each operation, which may not be
+    * contiguous, or empty if the operations start at the offset passed to
+    * _mongoc_write_command_execute */
+   mongoc_array_t indexes;
    union {
       struct {
          bool allow_bulk_op_insert;
@@ -67,6 +80,10 @@ typedef struct {
 } mongoc_write_command_t;
 
 
+/* errors of each kind a result with resultDetail "counts" keeps */
+#define MONGOC_WRITE_RESULT_MAX_ERRORS 100
+
+
 typedef struct {
    uint32_t nInserted;
    uint32_t nMatched;
@@ -84,6 +101,10 @@ typedef struct {
    bool must_stop; /* The stream may have been disconnected */
    bson_error_t error;
    uint32_t upsert_append_count;
+   uint32_t n_writeErrors;
+   /* for resultDetail "counts": don't record upserts, and keep only the
+    * first MONGOC_WRITE_RESULT_MAX_ERRORS write and write concern errors */
+   bool counts_only;
 } mongoc_write_result_t;
 
 
@@ -135,11 +156,28 @@ _mongoc_write_command_delete_append (mongoc_write_command_t *command,
                                      const bson_t *opts);
 
 void
+_mongoc_write_command_init_slice (mongoc_write_command_t *slice,
+                                  const mongoc_write_command_t *command,
+                                  uint32_t first_document,
+                                  uint32_t n_documents,
+                                  uint32_t payload_offset,
+                                  uint32_t len);
+bool
+_mongoc_write_command_is_compatible (const mongoc_write_command_t *command,
+                                     const bson_t *opts);
+uint32_t
+_mongoc_write_command_index (const mongoc_write_command_t *command,
+                             uint32_t i);
+void
 _mongoc_write_command_too_large_error (bson_error_t *error,
                                        int32_t idx,
                                        int32_t len,
                                        int32_t max_bson_size);
 void
+_mongoc_write_command_batch_limits (mongoc_server_stream_t *server_stream,
+                                    int32_t *max_batch_size,
+                                    int32_t *max_batch_bytes);
+void
 _mongoc_write_command_execute (mongoc_write_command_t *command,
                                mongoc_client_t *client,
                                mongoc_server_stream_t *server_stream,
@@ -156,7 +194,8 @@ _mongoc_write_result_append_upsert (mongoc_write_result_t *result,
                                     int32_t idx,
                                     const bson_value_t *value);
 int32_t
-_mongoc_write_result_merge_arrays (uint32_t offset,
+_mongoc_write_result_merge_arrays (mongoc_write_command_t *command,
+                                   uint32_t offset,
                                    mongoc_write_result_t *result,
                                    bson_t *dest,
                                    bson_iter_t *iter);
@@ -165,6 +204,11 @@ _mongoc_write_result_merge (mongoc_write_result_t *result,
                             mongoc_write_command_t *command,
                             const bson_t *reply,
                             uint32_t offset);
+void
+_mongoc_write_result_append (mongoc_write_result_t *result,
+                             const mongoc_write_result_t *other);
+void
+_mongoc_write_result_sort_by_index (mongoc_write_result_t *result);
 #define MONGOC_WRITE_RESULT_COMPLETE(_result, ...) \
    _mongoc_write_result_complete (_result, __VA_ARGS__, NULL)
 bool
@@ -176,6 +220,9 @@ _mongoc_write_result_complete (mongoc_write_result_t *result,
                                bson_error_t *error,
                                ...);
 void
+_mongoc_write_result_set_detail (mongoc_write_result_t *result,
+                                 const bson_t *opts);
+void
 _mongoc_write_result_destroy (mongoc_write_result_t *result);
 
 void
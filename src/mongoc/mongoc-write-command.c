@@ -71,7 +71,8 @@ _mongoc_write_command_insert_append (mongoc_write_command_t *command,
 {
    bson_iter_t iter;
    bson_oid_t oid;
-   bson_t tmp;
+   uint8_t id[MONGOC_WRITE_COMMAND_ID_LEN];
+   uint32_t len_le;
 
    ENTRY;
 
@@ -82,15 +83,22 @@ _mongoc_write_command_insert_append (mongoc_write_command_t *command,
 
    /*
     * If the document does not contain an "_id" field, we need to generate
-    * a new oid for "_id".
+    * a new oid for "_id". Write the new document's length, the _id element,
+    * and the original's elements straight into the payload, copying the
+    * document once.
     */
    if (!bson_iter_init_find (&iter, document, "_id")) {
-      bson_init (&tmp);
+      len_le = BSON_UINT32_TO_LE (document->len + MONGOC_WRITE_COMMAND_ID_LEN);
       bson_oid_init (&oid, NULL);
-      BSON_APPEND_OID (&tmp, "_id", &oid);
-      bson_concat (&tmp, document);
-      _mongoc_buffer_append (&command->payload, bson_get_data (&tmp), tmp.len);
-      bson_destroy (&tmp);
+      id[0] = (uint8_t) BSON_TYPE_OID;
+      memcpy (&id[1], "_id", 4);
+      memcpy (&id[5], oid.bytes, sizeof oid.bytes);
+
+      _mongoc_buffer_append (&command->payload, (uint8_t *) &len_le, 4);
+      _mongoc_buffer_append (&command->payload, id, sizeof id);
+      _mongoc_buffer_append (&command->payload,
+                             bson_get_data (document) + 4,
+                             document->len - 4);
    } else {
       _mongoc_buffer_append (
          &command->payload, bson_get_data (document), document->len);
@@ -123,6 +131,8 @@ _mongoc_write_command_update_append (mongoc_write_command_t *command,
 
       bson_concat (&document, opts);
       command->flags.has_collation |= bson_has_field (opts, "collation");
+      command->flags.has_array_filters |=
+         bson_has_field (opts, "arrayFilters");
 
       if (bson_iter_init_find (&iter, opts, "multi") &&
           bson_iter_as_bool (&iter)) {
@@ -198,6 +208,7 @@ _mongoc_write_command_init_bulk (mongoc_write_command_t *command,
    }
 
    _mongoc_buffer_init (&command->payload, NULL, 0, NULL, NULL);
+   _mongoc_array_init (&command->indexes, sizeof (uint32_t));
    command->n_documents = 0;
 
    EXIT;
@@ -272,6 +283,101 @@ _mongoc_write_command_init_update (mongoc_write_command_t *command, /* IN */
 }
 
 
+/*
+ *--------------------------------------------------------------------------
+ *
+ * _mongoc_write_command_init_slice --
+ *
+ *       Initialize @slice with @n_documents of @command's operations,
+ *       starting with the operation at @first_document, which begins
+ *       @payload_offset bytes into the payload and spans @len bytes. The
+ *       slice reports the operations' indexes in @command's bulk, so it
+ *       must be executed with offset 0.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+void
+_mongoc_write_command_init_slice (mongoc_write_command_t *slice,
+                                  const mongoc_write_command_t *command,
+                                  uint32_t first_document,
+                                  uint32_t n_documents,
+                                  uint32_t payload_offset,
+                                  uint32_t len)
+{
+   uint32_t i;
+   uint32_t idx;
+
+   BSON_ASSERT (slice);
+   BSON_ASSERT (command);
+   BSON_ASSERT (first_document + n_documents <= command->n_documents);
+   BSON_ASSERT (payload_offset + len <= command->payload.len);
+
+   _mongoc_write_command_init_bulk (slice,
+                                    command->type,
+                                    command->flags,
+                                    command->operation_id,
+                                    &command->cmd_opts);
+
+   slice->u = command->u;
+   _mongoc_buffer_append (
+      &slice->payload, command->payload.data + payload_offset, len);
+   slice->n_documents = n_documents;
+
+   for (i = 0; i < n_documents; i++) {
+      idx = _mongoc_write_command_index (command, first_document + i);
+      _mongoc_array_append_val (&slice->indexes, idx);
+   }
+}
+
+
+/* whether an operation with @opts can be sent in the same command as
+ * @command's operations without changing how either is executed */
+bool
+_mongoc_write_command_is_compatible (const mongoc_write_command_t *command,
+                                     const bson_t *opts)
+{
+   bson_iter_t iter;
+   bool is_multi = false;
+
+   BSON_ASSERT (command);
+
+   switch (command->type) {
+   case MONGOC_WRITE_COMMAND_DELETE:
+      is_multi = opts && bson_iter_init_find (&iter, opts, "limit") &&
+                 bson_iter_as_int64 (&iter) != 1;
+      break;
+   case MONGOC_WRITE_COMMAND_UPDATE:
+      is_multi = opts && bson_iter_init_find (&iter, opts, "multi") &&
+                 bson_iter_as_bool (&iter);
+      break;
+   case MONGOC_WRITE_COMMAND_INSERT:
+   default:
+      return true;
+   }
+
+   /* multi-document writes aren't retryable, and collation and arrayFilters
+    * fail on old servers, so they don't taint other operations */
+   return command->flags.has_multi_write == is_multi &&
+          command->flags.has_collation ==
+             (opts && bson_has_field (opts, "collation")) &&
+          command->flags.has_array_filters ==
+             (opts && bson_has_field (opts, "arrayFilters"));
+}
+
+
+/* the index to report for the command's operation at @i */
+uint32_t
+_mongoc_write_command_index (const mongoc_write_command_t *command, uint32_t i)
+{
+   if (command->indexes.len && i < command->indexes.len) {
+      return _mongoc_array_index (&command->indexes, uint32_t, i);
+   }
+
+   return i;
+}
+
+
 /* takes initialized bson_t *doc and begins formatting a write command */
 void
 _mongoc_write_command_init (bson_t *doc,
@@ -342,6 +448,38 @@ _mongoc_write_command_too_large_error (bson_error_t *error,
 }
 
 
+/*
+ *-------------------------------------------------------------------------
+ *
+ * _mongoc_write_command_batch_limits --
+ *
+ *       The most documents, and the most bytes of documents, that a
+ *       batch built by the driver may hold to fit in one write command
+ *       to @server_stream.
+ *
+ * Returns:
+ *       None.
+ *
+ * Side effects:
+ *       "max_batch_size" and "max_batch_bytes" are set, at least 1.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+void
+_mongoc_write_command_batch_limits (mongoc_server_stream_t *server_stream,
+                                    int32_t *max_batch_size,
+                                    int32_t *max_batch_bytes)
+{
+   *max_batch_size =
+      BSON_MAX (1, mongoc_server_stream_max_write_batch_size (server_stream));
+   *max_batch_bytes =
+      BSON_MAX (1,
+                mongoc_server_stream_max_msg_size (server_stream) -
+                   MONGOC_WRITE_COMMAND_OVERHEAD);
+}
+
+
 void
 _empty_error (mongoc_write_command_t *command, bson_error_t *error)
 {
@@ -480,7 +618,10 @@ _mongoc_write_opmsg (mongoc_write_command_t *command,
       if (len > max_bson_obj_size + BSON_OBJECT_ALLOWANCE) {
          /* Quit if the document is too large */
          _mongoc_write_command_too_large_error (
-            error, index_offset, len, max_bson_obj_size);
+            error,
+            (int32_t) _mongoc_write_command_index (command, index_offset),
+            len,
+            max_bson_obj_size);
          result->failed = true;
          break;
 
@@ -883,6 +1024,7 @@ _mongoc_write_command_destroy (mongoc_write_command_t *command)
    if (command) {
       bson_destroy (&command->cmd_opts);
       _mongoc_buffer_destroy (&command->payload);
+      _mongoc_array_destroy (&command->indexes);
    }
 
    EXIT;
@@ -906,6 +1048,33 @@ _mongoc_write_result_init (mongoc_write_result_t *result) /* IN */
 }
 
 
+/* apply a bulk write's "resultDetail" option, recording an invalid one in
+ * @result's error */
+void
+_mongoc_write_result_set_detail (mongoc_write_result_t *result,
+                                 const bson_t *opts)
+{
+   bson_iter_t iter;
+
+   BSON_ASSERT (result);
+
+   if (!opts || !bson_iter_init_find (&iter, opts, "resultDetail")) {
+      return;
+   }
+
+   if (BSON_ITER_HOLDS_UTF8 (&iter) &&
+       !strcmp (bson_iter_utf8 (&iter, NULL), "counts")) {
+      result->counts_only = true;
+   } else if (!BSON_ITER_HOLDS_UTF8 (&iter) ||
+              strcmp (bson_iter_utf8 (&iter, NULL), "full")) {
+      bson_set_error (&result->error,
+                      MONGOC_ERROR_COMMAND,
+                      MONGOC_ERROR_COMMAND_INVALID_ARG,
+                      "Invalid resultDetail, must be \"full\" or \"counts\"");
+   }
+}
+
+
 void
 _mongoc_write_result_destroy (mongoc_write_result_t *result)
 {
@@ -934,6 +1103,10 @@ _mongoc_write_result_append_upsert (mongoc_write_result_t *result,
    BSON_ASSERT (result);
    BSON_ASSERT (value);
 
+   if (result->counts_only) {
+      return;
+   }
+
    len = (int) bson_uint32_to_string (
       result->upsert_append_count, &keyptr, key, sizeof key);
 
@@ -947,7 +1120,8 @@ _mongoc_write_result_append_upsert (mongoc_write_result_t *result,
 
 
 int32_t
-_mongoc_write_result_merge_arrays (uint32_t offset,
+_mongoc_write_result_merge_arrays (mongoc_write_command_t *command,
+                                   uint32_t offset,
                                    mongoc_write_result_t *result, /* IN */
                                    bson_t *dest,                  /* IN */
                                    bson_iter_t *iter)             /* IN */
@@ -976,12 +1150,19 @@ _mongoc_write_result_merge_arrays (uint32_t offset,
       while (bson_iter_next (&ar)) {
          if (BSON_ITER_HOLDS_DOCUMENT (&ar) &&
              bson_iter_recurse (&ar, &citer)) {
+            count++;
+            if (result->counts_only &&
+                aridx >= MONGOC_WRITE_RESULT_MAX_ERRORS) {
+               continue;
+            }
+
             len =
                (int) bson_uint32_to_string (aridx++, &keyptr, key, sizeof key);
             bson_append_document_begin (dest, keyptr, len, &child);
             while (bson_iter_next (&citer)) {
                if (BSON_ITER_IS_KEY (&citer, "index")) {
-                  idx = bson_iter_int32 (&citer) + offset;
+                  idx = (int32_t) _mongoc_write_command_index (
+                     command, bson_iter_int32 (&citer) + offset);
                   BSON_APPEND_INT32 (&child, "index", idx);
                } else {
                   value = bson_iter_value (&citer);
@@ -989,7 +1170,6 @@ _mongoc_write_result_merge_arrays (uint32_t offset,
                }
             }
             bson_append_document_end (dest, &child);
-            count++;
          }
       }
    }
@@ -1053,7 +1233,10 @@ _mongoc_write_result_merge (mongoc_write_result_t *result,   /* IN */
                       bson_iter_find (&citer, "_id")) {
                      value = bson_iter_value (&citer);
                      _mongoc_write_result_append_upsert (
-                        result, offset + server_index, value);
+                        result,
+                        (int32_t) _mongoc_write_command_index (
+                           command, offset + server_index),
+                        value);
                      n_upserted++;
                   }
                }
@@ -1080,8 +1263,8 @@ _mongoc_write_result_merge (mongoc_write_result_t *result,   /* IN */
 
    if (bson_iter_init_find (&iter, reply, "writeErrors") &&
        BSON_ITER_HOLDS_ARRAY (&iter)) {
-      _mongoc_write_result_merge_arrays (
-         offset, result, &result->writeErrors, &iter);
+      result->n_writeErrors += (uint32_t) _mongoc_write_result_merge_arrays (
+         command, offset, result, &result->writeErrors, &iter);
    }
 
    if (bson_iter_init_find (&iter, reply, "writeConcernError") &&
@@ -1094,14 +1277,17 @@ _mongoc_write_result_merge (mongoc_write_result_t *result,   /* IN */
 
       /* writeConcernError is a subdocument in the server response
        * append it to the result->writeConcernErrors array */
-      bson_iter_document (&iter, &len, &data);
-      bson_init_static (&write_concern_error, data, len);
+      if (!result->counts_only ||
+          result->n_writeConcernErrors < MONGOC_WRITE_RESULT_MAX_ERRORS) {
+         bson_iter_document (&iter, &len, &data);
+         bson_init_static (&write_concern_error, data, len);
 
-      bson_uint32_to_string (
-         result->n_writeConcernErrors, &key, str, sizeof str);
+         bson_uint32_to_string (
+            result->n_writeConcernErrors, &key, str, sizeof str);
 
-      bson_append_document (
-         &result->writeConcernErrors, key, -1, &write_concern_error);
+         bson_append_document (
+            &result->writeConcernErrors, key, -1, &write_concern_error);
+      }
 
       result->n_writeConcernErrors++;
    }
@@ -1177,6 +1363,164 @@ _set_error_from_response (bson_t *bson_array,
 }
 
 
+typedef struct {
+   int32_t index;
+   uint32_t position;
+   const uint8_t *data;
+   uint32_t len;
+} mongoc_write_result_entry_t;
+
+
+static int
+_mongoc_write_result_entry_cmp (const void *a, const void *b)
+{
+   const mongoc_write_result_entry_t *ea = (mongoc_write_result_entry_t *) a;
+   const mongoc_write_result_entry_t *eb = (mongoc_write_result_entry_t *) b;
+
+   if (ea->index != eb->index) {
+      return ea->index < eb->index ? -1 : 1;
+   }
+
+   return ea->position < eb->position ? -1 : 1;
+}
+
+
+/* sort an array like [{"index": int, ...}, ...] by index */
+static void
+_mongoc_write_result_sort_array (bson_t *array)
+{
+   mongoc_write_result_entry_t *entries;
+   bson_iter_t iter;
+   bson_iter_t child;
+   bson_t sorted;
+   bson_t doc;
+   uint32_t n = 0;
+   uint32_t i;
+   const char *key;
+   char str[16];
+
+   entries = (mongoc_write_result_entry_t *) bson_malloc (
+      (size_t) BSON_MAX (bson_count_keys (array), 1) * sizeof *entries);
+
+   if (bson_iter_init (&iter, array)) {
+      while (bson_iter_next (&iter)) {
+         if (!BSON_ITER_HOLDS_DOCUMENT (&iter)) {
+            continue;
+         }
+
+         bson_iter_document (&iter, &entries[n].len, &entries[n].data);
+         entries[n].position = n;
+         entries[n].index = 0;
+         if (bson_iter_recurse (&iter, &child) &&
+             bson_iter_find (&child, "index") &&
+             BSON_ITER_HOLDS_INT32 (&child)) {
+            entries[n].index = bson_iter_int32 (&child);
+         }
+
+         n++;
+      }
+   }
+
+   qsort (entries, n, sizeof *entries, _mongoc_write_result_entry_cmp);
+
+   bson_init (&sorted);
+   for (i = 0; i < n; i++) {
+      bson_uint32_to_string (i, &key, str, sizeof str);
+      BSON_ASSERT (bson_init_static (&doc, entries[i].data, entries[i].len));
+      BSON_APPEND_DOCUMENT (&sorted, key, &doc);
+   }
+
+   bson_destroy (array);
+   bson_steal (array, &sorted);
+   bson_free (entries);
+}
+
+
+/* append the documents of one result array to another, up to @max */
+static void
+_mongoc_write_result_append_array (bson_t *dest,
+                                   const bson_t *src,
+                                   uint32_t max)
+{
+   bson_iter_t iter;
+   uint32_t i;
+   const char *key;
+   char str[16];
+
+   i = bson_count_keys (dest);
+
+   if (bson_iter_init (&iter, src)) {
+      while (i < max && bson_iter_next (&iter)) {
+         bson_uint32_to_string (i++, &key, str, sizeof str);
+         BSON_APPEND_VALUE (dest, key, bson_iter_value (&iter));
+      }
+   }
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * _mongoc_write_result_append --
+ *
+ *       Add the outcome of writes recorded in @other to @result, as when
+ *       parts of a bulk write are executed separately. The first error
+ *       is kept.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+void
+_mongoc_write_result_append (mongoc_write_result_t *result,
+                             const mongoc_write_result_t *other)
+{
+   uint32_t max;
+
+   BSON_ASSERT (result);
+   BSON_ASSERT (other);
+
+   result->nInserted += other->nInserted;
+   result->nMatched += other->nMatched;
+   result->nModified += other->nModified;
+   result->nRemoved += other->nRemoved;
+   result->nUpserted += other->nUpserted;
+
+   max = result->counts_only ? MONGOC_WRITE_RESULT_MAX_ERRORS : UINT32_MAX;
+
+   if (!result->counts_only) {
+      _mongoc_write_result_append_array (
+         &result->upserted, &other->upserted, UINT32_MAX);
+      result->upsert_append_count += other->upsert_append_count;
+   }
+
+   _mongoc_write_result_append_array (
+      &result->writeErrors, &other->writeErrors, max);
+   result->n_writeErrors += other->n_writeErrors;
+   _mongoc_write_result_append_array (
+      &result->writeConcernErrors, &other->writeConcernErrors, max);
+   result->n_writeConcernErrors += other->n_writeConcernErrors;
+
+   if (other->error.domain && !result->error.domain) {
+      memcpy (&result->error, &other->error, sizeof (bson_error_t));
+   }
+
+   result->failed |= other->failed;
+   result->must_stop |= other->must_stop;
+}
+
+
+/* after an unordered bulk sent its operations out of order, report upserts
+ * and write errors in the order of the operations */
+void
+_mongoc_write_result_sort_by_index (mongoc_write_result_t *result)
+{
+   BSON_ASSERT (result);
+
+   _mongoc_write_result_sort_array (&result->upserted);
+   _mongoc_write_result_sort_array (&result->writeErrors);
+}
+
+
 /* complete a write result, including only certain fields */
 bool
 _mongoc_write_result_complete (
@@ -1270,6 +1614,11 @@ _mongoc_write_result_complete (
          BSON_APPEND_ARRAY (bson, "writeErrors", &result->writeErrors);
       }
 
+      /* the number of write errors, of which the first few are listed */
+      if (result->counts_only) {
+         BSON_APPEND_INT32 (bson, "nWriteErrors", result->n_writeErrors);
+      }
+
       if (result->n_writeConcernErrors) {
          BSON_APPEND_ARRAY (
             bson, "writeConcernErrors", &result->writeConcernErrors);
@@ -25,6 +25,7 @@
 #include "mongoc-macros.h"
 #include "mongoc-apm.h"
 #include "mongoc-bulk-operation.h"
+#include "mongoc-bulk-writer.h"
 #include "mongoc-change-stream.h"
 #include "mongoc-client.h"
 #include "mongoc-client-pool.h"
@@ -36,10 +37,12 @@
 #include "mongoc-error.h"
 #include "mongoc-flags.h"
 #include "mongoc-gridfs.h"
+#include "mongoc-gridfs-chunk-cache.h"
 #include "mongoc-gridfs-file.h"
 #include "mongoc-gridfs-file-list.h"
 #include "mongoc-gridfs-file-page.h"
 #include "mongoc-host-list.h"
+#include "mongoc-importer.h"
 #include "mongoc-init.h"
 #include "mongoc-matcher.h"
 #include "mongoc-handshake.h"
@@ -53,6 +56,7 @@
 #include "mongoc-stream-gridfs.h"
 #include "mongoc-stream-socket.h"
 #include "mongoc-uri.h"
+#include "mongoc-write-combiner.h"
 #include "mongoc-write-concern.h"
 #include "mongoc-version.h"
 #include "mongoc-version-functions.h"
@@ -0,0 +1,204 @@
+/*
+ * Copyright 2018-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+
+#include <bson.h>
+#include <mongoc.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+
+static void
+usage (FILE *stream)
+{
+   fprintf (stream,
+            "Usage: mongoc-import [OPTIONS] DBNAME COLNAME FILE\n"
+            "\n"
+            "Inserts the documents in FILE, JSON or BSON, into a collection.\n"
+            "Parsing, validation and sending run in parallel threads. FILE\n"
+            "may be \"-\" to read JSON from stdin.\n"
+            "\n"
+            "Options:\n"
+            "\n"
+            "  --uri URI          Connection string [mongodb://127.0.0.1/].\n"
+            "  --bson             FILE contains BSON, like mongoc-dump's.\n"
+            "  --unordered        Continue after write errors.\n"
+            "  --workers N        Threads that validate documents [2].\n"
+            "  --connections N    Connections sending at once, with\n"
+            "                     --unordered [4].\n"
+            "  --queue-size N     Batches queued between threads [4].\n"
+            "\n");
+}
+
+
+static bool
+parse_count (const char *arg, const char *name, int32_t *count)
+{
+   *count = (int32_t) strtol (arg, NULL, 10);
+   if (*count <= 0) {
+      fprintf (stderr, "Invalid %s \"%s\"\n", name, arg);
+      return false;
+   }
+
+   return true;
+}
+
+
+int
+main (int argc, char *argv[])
+{
+   mongoc_client_pool_t *pool;
+   mongoc_importer_t *importer;
+   mongoc_uri_t *uri;
+   bson_json_reader_t *json_reader = NULL;
+   bson_reader_t *reader = NULL;
+   const char *uri_string = "mongodb://127.0.0.1/";
+   const char *args[3];
+   bson_t opts = BSON_INITIALIZER;
+   bson_t reply;
+   bson_error_t error;
+   bson_iter_t iter;
+   bool bson_input = false;
+   bool ret;
+   int32_t count;
+   int64_t elapsed_ms;
+   int n_args = 0;
+   int i;
+
+   for (i = 1; i < argc; i++) {
+      if (0 == strcmp (argv[i], "--help")) {
+         usage (stdout);
+         return EXIT_SUCCESS;
+      } else if (0 == strcmp (argv[i], "--uri") && ((i + 1) < argc)) {
+         uri_string = argv[++i];
+      } else if (0 == strcmp (argv[i], "--bson")) {
+         bson_input = true;
+      } else if (0 == strcmp (argv[i], "--unordered")) {
+         BSON_APPEND_BOOL (&opts, "ordered", false);
+      } else if (0 == strcmp (argv[i], "--workers") && ((i + 1) < argc)) {
+         if (!parse_count (argv[++i], "workers", &count)) {
+            return EXIT_FAILURE;
+         }
+         BSON_APPEND_INT32 (&opts, "workers", count);
+      } else if (0 == strcmp (argv[i], "--connections") && ((i + 1) < argc)) {
+         if (!parse_count (argv[++i], "connections", &count)) {
+            return EXIT_FAILURE;
+         }
+         BSON_APPEND_INT32 (&opts, "connections", count);
+      } else if (0 == strcmp (argv[i], "--queue-size") && ((i + 1) < argc)) {
+         if (!parse_count (argv[++i], "queue size", &count)) {
+            return EXIT_FAILURE;
+         }
+         BSON_APPEND_INT32 (&opts, "queueSize", count);
+      } else if (argv[i][0] == '-' && argv[i][1] != '\0') {
+         fprintf (stderr, "Unknown argument \"%s\"\n", argv[i]);
+         return EXIT_FAILURE;
+      } else if (n_args < 3) {
+         args[n_args++] = argv[i];
+      } else {
+         usage (stderr);
+         return EXIT_FAILURE;
+      }
+   }
+
+   if (n_args != 3) {
+      usage (stderr);
+      return EXIT_FAILURE;
+   }
+
+   /* report how many writes failed, not every write error */
+   BSON_APPEND_UTF8 (&opts, "resultDetail", "counts");
+
+   if (bson_input) {
+      reader = bson_reader_new_from_file (args[2], &error);
+   } else if (0 == strcmp (args[2], "-")) {
+      json_reader = bson_json_reader_new_from_fd (0, false);
+   } else {
+      json_reader = bson_json_reader_new_from_file (args[2], &error);
+   }
+
+   if (!reader && !json_reader) {
+      fprintf (stderr, "Failed to open \"%s\": %s\n", args[2], error.message);
+      return EXIT_FAILURE;
+   }
+
+   mongoc_init ();
+
+   uri = mongoc_uri_new_with_error (uri_string, &error);
+   if (!uri) {
+      fprintf (stderr,
+               "Invalid connection URI \"%s\": %s\n",
+               uri_string,
+               error.message);
+      return EXIT_FAILURE;
+   }
+
+   pool = mongoc_client_pool_new (uri);
+   mongoc_client_pool_set_error_api (pool, 2);
+   mongoc_client_pool_set_appname (pool, "mongoc-import");
+   importer = mongoc_importer_new (pool, args[0], args[1], &opts);
+
+   if (reader) {
+      ret = mongoc_importer_import_reader (importer, reader, &reply, &error);
+   } else {
+      ret = mongoc_importer_import_json_reader (
+         importer, json_reader, &reply, &error);
+   }
+
+   if (bson_iter_init_find (&iter, &reply, "elapsedMS")) {
+      elapsed_ms = BSON_MAX (1, bson_iter_as_int64 (&iter));
+      bson_iter_init_find (&iter, &reply, "nDocuments");
+      count = bson_iter_int32 (&iter);
+      printf ("Parsed %d documents in %.3f seconds: %.0f documents/s",
+              count,
+              elapsed_ms / 1000.0,
+              count * 1000.0 / elapsed_ms);
+      bson_iter_init_find (&iter, &reply, "nBytes");
+      printf (", %.2f MB/s",
+              bson_iter_as_int64 (&iter) / 1000.0 / elapsed_ms);
+      bson_iter_init_find (&iter, &reply, "nBatches");
+      printf (", %d batches sent\n", bson_iter_int32 (&iter));
+   }
+
+   if (bson_iter_init_find (&iter, &reply, "nInserted")) {
+      printf ("Inserted %d documents\n", bson_iter_int32 (&iter));
+   }
+
+   if (bson_iter_init_find (&iter, &reply, "nWriteErrors") &&
+       bson_iter_int32 (&iter)) {
+      printf ("%d write errors\n", bson_iter_int32 (&iter));
+   }
+
+   if (!ret) {
+      fprintf (stderr, "Import failed: %s\n", error.message);
+   }
+
+   bson_destroy (&reply);
+   mongoc_importer_destroy (importer);
+   mongoc_client_pool_destroy (pool);
+   mongoc_uri_destroy (uri);
+   if (reader) {
+      bson_reader_destroy (reader);
+   } else {
+      bson_json_reader_destroy (json_reader);
+   }
+   bson_destroy (&opts);
+
+   mongoc_cleanup ();
+
+   return ret ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -36,6 +36,19 @@ future_client_command_simple (
 );
 
 
+future_t *
+future_client_command_pipeline (
+
+   mongoc_client_ptr client,
+   const_char_ptr db_name,
+   const_bson_ptr_ptr commands,
+   size_t n_commands,
+   const_mongoc_read_prefs_ptr read_prefs,
+   bson_ptr replies,
+   bson_error_ptr errors
+);
+
+
 future_t *
 future_client_command_with_opts (
 
@@ -251,6 +264,15 @@ future_cursor_next (
 );
 
 
+future_t *
+future_cursor_next_batch (
+
+   mongoc_cursor_ptr cursor,
+   const_bson_ptr_ptr batch,
+   uint32_ptr n_docs
+);
+
+
 future_t *
 future_client_get_database_names_with_opts (
 
@@ -140,6 +140,20 @@ future_value_get_uint32_t (future_value_t *future_value)
    return future_value->value.uint32_t_value;
 }
 
+void
+future_value_set_uint32_ptr (future_value_t *future_value, uint32_ptr value)
+{
+   future_value->type = future_value_uint32_ptr_type;
+   future_value->value.uint32_ptr_value = value;
+}
+
+uint32_ptr
+future_value_get_uint32_ptr (future_value_t *future_value)
+{
+   BSON_ASSERT (future_value->type == future_value_uint32_ptr_type);
+   return future_value->value.uint32_ptr_value;
+}
+
 void
 future_value_set_const_char_ptr (future_value_t *future_value, const_char_ptr value)
 {
@@ -22,6 +22,7 @@
 
 typedef char * char_ptr;
 typedef char ** char_ptr_ptr;
+typedef uint32_t * uint32_ptr;
 typedef const char * const_char_ptr;
 typedef bson_error_t * bson_error_ptr;
 typedef bson_t * bson_ptr;
@@ -59,6 +60,7 @@ typedef enum {
    future_value_size_t_type,
    future_value_ssize_t_type,
    future_value_uint32_t_type,
+   future_value_uint32_ptr_type,
    future_value_const_char_ptr_type,
    future_value_bson_error_ptr_type,
    future_value_bson_ptr_type,
@@ -104,6 +106,7 @@ typedef struct _future_value_t
       size_t size_t_value;
       ssize_t ssize_t_value;
       uint32_t uint32_t_value;
+      uint32_ptr uint32_ptr_value;
       const_char_ptr const_char_ptr_value;
       bson_error_ptr bson_error_ptr_value;
       bson_ptr bson_ptr_value;
@@ -221,6 +224,15 @@ uint32_t
 future_value_get_uint32_t (
    future_value_t *future_value);
 
+void
+future_value_set_uint32_ptr(
+   future_value_t *future_value,
+   uint32_ptr value);
+
+uint32_ptr
+future_value_get_uint32_ptr (
+   future_value_t *future_value);
+
 void
 future_value_set_const_char_ptr(
    future_value_t *future_value,
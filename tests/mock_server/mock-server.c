@@ -23,6 +23,10 @@
 #include "mongoc-thread-private.h"
 #include "mongoc-util-private.h"
 #include "mongoc-trace-private.h"
+#ifdef MONGOC_ENABLE_SSL_OPENSSL
+#include "mongoc-stream-tls-private.h"
+#include "mongoc-stream-tls-openssl-private.h"
+#endif
 #include "sync-queue.h"
 #include "mock-server.h"
 #include "../test-conveniences.h"
@@ -60,6 +64,11 @@ struct _mock_server_t {
    bool ssl;
    mongoc_ssl_opt_t ssl_opts;
 #endif
+
+#ifdef MONGOC_ENABLE_SSL_OPENSSL
+   /* one context for all connections, so clients can resume sessions */
+   SSL_CTX *openssl_ctx;
+#endif
 };
 
 
@@ -79,6 +88,7 @@ typedef struct {
    uint16_t client_port;
    mongoc_opcode_t request_opcode;
    mongoc_query_flags_t query_flags;
+   uint32_t opmsg_flags;
    int32_t response_to;
 } reply_t;
 
@@ -230,6 +240,94 @@ mock_mongos_new (int32_t max_wire_version)
 }
 
 
+/* acknowledge each insert command, failing documents with _id 3 or 7 */
+static bool
+insert_counts_responder (request_t *request, void *data)
+{
+   mock_insert_counts_t *counts = (mock_insert_counts_t *) data;
+   bson_string_t *errors;
+   char *reply_json;
+   bson_iter_t iter;
+   size_t i;
+   int n = 0;
+   int32_t id;
+
+   if (!request->is_command || strcmp (request->command_name, "insert")) {
+      return false;
+   }
+
+   errors = bson_string_new ("");
+   for (i = 1; i < request->docs.len; i++) {
+      ASSERT (bson_iter_init_find (
+         &iter, request_get_doc (request, (int) i), "_id"));
+      id = bson_iter_int32 (&iter);
+      if (id == 3 || id == 7) {
+         bson_string_append_printf (
+            errors,
+            "%s{'index': %d, 'code': 11000, 'errmsg': 'duplicate key'}",
+            errors->len ? ", " : "",
+            (int) i - 1);
+      } else {
+         n++;
+      }
+   }
+
+   mongoc_mutex_lock (&counts->mutex);
+   counts->n_commands++;
+   counts->n_documents += (int) request->docs.len - 1;
+   mongoc_mutex_unlock (&counts->mutex);
+
+   reply_json = bson_strdup_printf (
+      "{'ok': 1, 'n': %d, 'writeErrors': [%s]}", n, errors->str);
+   mock_server_replies_simple (request, reply_json);
+   request_destroy (request);
+   bson_free (reply_json);
+   bson_string_free (errors, true);
+
+   return true;
+}
+
+
+/*--------------------------------------------------------------------------
+ *
+ * mock_server_with_insert_counts --
+ *
+ *       A new mock_server_t that autoresponds to ismaster with
+ *       @max_write_batch_size, and to insert commands by failing any
+ *       document whose _id is 3 or 7 with a duplicate key error. Each
+ *       insert command and its documents are counted in @counts, whose
+ *       mutex the caller must initialize. Call mock_server_run to start
+ *       it, then mock_server_get_uri to connect.
+ *
+ * Returns:
+ *       A server you must mock_server_destroy.
+ *
+ * Side effects:
+ *       None.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+mock_server_t *
+mock_server_with_insert_counts (int32_t max_write_batch_size,
+                                mock_insert_counts_t *counts)
+{
+   mock_server_t *server = mock_server_new ();
+
+   mock_server_auto_ismaster (server,
+                              "{'ok': 1,"
+                              " 'ismaster': true,"
+                              " 'minWireVersion': 0,"
+                              " 'maxWireVersion': %d,"
+                              " 'maxWriteBatchSize': %d}",
+                              WIRE_VERSION_OP_MSG,
+                              max_write_batch_size);
+   mock_server_autoresponds (server, insert_counts_responder, counts, NULL);
+
+   return server;
+}
+
+
 static bool
 hangup (request_t *request, void *ctx)
 {
@@ -288,6 +386,11 @@ mock_server_set_ssl_opts (mock_server_t *server, mongoc_ssl_opt_t *opts)
    mongoc_mutex_lock (&server->mutex);
    server->ssl = true;
    memcpy (&server->ssl_opts, opts, sizeof *opts);
+#ifdef MONGOC_ENABLE_SSL_OPENSSL
+   /* recreated from the new options on the next connection */
+   SSL_CTX_free (server->openssl_ctx);
+   server->openssl_ctx = NULL;
+#endif
    mongoc_mutex_unlock (&server->mutex);
 }
 
@@ -1503,6 +1606,9 @@ mock_server_destroy (mock_server_t *server)
    mongoc_cond_destroy (&server->cond);
    mongoc_mutex_destroy (&server->mutex);
    mongoc_socket_destroy (server->sock);
+#ifdef MONGOC_ENABLE_SSL_OPENSSL
+   SSL_CTX_free (server->openssl_ctx);
+#endif
    bson_free (server->uri_str);
    mongoc_uri_destroy (server->uri);
 
@@ -1589,8 +1695,24 @@ main_thread (void *data)
          mongoc_mutex_lock (&server->mutex);
          if (server->ssl) {
             server->ssl_opts.weak_cert_validation = 1;
+#ifdef MONGOC_ENABLE_SSL_OPENSSL
+            if (!server->openssl_ctx) {
+               server->openssl_ctx =
+                  mongoc_stream_tls_openssl_server_ctx_new (&server->ssl_opts);
+            }
+
+            client_stream =
+               mongoc_stream_tls_new_with_hostname_and_openssl_context (
+                  client_stream,
+                  NULL,
+                  &server->ssl_opts,
+                  0,
+                  server->openssl_ctx,
+                  NULL);
+#else
             client_stream = mongoc_stream_tls_new_with_hostname (
                client_stream, NULL, &server->ssl_opts, 0);
+#endif
             if (!client_stream) {
                mongoc_mutex_unlock (&server->mutex);
                perror ("Failed to attach tls stream");
@@ -1655,6 +1777,7 @@ worker_thread (void *data)
    mongoc_buffer_t buffer;
    mongoc_rpc_t *rpc = NULL;
    bool handled;
+   bool received;
    bson_error_t error;
    int32_t msg_len;
    sync_queue_t *requests;
@@ -1698,6 +1821,7 @@ again:
    /* loop, checking for requests to receive or replies to send */
    bson_free (rpc);
    rpc = NULL;
+   received = false;
 
    if (_mongoc_buffer_fill (&buffer, client_stream, 4, 10, &error) > 0) {
       BSON_ASSERT (buffer.len >= 4);
@@ -1757,13 +1881,22 @@ again:
          requests = mock_server_get_queue (server);
          q_put (requests, (void *) request);
       }
+
+      received = true;
    }
 
    if (_mock_server_stopping (server)) {
       GOTO (failure);
    }
 
-   reply = q_get (replies, 10);
+   /* don't stall after a request: it may have been sent with moreToCome and
+    * have no reply coming, and the client may already be sending the next */
+   if (received) {
+      reply = q_get_nowait (replies);
+   } else {
+      reply = q_get (replies, 10);
+   }
+
    if (reply) {
       _mock_server_reply_with_stream (server, reply, client_stream);
       _reply_destroy (reply);
@@ -1828,6 +1961,46 @@ mock_server_reply_multi (request_t *request,
 }
 
 
+/*--------------------------------------------------------------------------
+ *
+ * mock_server_replies_opmsg --
+ *
+ *       Respond to an OP_MSG request with @flags, e.g. MONGOC_MSG_MORE_TO_COME
+ *       to stream several replies to one request that allowed exhaust.
+ *
+ * Returns:
+ *       None.
+ *
+ * Side effects:
+ *       Sends an OP_MSG to the client.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+void
+mock_server_replies_opmsg (request_t *request,
+                           uint32_t flags,
+                           const bson_t *doc)
+{
+   reply_t *reply;
+
+   BSON_ASSERT (request);
+   BSON_ASSERT (request->request_rpc.header.opcode == MONGOC_OPCODE_MSG);
+
+   reply = bson_malloc0 (sizeof (reply_t));
+
+   reply->n_docs = 1;
+   reply->docs = bson_malloc0 (sizeof (bson_t));
+   bson_copy_to (doc, &reply->docs[0]);
+   reply->client_port = request_get_client_port (request);
+   reply->request_opcode = MONGOC_OPCODE_MSG;
+   reply->opmsg_flags = flags;
+   reply->response_to = request->request_rpc.header.request_id;
+
+   q_put (request->replies, reply);
+}
+
+
 static void
 _mock_server_reply_with_stream (mock_server_t *server,
                                 reply_t *reply,
@@ -1900,6 +2073,7 @@ _mock_server_reply_with_stream (mock_server_t *server,
 
    if (is_op_msg) {
       r.header.opcode = MONGOC_OPCODE_MSG;
+      r.msg.flags = reply->opmsg_flags;
       r.msg.n_sections = 1;
       /* we don't yet implement payload type 1, a document stream */
       r.msg.sections[0].payload_type = 0;
@@ -20,6 +20,7 @@
 #include <bson.h>
 
 #include "mongoc-uri.h"
+#include "mongoc-thread-private.h"
 
 #ifdef MONGOC_ENABLE_SSL
 #include "mongoc-ssl.h"
@@ -34,6 +35,14 @@ typedef bool (*autoresponder_t) (request_t *request, void *data);
 
 typedef void (*destructor_t) (void *data);
 
+/* insert commands and documents received by a server from
+ * mock_server_with_insert_counts */
+typedef struct {
+   mongoc_mutex_t mutex;
+   int n_commands;
+   int n_documents;
+} mock_insert_counts_t;
+
 mock_server_t *
 mock_server_new ();
 
@@ -43,6 +52,10 @@ mock_server_with_autoismaster (int32_t max_wire_version);
 mock_server_t *
 mock_mongos_new (int32_t max_wire_version);
 
+mock_server_t *
+mock_server_with_insert_counts (int32_t max_write_batch_size,
+                                mock_insert_counts_t *counts);
+
 mock_server_t *
 mock_server_down (void);
 
@@ -195,6 +208,11 @@ mock_server_reply_multi (request_t *request,
                          int n_docs,
                          int64_t cursor_id);
 
+void
+mock_server_replies_opmsg (request_t *request,
+                           uint32_t flags,
+                           const bson_t *doc);
+
 void
 mock_server_destroy (mock_server_t *server);
 
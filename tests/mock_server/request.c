@@ -1046,10 +1046,12 @@ request_from_op_msg (request_t *request, const mongoc_rpc_t *rpc)
          /* a sequence of BSON documents */
          bson_string_append (msg_as_str, section->payload.sequence.identifier);
          bson_string_append (msg_as_str, ": [");
-         parse_op_msg_doc (request,
-                           section->payload.sequence.bson_documents,
-                           section->payload.sequence.size,
-                           msg_as_str);
+         parse_op_msg_doc (
+            request,
+            section->payload.sequence.bson_documents,
+            section->payload.sequence.size - 4 -
+               (int32_t) strlen (section->payload.sequence.identifier) - 1,
+            msg_as_str);
          bson_string_append (msg_as_str, "]");
          break;
       default:
@@ -1110,3 +1110,34 @@ four_mb_string ()
    init_four_mb_string ();
    return gFourMBString;
 }
+
+
+/*--------------------------------------------------------------------------
+ *
+ * assert_error_count --
+ *
+ *       Check the length of a bulk operation reply's writeErrors.
+ *
+ * Returns:
+ *       None.
+ *
+ * Side effects:
+ *       Aborts if the array is the wrong length.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+void
+assert_error_count (int len, const bson_t *reply)
+{
+   bson_iter_t iter;
+   bson_iter_t error_iter;
+   int n = 0;
+
+   BSON_ASSERT (bson_iter_init_find (&iter, reply, "writeErrors"));
+   BSON_ASSERT (bson_iter_recurse (&iter, &error_iter));
+   while (bson_iter_next (&error_iter)) {
+      n++;
+   }
+   ASSERT_CMPINT (len, ==, n);
+}
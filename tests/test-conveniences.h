@@ -109,6 +109,9 @@ huge_string_length (mongoc_client_t *client);
 const char *
 four_mb_string ();
 
+void
+assert_error_count (int len, const bson_t *reply);
+
 #define ASSERT_MATCH(doc, ...)                                                 \
    do {                                                                        \
       BSON_ASSERT (                                                            \
@@ -43,6 +43,8 @@ test_buffer_install (TestSuite *suite);
 extern void
 test_bulk_install (TestSuite *suite);
 extern void
+test_bulk_writer_install (TestSuite *suite);
+extern void
 test_change_stream_install (TestSuite *suite);
 extern void
 test_client_install (TestSuite *suite);
@@ -89,6 +91,8 @@ test_matcher_install (TestSuite *suite);
 extern void
 test_handshake_install (TestSuite *suite);
 extern void
+test_importer_install (TestSuite *suite);
+extern void
 test_queue_install (TestSuite *suite);
 extern void
 test_read_concern_install (TestSuite *suite);
@@ -138,6 +142,8 @@ test_util_install (TestSuite *suite);
 extern void
 test_version_install (TestSuite *suite);
 extern void
+test_write_combiner_install (TestSuite *suite);
+extern void
 test_write_command_install (TestSuite *suite);
 extern void
 test_write_concern_install (TestSuite *suite);
@@ -2173,6 +2179,7 @@ main (int argc, char *argv[])
    test_client_pool_install (&suite);
    test_write_command_install (&suite);
    test_bulk_install (&suite);
+   test_bulk_writer_install (&suite);
    test_cluster_install (&suite);
    test_collection_install (&suite);
    test_collection_find_install (&suite);
@@ -2187,6 +2194,7 @@ main (int argc, char *argv[])
    test_gridfs_install (&suite);
    test_gridfs_file_page_install (&suite);
    test_handshake_install (&suite);
+   test_importer_install (&suite);
    test_linux_distro_scanner_install (&suite);
    test_list_install (&suite);
    test_log_install (&suite);
@@ -2218,6 +2226,7 @@ main (int argc, char *argv[])
    test_usleep_install (&suite);
    test_util_install (&suite);
    test_version_install (&suite);
+   test_write_combiner_install (&suite);
    test_write_concern_install (&suite);
 #ifdef MONGOC_ENABLE_SSL
    test_stream_tls_install (&suite);
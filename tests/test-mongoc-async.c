@@ -19,7 +19,8 @@ struct result {
 
 
 static void
-test_ismaster_helper (mongoc_async_cmd_result_t result,
+test_ismaster_helper (mongoc_async_cmd_t *acmd,
+                      mongoc_async_cmd_result_t result,
                       const bson_t *bson,
                       int64_t rtt_msec,
                       void *data,
@@ -174,10 +175,123 @@ test_ismaster_ssl (void)
 #endif
 
 
+struct delayed_result {
+   mongoc_async_cmd_result_t result;
+   int64_t initiated;
+   bool finished;
+};
+
+
+static mongoc_stream_t *
+test_delayed_initiator (mongoc_async_cmd_t *acmd)
+{
+   struct delayed_result *r = (struct delayed_result *) acmd->data;
+   uint16_t *port = (uint16_t *) acmd->initiate_ctx;
+   struct sockaddr_in server_addr = {0};
+   mongoc_socket_t *conn_sock;
+
+   r->initiated = bson_get_monotonic_time ();
+
+   if (!port) {
+      bson_set_error (&acmd->error,
+                      MONGOC_ERROR_STREAM,
+                      MONGOC_ERROR_STREAM_SOCKET,
+                      "no address");
+      return NULL;
+   }
+
+   conn_sock = mongoc_socket_new (AF_INET, SOCK_STREAM, 0);
+   BSON_ASSERT (conn_sock);
+
+   server_addr.sin_family = AF_INET;
+   server_addr.sin_port = htons (*port);
+   server_addr.sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+   mongoc_socket_connect (
+      conn_sock, (struct sockaddr *) &server_addr, sizeof (server_addr), 0);
+
+   return mongoc_stream_socket_new (conn_sock);
+}
+
+
+static void
+test_delayed_helper (mongoc_async_cmd_t *acmd,
+                     mongoc_async_cmd_result_t result,
+                     const bson_t *bson,
+                     int64_t rtt_msec,
+                     void *data,
+                     bson_error_t *error)
+{
+   struct delayed_result *r = (struct delayed_result *) data;
+
+   r->result = result;
+   r->finished = true;
+}
+
+
+/* delayed cmds connect once their delay passes, and own their streams */
+static void
+test_ismaster_delayed (void)
+{
+   mock_server_t *server;
+   mongoc_async_t *async;
+   uint16_t port;
+   struct delayed_result failed = {MONGOC_ASYNC_CMD_IN_PROGRESS};
+   struct delayed_result delayed = {MONGOC_ASYNC_CMD_IN_PROGRESS};
+   int64_t start;
+   bson_t q = BSON_INITIALIZER;
+
+   BSON_ASSERT (bson_append_int32 (&q, "isMaster", 8, 1));
+
+   server = mock_server_with_autoismaster (2);
+   port = mock_server_run (server);
+
+   async = mongoc_async_new ();
+
+   mongoc_async_cmd_new_delayed (async,
+                                 &test_delayed_initiator,
+                                 NULL,
+                                 0,
+                                 NULL,
+                                 NULL,
+                                 "admin",
+                                 &q,
+                                 &test_delayed_helper,
+                                 (void *) &failed,
+                                 TIMEOUT);
+
+   mongoc_async_cmd_new_delayed (async,
+                                 &test_delayed_initiator,
+                                 (void *) &port,
+                                 100,
+                                 NULL,
+                                 NULL,
+                                 "admin",
+                                 &q,
+                                 &test_delayed_helper,
+                                 (void *) &delayed,
+                                 TIMEOUT);
+
+   start = bson_get_monotonic_time ();
+   mongoc_async_run (async);
+
+   BSON_ASSERT (failed.finished);
+   ASSERT_CMPINT (failed.result, ==, MONGOC_ASYNC_CMD_ERROR);
+   BSON_ASSERT (delayed.finished);
+   ASSERT_CMPINT (delayed.result, ==, MONGOC_ASYNC_CMD_SUCCESS);
+   ASSERT_CMPINT64 (delayed.initiated - start, >=, (int64_t) 100 * 1000);
+
+   mongoc_async_destroy (async);
+   bson_destroy (&q);
+   mock_server_destroy (server);
+}
+
+
 void
 test_async_install (TestSuite *suite)
 {
    TestSuite_AddMockServerTest (suite, "/Async/ismaster", test_ismaster);
+   TestSuite_AddMockServerTest (
+      suite, "/Async/ismaster_delayed", test_ismaster_delayed);
 #if defined(MONGOC_ENABLE_SSL_OPENSSL)
    TestSuite_AddMockServerTest (
       suite, "/Async/ismaster_ssl", test_ismaster_ssl);
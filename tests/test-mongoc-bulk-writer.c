@@ -0,0 +1,201 @@
+#include <mongoc.h>
+#include <mongoc-thread-private.h>
+
+#include "TestSuite.h"
+#include "test-conveniences.h"
+#include "test-libmongoc.h"
+#include "mock_server/mock-server.h"
+
+
+/* full batches are sent while documents are added, and an ordered writer
+ * stops at the first error */
+static void
+test_bulk_writer_ordered (void)
+{
+   mock_insert_counts_t test = {0};
+   mock_server_t *server;
+   mongoc_client_t *client;
+   mongoc_collection_t *collection;
+   mongoc_bulk_writer_t *writer;
+   bson_t reply;
+   bson_error_t error;
+   int i;
+
+   mongoc_mutex_init (&test.mutex);
+   server = mock_server_with_insert_counts (2, &test);
+   mock_server_run (server);
+   client = mongoc_client_new_from_uri (mock_server_get_uri (server));
+   collection = mongoc_client_get_collection (client, "db", "collection");
+   writer = mongoc_bulk_writer_new (collection, NULL);
+
+   for (i = 0; i < 4; i++) {
+      ASSERT_OR_PRINT (mongoc_bulk_writer_insert (
+                          writer, tmp_bson ("{'_id': %d}", i), &error),
+                       error);
+   }
+
+   /* only the first batch is sent, the second is being filled */
+   ASSERT_CMPINT (test.n_commands, ==, 1);
+   ASSERT_CMPINT (test.n_documents, ==, 2);
+
+   /* sends [2, 3] and fails */
+   ASSERT (
+      !mongoc_bulk_writer_insert (writer, tmp_bson ("{'_id': 4}"), &error));
+   ASSERT_ERROR_CONTAINS (error,
+                          MONGOC_ERROR_COMMAND,
+                          MONGOC_ERROR_COMMAND_INVALID_ARG,
+                          "stopped by an error");
+   ASSERT (
+      !mongoc_bulk_writer_insert (writer, tmp_bson ("{'_id': 5}"), &error));
+
+   ASSERT (!mongoc_bulk_writer_finish (writer, &reply, &error));
+   ASSERT_ERROR_CONTAINS (error, MONGOC_ERROR_COMMAND, 11000, "");
+   ASSERT_MATCH (&reply,
+                 "{'nInserted': 3, 'writeErrors': [{'index': 3}]}");
+   assert_error_count (1, &reply);
+   ASSERT_CMPINT (test.n_commands, ==, 2);
+   bson_destroy (&reply);
+
+   ASSERT (!mongoc_bulk_writer_finish (writer, &reply, &error));
+   ASSERT_ERROR_CONTAINS (error,
+                          MONGOC_ERROR_COMMAND,
+                          MONGOC_ERROR_COMMAND_INVALID_ARG,
+                          "has been called");
+   bson_destroy (&reply);
+
+   mongoc_bulk_writer_destroy (writer);
+   mongoc_collection_destroy (collection);
+   mongoc_client_destroy (client);
+   mock_server_destroy (server);
+   mongoc_mutex_destroy (&test.mutex);
+}
+
+
+/* an unordered writer with a background thread inserts everything a JSON
+ * reader produces, and reports errors by the documents' positions */
+static void
+test_bulk_writer_unordered_json (void)
+{
+   mock_insert_counts_t test = {0};
+   mock_server_t *server;
+   mongoc_client_t *client;
+   mongoc_collection_t *collection;
+   mongoc_bulk_writer_t *writer;
+   bson_json_reader_t *reader;
+   bson_string_t *json;
+   bson_t reply;
+   bson_error_t error;
+   int i;
+
+   mongoc_mutex_init (&test.mutex);
+   server = mock_server_with_insert_counts (2, &test);
+   mock_server_run (server);
+   client = mongoc_client_new_from_uri (mock_server_get_uri (server));
+   collection = mongoc_client_get_collection (client, "db", "collection");
+   writer = mongoc_bulk_writer_new (
+      collection, tmp_bson ("{'ordered': false, 'maxInFlight': 2}"));
+
+   json = bson_string_new ("");
+   for (i = 0; i < 11; i++) {
+      bson_string_append_printf (json, "{\"_id\": %d}\n", i);
+   }
+
+   reader = bson_json_data_reader_new (true, 1024);
+   bson_json_data_reader_ingest (
+      reader, (const uint8_t *) json->str, json->len);
+
+   ASSERT_OR_PRINT (
+      mongoc_bulk_writer_insert_from_json_reader (writer, reader, &error),
+      error);
+
+   ASSERT (!mongoc_bulk_writer_finish (writer, &reply, &error));
+   ASSERT_MATCH (&reply,
+                 "{'nInserted': 9,"
+                 " 'writeErrors': [{'index': 3}, {'index': 7}]}");
+   assert_error_count (2, &reply);
+   ASSERT_CMPINT (test.n_commands, ==, 6);
+   ASSERT_CMPINT (test.n_documents, ==, 11);
+
+   bson_destroy (&reply);
+   bson_json_reader_destroy (reader);
+   bson_string_free (json, true);
+   mongoc_bulk_writer_destroy (writer);
+   mongoc_collection_destroy (collection);
+   mongoc_client_destroy (client);
+   mock_server_destroy (server);
+   mongoc_mutex_destroy (&test.mutex);
+}
+
+
+/* documents from a BSON reader, and invalid options */
+static void
+test_bulk_writer_reader (void)
+{
+   mock_insert_counts_t test = {0};
+   mock_server_t *server;
+   mongoc_client_t *client;
+   mongoc_collection_t *collection;
+   mongoc_bulk_writer_t *writer;
+   bson_reader_t *reader;
+   bson_writer_t *bson_writer;
+   uint8_t *buf = NULL;
+   size_t buflen = 0;
+   bson_t *doc;
+   bson_t reply;
+   bson_error_t error;
+   int i;
+
+   mongoc_mutex_init (&test.mutex);
+   server = mock_server_with_insert_counts (2, &test);
+   mock_server_run (server);
+   client = mongoc_client_new_from_uri (mock_server_get_uri (server));
+   collection = mongoc_client_get_collection (client, "db", "collection");
+
+   writer =
+      mongoc_bulk_writer_new (collection, tmp_bson ("{'maxInFlight': -1}"));
+   ASSERT (!mongoc_bulk_writer_insert (writer, tmp_bson ("{}"), &error));
+   ASSERT_ERROR_CONTAINS (error,
+                          MONGOC_ERROR_COMMAND,
+                          MONGOC_ERROR_COMMAND_INVALID_ARG,
+                          "Invalid maxInFlight");
+   mongoc_bulk_writer_destroy (writer);
+
+   bson_writer = bson_writer_new (&buf, &buflen, 0, bson_realloc_ctx, NULL);
+   for (i = 0; i < 3; i++) {
+      bson_writer_begin (bson_writer, &doc);
+      BSON_APPEND_INT32 (doc, "_id", i);
+      bson_writer_end (bson_writer);
+   }
+
+   reader =
+      bson_reader_new_from_data (buf, bson_writer_get_length (bson_writer));
+   writer =
+      mongoc_bulk_writer_new (collection, tmp_bson ("{'maxInFlight': 1}"));
+   ASSERT_OR_PRINT (
+      mongoc_bulk_writer_insert_from_reader (writer, reader, &error), error);
+   ASSERT_OR_PRINT (mongoc_bulk_writer_finish (writer, &reply, &error), error);
+   ASSERT_MATCH (&reply, "{'nInserted': 3}");
+   ASSERT_CMPINT (test.n_commands, ==, 2);
+
+   bson_destroy (&reply);
+   mongoc_bulk_writer_destroy (writer);
+   bson_reader_destroy (reader);
+   bson_writer_destroy (bson_writer);
+   bson_free (buf);
+   mongoc_collection_destroy (collection);
+   mongoc_client_destroy (client);
+   mock_server_destroy (server);
+   mongoc_mutex_destroy (&test.mutex);
+}
+
+
+void
+test_bulk_writer_install (TestSuite *suite)
+{
+   TestSuite_AddMockServerTest (
+      suite, "/BulkWriter/ordered", test_bulk_writer_ordered);
+   TestSuite_AddMockServerTest (
+      suite, "/BulkWriter/unordered_json", test_bulk_writer_unordered_json);
+   TestSuite_AddMockServerTest (
+      suite, "/BulkWriter/reader", test_bulk_writer_reader);
+}
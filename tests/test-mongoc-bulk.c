@@ -13,37 +13,6 @@
 #include "test-conveniences.h"
 #include "mock_server/mock-rs.h"
 
-/*--------------------------------------------------------------------------
- *
- * assert_error_count --
- *
- *       Check the length of a bulk operation reply's writeErrors.
- *
- * Returns:
- *       None.
- *
- * Side effects:
- *       Aborts if the array is the wrong length.
- *
- *--------------------------------------------------------------------------
- */
-
-static void
-assert_error_count (int len, const bson_t *reply)
-{
-   bson_iter_t iter;
-   bson_iter_t error_iter;
-   int n = 0;
-
-   BSON_ASSERT (bson_iter_init_find (&iter, reply, "writeErrors"));
-   BSON_ASSERT (bson_iter_recurse (&iter, &error_iter));
-   while (bson_iter_next (&error_iter)) {
-      n++;
-   }
-   ASSERT_CMPINT (len, ==, n);
-}
-
-
 /*--------------------------------------------------------------------------
  *
  * assert_n_inserted --
@@ -329,6 +298,520 @@ test_bulk_error_unordered (void)
    mongoc_client_destroy (client);
 }
 
+/* an unordered bulk sends interleaved operations in one command per type and
+ * reports errors and upserts by the operations' original indexes */
+static void
+test_bulk_unordered_coalesce (void)
+{
+   mock_server_t *server;
+   mongoc_client_t *client;
+   mongoc_collection_t *collection;
+   mongoc_bulk_operation_t *bulk;
+   bson_t *upsert = tmp_bson ("{'upsert': true}");
+   bson_t reply;
+   bson_error_t error;
+   request_t *request;
+   future_t *future;
+   int i;
+
+   server = mock_server_with_autoismaster (WIRE_VERSION_OP_MSG);
+   mock_server_run (server);
+   client = mongoc_client_new_from_uri (mock_server_get_uri (server));
+   collection = mongoc_client_get_collection (client, "db", "collection");
+   bulk = mongoc_collection_create_bulk_operation_with_opts (
+      collection, tmp_bson ("{'ordered': false}"));
+
+   for (i = 0; i < 6; i += 3) {
+      ASSERT_OR_PRINT (mongoc_bulk_operation_insert_with_opts (
+                          bulk, tmp_bson ("{'_id': %d}", i), NULL, &error),
+                       error);
+      ASSERT_OR_PRINT (
+         mongoc_bulk_operation_update_one_with_opts (
+            bulk,
+            tmp_bson ("{'_id': %d}", i + 1),
+            tmp_bson ("{'$set': {'x': 1}}"),
+            upsert,
+            &error),
+         error);
+      ASSERT_OR_PRINT (mongoc_bulk_operation_remove_one_with_opts (
+                          bulk, tmp_bson ("{'_id': %d}", i + 2), NULL, &error),
+                       error);
+   }
+
+   future = future_bulk_operation_execute (bulk, &reply, &error);
+
+   request = mock_server_receives_msg (server,
+                                       0,
+                                       tmp_bson ("{'insert': 'collection'}"),
+                                       tmp_bson ("{'_id': 0}"),
+                                       tmp_bson ("{'_id': 3}"));
+   mock_server_replies_simple (request,
+                               "{'ok': 1, 'n': 1, 'writeErrors': [{"
+                               "   'index': 1, 'code': 11000, 'errmsg': 'dup'"
+                               "}]}");
+   request_destroy (request);
+
+   request = mock_server_receives_msg (server,
+                                       0,
+                                       tmp_bson ("{'update': 'collection'}"),
+                                       tmp_bson ("{'q': {'_id': 1}}"),
+                                       tmp_bson ("{'q': {'_id': 4}}"));
+   mock_server_replies_simple (request,
+                               "{'ok': 1, 'n': 1, 'nModified': 0,"
+                               " 'upserted': [{'index': 1, '_id': 4}],"
+                               " 'writeErrors': [{"
+                               "   'index': 0, 'code': 2, 'errmsg': 'bad'"
+                               "}]}");
+   request_destroy (request);
+
+   request = mock_server_receives_msg (server,
+                                       0,
+                                       tmp_bson ("{'delete': 'collection'}"),
+                                       tmp_bson ("{'q': {'_id': 2}}"),
+                                       tmp_bson ("{'q': {'_id': 5}}"));
+   mock_server_replies_simple (request, "{'ok': 1, 'n': 2}");
+   request_destroy (request);
+
+   ASSERT (!future_get_uint32_t (future));
+   future_destroy (future);
+
+   ASSERT_MATCH (&reply,
+                 "{'nInserted': 1,"
+                 " 'nUpserted': 1,"
+                 " 'nRemoved':  2,"
+                 " 'upserted': [{'index': 4, '_id': 4}],"
+                 " 'writeErrors': [{'index': 1, 'code': 2},"
+                 "                 {'index': 3, 'code': 11000}]}");
+   assert_error_count (2, &reply);
+
+   bson_destroy (&reply);
+   mongoc_bulk_operation_destroy (bulk);
+   mongoc_collection_destroy (collection);
+   mongoc_client_destroy (client);
+   mock_server_destroy (server);
+}
+
+
+/* multi-document updates, and updates with collation, aren't sent with
+ * other updates */
+static void
+test_bulk_unordered_coalesce_compatible (void)
+{
+   mock_server_t *server;
+   mongoc_client_t *client;
+   mongoc_collection_t *collection;
+   mongoc_bulk_operation_t *bulk;
+   bson_t *update = tmp_bson ("{'$set': {'x': 1}}");
+   bson_t reply;
+   bson_error_t error;
+   request_t *request;
+   future_t *future;
+   int i;
+
+   server = mock_server_with_autoismaster (WIRE_VERSION_OP_MSG);
+   mock_server_run (server);
+   client = mongoc_client_new_from_uri (mock_server_get_uri (server));
+   collection = mongoc_client_get_collection (client, "db", "collection");
+   bulk = mongoc_collection_create_bulk_operation_with_opts (
+      collection, tmp_bson ("{'ordered': false}"));
+
+   for (i = 0; i < 6; i += 3) {
+      ASSERT_OR_PRINT (
+         mongoc_bulk_operation_update_one_with_opts (
+            bulk, tmp_bson ("{'_id': %d}", i), update, NULL, &error),
+         error);
+      ASSERT_OR_PRINT (
+         mongoc_bulk_operation_update_many_with_opts (
+            bulk, tmp_bson ("{'_id': %d}", i + 1), update, NULL, &error),
+         error);
+      ASSERT_OR_PRINT (mongoc_bulk_operation_update_one_with_opts (
+                          bulk,
+                          tmp_bson ("{'_id': %d}", i + 2),
+                          update,
+                          tmp_bson ("{'collation': {'locale': 'en_US'}}"),
+                          &error),
+                       error);
+   }
+
+   future = future_bulk_operation_execute (bulk, &reply, &error);
+
+   request = mock_server_receives_msg (server,
+                                       0,
+                                       tmp_bson ("{'update': 'collection'}"),
+                                       tmp_bson ("{'q': {'_id': 0}}"),
+                                       tmp_bson ("{'q': {'_id': 3}}"));
+   mock_server_replies_simple (request, "{'ok': 1, 'n': 2, 'nModified': 2}");
+   request_destroy (request);
+
+   request = mock_server_receives_msg (
+      server,
+      0,
+      tmp_bson ("{'update': 'collection'}"),
+      tmp_bson ("{'q': {'_id': 1}, 'multi': true}"),
+      tmp_bson ("{'q': {'_id': 4}, 'multi': true}"));
+   mock_server_replies_simple (request, "{'ok': 1, 'n': 2, 'nModified': 2}");
+   request_destroy (request);
+
+   request = mock_server_receives_msg (
+      server,
+      0,
+      tmp_bson ("{'update': 'collection'}"),
+      tmp_bson ("{'q': {'_id': 2}, 'collation': {'locale': 'en_US'}}"),
+      tmp_bson ("{'q': {'_id': 5}, 'collation': {'locale': 'en_US'}}"));
+   mock_server_replies_simple (request,
+                               "{'ok': 1, 'n': 1, 'nModified': 1,"
+                               " 'writeErrors': [{"
+                               "   'index': 1, 'code': 2, 'errmsg': 'bad'"
+                               "}]}");
+   request_destroy (request);
+
+   ASSERT (!future_get_uint32_t (future));
+   future_destroy (future);
+
+   ASSERT_MATCH (&reply,
+                 "{'nMatched': 5, 'nModified': 5,"
+                 " 'writeErrors': [{'index': 5, 'code': 2}]}");
+   assert_error_count (1, &reply);
+
+   bson_destroy (&reply);
+   mongoc_bulk_operation_destroy (bulk);
+   mongoc_collection_destroy (collection);
+   mongoc_client_destroy (client);
+   mock_server_destroy (server);
+}
+
+
+/* with resultDetail "counts" a bulk's reply has counts, and only the first
+ * write errors */
+static void
+test_bulk_result_detail_counts (void)
+{
+   mock_server_t *server;
+   mongoc_client_t *client;
+   mongoc_collection_t *collection;
+   mongoc_bulk_operation_t *bulk;
+   bson_string_t *reply_json;
+   bson_t reply;
+   bson_error_t error;
+   request_t *request;
+   future_t *future;
+   int i;
+
+   server = mock_server_with_autoismaster (WIRE_VERSION_OP_MSG);
+   mock_server_run (server);
+   client = mongoc_client_new_from_uri (mock_server_get_uri (server));
+   collection = mongoc_client_get_collection (client, "db", "collection");
+
+   bulk = mongoc_collection_create_bulk_operation_with_opts (
+      collection, tmp_bson ("{'resultDetail': 'none'}"));
+   ASSERT (!mongoc_bulk_operation_execute (bulk, &reply, &error));
+   ASSERT_ERROR_CONTAINS (error,
+                          MONGOC_ERROR_COMMAND,
+                          MONGOC_ERROR_COMMAND_INVALID_ARG,
+                          "Invalid resultDetail");
+   bson_destroy (&reply);
+   mongoc_bulk_operation_destroy (bulk);
+
+   bulk = mongoc_collection_create_bulk_operation_with_opts (
+      collection, tmp_bson ("{'ordered': false, 'resultDetail': 'counts'}"));
+
+   for (i = 0; i < 200; i++) {
+      ASSERT_OR_PRINT (mongoc_bulk_operation_insert_with_opts (
+                          bulk, tmp_bson ("{'_id': %d}", i), NULL, &error),
+                       error);
+   }
+
+   ASSERT_OR_PRINT (
+      mongoc_bulk_operation_update_one_with_opts (bulk,
+                                                  tmp_bson ("{'_id': 200}"),
+                                                  tmp_bson ("{'$set': {}}"),
+                                                  tmp_bson ("{'upsert': true}"),
+                                                  &error),
+      error);
+
+   future = future_bulk_operation_execute (bulk, &reply, &error);
+
+   /* the first 150 inserts fail */
+   reply_json = bson_string_new ("{'ok': 1, 'n': 50, 'writeErrors': [");
+   for (i = 0; i < 150; i++) {
+      bson_string_append_printf (reply_json,
+                                 "%s{'index': %d, 'code': 11000}",
+                                 i ? ", " : "",
+                                 i);
+   }
+
+   bson_string_append (reply_json, "]}");
+
+   request = mock_server_receives_request (server);
+   ASSERT_CMPSTR (request->command_name, "insert");
+   ASSERT_CMPSIZE_T (request->docs.len, ==, (size_t) 201);
+   mock_server_replies_simple (request, reply_json->str);
+   request_destroy (request);
+
+   request = mock_server_receives_msg (server,
+                                       0,
+                                       tmp_bson ("{'update': 'collection'}"),
+                                       tmp_bson ("{'q': {'_id': 200}}"));
+   mock_server_replies_simple (request,
+                               "{'ok': 1, 'n': 1, 'nModified': 0,"
+                               " 'upserted': [{'index': 0, '_id': 200}]}");
+   request_destroy (request);
+
+   ASSERT (!future_get_uint32_t (future));
+   future_destroy (future);
+
+   ASSERT_MATCH (&reply,
+                 "{'nInserted': 50,"
+                 " 'nUpserted': 1,"
+                 " 'upserted': {'$exists': false},"
+                 " 'nWriteErrors': 150}");
+   assert_error_count (MONGOC_WRITE_RESULT_MAX_ERRORS, &reply);
+   ASSERT_CMPINT (error.code, ==, 11000);
+
+   bson_string_free (reply_json, true);
+   bson_destroy (&reply);
+   mongoc_bulk_operation_destroy (bulk);
+   mongoc_collection_destroy (collection);
+   mongoc_client_destroy (client);
+   mock_server_destroy (server);
+}
+
+
+/* documents built in place are sent with the bulk's other inserts, with
+ * an _id added if they have none */
+static void
+test_bulk_insert_begin (void)
+{
+   mock_server_t *server;
+   mongoc_client_t *client;
+   mongoc_collection_t *collection;
+   mongoc_bulk_operation_t *bulk;
+   bson_t *document;
+   bson_t reply;
+   bson_error_t error;
+   request_t *request;
+   future_t *future;
+
+   server = mock_server_with_autoismaster (WIRE_VERSION_OP_MSG);
+   mock_server_run (server);
+   client = mongoc_client_new_from_uri (mock_server_get_uri (server));
+   collection = mongoc_client_get_collection (client, "db", "collection");
+   bulk = mongoc_collection_create_bulk_operation_with_opts (collection, NULL);
+
+   /* an invalid first document doesn't leave an empty command behind */
+   ASSERT_OR_PRINT (
+      mongoc_bulk_operation_insert_begin (bulk, NULL, &document, &error),
+      error);
+   BSON_APPEND_INT32 (document, "$bad", 1);
+   ASSERT (!mongoc_bulk_operation_insert_end (bulk, &error));
+   ASSERT_ERROR_CONTAINS (error,
+                          MONGOC_ERROR_COMMAND,
+                          MONGOC_ERROR_COMMAND_INVALID_ARG,
+                          "invalid document for insert");
+
+   ASSERT_OR_PRINT (
+      mongoc_bulk_operation_insert_begin (bulk, NULL, &document, &error),
+      error);
+   BSON_APPEND_INT32 (document, "_id", 1);
+   BSON_APPEND_UTF8 (document, "x", "a");
+   ASSERT_OR_PRINT (mongoc_bulk_operation_insert_end (bulk, &error), error);
+
+   /* can't begin twice, or add other operations before insert_end */
+   ASSERT_OR_PRINT (
+      mongoc_bulk_operation_insert_begin (bulk, NULL, &document, &error),
+      error);
+   ASSERT (
+      !mongoc_bulk_operation_insert_begin (bulk, NULL, &document, &error));
+   ASSERT_ERROR_CONTAINS (error,
+                          MONGOC_ERROR_COMMAND,
+                          MONGOC_ERROR_COMMAND_INVALID_ARG,
+                          "insert_end() must be called");
+   ASSERT (!mongoc_bulk_operation_insert_with_opts (
+      bulk, tmp_bson ("{'x': 'c'}"), NULL, &error));
+   ASSERT_ERROR_CONTAINS (error,
+                          MONGOC_ERROR_COMMAND,
+                          MONGOC_ERROR_COMMAND_INVALID_ARG,
+                          "insert_end() must be called");
+   ASSERT (!mongoc_bulk_operation_update_one_with_opts (
+      bulk, tmp_bson ("{}"), tmp_bson ("{'$set': {'x': 1}}"), NULL, &error));
+   ASSERT_ERROR_CONTAINS (error,
+                          MONGOC_ERROR_COMMAND,
+                          MONGOC_ERROR_COMMAND_INVALID_ARG,
+                          "insert_end() must be called");
+   ASSERT (!mongoc_bulk_operation_remove_one_with_opts (
+      bulk, tmp_bson ("{}"), NULL, &error));
+   ASSERT_ERROR_CONTAINS (error,
+                          MONGOC_ERROR_COMMAND,
+                          MONGOC_ERROR_COMMAND_INVALID_ARG,
+                          "insert_end() must be called");
+   BSON_APPEND_UTF8 (document, "x", "b");
+   ASSERT_OR_PRINT (mongoc_bulk_operation_insert_end (bulk, &error), error);
+
+   ASSERT_OR_PRINT (mongoc_bulk_operation_insert_with_opts (
+                       bulk, tmp_bson ("{'x': 'c'}"), NULL, &error),
+                    error);
+
+   ASSERT_OR_PRINT (
+      mongoc_bulk_operation_insert_begin (bulk, NULL, &document, &error),
+      error);
+   BSON_APPEND_UTF8 (document, "x", "d");
+   BSON_APPEND_UTF8 (document, "$bad", "d");
+   ASSERT (!mongoc_bulk_operation_insert_end (bulk, &error));
+
+   future = future_bulk_operation_execute (bulk, &reply, &error);
+   request = mock_server_receives_msg (
+      server,
+      0,
+      tmp_bson ("{'insert': 'collection'}"),
+      tmp_bson ("{'_id': 1, 'x': 'a'}"),
+      tmp_bson ("{'x': 'b', '_id': {'$exists': true}}"),
+      tmp_bson ("{'_id': {'$exists': true}, 'x': 'c'}"));
+   mock_server_replies_simple (request, "{'ok': 1, 'n': 3}");
+   request_destroy (request);
+
+   ASSERT_OR_PRINT (future_get_uint32_t (future), error);
+   future_destroy (future);
+   ASSERT_MATCH (&reply, "{'nInserted': 3}");
+
+   bson_destroy (&reply);
+   mongoc_bulk_operation_destroy (bulk);
+   mongoc_collection_destroy (collection);
+   mongoc_client_destroy (client);
+   mock_server_destroy (server);
+}
+
+
+typedef struct {
+   mongoc_mutex_t mutex;
+   int in_flight;
+   int max_in_flight;
+   int n_inserted;
+   int n_batches;
+} parallel_test_t;
+
+
+/* acknowledge inserts slowly, failing documents with _id 5 or 95 */
+static bool
+parallel_insert_responder (request_t *request, void *data)
+{
+   parallel_test_t *test = (parallel_test_t *) data;
+   bson_string_t *errors;
+   char *reply_json;
+   bson_iter_t iter;
+   size_t i;
+   int n = 0;
+   int32_t id;
+
+   if (!request->is_command || strcmp (request->command_name, "insert")) {
+      return false;
+   }
+
+   mongoc_mutex_lock (&test->mutex);
+   test->in_flight++;
+   test->max_in_flight = BSON_MAX (test->max_in_flight, test->in_flight);
+   mongoc_mutex_unlock (&test->mutex);
+
+   _mongoc_usleep (50 * 1000);
+
+   errors = bson_string_new ("");
+   for (i = 1; i < request->docs.len; i++) {
+      ASSERT (bson_iter_init_find (
+         &iter, request_get_doc (request, (int) i), "_id"));
+      id = bson_iter_int32 (&iter);
+      if (id == 5 || id == 95) {
+         bson_string_append_printf (errors,
+                                    "%s{'index': %d, 'code': 11000}",
+                                    errors->len ? ", " : "",
+                                    (int) i - 1);
+      } else {
+         n++;
+      }
+   }
+
+   mongoc_mutex_lock (&test->mutex);
+   test->in_flight--;
+   test->n_inserted += n;
+   test->n_batches++;
+   mongoc_mutex_unlock (&test->mutex);
+
+   reply_json = bson_strdup_printf (
+      "{'ok': 1, 'n': %d, 'writeErrors': [%s]}", n, errors->str);
+   mock_server_replies_simple (request, reply_json);
+   request_destroy (request);
+   bson_free (reply_json);
+   bson_string_free (errors, true);
+
+   return true;
+}
+
+
+/* an unordered bulk's batches are sent on several pooled connections at
+ * once, no more than the caller allows */
+static void
+test_bulk_execute_parallel (void)
+{
+   parallel_test_t test = {0};
+   mock_server_t *server;
+   mongoc_client_pool_t *pool;
+   mongoc_client_t *client;
+   mongoc_collection_t *collection;
+   mongoc_bulk_operation_t *bulk;
+   bson_t reply;
+   bson_error_t error;
+   int i;
+
+   mongoc_mutex_init (&test.mutex);
+   server = mock_server_new ();
+   mock_server_auto_ismaster (server,
+                              "{'ok': 1,"
+                              " 'ismaster': true,"
+                              " 'minWireVersion': 0,"
+                              " 'maxWireVersion': %d,"
+                              " 'maxWriteBatchSize': 10}",
+                              WIRE_VERSION_OP_MSG);
+   mock_server_autoresponds (server, parallel_insert_responder, &test, NULL);
+   mock_server_run (server);
+
+   pool = mongoc_client_pool_new (mock_server_get_uri (server));
+   client = mongoc_client_pool_pop (pool);
+   collection = mongoc_client_get_collection (client, "db", "collection");
+   bulk = mongoc_collection_create_bulk_operation_with_opts (
+      collection, tmp_bson ("{'ordered': false}"));
+
+   for (i = 0; i < 100; i++) {
+      ASSERT_OR_PRINT (mongoc_bulk_operation_insert_with_opts (
+                          bulk, tmp_bson ("{'_id': %d}", i), NULL, &error),
+                       error);
+   }
+
+   ASSERT (!mongoc_bulk_operation_execute_parallel (
+      bulk, pool, 3, &reply, &error));
+   ASSERT_ERROR_CONTAINS (error,
+                          MONGOC_ERROR_COMMAND,
+                          11000,
+                          "Multiple write errors");
+
+   ASSERT_CMPINT (test.n_batches, ==, 10);
+   ASSERT_CMPINT (test.n_inserted, ==, 98);
+   ASSERT_CMPINT (test.max_in_flight, >, 1);
+   ASSERT_CMPINT (test.max_in_flight, <=, 3);
+
+   ASSERT_MATCH (&reply,
+                 "{'nInserted': 98,"
+                 " 'writeErrors': [{'index': 5, 'code': 11000},"
+                 "                 {'index': 95, 'code': 11000}]}");
+   assert_error_count (2, &reply);
+
+   bson_destroy (&reply);
+   mongoc_bulk_operation_destroy (bulk);
+   mongoc_collection_destroy (collection);
+   mongoc_client_pool_push (pool, client);
+   mongoc_client_pool_destroy (pool);
+   mock_server_destroy (server);
+   mongoc_mutex_destroy (&test.mutex);
+}
+
+
 static void
 test_insert (bool ordered)
 {
@@ -4141,6 +4624,19 @@ test_bulk_install (TestSuite *suite)
    TestSuite_AddMockServerTest (suite, "/BulkOperation/error", test_bulk_error);
    TestSuite_AddMockServerTest (
       suite, "/BulkOperation/error/unordered", test_bulk_error_unordered);
+   TestSuite_AddMockServerTest (suite,
+                                "/BulkOperation/unordered/coalesce",
+                                test_bulk_unordered_coalesce);
+   TestSuite_AddMockServerTest (suite,
+                                "/BulkOperation/unordered/coalesce/compatible",
+                                test_bulk_unordered_coalesce_compatible);
+   TestSuite_AddMockServerTest (
+      suite, "/BulkOperation/execute_parallel", test_bulk_execute_parallel);
+   TestSuite_AddMockServerTest (
+      suite, "/BulkOperation/insert_begin", test_bulk_insert_begin);
+   TestSuite_AddMockServerTest (suite,
+                                "/BulkOperation/result_detail/counts",
+                                test_bulk_result_detail_counts);
    TestSuite_AddLive (
       suite, "/BulkOperation/insert_ordered", test_insert_ordered);
    TestSuite_AddLive (
@@ -1,10 +1,13 @@
 #include <mongoc.h>
 #include "mongoc-client-pool-private.h"
+#include "mongoc-client-private.h"
 #include "mongoc-util-private.h"
+#include "mongoc-thread-private.h"
 
 
 #include "TestSuite.h"
 #include "test-libmongoc.h"
+#include "mock_server/mock-server.h"
 
 
 static void
@@ -282,6 +285,261 @@ test_mongoc_client_pool_handshake (void)
    mongoc_client_pool_destroy (pool);
 }
 
+
+static bool
+_client_is_connected (mongoc_client_t *client)
+{
+   return mongoc_set_get (client->cluster.nodes, 1) != NULL;
+}
+
+
+static void
+test_mongoc_client_pool_prewarm (void)
+{
+   mock_server_t *server;
+   mongoc_uri_t *uri;
+   mongoc_client_pool_t *pool;
+   mongoc_client_t *clients[3];
+   int i;
+
+   server = mock_server_with_autoismaster (WIRE_VERSION_MIN);
+   mock_server_run (server);
+   uri = mongoc_uri_copy (mock_server_get_uri (server));
+   capture_logs (true);
+   mongoc_uri_set_option_as_int32 (uri, MONGOC_URI_MINPOOLSIZE, 3);
+   pool = mongoc_client_pool_new (uri);
+
+   mongoc_client_pool_set_prewarm (pool, true);
+   WAIT_UNTIL (mongoc_client_pool_num_pushed (pool) == 3);
+   ASSERT_CMPSIZE_T (mongoc_client_pool_get_size (pool), ==, (size_t) 3);
+
+   /* each client connected in the background, not on first use */
+   for (i = 0; i < 3; i++) {
+      clients[i] = mongoc_client_pool_pop (pool);
+      BSON_ASSERT (_client_is_connected (clients[i]));
+   }
+
+   ASSERT_CMPSIZE_T (mongoc_client_pool_get_size (pool), ==, (size_t) 3);
+
+   for (i = 0; i < 3; i++) {
+      mongoc_client_pool_push (pool, clients[i]);
+   }
+
+   mongoc_client_pool_destroy (pool);
+   mongoc_uri_destroy (uri);
+   mock_server_destroy (server);
+}
+
+
+static void
+test_mongoc_client_pool_prewarm_refill (void)
+{
+   mock_server_t *server;
+   mongoc_uri_t *uri;
+   mongoc_client_pool_t *pool;
+   mongoc_client_t *client;
+
+   server = mock_server_with_autoismaster (WIRE_VERSION_MIN);
+   mock_server_run (server);
+   uri = mongoc_uri_copy (mock_server_get_uri (server));
+   capture_logs (true);
+   mongoc_uri_set_option_as_int32 (uri, MONGOC_URI_MINPOOLSIZE, 1);
+   mongoc_uri_set_option_as_int32 (uri, MONGOC_URI_MAXPOOLSIZE, 1);
+   pool = mongoc_client_pool_new (uri);
+
+   mongoc_client_pool_set_prewarm (pool, true);
+   WAIT_UNTIL (mongoc_client_pool_num_pushed (pool) == 1);
+
+   client = mongoc_client_pool_pop (pool);
+   BSON_ASSERT (_client_is_connected (client));
+   mongoc_cluster_disconnect_node (&client->cluster, 1, false, NULL);
+   BSON_ASSERT (!_client_is_connected (client));
+
+   /* the pool reconnects it before handing it out again */
+   mongoc_client_pool_push (pool, client);
+   BSON_ASSERT (mongoc_client_pool_pop (pool) == client);
+   BSON_ASSERT (_client_is_connected (client));
+   BSON_ASSERT (!client->cluster.node_disconnected);
+
+   mongoc_client_pool_push (pool, client);
+   mongoc_client_pool_destroy (pool);
+   mongoc_uri_destroy (uri);
+   mock_server_destroy (server);
+}
+
+
+#define POOL_THREADS_MAX 256
+
+typedef struct {
+   mongoc_client_pool_t *pool;
+   int loops;
+   bool check;
+   mongoc_mutex_t mutex;
+   mongoc_cond_t cond;
+   bool go;
+   mongoc_client_t *held[POOL_THREADS_MAX];
+   int n_held;
+} pool_threads_ctx_t;
+
+
+static void
+_pool_threads_hold (pool_threads_ctx_t *ctx, mongoc_client_t *client)
+{
+   int i;
+
+   mongoc_mutex_lock (&ctx->mutex);
+   for (i = 0; i < ctx->n_held; i++) {
+      /* no two threads hold the same client */
+      BSON_ASSERT (ctx->held[i] != client);
+   }
+
+   ctx->held[ctx->n_held++] = client;
+   mongoc_mutex_unlock (&ctx->mutex);
+}
+
+
+static void
+_pool_threads_release (pool_threads_ctx_t *ctx, mongoc_client_t *client)
+{
+   int i;
+
+   mongoc_mutex_lock (&ctx->mutex);
+   for (i = 0; i < ctx->n_held; i++) {
+      if (ctx->held[i] == client) {
+         ctx->held[i] = ctx->held[--ctx->n_held];
+         break;
+      }
+   }
+
+   mongoc_mutex_unlock (&ctx->mutex);
+}
+
+
+static void *
+_pool_threads_worker (void *data)
+{
+   pool_threads_ctx_t *ctx = (pool_threads_ctx_t *) data;
+   mongoc_client_t *client;
+   int i;
+
+   /* start all threads together */
+   mongoc_mutex_lock (&ctx->mutex);
+   while (!ctx->go) {
+      mongoc_cond_wait (&ctx->cond, &ctx->mutex);
+   }
+
+   mongoc_mutex_unlock (&ctx->mutex);
+
+   for (i = 0; i < ctx->loops; i++) {
+      client = mongoc_client_pool_pop (ctx->pool);
+      BSON_ASSERT (client);
+
+      if (ctx->check) {
+         _pool_threads_hold (ctx, client);
+         _pool_threads_release (ctx, client);
+      }
+
+      mongoc_client_pool_push (ctx->pool, client);
+   }
+
+   return NULL;
+}
+
+
+/* returns the elapsed microseconds */
+static int64_t
+_pool_threads_run (mongoc_client_pool_t *pool,
+                   int n_threads,
+                   int loops,
+                   bool check)
+{
+   pool_threads_ctx_t ctx = {0};
+   mongoc_thread_t threads[POOL_THREADS_MAX];
+   int64_t start;
+   int i;
+
+   BSON_ASSERT (n_threads <= POOL_THREADS_MAX);
+
+   ctx.pool = pool;
+   ctx.loops = loops;
+   ctx.check = check;
+   mongoc_mutex_init (&ctx.mutex);
+   mongoc_cond_init (&ctx.cond);
+
+   for (i = 0; i < n_threads; i++) {
+      BSON_ASSERT (!mongoc_thread_create (
+         &threads[i], _pool_threads_worker, (void *) &ctx));
+   }
+
+   mongoc_mutex_lock (&ctx.mutex);
+   ctx.go = true;
+   start = bson_get_monotonic_time ();
+   mongoc_cond_broadcast (&ctx.cond);
+   mongoc_mutex_unlock (&ctx.mutex);
+
+   for (i = 0; i < n_threads; i++) {
+      mongoc_thread_join (threads[i]);
+   }
+
+   mongoc_cond_destroy (&ctx.cond);
+   mongoc_mutex_destroy (&ctx.mutex);
+
+   return bson_get_monotonic_time () - start;
+}
+
+
+/* many threads share a few clients */
+static void
+test_mongoc_client_pool_threads (void)
+{
+   mongoc_client_pool_t *pool;
+   mongoc_uri_t *uri;
+
+   uri = mongoc_uri_new ("mongodb://127.0.0.1/?maxpoolsize=4");
+   pool = mongoc_client_pool_new (uri);
+
+   _pool_threads_run (pool, 16, 1000, true /* check */);
+
+   ASSERT_CMPSIZE_T (mongoc_client_pool_get_size (pool), <=, (size_t) 4);
+   ASSERT_CMPSIZE_T (mongoc_client_pool_num_pushed (pool),
+                     ==,
+                     mongoc_client_pool_get_size (pool));
+
+   mongoc_client_pool_destroy (pool);
+   mongoc_uri_destroy (uri);
+}
+
+
+#define POOL_BENCHMARK_OPS 2000000
+
+static void
+test_mongoc_client_pool_benchmark (void *ctx)
+{
+   mongoc_client_pool_t *pool;
+   mongoc_uri_t *uri;
+   int n_threads;
+   int64_t elapsed;
+
+   for (n_threads = 1; n_threads <= POOL_THREADS_MAX; n_threads *= 2) {
+      uri = mongoc_uri_new ("mongodb://127.0.0.1/?maxpoolsize=100");
+      pool = mongoc_client_pool_new (uri);
+
+      elapsed = _pool_threads_run (
+         pool, n_threads, POOL_BENCHMARK_OPS / n_threads, false /* check */);
+
+      if (test_suite_debug_output ()) {
+         printf ("      %3d threads: %.0f pop/push per second\n",
+                 n_threads,
+                 POOL_BENCHMARK_OPS * 1e6 / (double) BSON_MAX (elapsed, 1));
+         fflush (stdout);
+      }
+
+      mongoc_client_pool_destroy (pool);
+      mongoc_uri_destroy (uri);
+   }
+}
+
+
 void
 test_client_pool_install (TestSuite *suite)
 {
@@ -301,6 +559,19 @@ test_client_pool_install (TestSuite *suite)
 
    TestSuite_Add (
       suite, "/ClientPool/handshake", test_mongoc_client_pool_handshake);
+   TestSuite_AddMockServerTest (
+      suite, "/ClientPool/prewarm", test_mongoc_client_pool_prewarm);
+   TestSuite_AddMockServerTest (suite,
+                                "/ClientPool/prewarm/refill",
+                                test_mongoc_client_pool_prewarm_refill);
+   TestSuite_Add (
+      suite, "/ClientPool/threads", test_mongoc_client_pool_threads);
+   TestSuite_AddFull (suite,
+                      "/ClientPool/benchmark",
+                      test_mongoc_client_pool_benchmark,
+                      NULL,
+                      NULL,
+                      test_framework_skip_if_slow);
 
 #ifndef MONGOC_ENABLE_SSL
    TestSuite_Add (
@@ -10,6 +10,12 @@
 
 #include "mongoc-handshake-private.h"
 
+#ifdef MONGOC_ENABLE_SSL_OPENSSL
+#include "mongoc-stream-private.h"
+#include "mongoc-stream-tls-private.h"
+#include "mongoc-stream-tls-openssl-private.h"
+#endif
+
 #include "TestSuite.h"
 #include "test-conveniences.h"
 #include "test-libmongoc.h"
@@ -2960,6 +2966,171 @@ test_ssl_reconnect_pooled (void)
 #endif /* OpenSSL or Secure Transport */
 
 
+#ifdef MONGOC_ENABLE_SSL_OPENSSL
+/* the SSL object of the TLS stream in a stack of streams */
+static SSL *
+_tls_stream_ssl (mongoc_stream_t *stream)
+{
+   mongoc_stream_tls_openssl_t *openssl;
+   SSL *ssl;
+
+   while (stream->type != MONGOC_STREAM_TLS) {
+      stream = mongoc_stream_get_base_stream (stream);
+   }
+
+   openssl =
+      (mongoc_stream_tls_openssl_t *) ((mongoc_stream_tls_t *) stream)->ctx;
+   BIO_get_ssl (openssl->bio, &ssl);
+
+   return ssl;
+}
+
+
+/* every TLS stream for the same ssl opts uses one SSL_CTX */
+static void
+_test_ssl_shared_context (bool pooled)
+{
+   mongoc_ssl_opt_t client_opts = {0};
+   mongoc_uri_t *uri;
+   mongoc_client_pool_t *pool = NULL;
+   mongoc_client_t *client;
+   mongoc_client_t *client2 = NULL;
+   SSL_CTX *ssl_ctx;
+   mongoc_stream_t *streams[2];
+   int i;
+
+   client_opts.ca_file = CERT_CA;
+   uri = mongoc_uri_new ("mongodb://localhost");
+
+   if (pooled) {
+      pool = mongoc_client_pool_new (uri);
+      mongoc_client_pool_set_ssl_opts (pool, &client_opts);
+      client = mongoc_client_pool_pop (pool);
+      client2 = mongoc_client_pool_pop (pool);
+      ASSERT (client2->topology->scanner->openssl_ctx ==
+              client->topology->scanner->openssl_ctx);
+   } else {
+      client = mongoc_client_new_from_uri (uri);
+      mongoc_client_set_ssl_opts (client, &client_opts);
+   }
+
+   ssl_ctx = client->topology->scanner->openssl_ctx;
+   ASSERT (ssl_ctx);
+
+   for (i = 0; i < 2; i++) {
+      streams[i] = mongoc_stream_tls_new_with_hostname_and_openssl_context (
+         mongoc_stream_socket_new (mongoc_socket_new (AF_INET, SOCK_STREAM, 0)),
+         "localhost",
+         &client->ssl_opts,
+         1,
+         ssl_ctx,
+         NULL);
+      ASSERT (streams[i]);
+      ASSERT (SSL_get_SSL_CTX (_tls_stream_ssl (streams[i])) == ssl_ctx);
+   }
+
+   /* streams hold their own references */
+   for (i = 0; i < 2; i++) {
+      mongoc_stream_destroy (streams[i]);
+   }
+
+   ASSERT (SSL_CTX_get_verify_mode (ssl_ctx) == SSL_VERIFY_PEER);
+
+   if (pooled) {
+      mongoc_client_pool_push (pool, client2);
+      mongoc_client_pool_push (pool, client);
+      mongoc_client_pool_destroy (pool);
+   } else {
+      mongoc_client_destroy (client);
+   }
+
+   mongoc_uri_destroy (uri);
+}
+
+
+static void
+test_ssl_shared_context_single (void)
+{
+   _test_ssl_shared_context (false);
+}
+
+
+static void
+test_ssl_shared_context_pooled (void)
+{
+   _test_ssl_shared_context (true);
+}
+
+
+static void
+_test_ssl_session_resumption (bool resume)
+{
+   mongoc_uri_t *uri;
+   mock_server_t *server;
+   mongoc_ssl_opt_t client_opts = {0};
+   mongoc_ssl_opt_t server_opts = {0};
+   mongoc_client_t *client;
+   mongoc_server_stream_t *server_stream;
+   bson_error_t error;
+
+   client_opts.ca_file = CERT_CA;
+
+   server_opts.weak_cert_validation = true;
+   server_opts.ca_file = CERT_CA;
+   server_opts.pem_file = CERT_SERVER;
+
+   server = mock_server_with_autoismaster (WIRE_VERSION_MIN);
+   mock_server_set_ssl_opts (server, &server_opts);
+   mock_server_run (server);
+
+   uri = mongoc_uri_copy (mock_server_get_uri (server));
+   if (!resume) {
+      mongoc_uri_set_option_as_bool (
+         uri, MONGOC_URI_SSLSESSIONRESUMPTION, false);
+   }
+
+   client = mongoc_client_new_from_uri (uri);
+   mongoc_client_set_ssl_opts (client, &client_opts);
+
+   ASSERT_OR_PRINT (_cmd (server, client, true /* server replies */, &error),
+                    error);
+
+   /* reconnect */
+   mongoc_cluster_disconnect_node (&client->cluster, 1, false, NULL);
+   ASSERT_OR_PRINT (_cmd (server, client, true /* server replies */, &error),
+                    error);
+
+   server_stream =
+      mongoc_cluster_stream_for_server (&client->cluster, 1, true, &error);
+   ASSERT_OR_PRINT (server_stream, error);
+
+   ASSERT_CMPINT (
+      (int) SSL_session_reused (_tls_stream_ssl (server_stream->stream)),
+      ==,
+      (int) resume);
+
+   mongoc_server_stream_cleanup (server_stream);
+   mongoc_client_destroy (client);
+   mock_server_destroy (server);
+   mongoc_uri_destroy (uri);
+}
+
+
+static void
+test_ssl_session_resumption (void)
+{
+   _test_ssl_session_resumption (true);
+}
+
+
+static void
+test_ssl_session_resumption_disabled (void)
+{
+   _test_ssl_session_resumption (false);
+}
+#endif
+
+
 static void
 test_mongoc_client_application_handshake (void)
 {
@@ -3593,6 +3764,19 @@ test_client_install (TestSuite *suite)
    TestSuite_AddMockServerTest (
       suite, "/Client/ssl/reconnect/pooled", test_ssl_reconnect_pooled);
 #endif
+#ifdef MONGOC_ENABLE_SSL_OPENSSL
+   TestSuite_Add (suite,
+                  "/Client/ssl/shared_context/single",
+                  test_ssl_shared_context_single);
+   TestSuite_Add (suite,
+                  "/Client/ssl/shared_context/pooled",
+                  test_ssl_shared_context_pooled);
+   TestSuite_AddMockServerTest (
+      suite, "/Client/ssl/session_resumption", test_ssl_session_resumption);
+   TestSuite_AddMockServerTest (suite,
+                                "/Client/ssl/session_resumption/disabled",
+                                test_ssl_session_resumption_disabled);
+#endif
 #else
    /* No SSL support at all */
    TestSuite_Add (
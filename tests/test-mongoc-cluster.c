@@ -1,6 +1,7 @@
 #include <mongoc-util-private.h>
 #include <mongoc.h>
 
+#include "mongoc-b64-private.h"
 #include "mongoc-client-private.h"
 #include "mongoc-uri-private.h"
 
@@ -1335,6 +1336,362 @@ dollar_query_test_t tests[] = {
    {NULL}};
 
 
+static void
+test_cluster_pipeline_op_msg (void)
+{
+   mock_server_t *server;
+   mongoc_client_t *client;
+   const bson_t *commands[3];
+   bson_t replies[3];
+   bson_error_t pipeline_errors[3];
+   future_t *future;
+   request_t *requests[3];
+   int i;
+
+   server = mock_server_with_autoismaster (WIRE_VERSION_OP_MSG);
+   mock_server_run (server);
+   client = mongoc_client_new_from_uri (mock_server_get_uri (server));
+
+   commands[0] = tmp_bson ("{'count': 'a'}");
+   commands[1] = tmp_bson ("{'count': 'b'}");
+   commands[2] = tmp_bson ("{'count': 'c'}");
+
+   future = future_client_command_pipeline (
+      client, "db", commands, 3, NULL, replies, pipeline_errors);
+
+   /* all commands arrive before the server answers any of them */
+   requests[0] = mock_server_receives_msg (
+      server, 0, tmp_bson ("{'count': 'a', '$db': 'db'}"));
+   requests[1] = mock_server_receives_msg (
+      server, 0, tmp_bson ("{'count': 'b', '$db': 'db'}"));
+   requests[2] = mock_server_receives_msg (
+      server, 0, tmp_bson ("{'count': 'c', '$db': 'db'}"));
+
+   /* answer out of order, replies are matched by responseTo */
+   mock_server_replies_simple (requests[2], "{'ok': 1, 'n': 3}");
+   mock_server_replies_simple (requests[0], "{'ok': 1, 'n': 1}");
+   mock_server_replies_simple (requests[1],
+                               "{'ok': 0, 'code': 42, 'errmsg': 'bad'}");
+
+   BSON_ASSERT (!future_get_bool (future));
+   ASSERT_MATCH (&replies[0], "{'ok': 1, 'n': 1}");
+   ASSERT_MATCH (&replies[1], "{'ok': 0, 'code': 42}");
+   ASSERT_MATCH (&replies[2], "{'ok': 1, 'n': 3}");
+   ASSERT_ERROR_CONTAINS (pipeline_errors[1], MONGOC_ERROR_QUERY, 42, "bad");
+
+   for (i = 0; i < 3; i++) {
+      request_destroy (requests[i]);
+      bson_destroy (&replies[i]);
+   }
+
+   future_destroy (future);
+   mongoc_client_destroy (client);
+   mock_server_destroy (server);
+}
+
+
+/* more commands than fit in the pipeline window */
+static void
+test_cluster_pipeline_window (void)
+{
+   mock_server_t *server;
+   mongoc_client_t *client;
+   const bson_t *commands[20];
+   bson_t replies[20];
+   future_t *future;
+   request_t *requests[20];
+   char *reply_json;
+   int i;
+
+   server = mock_server_with_autoismaster (WIRE_VERSION_OP_MSG);
+   mock_server_run (server);
+   client = mongoc_client_new_from_uri (mock_server_get_uri (server));
+
+   for (i = 0; i < 20; i++) {
+      commands[i] =
+         tmp_bson ("{'find': 'collection', 'filter': {'_id': %d}}", i);
+   }
+
+   future = future_client_command_pipeline (
+      client, "db", commands, 20, NULL, replies, NULL);
+
+   for (i = 0; i < 16; i++) {
+      requests[i] = mock_server_receives_msg (
+         server,
+         0,
+         tmp_bson ("{'find': 'collection', 'filter': {'_id': %d}}", i));
+   }
+
+   /* each reply opens the window for one more command */
+   for (i = 0; i < 20; i++) {
+      reply_json = bson_strdup_printf (
+         "{'ok': 1, 'cursor': {'id': 0, 'ns': 'db.collection',"
+         "                     'firstBatch': [{'_id': %d}]}}",
+         i);
+      mock_server_replies_simple (requests[i], reply_json);
+      bson_free (reply_json);
+      request_destroy (requests[i]);
+
+      if (i + 16 < 20) {
+         requests[i + 16] = mock_server_receives_msg (
+            server,
+            0,
+            tmp_bson ("{'find': 'collection', 'filter': {'_id': %d}}",
+                      i + 16));
+      }
+   }
+
+   BSON_ASSERT (future_get_bool (future));
+
+   for (i = 0; i < 20; i++) {
+      ASSERT_MATCH (
+         &replies[i], "{'cursor': {'firstBatch': [{'_id': %d}]}}", i);
+      bson_destroy (&replies[i]);
+   }
+
+   future_destroy (future);
+   mongoc_client_destroy (client);
+   mock_server_destroy (server);
+}
+
+
+static void
+test_cluster_pipeline_hangup (void)
+{
+   mock_server_t *server;
+   mongoc_client_t *client;
+   const bson_t *commands[2];
+   bson_t replies[2];
+   bson_error_t pipeline_errors[2];
+   future_t *future;
+   request_t *requests[2];
+   int i;
+
+   server = mock_server_with_autoismaster (WIRE_VERSION_OP_MSG);
+   mock_server_run (server);
+   client = mongoc_client_new_from_uri (mock_server_get_uri (server));
+
+   commands[0] = tmp_bson ("{'ping': 1}");
+   commands[1] = tmp_bson ("{'ping': 2}");
+
+   future = future_client_command_pipeline (
+      client, "admin", commands, 2, NULL, replies, pipeline_errors);
+
+   requests[0] = mock_server_receives_msg (server, 0, tmp_bson ("{'ping': 1}"));
+   requests[1] = mock_server_receives_msg (server, 0, tmp_bson ("{'ping': 2}"));
+   mock_server_hangs_up (requests[0]);
+
+   BSON_ASSERT (!future_get_bool (future));
+
+   for (i = 0; i < 2; i++) {
+      ASSERT_CMPINT (pipeline_errors[i].domain, ==, MONGOC_ERROR_STREAM);
+      ASSERT_CMPINT (pipeline_errors[i].code, ==, MONGOC_ERROR_STREAM_SOCKET);
+      ASSERT_CMPUINT32 (replies[i].len, ==, 5);
+      request_destroy (requests[i]);
+      bson_destroy (&replies[i]);
+   }
+
+   future_destroy (future);
+   mongoc_client_destroy (client);
+   mock_server_destroy (server);
+}
+
+
+/* servers older than 3.6 run the commands one at a time with OP_QUERY */
+static void
+test_cluster_pipeline_op_query (void)
+{
+   mock_server_t *server;
+   mongoc_client_t *client;
+   const bson_t *commands[2];
+   bson_t replies[2];
+   bson_error_t pipeline_errors[2];
+   future_t *future;
+   request_t *request;
+
+   server = mock_server_with_autoismaster (WIRE_VERSION_OP_MSG - 1);
+   mock_server_run (server);
+   client = mongoc_client_new_from_uri (mock_server_get_uri (server));
+
+   commands[0] = tmp_bson ("{'ping': 1}");
+   commands[1] = tmp_bson ("{'ping': 2}");
+
+   future = future_client_command_pipeline (
+      client, "admin", commands, 2, NULL, replies, pipeline_errors);
+
+   request = mock_server_receives_command (
+      server, "admin", MONGOC_QUERY_SLAVE_OK, "{'ping': 1}");
+   mock_server_replies_simple (request, "{'ok': 1, 'x': 1}");
+   request_destroy (request);
+   request = mock_server_receives_command (
+      server, "admin", MONGOC_QUERY_SLAVE_OK, "{'ping': 2}");
+   mock_server_replies_simple (request, "{'ok': 1, 'x': 2}");
+   request_destroy (request);
+
+   BSON_ASSERT (future_get_bool (future));
+   ASSERT_MATCH (&replies[0], "{'x': 1}");
+   ASSERT_MATCH (&replies[1], "{'x': 2}");
+
+   bson_destroy (&replies[0]);
+   bson_destroy (&replies[1]);
+   future_destroy (future);
+   mongoc_client_destroy (client);
+   mock_server_destroy (server);
+}
+
+
+#ifdef MONGOC_ENABLE_CRYPTO
+/* answer the pool's monitoring ismasters, leave the handshake to the test */
+static bool
+auto_ismaster_not_speculative (request_t *request, void *data)
+{
+   if (!request->is_command ||
+       strcasecmp (request->command_name, "ismaster") != 0 ||
+       bson_has_field (request_get_doc (request, 0),
+                       "speculativeAuthenticate")) {
+      return false;
+   }
+
+   mock_server_replies_simple (request,
+                               "{'ok': 1,"
+                               " 'ismaster': true,"
+                               " 'minWireVersion': 0,"
+                               " 'maxWireVersion': 6}");
+   request_destroy (request);
+
+   return true;
+}
+
+
+static void
+_test_speculative_auth (bool accepted)
+{
+   mock_server_t *server;
+   mongoc_uri_t *uri;
+   mongoc_client_pool_t *pool;
+   mongoc_client_t *client;
+   future_t *future;
+   request_t *request;
+   bson_error_t error;
+   bson_iter_t iter;
+   bson_subtype_t subtype;
+   uint32_t len;
+   const uint8_t *payload;
+   const char *nonce;
+   char *server_first;
+   char server_first_b64[256];
+   char *reply;
+
+   server = mock_server_new ();
+   mock_server_autoresponds (
+      server, auto_ismaster_not_speculative, NULL, NULL);
+   mock_server_run (server);
+
+   uri = mongoc_uri_copy (mock_server_get_uri (server));
+   mongoc_uri_set_username (uri, "user");
+   mongoc_uri_set_password (uri, "password");
+   pool = mongoc_client_pool_new (uri);
+   client = mongoc_client_pool_pop (pool);
+
+   future = future_client_command_simple (
+      client, "admin", tmp_bson ("{'ping': 1}"), NULL, NULL, &error);
+
+   /* the handshake begins the SCRAM conversation */
+   request = mock_server_receives_msg (
+      server,
+      0,
+      tmp_bson ("{'isMaster': 1,"
+                " 'speculativeAuthenticate': {"
+                "    'saslStart': 1,"
+                "    'mechanism': 'SCRAM-SHA-1',"
+                "    'db': 'admin'}}"));
+
+   ASSERT (bson_iter_init (&iter, request_get_doc (request, 0)));
+   ASSERT (bson_iter_find_descendant (
+      &iter, "speculativeAuthenticate.payload", &iter));
+   ASSERT (BSON_ITER_HOLDS_BINARY (&iter));
+   bson_iter_binary (&iter, &subtype, &len, &payload);
+   ASSERT (!strncmp ((const char *) payload, "n,,n=user,r=", 12));
+   nonce = (const char *) payload + 12;
+
+   if (accepted) {
+      server_first = bson_strdup_printf (
+         "r=%.*sSERVERNONCE,s=c2FsdHNhbHRzYWx0c2FsdA==,i=4096",
+         (int) (len - 12),
+         nonce);
+      ASSERT_CMPINT (mongoc_b64_ntop ((const uint8_t *) server_first,
+                                      strlen (server_first),
+                                      server_first_b64,
+                                      sizeof server_first_b64),
+                     !=,
+                     -1);
+
+      reply = bson_strdup_printf (
+         "{'ok': 1, 'ismaster': true,"
+         " 'minWireVersion': 0, 'maxWireVersion': 6,"
+         " 'speculativeAuthenticate': {"
+         "    'conversationId': 1, 'done': false,"
+         "    'payload': {'$binary': {'base64': '%s', 'subType': '00'}}}}",
+         server_first_b64);
+
+      mock_server_replies_simple (request, reply);
+      request_destroy (request);
+      bson_free (reply);
+      bson_free (server_first);
+
+      /* no saslStart, the client continues the conversation */
+      request = mock_server_receives_msg (
+         server,
+         0,
+         tmp_bson ("{'saslContinue': 1, 'conversationId': 1, '$db': 'admin'}"));
+   } else {
+      /* a server that ignores speculativeAuthenticate */
+      mock_server_replies_simple (request,
+                                  "{'ok': 1, 'ismaster': true,"
+                                  " 'minWireVersion': 0,"
+                                  " 'maxWireVersion': 6}");
+      request_destroy (request);
+
+      request = mock_server_receives_msg (
+         server,
+         0,
+         tmp_bson ("{'saslStart': 1,"
+                   " 'mechanism': 'SCRAM-SHA-1',"
+                   " '$db': 'admin'}"));
+   }
+
+   mock_server_replies_simple (request, "{'ok': 0, 'errmsg': 'auth failed'}");
+   request_destroy (request);
+
+   ASSERT (!future_get_bool (future));
+   ASSERT_ERROR_CONTAINS (error,
+                          MONGOC_ERROR_CLIENT,
+                          MONGOC_ERROR_CLIENT_AUTHENTICATE,
+                          "auth failed");
+
+   future_destroy (future);
+   mongoc_client_pool_push (pool, client);
+   mongoc_client_pool_destroy (pool);
+   mongoc_uri_destroy (uri);
+   mock_server_destroy (server);
+}
+
+
+static void
+test_speculative_auth (void)
+{
+   _test_speculative_auth (true);
+}
+
+
+static void
+test_speculative_auth_fallback (void)
+{
+   _test_speculative_auth (false);
+}
+#endif
+
+
 void
 test_cluster_install (TestSuite *suite)
 {
@@ -1455,4 +1812,19 @@ test_cluster_install (TestSuite *suite)
                                 "/Cluster/not_master_auth/pooled/op_msg",
                                 test_not_master_auth_pooled_op_msg,
                                 test_framework_skip_if_slow);
+   TestSuite_AddMockServerTest (
+      suite, "/Cluster/pipeline/op_msg", test_cluster_pipeline_op_msg);
+   TestSuite_AddMockServerTest (
+      suite, "/Cluster/pipeline/window", test_cluster_pipeline_window);
+   TestSuite_AddMockServerTest (
+      suite, "/Cluster/pipeline/hangup", test_cluster_pipeline_hangup);
+   TestSuite_AddMockServerTest (
+      suite, "/Cluster/pipeline/op_query", test_cluster_pipeline_op_query);
+#ifdef MONGOC_ENABLE_CRYPTO
+   TestSuite_AddMockServerTest (
+      suite, "/Cluster/speculative_auth", test_speculative_auth);
+   TestSuite_AddMockServerTest (suite,
+                                "/Cluster/speculative_auth/fallback",
+                                test_speculative_auth_fallback);
+#endif
 }
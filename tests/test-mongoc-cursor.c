@@ -6,6 +6,7 @@
 #include "mock_server/mock-rs.h"
 #include "mock_server/future-functions.h"
 #include "mongoc-cursor-private.h"
+#include "mongoc-cursor-cursorid-private.h"
 #include "mongoc-collection-private.h"
 #include "mongoc-read-concern-private.h"
 #include "mongoc-write-concern-private.h"
@@ -1787,6 +1788,557 @@ test_error_document_getmore (void)
 }
 
 
+static mongoc_cursor_prefetch_state_t
+_prefetch_state (mongoc_cursor_t *cursor)
+{
+   return ((mongoc_cursor_cursorid_t *) cursor->iface_data)->prefetch_state;
+}
+
+
+static mongoc_cursor_t *
+_prefetch_cursor_first_batch (mock_server_t *server,
+                              mongoc_collection_t *collection,
+                              const bson_t *opts,
+                              const char *find_pattern)
+{
+   mongoc_cursor_t *cursor;
+   const bson_t *doc;
+   future_t *future;
+   request_t *request;
+
+   cursor = mongoc_collection_find_with_opts (
+      collection, tmp_bson ("{}"), opts, NULL);
+   future = future_cursor_next (cursor, &doc);
+   request = mock_server_receives_msg (
+      server, MONGOC_MSG_NONE, tmp_bson (find_pattern));
+   mock_server_replies_simple (request,
+                               "{'ok': 1, 'cursor': {"
+                               "   'id': 123, 'ns': 'db.test',"
+                               "   'firstBatch': [{'a': 1}, {'a': 2}]}}");
+   ASSERT (future_get_bool (future));
+   ASSERT_MATCH (doc, "{'a': 1}");
+   future_destroy (future);
+   request_destroy (request);
+
+   return cursor;
+}
+
+
+/* the getMore is sent as soon as the first batch arrives, its reply is read
+ * when the application reaches the end of the first batch */
+static void
+test_cursor_prefetch (void)
+{
+   mock_server_t *server;
+   mongoc_client_t *client;
+   mongoc_collection_t *collection;
+   mongoc_cursor_t *cursor;
+   const bson_t *doc;
+   bson_error_t error;
+   request_t *request;
+
+   server = mock_server_with_autoismaster (WIRE_VERSION_OP_MSG);
+   mock_server_run (server);
+   client = mongoc_client_new_from_uri (mock_server_get_uri (server));
+   collection = mongoc_client_get_collection (client, "db", "test");
+   cursor = _prefetch_cursor_first_batch (
+      server,
+      collection,
+      tmp_bson ("{'prefetch': true, 'batchSize': 2}"),
+      "{'find': 'test', 'batchSize': 2, 'prefetch': {'$exists': false}}");
+
+   request = mock_server_receives_msg (
+      server,
+      MONGOC_MSG_NONE,
+      tmp_bson ("{'getMore': {'$numberLong': '123'},"
+                " 'collection': 'test', 'batchSize': {'$numberLong': '2'}}"));
+   ASSERT_CMPINT (_prefetch_state (cursor), ==, MONGOC_CURSOR_PREFETCH_SENT);
+   mock_server_replies_simple (request,
+                               "{'ok': 1, 'cursor': {"
+                               "   'id': 0, 'ns': 'db.test',"
+                               "   'nextBatch': [{'a': 3}]}}");
+   request_destroy (request);
+
+   /* no further requests, the getMore reply is in the socket buffer */
+   ASSERT (mongoc_cursor_next (cursor, &doc));
+   ASSERT_MATCH (doc, "{'a': 2}");
+   ASSERT (mongoc_cursor_next (cursor, &doc));
+   ASSERT_MATCH (doc, "{'a': 3}");
+   ASSERT_CMPINT (_prefetch_state (cursor), ==, MONGOC_CURSOR_PREFETCH_NONE);
+   ASSERT (!mongoc_cursor_next (cursor, &doc));
+   ASSERT_OR_PRINT (!mongoc_cursor_error (cursor, &error), error);
+
+   mongoc_cursor_destroy (cursor);
+   mongoc_collection_destroy (collection);
+   mongoc_client_destroy (client);
+   mock_server_destroy (server);
+}
+
+
+/* another operation on the client reads the pending getMore reply first */
+static void
+test_cursor_prefetch_interleaved (void)
+{
+   mock_server_t *server;
+   mongoc_client_t *client;
+   mongoc_collection_t *collection;
+   mongoc_cursor_t *cursor;
+   const bson_t *doc;
+   bson_error_t error;
+   future_t *future;
+   request_t *getmore;
+   request_t *request;
+
+   server = mock_server_with_autoismaster (WIRE_VERSION_OP_MSG);
+   mock_server_run (server);
+   client = mongoc_client_new_from_uri (mock_server_get_uri (server));
+   collection = mongoc_client_get_collection (client, "db", "test");
+   cursor = _prefetch_cursor_first_batch (
+      server, collection, tmp_bson ("{'prefetch': true}"), "{'find': 'test'}");
+
+   getmore = mock_server_receives_msg (
+      server,
+      MONGOC_MSG_NONE,
+      tmp_bson ("{'getMore': {'$numberLong': '123'}, 'collection': 'test'}"));
+
+   future = future_client_command_simple (
+      client, "admin", tmp_bson ("{'ping': 1}"), NULL, NULL, &error);
+
+   /* the ping waits for the getMore reply */
+   mock_server_replies_simple (getmore,
+                               "{'ok': 1, 'cursor': {"
+                               "   'id': 0, 'ns': 'db.test',"
+                               "   'nextBatch': [{'a': 3}]}}");
+   request_destroy (getmore);
+
+   request = mock_server_receives_msg (
+      server, MONGOC_MSG_NONE, tmp_bson ("{'ping': 1}"));
+   ASSERT_CMPINT (
+      _prefetch_state (cursor), ==, MONGOC_CURSOR_PREFETCH_RECEIVED);
+   mock_server_replies_ok_and_destroys (request);
+   ASSERT_OR_PRINT (future_get_bool (future), error);
+   future_destroy (future);
+
+   ASSERT (mongoc_cursor_next (cursor, &doc));
+   ASSERT_MATCH (doc, "{'a': 2}");
+   ASSERT (mongoc_cursor_next (cursor, &doc));
+   ASSERT_MATCH (doc, "{'a': 3}");
+   ASSERT (!mongoc_cursor_next (cursor, &doc));
+   ASSERT_OR_PRINT (!mongoc_cursor_error (cursor, &error), error);
+
+   mongoc_cursor_destroy (cursor);
+   mongoc_collection_destroy (collection);
+   mongoc_client_destroy (client);
+   mock_server_destroy (server);
+}
+
+
+/* the prefetched getMore asks for the documents remaining after the current
+ * batch, and the last batch is not prefetched */
+static void
+test_cursor_prefetch_limit (void)
+{
+   mock_server_t *server;
+   mongoc_client_t *client;
+   mongoc_collection_t *collection;
+   mongoc_cursor_t *cursor;
+   const bson_t *doc;
+   future_t *future;
+   request_t *request;
+
+   server = mock_server_with_autoismaster (WIRE_VERSION_OP_MSG);
+   mock_server_run (server);
+   client = mongoc_client_new_from_uri (mock_server_get_uri (server));
+   collection = mongoc_client_get_collection (client, "db", "test");
+   cursor = _prefetch_cursor_first_batch (
+      server,
+      collection,
+      tmp_bson ("{'prefetch': true, 'batchSize': 2, 'limit': 3}"),
+      "{'find': 'test', 'batchSize': 2, 'limit': 3}");
+
+   request = mock_server_receives_msg (
+      server,
+      MONGOC_MSG_NONE,
+      tmp_bson ("{'getMore': {'$numberLong': '123'},"
+                " 'collection': 'test', 'batchSize': {'$numberLong': '1'}}"));
+   mock_server_replies_simple (request,
+                               "{'ok': 1, 'cursor': {"
+                               "   'id': 0, 'ns': 'db.test',"
+                               "   'nextBatch': [{'a': 3}]}}");
+   request_destroy (request);
+
+   ASSERT (mongoc_cursor_next (cursor, &doc));
+   mongoc_cursor_destroy (cursor);
+
+   /* limit 2 is reached by the first batch, the next request is the
+    * killCursors sent by mongoc_cursor_destroy */
+   cursor = _prefetch_cursor_first_batch (
+      server,
+      collection,
+      tmp_bson ("{'prefetch': true, 'batchSize': 2, 'limit': 2}"),
+      "{'find': 'test', 'batchSize': 2, 'limit': 2}");
+   ASSERT_CMPINT (_prefetch_state (cursor), ==, MONGOC_CURSOR_PREFETCH_NONE);
+
+   future = future_cursor_destroy (cursor);
+   request = mock_server_receives_msg (
+      server,
+      MONGOC_MSG_NONE,
+      tmp_bson ("{'killCursors': 'test',"
+                " 'cursors': [{'$numberLong': '123'}]}"));
+   mock_server_replies_ok_and_destroys (request);
+   future_wait (future);
+   future_destroy (future);
+
+   mongoc_collection_destroy (collection);
+   mongoc_client_destroy (client);
+   mock_server_destroy (server);
+}
+
+
+/* destroying the cursor reads the getMore reply to learn which cursor id to
+ * kill */
+static void
+test_cursor_prefetch_destroy (void)
+{
+   mock_server_t *server;
+   mongoc_client_t *client;
+   mongoc_collection_t *collection;
+   mongoc_cursor_t *cursor;
+   future_t *future;
+   request_t *request;
+
+   server = mock_server_with_autoismaster (WIRE_VERSION_OP_MSG);
+   mock_server_run (server);
+   client = mongoc_client_new_from_uri (mock_server_get_uri (server));
+   collection = mongoc_client_get_collection (client, "db", "test");
+   cursor = _prefetch_cursor_first_batch (
+      server, collection, tmp_bson ("{'prefetch': true}"), "{'find': 'test'}");
+
+   request = mock_server_receives_msg (
+      server,
+      MONGOC_MSG_NONE,
+      tmp_bson ("{'getMore': {'$numberLong': '123'}, 'collection': 'test'}"));
+
+   future = future_cursor_destroy (cursor);
+   mock_server_replies_simple (request,
+                               "{'ok': 1, 'cursor': {"
+                               "   'id': 456, 'ns': 'db.test',"
+                               "   'nextBatch': [{'a': 3}]}}");
+   request_destroy (request);
+
+   request = mock_server_receives_msg (
+      server,
+      MONGOC_MSG_NONE,
+      tmp_bson ("{'killCursors': 'test',"
+                " 'cursors': [{'$numberLong': '456'}]}"));
+   mock_server_replies_ok_and_destroys (request);
+   future_wait (future);
+   future_destroy (future);
+
+   mongoc_collection_destroy (collection);
+   mongoc_client_destroy (client);
+   mock_server_destroy (server);
+}
+
+
+/* a network error on the prefetched getMore is reported by the cursor when
+ * it reaches the next batch */
+static void
+test_cursor_prefetch_hangup (void)
+{
+   mock_server_t *server;
+   mongoc_client_t *client;
+   mongoc_collection_t *collection;
+   mongoc_cursor_t *cursor;
+   const bson_t *doc;
+   bson_error_t error;
+   future_t *future;
+   request_t *request;
+
+   server = mock_server_with_autoismaster (WIRE_VERSION_OP_MSG);
+   mock_server_run (server);
+   client = mongoc_client_new_from_uri (mock_server_get_uri (server));
+   collection = mongoc_client_get_collection (client, "db", "test");
+   cursor = _prefetch_cursor_first_batch (
+      server, collection, tmp_bson ("{'prefetch': true}"), "{'find': 'test'}");
+
+   request = mock_server_receives_msg (
+      server,
+      MONGOC_MSG_NONE,
+      tmp_bson ("{'getMore': {'$numberLong': '123'}, 'collection': 'test'}"));
+
+   ASSERT (mongoc_cursor_next (cursor, &doc));
+   ASSERT_MATCH (doc, "{'a': 2}");
+
+   future = future_cursor_next (cursor, &doc);
+   mock_server_hangs_up (request);
+   request_destroy (request);
+   ASSERT (!future_get_bool (future));
+   future_destroy (future);
+
+   ASSERT (mongoc_cursor_error (cursor, &error));
+   ASSERT_CMPUINT32 (error.domain, ==, (uint32_t) MONGOC_ERROR_STREAM);
+
+   mongoc_cursor_destroy (cursor);
+   mongoc_collection_destroy (collection);
+   mongoc_client_destroy (client);
+   mock_server_destroy (server);
+}
+
+
+static request_t *
+_prefetch_receives (mock_server_t *server,
+                    int32_t max_wire_version,
+                    const char *pattern)
+{
+   if (max_wire_version >= WIRE_VERSION_OP_MSG) {
+      return mock_server_receives_msg (
+         server, MONGOC_MSG_NONE, tmp_bson (pattern));
+   }
+
+   return mock_server_receives_command (
+      server, "db", MONGOC_QUERY_SLAVE_OK, pattern);
+}
+
+
+/* tailable cursors wait on the server, and old servers don't use OP_MSG */
+static void
+_test_cursor_prefetch_skipped (int32_t max_wire_version, const char *opts)
+{
+   mock_server_t *server;
+   mongoc_client_t *client;
+   mongoc_collection_t *collection;
+   mongoc_cursor_t *cursor;
+   const bson_t *doc;
+   future_t *future;
+   request_t *request;
+
+   server = mock_server_with_autoismaster (max_wire_version);
+   mock_server_run (server);
+   client = mongoc_client_new_from_uri (mock_server_get_uri (server));
+   collection = mongoc_client_get_collection (client, "db", "test");
+   cursor = mongoc_collection_find_with_opts (
+      collection, tmp_bson ("{}"), tmp_bson (opts), NULL);
+
+   future = future_cursor_next (cursor, &doc);
+   request = _prefetch_receives (server, max_wire_version, "{'find': 'test'}");
+   mock_server_replies_simple (request,
+                               "{'ok': 1, 'cursor': {"
+                               "   'id': 123, 'ns': 'db.test',"
+                               "   'firstBatch': [{'a': 1}]}}");
+   ASSERT (future_get_bool (future));
+   future_destroy (future);
+   request_destroy (request);
+
+   ASSERT_CMPINT (_prefetch_state (cursor), ==, MONGOC_CURSOR_PREFETCH_NONE);
+
+   /* the getMore is sent on demand */
+   future = future_cursor_next (cursor, &doc);
+   request = _prefetch_receives (
+      server, max_wire_version, "{'getMore': {'$numberLong': '123'}}");
+   mock_server_replies_simple (request,
+                               "{'ok': 1, 'cursor': {"
+                               "   'id': 0, 'ns': 'db.test',"
+                               "   'nextBatch': [{'a': 2}]}}");
+   ASSERT (future_get_bool (future));
+   ASSERT_MATCH (doc, "{'a': 2}");
+   future_destroy (future);
+   request_destroy (request);
+
+   mongoc_cursor_destroy (cursor);
+   mongoc_collection_destroy (collection);
+   mongoc_client_destroy (client);
+   mock_server_destroy (server);
+}
+
+
+static void
+test_cursor_prefetch_tailable (void)
+{
+   _test_cursor_prefetch_skipped (
+      WIRE_VERSION_OP_MSG,
+      "{'prefetch': true, 'tailable': true, 'awaitData': true}");
+}
+
+
+static void
+test_cursor_prefetch_old_server (void)
+{
+   _test_cursor_prefetch_skipped (WIRE_VERSION_OP_MSG - 1,
+                                  "{'prefetch': true}");
+}
+
+
+/* whole batches from the find and getMore commands, without copying */
+static void
+test_cursor_next_batch (void)
+{
+   mock_server_t *server;
+   mongoc_client_t *client;
+   mongoc_collection_t *collection;
+   mongoc_cursor_t *cursor;
+   const bson_t *batch;
+   uint32_t n_docs;
+   bson_error_t error;
+   future_t *future;
+   request_t *request;
+
+   server = mock_server_with_autoismaster (WIRE_VERSION_OP_MSG);
+   mock_server_run (server);
+   client = mongoc_client_new_from_uri (mock_server_get_uri (server));
+   collection = mongoc_client_get_collection (client, "db", "test");
+   cursor = mongoc_collection_find_with_opts (
+      collection, tmp_bson ("{}"), tmp_bson ("{'batchSize': 2}"), NULL);
+
+   future = future_cursor_next_batch (cursor, &batch, &n_docs);
+   request = mock_server_receives_msg (
+      server, MONGOC_MSG_NONE, tmp_bson ("{'find': 'test', 'batchSize': 2}"));
+   mock_server_replies_simple (request,
+                               "{'ok': 1, 'cursor': {"
+                               "   'id': 123, 'ns': 'db.test',"
+                               "   'firstBatch': [{'a': 1}, {'a': 2}]}}");
+   ASSERT (future_get_bool (future));
+   ASSERT_CMPUINT32 (n_docs, ==, (uint32_t) 2);
+   ASSERT_MATCH (batch, "{'0': {'a': 1}, '1': {'a': 2}}");
+   ASSERT (batch != &cursor->batch);
+   future_destroy (future);
+   request_destroy (request);
+
+   future = future_cursor_next_batch (cursor, &batch, &n_docs);
+   request = mock_server_receives_msg (
+      server,
+      MONGOC_MSG_NONE,
+      tmp_bson ("{'getMore': {'$numberLong': '123'}, 'collection': 'test'}"));
+   mock_server_replies_simple (request,
+                               "{'ok': 1, 'cursor': {"
+                               "   'id': 0, 'ns': 'db.test',"
+                               "   'nextBatch': [{'a': 3}]}}");
+   ASSERT (future_get_bool (future));
+   ASSERT_CMPUINT32 (n_docs, ==, (uint32_t) 1);
+   ASSERT_MATCH (batch, "{'0': {'a': 3}}");
+   future_destroy (future);
+   request_destroy (request);
+
+   ASSERT (!mongoc_cursor_next_batch (cursor, &batch, &n_docs));
+   ASSERT (!batch);
+   ASSERT_CMPUINT32 (n_docs, ==, (uint32_t) 0);
+   ASSERT_OR_PRINT (!mongoc_cursor_error (cursor, &error), error);
+   ASSERT (!mongoc_cursor_more (cursor));
+
+   mongoc_cursor_destroy (cursor);
+   mongoc_collection_destroy (collection);
+   mongoc_client_destroy (client);
+   mock_server_destroy (server);
+}
+
+
+/* after mongoc_cursor_next, the rest of the batch is copied */
+static void
+test_cursor_next_batch_partial (void)
+{
+   mock_server_t *server;
+   mongoc_client_t *client;
+   mongoc_collection_t *collection;
+   mongoc_cursor_t *cursor;
+   const bson_t *doc;
+   const bson_t *batch;
+   uint32_t n_docs;
+   bson_error_t error;
+   future_t *future;
+   request_t *request;
+
+   server = mock_server_with_autoismaster (WIRE_VERSION_OP_MSG);
+   mock_server_run (server);
+   client = mongoc_client_new_from_uri (mock_server_get_uri (server));
+   collection = mongoc_client_get_collection (client, "db", "test");
+   cursor = mongoc_collection_find_with_opts (
+      collection, tmp_bson ("{}"), NULL, NULL);
+
+   future = future_cursor_next (cursor, &doc);
+   request = mock_server_receives_msg (
+      server, MONGOC_MSG_NONE, tmp_bson ("{'find': 'test'}"));
+   mock_server_replies_simple (
+      request,
+      "{'ok': 1, 'cursor': {"
+      "   'id': 0, 'ns': 'db.test',"
+      "   'firstBatch': [{'a': 1}, {'a': 2}, {'a': 3}]}}");
+   ASSERT (future_get_bool (future));
+   ASSERT_MATCH (doc, "{'a': 1}");
+   future_destroy (future);
+   request_destroy (request);
+
+   ASSERT (mongoc_cursor_next_batch (cursor, &batch, &n_docs));
+   ASSERT_CMPUINT32 (n_docs, ==, (uint32_t) 2);
+   ASSERT_MATCH (batch, "{'0': {'a': 2}, '1': {'a': 3}}");
+   ASSERT (batch == &cursor->batch);
+
+   ASSERT (!mongoc_cursor_next_batch (cursor, &batch, &n_docs));
+   ASSERT_OR_PRINT (!mongoc_cursor_error (cursor, &error), error);
+
+   mongoc_cursor_destroy (cursor);
+   mongoc_collection_destroy (collection);
+   mongoc_client_destroy (client);
+   mock_server_destroy (server);
+}
+
+
+/* before MongoDB 3.2, documents from OP_QUERY and OP_GETMORE are copied */
+static void
+test_cursor_next_batch_op_query (void)
+{
+   mock_server_t *server;
+   mongoc_client_t *client;
+   mongoc_collection_t *collection;
+   mongoc_cursor_t *cursor;
+   const bson_t *batch;
+   uint32_t n_docs;
+   bson_t docs[2];
+   bson_error_t error;
+   future_t *future;
+   request_t *request;
+
+   server = mock_server_with_autoismaster (WIRE_VERSION_MIN);
+   mock_server_run (server);
+   client = mongoc_client_new_from_uri (mock_server_get_uri (server));
+   collection = mongoc_client_get_collection (client, "db", "test");
+   cursor = mongoc_collection_find_with_opts (
+      collection, tmp_bson ("{}"), tmp_bson ("{'batchSize': 2}"), NULL);
+
+   future = future_cursor_next_batch (cursor, &batch, &n_docs);
+   request = mock_server_receives_query (
+      server, "db.test", MONGOC_QUERY_SLAVE_OK, 0, 2, "{}", NULL);
+   bson_init (&docs[0]);
+   BSON_APPEND_INT32 (&docs[0], "a", 1);
+   bson_init (&docs[1]);
+   BSON_APPEND_INT32 (&docs[1], "a", 2);
+   mock_server_reply_multi (request, MONGOC_REPLY_NONE, docs, 2, 123);
+   ASSERT (future_get_bool (future));
+   ASSERT_CMPUINT32 (n_docs, ==, (uint32_t) 2);
+   ASSERT_MATCH (batch, "{'0': {'a': 1}, '1': {'a': 2}}");
+   future_destroy (future);
+   request_destroy (request);
+
+   future = future_cursor_next_batch (cursor, &batch, &n_docs);
+   request = mock_server_receives_getmore (server, "db.test", 2, 123);
+   mock_server_reply_multi (request, MONGOC_REPLY_NONE, docs, 1, 0);
+   ASSERT (future_get_bool (future));
+   ASSERT_CMPUINT32 (n_docs, ==, (uint32_t) 1);
+   ASSERT_MATCH (batch, "{'0': {'a': 1}}");
+   future_destroy (future);
+   request_destroy (request);
+
+   ASSERT (!mongoc_cursor_next_batch (cursor, &batch, &n_docs));
+   ASSERT_OR_PRINT (!mongoc_cursor_error (cursor, &error), error);
+
+   bson_destroy (&docs[0]);
+   bson_destroy (&docs[1]);
+   mongoc_cursor_destroy (cursor);
+   mongoc_collection_destroy (collection);
+   mongoc_client_destroy (client);
+   mock_server_destroy (server);
+}
+
+
 void
 test_cursor_install (TestSuite *suite)
 {
@@ -1876,4 +2428,24 @@ test_cursor_install (TestSuite *suite)
       suite, "/Cursor/error_document/getmore", test_error_document_getmore);
    TestSuite_AddLive (
       suite, "/Cursor/error_document/command", test_error_document_command);
+   TestSuite_AddMockServerTest (
+      suite, "/Cursor/prefetch", test_cursor_prefetch);
+   TestSuite_AddMockServerTest (
+      suite, "/Cursor/prefetch/interleaved", test_cursor_prefetch_interleaved);
+   TestSuite_AddMockServerTest (
+      suite, "/Cursor/prefetch/limit", test_cursor_prefetch_limit);
+   TestSuite_AddMockServerTest (
+      suite, "/Cursor/prefetch/destroy", test_cursor_prefetch_destroy);
+   TestSuite_AddMockServerTest (
+      suite, "/Cursor/prefetch/hangup", test_cursor_prefetch_hangup);
+   TestSuite_AddMockServerTest (
+      suite, "/Cursor/prefetch/tailable", test_cursor_prefetch_tailable);
+   TestSuite_AddMockServerTest (
+      suite, "/Cursor/prefetch/old_server", test_cursor_prefetch_old_server);
+   TestSuite_AddMockServerTest (
+      suite, "/Cursor/next_batch", test_cursor_next_batch);
+   TestSuite_AddMockServerTest (
+      suite, "/Cursor/next_batch/partial", test_cursor_next_batch_partial);
+   TestSuite_AddMockServerTest (
+      suite, "/Cursor/next_batch/op_query", test_cursor_next_batch_op_query);
 }
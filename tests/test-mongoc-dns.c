@@ -1,11 +1,14 @@
 #include <mongoc-util-private.h>
 #include <mongoc-client-pool-private.h>
 #include "mongoc.h"
+#include "mongoc-client-private.h"
+#include "mongoc-dns-cache-private.h"
 #include "mongoc-host-list-private.h"
 #include "mongoc-thread-private.h"
 
 #include "json-test.h"
 #include "test-libmongoc.h"
+#include "mock_server/mock-server.h"
 
 
 static void
@@ -305,6 +308,214 @@ test_null_error_pointer (void *ctx)
 }
 
 
+/* a resolver that answers 127.0.0.1 for any name, or fails */
+static int gResolverCalls;
+static bool gResolverFails;
+
+typedef struct {
+   struct addrinfo ai;
+   struct sockaddr_in addr;
+} fake_addrinfo_t;
+
+
+static int
+_fake_resolver (const char *node,
+                const char *service,
+                const struct addrinfo *hints,
+                struct addrinfo **res)
+{
+   fake_addrinfo_t *fake;
+
+   bson_atomic_int_add (&gResolverCalls, 1);
+
+   if (gResolverFails) {
+      return EAI_NONAME;
+   }
+
+   fake = (fake_addrinfo_t *) bson_malloc0 (sizeof *fake);
+   fake->addr.sin_family = AF_INET;
+   fake->addr.sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+   fake->addr.sin_port = htons ((uint16_t) atoi (service));
+   fake->ai.ai_family = AF_INET;
+   fake->ai.ai_socktype = SOCK_STREAM;
+   fake->ai.ai_addr = (struct sockaddr *) &fake->addr;
+   fake->ai.ai_addrlen = sizeof fake->addr;
+
+   *res = &fake->ai;
+
+   return 0;
+}
+
+
+static void
+_fake_resolver_free (struct addrinfo *res)
+{
+   bson_free (res);
+}
+
+
+static void
+_fake_resolver_install (void)
+{
+   gResolverCalls = 0;
+   gResolverFails = false;
+   _mongoc_dns_cache_set_resolver (_fake_resolver, _fake_resolver_free);
+}
+
+
+static uint16_t
+_resolved_port (struct addrinfo *result)
+{
+   BSON_ASSERT (result && !result->ai_next);
+   return ntohs (((struct sockaddr_in *) result->ai_addr)->sin_port);
+}
+
+
+static void
+test_dns_cache_ttl (void)
+{
+   mongoc_host_list_t host;
+   mongoc_host_list_t other_port;
+   struct addrinfo *result;
+
+   _fake_resolver_install ();
+   ASSERT (_mongoc_host_list_from_string (&host, "example.com:1234"));
+   ASSERT (_mongoc_host_list_from_string (&other_port, "example.com:5678"));
+
+   ASSERT_CMPINT (_mongoc_dns_cache_getaddrinfo (&host, 60000, &result), ==, 0);
+   ASSERT_CMPINT (_resolved_port (result), ==, 1234);
+   _mongoc_dns_cache_freeaddrinfo (result);
+   ASSERT_CMPINT (gResolverCalls, ==, 1);
+
+   /* answered from the cache */
+   ASSERT_CMPINT (_mongoc_dns_cache_getaddrinfo (&host, 60000, &result), ==, 0);
+   ASSERT_CMPINT (_resolved_port (result), ==, 1234);
+   _mongoc_dns_cache_freeaddrinfo (result);
+   ASSERT_CMPINT (gResolverCalls, ==, 1);
+
+   /* each port is cached separately */
+   ASSERT_CMPINT (
+      _mongoc_dns_cache_getaddrinfo (&other_port, 60000, &result), ==, 0);
+   ASSERT_CMPINT (_resolved_port (result), ==, 5678);
+   _mongoc_dns_cache_freeaddrinfo (result);
+   ASSERT_CMPINT (gResolverCalls, ==, 2);
+
+   /* a negative TTL bypasses the cache */
+   ASSERT_CMPINT (_mongoc_dns_cache_getaddrinfo (&host, -1, &result), ==, 0);
+   _mongoc_dns_cache_freeaddrinfo (result);
+   ASSERT_CMPINT (gResolverCalls, ==, 3);
+
+   /* the entry expires */
+   _mongoc_usleep (20 * 1000);
+   ASSERT_CMPINT (_mongoc_dns_cache_getaddrinfo (&host, 10, &result), ==, 0);
+   _mongoc_dns_cache_freeaddrinfo (result);
+   ASSERT_CMPINT (gResolverCalls, ==, 4);
+
+   _mongoc_dns_cache_set_resolver (NULL, NULL);
+}
+
+
+static void
+test_dns_cache_negative (void)
+{
+   mongoc_host_list_t host;
+   struct addrinfo *result;
+
+   _fake_resolver_install ();
+   ASSERT (_mongoc_host_list_from_string (&host, "example.com:1234"));
+
+   gResolverFails = true;
+   ASSERT_CMPINT (_mongoc_dns_cache_getaddrinfo (&host, 100, &result), !=, 0);
+   ASSERT (!result);
+   ASSERT_CMPINT (gResolverCalls, ==, 1);
+
+   /* the failure is remembered */
+   gResolverFails = false;
+   ASSERT_CMPINT (_mongoc_dns_cache_getaddrinfo (&host, 100, &result), !=, 0);
+   ASSERT_CMPINT (gResolverCalls, ==, 1);
+
+   /* but not for longer than the TTL */
+   _mongoc_usleep (200 * 1000);
+   ASSERT_CMPINT (_mongoc_dns_cache_getaddrinfo (&host, 100, &result), ==, 0);
+   _mongoc_dns_cache_freeaddrinfo (result);
+   ASSERT_CMPINT (gResolverCalls, ==, 2);
+
+   _mongoc_dns_cache_set_resolver (NULL, NULL);
+}
+
+
+/* clients connecting to the same host share one resolution */
+static void
+_test_dns_cache_clients (bool pooled)
+{
+   mock_server_t *server;
+   mongoc_uri_t *uri;
+   char *uri_str;
+   mongoc_client_pool_t *pool = NULL;
+   mongoc_client_t *clients[2];
+   bson_error_t error;
+   int i;
+
+   _fake_resolver_install ();
+
+   server = mock_server_with_autoismaster (WIRE_VERSION_OP_MSG);
+   mock_server_auto_endsessions (server);
+   mock_server_run (server);
+
+   uri_str = bson_strdup_printf ("mongodb://fake.example.com:%hu",
+                                 mock_server_get_port (server));
+   uri = mongoc_uri_new (uri_str);
+
+   if (pooled) {
+      pool = mongoc_client_pool_new (uri);
+   }
+
+   for (i = 0; i < 2; i++) {
+      if (pooled) {
+         clients[i] = mongoc_client_pool_pop (pool);
+      } else {
+         clients[i] = mongoc_client_new_from_uri (uri);
+      }
+
+      ASSERT_OR_PRINT (mongoc_client_select_server (
+                          clients[i], false /* for writes */, NULL, &error),
+                       error);
+   }
+
+   ASSERT_CMPINT (gResolverCalls, ==, 1);
+
+   for (i = 0; i < 2; i++) {
+      if (pooled) {
+         mongoc_client_pool_push (pool, clients[i]);
+      } else {
+         mongoc_client_destroy (clients[i]);
+      }
+   }
+
+   if (pooled) {
+      mongoc_client_pool_destroy (pool);
+   }
+
+   mongoc_uri_destroy (uri);
+   bson_free (uri_str);
+   mock_server_destroy (server);
+   _mongoc_dns_cache_set_resolver (NULL, NULL);
+}
+
+
+static void
+test_dns_cache_clients_single (void)
+{
+   _test_dns_cache_clients (false);
+}
+
+
+static void
+test_dns_cache_clients_pooled (void)
+{
+   _test_dns_cache_clients (true);
+}
+
 /*
  *-----------------------------------------------------------------------
  *
@@ -343,4 +554,10 @@ test_dns_install (TestSuite *suite)
                       NULL,
                       NULL,
                       test_framework_skip_if_no_crypto);
+   TestSuite_Add (suite, "/DNS/cache/ttl", test_dns_cache_ttl);
+   TestSuite_Add (suite, "/DNS/cache/negative", test_dns_cache_negative);
+   TestSuite_AddMockServerTest (
+      suite, "/DNS/cache/clients/single", test_dns_cache_clients_single);
+   TestSuite_AddMockServerTest (
+      suite, "/DNS/cache/clients/pooled", test_dns_cache_clients_pooled);
 }
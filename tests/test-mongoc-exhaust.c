@@ -533,6 +533,197 @@ test_exhaust_server_err_2nd_batch_pooled (void)
    _mock_test_exhaust (true, SECOND_BATCH, SERVER_ERROR);
 }
 
+typedef enum {
+   OP_MSG_EXHAUST_COMPLETE,
+   OP_MSG_EXHAUST_DESTROY,
+   OP_MSG_EXHAUST_HANGUP,
+} op_msg_exhaust_test_t;
+
+static void
+_test_exhaust_op_msg (op_msg_exhaust_test_t test)
+{
+   mock_server_t *server;
+   mongoc_client_t *client;
+   mongoc_collection_t *collection;
+   mongoc_cursor_t *cursor;
+   const bson_t *doc;
+   bson_error_t error;
+   future_t *future;
+   request_t *request;
+   request_t *getmore;
+   uint32_t server_id;
+
+   server = mock_server_with_autoismaster (WIRE_VERSION_EXHAUST_OP_MSG);
+   mock_server_run (server);
+   client = mongoc_client_new_from_uri (mock_server_get_uri (server));
+   collection = mongoc_client_get_collection (client, "db", "test");
+   cursor = mongoc_collection_find_with_opts (
+      collection, tmp_bson ("{}"), tmp_bson ("{'exhaust': true}"), NULL);
+
+   /* the first batch comes from a find command, without exhaust */
+   future = future_cursor_next (cursor, &doc);
+   request = mock_server_receives_msg (
+      server,
+      MONGOC_MSG_NONE,
+      tmp_bson ("{'find': 'test', 'exhaust': {'$exists': false}}"));
+   mock_server_replies_simple (request,
+                               "{'ok': 1, 'cursor': {"
+                               "   'id': 123, 'ns': 'db.test',"
+                               "   'firstBatch': [{'a': 1}]}}");
+   ASSERT (future_get_bool (future));
+   ASSERT_MATCH (doc, "{'a': 1}");
+   ASSERT (!cursor->in_exhaust);
+   future_destroy (future);
+   request_destroy (request);
+
+   /* one getMore allows exhaust, the server streams the other batches */
+   future = future_cursor_next (cursor, &doc);
+   getmore = mock_server_receives_msg (
+      server,
+      MONGOC_MSG_EXHAUST_ALLOWED,
+      tmp_bson ("{'getMore': {'$numberLong': '123'}, 'collection': 'test'}"));
+   mock_server_replies_opmsg (getmore,
+                              MONGOC_MSG_MORE_TO_COME,
+                              tmp_bson ("{'ok': 1, 'cursor': {"
+                                        "   'id': 123, 'ns': 'db.test',"
+                                        "   'nextBatch': [{'a': 2}]}}"));
+   ASSERT (future_get_bool (future));
+   ASSERT_MATCH (doc, "{'a': 2}");
+   ASSERT (cursor->in_exhaust);
+   ASSERT (client->in_exhaust);
+   future_destroy (future);
+
+   server_id = mongoc_cursor_get_hint (cursor);
+
+   if (test == OP_MSG_EXHAUST_DESTROY) {
+      /* the only way to stop the stream is to close the connection */
+      mongoc_cursor_destroy (cursor);
+      ASSERT (!client->in_exhaust);
+      ASSERT (!mongoc_cluster_stream_for_server (
+         &client->cluster, server_id, false /* don't reconnect */, &error));
+      request_destroy (getmore);
+      goto done;
+   }
+
+   future = future_cursor_next (cursor, &doc);
+
+   if (test == OP_MSG_EXHAUST_HANGUP) {
+      mock_server_hangs_up (getmore);
+      ASSERT (!future_get_bool (future));
+      ASSERT (mongoc_cursor_error (cursor, &error));
+      ASSERT_ERROR_CONTAINS (error,
+                             MONGOC_ERROR_STREAM,
+                             MONGOC_ERROR_STREAM_SOCKET,
+                             "socket error or timeout");
+      ASSERT (!cursor->in_exhaust);
+      ASSERT (!client->in_exhaust);
+      future_destroy (future);
+      request_destroy (getmore);
+      mongoc_cursor_destroy (cursor);
+      goto done;
+   }
+
+   mock_server_replies_opmsg (getmore,
+                              MONGOC_MSG_MORE_TO_COME,
+                              tmp_bson ("{'ok': 1, 'cursor': {"
+                                        "   'id': 123, 'ns': 'db.test',"
+                                        "   'nextBatch': [{'a': 3}]}}"));
+   ASSERT (future_get_bool (future));
+   ASSERT_MATCH (doc, "{'a': 3}");
+   future_destroy (future);
+
+   /* the last reply does not set moreToCome, and the cursor is exhausted */
+   future = future_cursor_next (cursor, &doc);
+   mock_server_replies_opmsg (getmore,
+                              MONGOC_MSG_NONE,
+                              tmp_bson ("{'ok': 1, 'cursor': {"
+                                        "   'id': 0, 'ns': 'db.test',"
+                                        "   'nextBatch': [{'a': 4}]}}"));
+   ASSERT (future_get_bool (future));
+   ASSERT_MATCH (doc, "{'a': 4}");
+   ASSERT (!cursor->in_exhaust);
+   ASSERT (!client->in_exhaust);
+   future_destroy (future);
+   request_destroy (getmore);
+
+   ASSERT (!mongoc_cursor_next (cursor, &doc));
+   ASSERT_OR_PRINT (!mongoc_cursor_error (cursor, &error), error);
+   mongoc_cursor_destroy (cursor);
+
+   /* no getMores or killCursors were sent, and the connection is usable */
+   future = future_client_command_simple (
+      client, "admin", tmp_bson ("{'ping': 1}"), NULL, NULL, &error);
+   request = mock_server_receives_msg (
+      server, MONGOC_MSG_NONE, tmp_bson ("{'ping': 1}"));
+   mock_server_replies_simple (request, "{'ok': 1}");
+   ASSERT_OR_PRINT (future_get_bool (future), error);
+   future_destroy (future);
+   request_destroy (request);
+
+done:
+   mongoc_collection_destroy (collection);
+   mongoc_client_destroy (client);
+   mock_server_destroy (server);
+}
+
+static void
+test_exhaust_op_msg (void)
+{
+   _test_exhaust_op_msg (OP_MSG_EXHAUST_COMPLETE);
+}
+
+static void
+test_exhaust_op_msg_destroy (void)
+{
+   _test_exhaust_op_msg (OP_MSG_EXHAUST_DESTROY);
+}
+
+static void
+test_exhaust_op_msg_hangup (void)
+{
+   _test_exhaust_op_msg (OP_MSG_EXHAUST_HANGUP);
+}
+
+/* before MongoDB 4.2, exhaust cursors still use OP_QUERY */
+static void
+test_exhaust_op_msg_old_server (void)
+{
+   mock_server_t *server;
+   mongoc_client_t *client;
+   mongoc_collection_t *collection;
+   mongoc_cursor_t *cursor;
+   const bson_t *doc;
+   future_t *future;
+   request_t *request;
+
+   server = mock_server_with_autoismaster (WIRE_VERSION_EXHAUST_OP_MSG - 1);
+   mock_server_run (server);
+   client = mongoc_client_new_from_uri (mock_server_get_uri (server));
+   collection = mongoc_client_get_collection (client, "db", "test");
+   cursor = mongoc_collection_find_with_opts (
+      collection, tmp_bson ("{}"), tmp_bson ("{'exhaust': true}"), NULL);
+
+   future = future_cursor_next (cursor, &doc);
+   request =
+      mock_server_receives_query (server,
+                                  "db.test",
+                                  MONGOC_QUERY_SLAVE_OK | MONGOC_QUERY_EXHAUST,
+                                  0,
+                                  0,
+                                  "{}",
+                                  NULL);
+   mock_server_replies (request, MONGOC_REPLY_NONE, 0, 0, 1, "{'a': 1}");
+   ASSERT (future_get_bool (future));
+   ASSERT_MATCH (doc, "{'a': 1}");
+
+   future_destroy (future);
+   request_destroy (request);
+   mongoc_cursor_destroy (cursor);
+   mongoc_collection_destroy (collection);
+   mongoc_client_destroy (client);
+   mock_server_destroy (server);
+}
+
 void
 test_exhaust_install (TestSuite *suite)
 {
@@ -589,4 +780,15 @@ test_exhaust_install (TestSuite *suite)
       suite,
       "/Client/exhaust_cursor/err/server/2nd_batch/pooled",
       test_exhaust_server_err_2nd_batch_pooled);
+   TestSuite_AddMockServerTest (
+      suite, "/Client/exhaust_cursor/op_msg", test_exhaust_op_msg);
+   TestSuite_AddMockServerTest (suite,
+                                "/Client/exhaust_cursor/op_msg/destroy",
+                                test_exhaust_op_msg_destroy);
+   TestSuite_AddMockServerTest (suite,
+                                "/Client/exhaust_cursor/op_msg/hangup",
+                                test_exhaust_op_msg_hangup);
+   TestSuite_AddMockServerTest (suite,
+                                "/Client/exhaust_cursor/op_msg/old_server",
+                                test_exhaust_op_msg_old_server);
 }
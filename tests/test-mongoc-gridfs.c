@@ -1359,12 +1359,708 @@ test_find_one_empty (void)
    mongoc_client_destroy (client);
 }
 
+typedef struct {
+   bson_string_t *log;
+   int n_inserts;
+   int fail_insert;
+} upload_test_t;
+
+
+static bool
+upload_responder (request_t *request, void *data)
+{
+   upload_test_t *test;
+   const bson_t *cmd;
+   int i;
+
+   test = (upload_test_t *) data;
+
+   if (!request->command_name) {
+      return false;
+   }
+
+   if (!strcmp (request->command_name, "createIndexes")) {
+      mock_server_replies_ok_and_destroys (request);
+      return true;
+   }
+
+   cmd = request_get_doc (request, 0);
+
+   if (!strcmp (request->command_name, "insert")) {
+      ASSERT_CMPSTR (bson_lookup_utf8 (cmd, "insert"), "fs.chunks");
+      bson_string_append (test->log, "insert");
+      for (i = 1; i < (int) request->docs.len; i++) {
+         bson_string_append_printf (
+            test->log,
+            " %d",
+            bson_lookup_int32 (request_get_doc (request, i), "n"));
+      }
+
+      bson_string_append (test->log, ";");
+
+      if (++test->n_inserts == test->fail_insert) {
+         mock_server_replies_opmsg (
+            request,
+            0,
+            tmp_bson ("{'ok': 1, 'n': 0, 'writeErrors': [{'index': 0,"
+                      " 'code': 11000, 'errmsg': 'duplicate key'}]}"));
+      } else {
+         mock_server_replies_opmsg (
+            request,
+            0,
+            tmp_bson ("{'ok': 1, 'n': %d}", (int) request->docs.len - 1));
+      }
+
+      request_destroy (request);
+      return true;
+   }
+
+   if (!strcmp (request->command_name, "update")) {
+      ASSERT_CMPSTR (bson_lookup_utf8 (cmd, "update"), "fs.files");
+      ASSERT_CMPINT64 (
+         bson_lookup_int64 (request_get_doc (request, 1), "u.$set.length"),
+         ==,
+         (int64_t) 2490);
+      bson_string_append (test->log, "update;");
+      mock_server_replies_opmsg (
+         request, 0, tmp_bson ("{'ok': 1, 'n': 1, 'nModified': 1}"));
+      request_destroy (request);
+      return true;
+   }
+
+   return false;
+}
+
+
+/* upload the 2490-byte gridfs.dat in 256-byte chunks */
+static void
+_test_create_from_stream_batches (const char *ismaster,
+                                  int fail_insert,
+                                  const char *expected_log)
+{
+   mock_server_t *server;
+   mongoc_client_t *client;
+   mongoc_gridfs_t *gridfs;
+   mongoc_gridfs_file_t *file;
+   mongoc_gridfs_file_opt_t opt = {0};
+   mongoc_stream_t *stream;
+   upload_test_t test = {0};
+   bson_error_t error;
+
+   test.log = bson_string_new (NULL);
+   test.fail_insert = fail_insert;
+
+   server = mock_server_new ();
+   mock_server_auto_ismaster (server, ismaster);
+   mock_server_autoresponds (server, upload_responder, &test, NULL);
+   mock_server_run (server);
+
+   client = mongoc_client_new_from_uri (mock_server_get_uri (server));
+   gridfs = mongoc_client_get_gridfs (client, "db", NULL, &error);
+   ASSERT_OR_PRINT (gridfs, error);
+
+   stream =
+      mongoc_stream_file_new_for_path (BINARY_DIR "/gridfs.dat", O_RDONLY, 0);
+   ASSERT_OR_PRINT_ERRNO (stream, errno);
+
+   opt.chunk_size = 256;
+   file = mongoc_gridfs_create_file_from_stream (gridfs, stream, &opt);
+
+   if (fail_insert) {
+      BSON_ASSERT (!file);
+   } else {
+      BSON_ASSERT (file);
+      ASSERT_CMPINT64 (
+         mongoc_gridfs_file_get_length (file), ==, (int64_t) 2490);
+      /* already saved */
+      ASSERT (mongoc_gridfs_file_save (file));
+      mongoc_gridfs_file_destroy (file);
+   }
+
+   ASSERT_CMPSTR (test.log->str, expected_log);
+
+   mongoc_gridfs_destroy (gridfs);
+   mongoc_client_destroy (client);
+   mock_server_destroy (server);
+   bson_string_free (test.log, true);
+}
+
+
+static void
+test_create_from_stream_batch_size (void)
+{
+   _test_create_from_stream_batches (
+      "{'ok': 1, 'ismaster': true, 'minWireVersion': 0,"
+      " 'maxWireVersion': 6, 'maxWriteBatchSize': 4}",
+      0,
+      "insert 0 1 2 3;insert 4 5 6 7;insert 8 9;update;");
+}
+
+
+static void
+test_create_from_stream_message_size (void)
+{
+   /* room for three 318-byte chunk documents after the overhead of 16 KB */
+   _test_create_from_stream_batches (
+      "{'ok': 1, 'ismaster': true, 'minWireVersion': 0,"
+      " 'maxWireVersion': 6, 'maxMessageSizeBytes': 17384}",
+      0,
+      "insert 0 1 2;insert 3 4 5;insert 6 7 8;insert 9;update;");
+}
+
+
+static void
+test_create_from_stream_insert_error (void)
+{
+   /* the last batch isn't sent once the second fails */
+   _test_create_from_stream_batches (
+      "{'ok': 1, 'ismaster': true, 'minWireVersion': 0,"
+      " 'maxWireVersion': 6, 'maxWriteBatchSize': 4}",
+      2,
+      "insert 0 1 2 3;insert 4 5 6 7;");
+}
+
+
+typedef struct {
+   bson_string_t *log;
+   int32_t chunk_size;
+   int32_t n_chunks;
+   int32_t missing;
+} download_test_t;
+
+
+/* serve chunks whose bytes all equal their n, minus the missing chunk */
+static bool
+download_responder (request_t *request, void *data)
+{
+   download_test_t *test;
+   const bson_t *cmd;
+   uint8_t *buf;
+   bson_t reply;
+   bson_t cursor;
+   bson_t batch;
+   bson_t chunk;
+   char str[16];
+   const char *key;
+   int32_t start;
+   int32_t end;
+   int32_t i;
+   uint32_t n = 0;
+
+   test = (download_test_t *) data;
+
+   if (!request->command_name) {
+      return false;
+   }
+
+   if (!strcmp (request->command_name, "createIndexes")) {
+      mock_server_replies_ok_and_destroys (request);
+      return true;
+   }
+
+   if (strcmp (request->command_name, "find")) {
+      return false;
+   }
+
+   cmd = request_get_doc (request, 0);
+   /* "fs.chunks", or another bucket with the same chunks */
+   ASSERT (strstr (bson_lookup_utf8 (cmd, "find"), ".chunks"));
+   start = bson_lookup_int32 (cmd, "filter.n.$gte");
+
+   if (bson_has_field (cmd, "filter.n.$lt")) {
+      end = bson_lookup_int32 (cmd, "filter.n.$lt");
+      ASSERT (bson_has_field (cmd, "singleBatch"));
+      bson_string_append_printf (test->log, "find %d-%d;", start, end);
+   } else {
+      end = test->n_chunks;
+      bson_string_append_printf (test->log, "find %d-;", start);
+   }
+
+   buf = bson_malloc ((size_t) test->chunk_size);
+
+   bson_init (&reply);
+   BSON_APPEND_INT32 (&reply, "ok", 1);
+   BSON_APPEND_DOCUMENT_BEGIN (&reply, "cursor", &cursor);
+   BSON_APPEND_INT64 (&cursor, "id", 0);
+   BSON_APPEND_UTF8 (&cursor, "ns", "db.fs.chunks");
+   BSON_APPEND_ARRAY_BEGIN (&cursor, "firstBatch", &batch);
+
+   for (i = start; i < end; i++) {
+      if (i == test->missing) {
+         continue;
+      }
+
+      memset (buf, i, (size_t) test->chunk_size);
+      bson_uint32_to_string (n++, &key, str, sizeof str);
+      bson_append_document_begin (&batch, key, -1, &chunk);
+      BSON_APPEND_INT32 (&chunk, "n", i);
+      BSON_APPEND_BINARY (
+         &chunk, "data", BSON_SUBTYPE_BINARY, buf, (uint32_t) test->chunk_size);
+      bson_append_document_end (&batch, &chunk);
+   }
+
+   bson_append_array_end (&cursor, &batch);
+   bson_append_document_end (&reply, &cursor);
+
+   mock_server_replies_opmsg (request, 0, &reply);
+   request_destroy (request);
+
+   bson_destroy (&reply);
+   bson_free (buf);
+
+   return true;
+}
+
+
+static mongoc_gridfs_file_t *
+_download_test_file (mock_server_t *server,
+                     mongoc_client_t **client,
+                     mongoc_gridfs_t **gridfs,
+                     download_test_t *test)
+{
+   bson_error_t error;
+
+   mock_server_autoresponds (server, download_responder, test, NULL);
+   mock_server_run (server);
+
+   *client = mongoc_client_new_from_uri (mock_server_get_uri (server));
+   *gridfs = mongoc_client_get_gridfs (*client, "db", NULL, &error);
+   ASSERT_OR_PRINT (*gridfs, error);
+
+   return _mongoc_gridfs_file_new_from_bson (
+      *gridfs,
+      tmp_bson ("{'_id': 1, 'length': {'$numberLong': '%" PRId64 "'},"
+                " 'chunkSize': %d}",
+                (int64_t) test->chunk_size * test->n_chunks,
+                test->chunk_size));
+}
+
+
+/* read the chunks [from, to) and check each byte, returns the number of
+ * chunks read before an error */
+static int32_t
+_download_read (mongoc_gridfs_file_t *file,
+                download_test_t *test,
+                int32_t from,
+                int32_t to)
+{
+   mongoc_iovec_t iov;
+   uint8_t *buf;
+   ssize_t r;
+   int32_t i;
+   int32_t j;
+
+   buf = bson_malloc ((size_t) test->chunk_size);
+   iov.iov_base = (void *) buf;
+   iov.iov_len = (size_t) test->chunk_size;
+
+   ASSERT_CMPINT (mongoc_gridfs_file_seek (
+                     file, (int64_t) from * test->chunk_size, SEEK_SET),
+                  ==,
+                  0);
+
+   for (i = from; i < to; i++) {
+      r = mongoc_gridfs_file_readv (file, &iov, 1, iov.iov_len, 0);
+      if (r < 0) {
+         break;
+      }
+
+      ASSERT_CMPSSIZE_T (r, ==, (ssize_t) test->chunk_size);
+      for (j = 0; j < test->chunk_size; j++) {
+         ASSERT_CMPINT ((int) buf[j], ==, i & 0xff);
+      }
+   }
+
+   bson_free (buf);
+
+   return i - from;
+}
+
+
+static void
+test_download_pipeline (void)
+{
+   mock_server_t *server;
+   mongoc_client_t *client;
+   mongoc_gridfs_t *gridfs;
+   mongoc_gridfs_file_t *file;
+   download_test_t test = {0};
+
+   test.log = bson_string_new (NULL);
+   test.chunk_size = 1024 * 1024;
+   test.n_chunks = 18;
+   test.missing = -1;
+
+   server = mock_server_with_autoismaster (WIRE_VERSION_OP_MSG);
+   file = _download_test_file (server, &client, &gridfs, &test);
+
+   /* 4 chunks per range, 4 ranges per round trip */
+   ASSERT_CMPINT (_download_read (file, &test, 0, test.n_chunks), ==, 18);
+   ASSERT_CMPSTR (test.log->str,
+                  "find 0-4;find 4-8;find 8-12;find 12-16;find 16-18;");
+
+   mongoc_gridfs_file_destroy (file);
+   mongoc_gridfs_destroy (gridfs);
+   mongoc_client_destroy (client);
+   mock_server_destroy (server);
+   bson_string_free (test.log, true);
+}
+
+
+static void
+test_download_missing_chunk (void)
+{
+   mock_server_t *server;
+   mongoc_client_t *client;
+   mongoc_gridfs_t *gridfs;
+   mongoc_gridfs_file_t *file;
+   download_test_t test = {0};
+   bson_error_t error;
+
+   test.log = bson_string_new (NULL);
+   test.chunk_size = 1024 * 1024;
+   test.n_chunks = 18;
+   test.missing = 6;
+
+   server = mock_server_with_autoismaster (WIRE_VERSION_OP_MSG);
+   file = _download_test_file (server, &client, &gridfs, &test);
+
+   /* the chunks before the gap are read, then the gap is an error */
+   ASSERT_CMPINT (_download_read (file, &test, 0, test.n_chunks), ==, 6);
+   ASSERT (mongoc_gridfs_file_error (file, &error));
+   ASSERT_ERROR_CONTAINS (error,
+                          MONGOC_ERROR_GRIDFS,
+                          MONGOC_ERROR_GRIDFS_CHUNK_MISSING,
+                          "missing chunk number 6");
+   ASSERT_CMPSTR (test.log->str,
+                  "find 0-4;find 4-8;find 8-12;find 12-16;"
+                  "find 6-10;find 10-14;find 14-18;");
+
+   mongoc_gridfs_file_destroy (file);
+   mongoc_gridfs_destroy (gridfs);
+   mongoc_client_destroy (client);
+   mock_server_destroy (server);
+   bson_string_free (test.log, true);
+}
+
+
+static void
+test_download_random_access (void)
+{
+   mock_server_t *server;
+   mongoc_client_t *client;
+   mongoc_gridfs_t *gridfs;
+   mongoc_gridfs_file_t *file;
+   download_test_t test = {0};
+
+   test.log = bson_string_new (NULL);
+   test.chunk_size = 1024 * 1024;
+   test.n_chunks = 18;
+   test.missing = -1;
+
+   server = mock_server_with_autoismaster (WIRE_VERSION_OP_MSG);
+   file = _download_test_file (server, &client, &gridfs, &test);
+
+   /* reading from the middle uses a cursor, which then serves the next
+    * chunks too */
+   ASSERT_CMPINT (_download_read (file, &test, 9, 11), ==, 2);
+   ASSERT_CMPSTR (test.log->str, "find 9-;");
+
+   mongoc_gridfs_file_destroy (file);
+   mongoc_gridfs_destroy (gridfs);
+   mongoc_client_destroy (client);
+   mock_server_destroy (server);
+   bson_string_free (test.log, true);
+}
+
+
+/* another handle to the file _download_test_file opened */
+static mongoc_gridfs_file_t *
+_download_test_file_reopen (mongoc_gridfs_t *gridfs, download_test_t *test)
+{
+   return _mongoc_gridfs_file_new_from_bson (
+      gridfs,
+      tmp_bson ("{'_id': 1, 'length': {'$numberLong': '%" PRId64 "'},"
+                " 'chunkSize': %d}",
+                (int64_t) test->chunk_size * test->n_chunks,
+                test->chunk_size));
+}
+
+
+static void
+test_chunk_cache_random_access (void)
+{
+   mock_server_t *server;
+   mongoc_client_t *client;
+   mongoc_gridfs_t *gridfs;
+   mongoc_gridfs_file_t *file;
+   mongoc_gridfs_file_t *file2;
+   mongoc_gridfs_chunk_cache_t *cache;
+   download_test_t test = {0};
+
+   test.log = bson_string_new (NULL);
+   test.chunk_size = 1024 * 1024;
+   test.n_chunks = 18;
+   test.missing = -1;
+
+   server = mock_server_with_autoismaster (WIRE_VERSION_OP_MSG);
+   file = _download_test_file (server, &client, &gridfs, &test);
+   file2 = _download_test_file_reopen (gridfs, &test);
+   cache = mongoc_gridfs_chunk_cache_new (16 * 1024 * 1024);
+   mongoc_gridfs_file_set_chunk_cache (file, cache);
+   mongoc_gridfs_file_set_chunk_cache (file2, cache);
+
+   ASSERT_CMPINT (_download_read (file, &test, 9, 12), ==, 3);
+   ASSERT_CMPSTR (test.log->str, "find 9-;");
+
+   /* seeking backwards doesn't replace the cursor */
+   ASSERT_CMPINT (_download_read (file, &test, 10, 12), ==, 2);
+   ASSERT_CMPSTR (test.log->str, "find 9-;");
+
+   /* another handle reads an overlapping range from the cache, then reads
+    * ahead from the server */
+   ASSERT_CMPINT (_download_read (file2, &test, 11, 13), ==, 2);
+   ASSERT_CMPSTR (test.log->str, "find 9-;find 12-16;find 16-18;");
+
+   mongoc_gridfs_file_destroy (file);
+   mongoc_gridfs_file_destroy (file2);
+   mongoc_gridfs_chunk_cache_destroy (cache);
+   mongoc_gridfs_destroy (gridfs);
+   mongoc_client_destroy (client);
+   mock_server_destroy (server);
+   bson_string_free (test.log, true);
+}
+
+
+static void
+test_chunk_cache_read_ahead (void)
+{
+   mock_server_t *server;
+   mongoc_client_t *client;
+   mongoc_gridfs_t *gridfs;
+   mongoc_gridfs_file_t *file;
+   mongoc_gridfs_file_t *file2;
+   mongoc_gridfs_chunk_cache_t *cache;
+   download_test_t test = {0};
+
+   test.log = bson_string_new (NULL);
+   test.chunk_size = 1024 * 1024;
+   test.n_chunks = 18;
+   test.missing = -1;
+
+   server = mock_server_with_autoismaster (WIRE_VERSION_OP_MSG);
+   file = _download_test_file (server, &client, &gridfs, &test);
+   file2 = _download_test_file_reopen (gridfs, &test);
+   cache = mongoc_gridfs_chunk_cache_new (32 * 1024 * 1024);
+   mongoc_gridfs_file_set_chunk_cache (file, cache);
+   mongoc_gridfs_file_set_chunk_cache (file2, cache);
+
+   /* the chunks fetched ahead are cached before they are read */
+   ASSERT_CMPINT (_download_read (file, &test, 0, 2), ==, 2);
+   ASSERT_CMPSTR (test.log->str, "find 0-4;find 4-8;find 8-12;find 12-16;");
+   ASSERT_CMPINT (_download_read (file2, &test, 0, test.n_chunks), ==, 18);
+   ASSERT_CMPSTR (test.log->str,
+                  "find 0-4;find 4-8;find 8-12;find 12-16;find 16-18;");
+
+   mongoc_gridfs_file_destroy (file);
+   mongoc_gridfs_file_destroy (file2);
+   mongoc_gridfs_chunk_cache_destroy (cache);
+   mongoc_gridfs_destroy (gridfs);
+   mongoc_client_destroy (client);
+   mock_server_destroy (server);
+   bson_string_free (test.log, true);
+}
+
+
+/* files in different buckets can have the same id */
+static void
+test_chunk_cache_buckets (void)
+{
+   mock_server_t *server;
+   mongoc_client_t *client;
+   mongoc_gridfs_t *gridfs;
+   mongoc_gridfs_t *gridfs2;
+   mongoc_gridfs_file_t *file;
+   mongoc_gridfs_file_t *file2;
+   mongoc_gridfs_chunk_cache_t *cache;
+   download_test_t test = {0};
+   bson_error_t error;
+
+   test.log = bson_string_new (NULL);
+   test.chunk_size = 1024 * 1024;
+   test.n_chunks = 18;
+   test.missing = -1;
+
+   server = mock_server_with_autoismaster (WIRE_VERSION_OP_MSG);
+   file = _download_test_file (server, &client, &gridfs, &test);
+   gridfs2 = mongoc_client_get_gridfs (client, "db", "other", &error);
+   ASSERT_OR_PRINT (gridfs2, error);
+   file2 = _download_test_file_reopen (gridfs2, &test);
+   cache = mongoc_gridfs_chunk_cache_new (16 * 1024 * 1024);
+   mongoc_gridfs_file_set_chunk_cache (file, cache);
+   mongoc_gridfs_file_set_chunk_cache (file2, cache);
+
+   ASSERT_CMPINT (_download_read (file, &test, 9, 12), ==, 3);
+   ASSERT_CMPSTR (test.log->str, "find 9-;");
+
+   /* the other bucket's file isn't read from the first one's chunks */
+   ASSERT_CMPINT (_download_read (file2, &test, 9, 12), ==, 3);
+   ASSERT_CMPSTR (test.log->str, "find 9-;find 9-;");
+
+   mongoc_gridfs_file_destroy (file);
+   mongoc_gridfs_file_destroy (file2);
+   mongoc_gridfs_chunk_cache_destroy (cache);
+   mongoc_gridfs_destroy (gridfs);
+   mongoc_gridfs_destroy (gridfs2);
+   mongoc_client_destroy (client);
+   mock_server_destroy (server);
+   bson_string_free (test.log, true);
+}
+
+
+static void
+test_chunk_cache_evict (void)
+{
+   mock_server_t *server;
+   mongoc_client_t *client;
+   mongoc_gridfs_t *gridfs;
+   mongoc_gridfs_file_t *file;
+   mongoc_gridfs_file_t *file2;
+   mongoc_gridfs_chunk_cache_t *cache;
+   download_test_t test = {0};
+
+   test.log = bson_string_new (NULL);
+   test.chunk_size = 1024 * 1024;
+   test.n_chunks = 18;
+   test.missing = -1;
+
+   server = mock_server_with_autoismaster (WIRE_VERSION_OP_MSG);
+   file = _download_test_file (server, &client, &gridfs, &test);
+   file2 = _download_test_file_reopen (gridfs, &test);
+
+   /* room for three chunks */
+   cache = mongoc_gridfs_chunk_cache_new (3 * 1024 * 1024 + 1024);
+   mongoc_gridfs_file_set_chunk_cache (file, cache);
+   mongoc_gridfs_file_set_chunk_cache (file2, cache);
+
+   ASSERT_CMPINT (_download_read (file, &test, 9, 13), ==, 4);
+   ASSERT_CMPSTR (test.log->str, "find 9-;");
+
+   /* chunk 10 was used recently, so 11 is the oldest when 9 is fetched */
+   ASSERT_CMPINT (_download_read (file2, &test, 10, 11), ==, 1);
+   ASSERT_CMPSTR (test.log->str, "find 9-;");
+   ASSERT_CMPINT (_download_read (file2, &test, 9, 10), ==, 1);
+   ASSERT_CMPSTR (test.log->str, "find 9-;find 9-;");
+   ASSERT_CMPINT (_download_read (file2, &test, 12, 13), ==, 1);
+   ASSERT_CMPINT (_download_read (file2, &test, 10, 11), ==, 1);
+   ASSERT_CMPSTR (test.log->str, "find 9-;find 9-;");
+   ASSERT_CMPINT (_download_read (file, &test, 11, 12), ==, 1);
+   ASSERT_CMPSTR (test.log->str, "find 9-;find 9-;find 11-;");
+
+   mongoc_gridfs_file_destroy (file);
+   mongoc_gridfs_file_destroy (file2);
+   mongoc_gridfs_chunk_cache_destroy (cache);
+   mongoc_gridfs_destroy (gridfs);
+   mongoc_client_destroy (client);
+   mock_server_destroy (server);
+   bson_string_free (test.log, true);
+}
+
+
+#define DOWNLOAD_BENCHMARK_CHUNKS 256
+
+/* measure how fast a 64 MB file in default-sized chunks is read through a
+ * GridFS stream */
+static void
+test_download_throughput (void *ctx)
+{
+   mock_server_t *server;
+   mongoc_client_t *client;
+   mongoc_gridfs_t *gridfs;
+   mongoc_gridfs_file_t *file;
+   mongoc_stream_t *stream;
+   download_test_t test = {0};
+   mongoc_iovec_t iov;
+   uint8_t buf[64 * 1024];
+   int64_t total = 0;
+   int64_t start;
+   int64_t elapsed;
+   ssize_t r;
+
+   test.log = bson_string_new (NULL);
+   test.chunk_size = 255 * 1024;
+   test.n_chunks = DOWNLOAD_BENCHMARK_CHUNKS;
+   test.missing = -1;
+
+   server = mock_server_with_autoismaster (WIRE_VERSION_OP_MSG);
+   file = _download_test_file (server, &client, &gridfs, &test);
+   stream = mongoc_stream_gridfs_new (file);
+
+   iov.iov_base = (void *) buf;
+   iov.iov_len = sizeof buf;
+
+   start = bson_get_monotonic_time ();
+   while ((r = mongoc_stream_readv (stream, &iov, 1, sizeof buf, 0)) > 0) {
+      total += r;
+   }
+
+   elapsed = bson_get_monotonic_time () - start;
+   ASSERT_CMPINT64 (total, ==, (int64_t) test.chunk_size * test.n_chunks);
+
+   if (test_suite_debug_output ()) {
+      printf ("      %.1f MB in %.3f s (%.1f MB/s)\n",
+              (double) total / (1024 * 1024),
+              (double) elapsed / 1e6,
+              (double) total / (1024 * 1024) * 1e6 /
+                 (double) BSON_MAX (elapsed, 1));
+      fflush (stdout);
+   }
+
+   mongoc_stream_destroy (stream);
+   mongoc_gridfs_file_destroy (file);
+   mongoc_gridfs_destroy (gridfs);
+   mongoc_client_destroy (client);
+   mock_server_destroy (server);
+   bson_string_free (test.log, true);
+}
+
+
 void
 test_gridfs_install (TestSuite *suite)
 {
    TestSuite_AddLive (suite, "/GridFS/create", test_create);
    TestSuite_AddLive (
       suite, "/GridFS/create_from_stream", test_create_from_stream);
+   TestSuite_AddMockServerTest (suite,
+                                "/GridFS/create_from_stream/batch_size",
+                                test_create_from_stream_batch_size);
+   TestSuite_AddMockServerTest (suite,
+                                "/GridFS/create_from_stream/message_size",
+                                test_create_from_stream_message_size);
+   TestSuite_AddMockServerTest (suite,
+                                "/GridFS/create_from_stream/insert_error",
+                                test_create_from_stream_insert_error);
+   TestSuite_AddMockServerTest (
+      suite, "/GridFS/download/pipeline", test_download_pipeline);
+   TestSuite_AddMockServerTest (
+      suite, "/GridFS/download/missing_chunk", test_download_missing_chunk);
+   TestSuite_AddMockServerTest (
+      suite, "/GridFS/download/random_access", test_download_random_access);
+   TestSuite_AddMockServerTest (suite,
+                                "/GridFS/chunk_cache/random_access",
+                                test_chunk_cache_random_access);
+   TestSuite_AddMockServerTest (
+      suite, "/GridFS/chunk_cache/read_ahead", test_chunk_cache_read_ahead);
+   TestSuite_AddMockServerTest (
+      suite, "/GridFS/chunk_cache/buckets", test_chunk_cache_buckets);
+   TestSuite_AddMockServerTest (
+      suite, "/GridFS/chunk_cache/evict", test_chunk_cache_evict);
+   TestSuite_AddFull (suite,
+                      "/GridFS/download/throughput",
+                      test_download_throughput,
+                      NULL,
+                      NULL,
+                      test_framework_skip_if_slow);
    TestSuite_AddLive (suite, "/GridFS/list", test_list);
    TestSuite_AddLive (suite, "/GridFS/find_one_empty", test_find_one_empty);
    TestSuite_AddLive (suite, "/GridFS/find_with_opts", test_find_with_opts);
@@ -0,0 +1,236 @@
+#include <mongoc.h>
+#include <mongoc-thread-private.h>
+
+#include "TestSuite.h"
+#include "test-conveniences.h"
+#include "test-libmongoc.h"
+#include "mock_server/mock-server.h"
+
+
+/* a JSON reader over documents with _ids 0 to n - 1, and @extra */
+static bson_json_reader_t *
+importer_json_reader (int n, const char *extra, bson_string_t **json)
+{
+   bson_json_reader_t *reader;
+   int i;
+
+   *json = bson_string_new ("");
+   for (i = 0; i < n; i++) {
+      bson_string_append_printf (*json, "{\"_id\": %d}\n", i);
+   }
+
+   if (extra) {
+      bson_string_append (*json, extra);
+   }
+
+   reader = bson_json_data_reader_new (true, 1024);
+   bson_json_data_reader_ingest (
+      reader, (const uint8_t *) (*json)->str, (*json)->len);
+
+   return reader;
+}
+
+
+/* batches are sent on several connections, and write errors are reported in
+ * the order of the documents */
+static void
+test_importer_unordered (void)
+{
+   mock_insert_counts_t test = {0};
+   mock_server_t *server;
+   mongoc_client_pool_t *pool;
+   mongoc_importer_t *importer;
+   bson_json_reader_t *reader;
+   bson_string_t *json;
+   bson_t reply;
+   bson_error_t error;
+
+   mongoc_mutex_init (&test.mutex);
+   server = mock_server_with_insert_counts (2, &test);
+   mock_server_run (server);
+   pool = mongoc_client_pool_new (mock_server_get_uri (server));
+   importer = mongoc_importer_new (
+      pool,
+      "db",
+      "collection",
+      tmp_bson ("{'ordered': false, 'workers': 3, 'connections': 3}"));
+
+   reader = importer_json_reader (11, NULL, &json);
+   ASSERT (!mongoc_importer_import_json_reader (
+      importer, reader, &reply, &error));
+   ASSERT_ERROR_CONTAINS (error, MONGOC_ERROR_COMMAND, 11000, "duplicate");
+   ASSERT_MATCH (&reply,
+                 "{'nInserted': 9,"
+                 " 'writeErrors': [{'index': 3}, {'index': 7}],"
+                 " 'nDocuments': 11,"
+                 " 'nBatches': 6}");
+   assert_error_count (2, &reply);
+   ASSERT_CMPINT (test.n_commands, ==, 6);
+   ASSERT_CMPINT (test.n_documents, ==, 11);
+
+   bson_destroy (&reply);
+   bson_json_reader_destroy (reader);
+   bson_string_free (json, true);
+   mongoc_importer_destroy (importer);
+   mongoc_client_pool_destroy (pool);
+   mock_server_destroy (server);
+   mongoc_mutex_destroy (&test.mutex);
+}
+
+
+/* an ordered import of BSON stops at the first write error */
+static void
+test_importer_ordered (void)
+{
+   mock_insert_counts_t test = {0};
+   mock_server_t *server;
+   mongoc_client_pool_t *pool;
+   mongoc_importer_t *importer;
+   bson_reader_t *reader;
+   bson_writer_t *bson_writer;
+   uint8_t *buf = NULL;
+   size_t buflen = 0;
+   bson_t *doc;
+   bson_t reply;
+   bson_error_t error;
+   int i;
+
+   mongoc_mutex_init (&test.mutex);
+   server = mock_server_with_insert_counts (2, &test);
+   mock_server_run (server);
+   pool = mongoc_client_pool_new (mock_server_get_uri (server));
+   importer = mongoc_importer_new (pool, "db", "collection", NULL);
+
+   bson_writer = bson_writer_new (&buf, &buflen, 0, bson_realloc_ctx, NULL);
+   for (i = 0; i < 10; i++) {
+      bson_writer_begin (bson_writer, &doc);
+      BSON_APPEND_INT32 (doc, "_id", i);
+      bson_writer_end (bson_writer);
+   }
+
+   reader =
+      bson_reader_new_from_data (buf, bson_writer_get_length (bson_writer));
+   ASSERT (!mongoc_importer_import_reader (importer, reader, &reply, &error));
+   ASSERT_ERROR_CONTAINS (error, MONGOC_ERROR_COMMAND, 11000, "duplicate");
+   ASSERT_MATCH (&reply,
+                 "{'nInserted': 3,"
+                 " 'writeErrors': [{'index': 3}],"
+                 " 'nDocuments': 10,"
+                 " 'nBatches': 2}");
+   assert_error_count (1, &reply);
+   ASSERT_CMPINT (test.n_commands, ==, 2);
+
+   bson_destroy (&reply);
+   bson_reader_destroy (reader);
+   bson_writer_destroy (bson_writer);
+   bson_free (buf);
+   mongoc_importer_destroy (importer);
+   mongoc_client_pool_destroy (pool);
+   mock_server_destroy (server);
+   mongoc_mutex_destroy (&test.mutex);
+}
+
+
+/* invalid options and JSON stop the import, invalid documents are write
+ * errors */
+static void
+test_importer_errors (void)
+{
+   mock_insert_counts_t test = {0};
+   mock_server_t *server;
+   mongoc_client_pool_t *pool;
+   mongoc_importer_t *importer;
+   bson_json_reader_t *reader;
+   bson_string_t *json;
+   bson_t reply;
+   bson_error_t error;
+
+   mongoc_mutex_init (&test.mutex);
+   server = mock_server_with_insert_counts (2, &test);
+   mock_server_run (server);
+   pool = mongoc_client_pool_new (mock_server_get_uri (server));
+
+   importer = mongoc_importer_new (
+      pool, "db", "collection", tmp_bson ("{'connections': 0}"));
+   reader = importer_json_reader (1, NULL, &json);
+   ASSERT (!mongoc_importer_import_json_reader (
+      importer, reader, &reply, &error));
+   ASSERT_ERROR_CONTAINS (error,
+                          MONGOC_ERROR_COMMAND,
+                          MONGOC_ERROR_COMMAND_INVALID_ARG,
+                          "Invalid connections");
+   bson_destroy (&reply);
+   bson_json_reader_destroy (reader);
+   bson_string_free (json, true);
+   mongoc_importer_destroy (importer);
+
+   /* an ordered import inserts every document before an invalid one */
+   importer = mongoc_importer_new (pool, "db", "collection", NULL);
+   reader = importer_json_reader (3, "{\"_id\": 4}\n{\"$bad\": 1}\n", &json);
+   ASSERT (!mongoc_importer_import_json_reader (
+      importer, reader, &reply, &error));
+   ASSERT_ERROR_CONTAINS (error,
+                          MONGOC_ERROR_COMMAND,
+                          MONGOC_ERROR_COMMAND_INVALID_ARG,
+                          "invalid document");
+   ASSERT_MATCH (&reply,
+                 "{'nInserted': 4,"
+                 " 'writeErrors': [{'index': 4, 'code': %d}],"
+                 " 'nDocuments': 5}",
+                 MONGOC_ERROR_COMMAND_INVALID_ARG);
+   assert_error_count (1, &reply);
+   bson_destroy (&reply);
+   bson_json_reader_destroy (reader);
+   bson_string_free (json, true);
+   mongoc_importer_destroy (importer);
+
+   /* an unordered import skips invalid documents, and reports errors from
+    * the server at the index of the document in the input */
+   importer = mongoc_importer_new (
+      pool, "db", "collection", tmp_bson ("{'ordered': false}"));
+   reader = importer_json_reader (
+      1, "{\"$bad\": 1}\n{\"$bad\": 2}\n{\"_id\": 3}\n", &json);
+   ASSERT (!mongoc_importer_import_json_reader (
+      importer, reader, &reply, &error));
+   ASSERT_MATCH (&reply,
+                 "{'nInserted': 1,"
+                 " 'writeErrors': [{'index': 1, 'code': %d},"
+                 "                 {'index': 2, 'code': %d},"
+                 "                 {'index': 3, 'code': 11000}],"
+                 " 'nDocuments': 4}",
+                 MONGOC_ERROR_COMMAND_INVALID_ARG,
+                 MONGOC_ERROR_COMMAND_INVALID_ARG);
+   assert_error_count (3, &reply);
+   bson_destroy (&reply);
+   bson_json_reader_destroy (reader);
+   bson_string_free (json, true);
+   mongoc_importer_destroy (importer);
+
+   importer = mongoc_importer_new (pool, "db", "collection", NULL);
+
+   reader = importer_json_reader (2, "{\"_id\": ", &json);
+   ASSERT (!mongoc_importer_import_json_reader (
+      importer, reader, &reply, &error));
+   ASSERT_CMPUINT32 (error.domain, ==, (uint32_t) BSON_ERROR_JSON);
+   ASSERT_MATCH (&reply, "{'nInserted': 2, 'nDocuments': 2}");
+   bson_destroy (&reply);
+   bson_json_reader_destroy (reader);
+   bson_string_free (json, true);
+
+   mongoc_importer_destroy (importer);
+   mongoc_client_pool_destroy (pool);
+   mock_server_destroy (server);
+   mongoc_mutex_destroy (&test.mutex);
+}
+
+
+void
+test_importer_install (TestSuite *suite)
+{
+   TestSuite_AddMockServerTest (
+      suite, "/Importer/unordered", test_importer_unordered);
+   TestSuite_AddMockServerTest (
+      suite, "/Importer/ordered", test_importer_ordered);
+   TestSuite_AddMockServerTest (
+      suite, "/Importer/errors", test_importer_errors);
+}
@@ -691,7 +691,10 @@ test_rs_failover (void)
    future = future_collection_insert_one (
       collection, tmp_bson ("{}"), &opts, NULL, &error);
    request =
-      mock_rs_receives_msg (rs, 0, tmp_bson ("{'insert': 'collection'}"));
+      mock_rs_receives_msg (rs,
+                            0,
+                            tmp_bson ("{'insert': 'collection'}"),
+                            tmp_bson ("{}"));
    mock_server_replies_ok_and_destroys (request);
    BSON_ASSERT (future_get_bool (future));
    future_destroy (future);
@@ -705,13 +708,19 @@ test_rs_failover (void)
       collection, tmp_bson ("{}"), &opts, NULL, &error);
 
    request =
-      mock_rs_receives_msg (rs, 0, tmp_bson ("{'insert': 'collection'}"));
+      mock_rs_receives_msg (rs,
+                            0,
+                            tmp_bson ("{'insert': 'collection'}"),
+                            tmp_bson ("{}"));
    BSON_ASSERT (mock_rs_request_is_to_secondary (rs, request));
    mock_server_replies_simple (request, "{'ok': 0, 'errmsg': 'not master'}");
    request_destroy (request);
 
    request =
-      mock_rs_receives_msg (rs, 0, tmp_bson ("{'insert': 'collection'}"));
+      mock_rs_receives_msg (rs,
+                            0,
+                            tmp_bson ("{'insert': 'collection'}"),
+                            tmp_bson ("{}"));
    BSON_ASSERT (mock_rs_request_is_to_primary (rs, request));
    mock_server_replies_ok_and_destroys (request);
    BSON_ASSERT (future_get_bool (future));
@@ -28,6 +28,122 @@ test_mongoc_scram_step_username_not_set (void)
 
    _mongoc_scram_destroy (&scram);
 }
+
+
+/* run SCRAM steps 1 and 2 against a server that sends @salt and
+ * @iterations, return a copy of the client's keys in @scram */
+static void
+_scram_step2 (mongoc_scram_t *scram,
+              const char *pass,
+              const char *salt,
+              int iterations)
+{
+   uint8_t buf[4096] = {0};
+   uint32_t buflen = 0;
+   char *server_first;
+   bson_error_t error;
+
+   _mongoc_scram_init (scram);
+   _mongoc_scram_set_user (scram, "user");
+   _mongoc_scram_set_pass (scram, pass);
+
+   ASSERT_OR_PRINT (
+      _mongoc_scram_step (scram, buf, buflen, buf, sizeof buf, &buflen, &error),
+      error);
+
+   server_first = bson_strdup_printf ("r=%.*sSERVERNONCE,s=%s,i=%d",
+                                      (int) scram->encoded_nonce_len,
+                                      scram->encoded_nonce,
+                                      salt,
+                                      iterations);
+
+   ASSERT_OR_PRINT (_mongoc_scram_step (scram,
+                                        (uint8_t *) server_first,
+                                        (uint32_t) strlen (server_first),
+                                        buf,
+                                        sizeof buf,
+                                        &buflen,
+                                        &error),
+                    error);
+
+   bson_free (server_first);
+}
+
+
+static void
+test_mongoc_scram_cache (void)
+{
+   const char *salt = "c2FsdHNhbHRzYWx0c2FsdA==";
+   const char *other_salt = "b3RoZXJzYWx0b3RoZXJzYQ==";
+   mongoc_scram_t first;
+   mongoc_scram_t second;
+   mongoc_scram_t other;
+
+   _mongoc_scram_cache_clear ();
+
+   _scram_step2 (&first, "password", salt, 1000);
+   ASSERT_CMPINT (_mongoc_scram_cache_count (), ==, 1);
+
+   /* same password, salt, and iteration count are served from the cache */
+   _scram_step2 (&second, "password", salt, 1000);
+   ASSERT_CMPINT (_mongoc_scram_cache_count (), ==, 1);
+   ASSERT (!memcmp (first.salted_password,
+                    second.salted_password,
+                    sizeof first.salted_password));
+   ASSERT (!memcmp (
+      first.client_key, second.client_key, sizeof first.client_key));
+   ASSERT (!memcmp (
+      first.server_key, second.server_key, sizeof first.server_key));
+
+   /* any difference in the inputs derives new keys */
+   _scram_step2 (&other, "password", salt, 2000);
+   ASSERT_CMPINT (_mongoc_scram_cache_count (), ==, 2);
+   ASSERT (memcmp (first.salted_password,
+                   other.salted_password,
+                   sizeof first.salted_password));
+   _mongoc_scram_destroy (&other);
+
+   _scram_step2 (&other, "password", other_salt, 1000);
+   ASSERT_CMPINT (_mongoc_scram_cache_count (), ==, 3);
+   ASSERT (memcmp (first.salted_password,
+                   other.salted_password,
+                   sizeof first.salted_password));
+   _mongoc_scram_destroy (&other);
+
+   _scram_step2 (&other, "drowssap", salt, 1000);
+   ASSERT_CMPINT (_mongoc_scram_cache_count (), ==, 4);
+   ASSERT (memcmp (first.salted_password,
+                   other.salted_password,
+                   sizeof first.salted_password));
+   _mongoc_scram_destroy (&other);
+
+   _mongoc_scram_cache_clear ();
+   ASSERT_CMPINT (_mongoc_scram_cache_count (), ==, 0);
+
+   _mongoc_scram_destroy (&first);
+   _mongoc_scram_destroy (&second);
+}
+
+
+static void
+test_mongoc_scram_cache_eviction (void)
+{
+   const char *salt = "c2FsdHNhbHRzYWx0c2FsdA==";
+   mongoc_scram_t scram;
+   int i;
+
+   _mongoc_scram_cache_clear ();
+
+   /* the cache is bounded, the least recently used entries are evicted */
+   for (i = 0; i < 100; i++) {
+      _scram_step2 (&scram, "password", salt, 10 + i);
+      _mongoc_scram_destroy (&scram);
+   }
+
+   ASSERT_CMPINT (_mongoc_scram_cache_count (), ==, 64);
+
+   _mongoc_scram_cache_clear ();
+}
 #endif
 
 
@@ -38,5 +154,8 @@ test_scram_install (TestSuite *suite)
    TestSuite_Add (suite,
                   "/scram/username_not_set",
                   test_mongoc_scram_step_username_not_set);
+   TestSuite_Add (suite, "/scram/cache", test_mongoc_scram_cache);
+   TestSuite_Add (
+      suite, "/scram/cache/eviction", test_mongoc_scram_cache_eviction);
 #endif
 }
@@ -403,11 +403,107 @@ test_mongoc_socket_sendv (void *ctx)
 }
 
 
+/* a loopback socket bound to an ephemeral port, its address in @addr */
+static mongoc_socket_t *
+_loopback_socket (struct sockaddr_in *addr)
+{
+   mongoc_socket_t *sock;
+   mongoc_socklen_t sock_len = sizeof *addr;
+   int r;
+
+   sock = mongoc_socket_new (AF_INET, SOCK_STREAM, 0);
+   BSON_ASSERT (sock);
+
+   memset (addr, 0, sizeof *addr);
+   addr->sin_family = AF_INET;
+   addr->sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+   addr->sin_port = htons (0);
+
+   r = mongoc_socket_bind (sock, (struct sockaddr *) addr, sizeof *addr);
+   BSON_ASSERT (r == 0);
+
+   r = mongoc_socket_getsockname (sock, (struct sockaddr *) addr, &sock_len);
+   BSON_ASSERT (r == 0);
+
+   return sock;
+}
+
+
+static void
+_addrinfo_init (struct addrinfo *ai,
+                struct sockaddr_in *addr,
+                struct addrinfo *next)
+{
+   memset (ai, 0, sizeof *ai);
+   ai->ai_family = AF_INET;
+   ai->ai_socktype = SOCK_STREAM;
+   ai->ai_addr = (struct sockaddr *) addr;
+   ai->ai_addrlen = sizeof *addr;
+   ai->ai_next = next;
+}
+
+
+static void
+test_mongoc_socket_connect_any (void)
+{
+   mongoc_socket_t *listen_sock;
+   mongoc_socket_t *closed_sock;
+   mongoc_socket_t *sock;
+   struct sockaddr_in listening;
+   struct sockaddr_in closed;
+   struct sockaddr_in blackhole;
+   struct addrinfo ai[3];
+   int64_t start;
+   int r;
+
+   listen_sock = _loopback_socket (&listening);
+   r = mongoc_socket_listen (listen_sock, 10);
+   BSON_ASSERT (r == 0);
+
+   /* nothing listens on this port once the socket is closed */
+   closed_sock = _loopback_socket (&closed);
+   mongoc_socket_destroy (closed_sock);
+
+   /* TEST-NET-1, connecting either fails or hangs */
+   memset (&blackhole, 0, sizeof blackhole);
+   blackhole.sin_family = AF_INET;
+   blackhole.sin_addr.s_addr = htonl (0xC0000201);
+   blackhole.sin_port = listening.sin_port;
+
+   /* refused, then unresponsive, then listening */
+   _addrinfo_init (&ai[2], &listening, NULL);
+   _addrinfo_init (&ai[1], &blackhole, &ai[2]);
+   _addrinfo_init (&ai[0], &closed, &ai[1]);
+
+   start = bson_get_monotonic_time ();
+   sock = mongoc_socket_connect_any (
+      ai, 100, start + 1000 * (int64_t) TIMEOUT);
+   BSON_ASSERT (sock);
+
+   /* the unresponsive address didn't hold us up for the whole timeout */
+   ASSERT_CMPINT64 (bson_get_monotonic_time () - start,
+                    <,
+                    (int64_t) 1000 * TIMEOUT / 2);
+
+   mongoc_socket_destroy (sock);
+
+   /* every address refuses */
+   _addrinfo_init (&ai[0], &closed, NULL);
+   sock = mongoc_socket_connect_any (
+      ai, 100, bson_get_monotonic_time () + 1000 * (int64_t) TIMEOUT);
+   BSON_ASSERT (!sock);
+   ASSERT_CMPINT (errno, ==, ECONNREFUSED);
+
+   mongoc_socket_destroy (listen_sock);
+}
+
 void
 test_socket_install (TestSuite *suite)
 {
    TestSuite_Add (
       suite, "/Socket/check_closed", test_mongoc_socket_check_closed);
+   TestSuite_Add (
+      suite, "/Socket/connect_any", test_mongoc_socket_connect_any);
    TestSuite_AddFull (suite,
                       "/Socket/timed_out",
                       test_mongoc_socket_timed_out,
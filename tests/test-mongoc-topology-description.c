@@ -141,6 +141,90 @@ test_get_servers (void)
 }
 
 
+static void
+test_select_power_of_two_choices (void)
+{
+   mongoc_uri_t *uri;
+   mongoc_topology_t *topology;
+   mongoc_topology_description_t *td;
+   mongoc_server_description_t *sd_a;
+   mongoc_server_description_t *sd_b;
+   mongoc_server_description_t *sd;
+   mongoc_server_load_t *load_a;
+   mongoc_server_load_t *load_b;
+   bool selected_a = false;
+   int i;
+
+   uri = mongoc_uri_new ("mongodb://a,b");
+   topology = mongoc_topology_new (uri, true /* single-threaded */);
+   td = &topology->description;
+   BSON_ASSERT (!td->server_load);
+
+   sd_a = _sd_for_host (td, "a");
+   mongoc_topology_description_handle_ismaster (
+      td, sd_a->id, tmp_bson ("{'ok': 1, 'msg': 'isdbgrid'}"), 100, NULL);
+
+   sd_b = _sd_for_host (td, "b");
+   mongoc_topology_description_handle_ismaster (
+      td, sd_b->id, tmp_bson ("{'ok': 1, 'msg': 'isdbgrid'}"), 100, NULL);
+
+   load_a = &topology->server_load[sd_a->id % MONGOC_SERVER_LOAD_SLOTS];
+   load_b = &topology->server_load[sd_b->id % MONGOC_SERVER_LOAD_SLOTS];
+
+   /* random selection ignores load */
+   load_a->in_flight = 10;
+   for (i = 0; i < 100; i++) {
+      sd = mongoc_topology_description_select (td, MONGOC_SS_READ, NULL, 15);
+      selected_a |= (sd == sd_a);
+   }
+
+   BSON_ASSERT (selected_a);
+   mongoc_topology_destroy (topology);
+   mongoc_uri_destroy (uri);
+
+   uri = mongoc_uri_new (
+      "mongodb://a,b/?" MONGOC_URI_SERVERSELECTIONPOLICY "=powerOfTwoChoices");
+   topology = mongoc_topology_new (uri, true /* single-threaded */);
+   td = &topology->description;
+   BSON_ASSERT (td->server_load == topology->server_load);
+
+   sd_a = _sd_for_host (td, "a");
+   mongoc_topology_description_handle_ismaster (
+      td, sd_a->id, tmp_bson ("{'ok': 1, 'msg': 'isdbgrid'}"), 100, NULL);
+
+   sd_b = _sd_for_host (td, "b");
+   mongoc_topology_description_handle_ismaster (
+      td, sd_b->id, tmp_bson ("{'ok': 1, 'msg': 'isdbgrid'}"), 100, NULL);
+
+   load_a = &topology->server_load[sd_a->id % MONGOC_SERVER_LOAD_SLOTS];
+   load_b = &topology->server_load[sd_b->id % MONGOC_SERVER_LOAD_SLOTS];
+
+   /* "a" is busier */
+   load_a->in_flight = 10;
+   for (i = 0; i < 100; i++) {
+      sd = mongoc_topology_description_select (td, MONGOC_SS_READ, NULL, 15);
+      ASSERT_CMPSTR ("b", sd->host.host);
+   }
+
+   /* "b" has been slow lately */
+   load_a->in_flight = 0;
+   _mongoc_topology_op_finished (
+      topology,
+      sd_b->id,
+      _mongoc_topology_op_started (topology, sd_b->id) - 100 * 1000);
+   _mongoc_topology_op_finished (
+      topology, sd_a->id, _mongoc_topology_op_started (topology, sd_a->id));
+   ASSERT_CMPINT (load_b->in_flight, ==, 0);
+   for (i = 0; i < 100; i++) {
+      sd = mongoc_topology_description_select (td, MONGOC_SS_READ, NULL, 15);
+      ASSERT_CMPSTR ("a", sd->host.host);
+   }
+
+   mongoc_topology_destroy (topology);
+   mongoc_uri_destroy (uri);
+}
+
+
 void
 test_topology_description_install (TestSuite *suite)
 {
@@ -151,4 +235,7 @@ test_topology_description_install (TestSuite *suite)
                       "/TopologyDescription/readable_writable/pooled",
                       test_has_readable_writable_server_pooled);
    TestSuite_Add (suite, "/TopologyDescription/get_servers", test_get_servers);
+   TestSuite_Add (suite,
+                  "/TopologyDescription/select/power_of_two_choices",
+                  test_select_power_of_two_choices);
 }
@@ -402,6 +402,105 @@ test_topology_scanner_blocking_initiator (void)
 }
 
 
+static void
+_multiple_addresses_cb (uint32_t id,
+                        const bson_t *bson,
+                        int64_t rtt_msec,
+                        void *data,
+                        const bson_error_t *error /* IN */)
+{
+   ASSERT_CMPINT (error->code, ==, 0);
+   BSON_ASSERT (bson);
+
+   *(bool *) data = true;
+}
+
+
+/* an address list entry allocated the way the DNS cache copies them */
+static struct addrinfo *
+_loopback_addrinfo (uint16_t port, uint32_t s_addr, struct addrinfo *next)
+{
+   struct addrinfo *ai;
+   struct sockaddr_in *addr;
+
+   ai = (struct addrinfo *) bson_malloc0 (sizeof *ai + sizeof *addr);
+   addr = (struct sockaddr_in *) (ai + 1);
+   addr->sin_family = AF_INET;
+   addr->sin_port = htons (port);
+   addr->sin_addr.s_addr = htonl (s_addr);
+
+   ai->ai_family = AF_INET;
+   ai->ai_socktype = SOCK_STREAM;
+   ai->ai_addr = (struct sockaddr *) addr;
+   ai->ai_addrlen = (mongoc_socklen_t) sizeof *addr;
+   ai->ai_next = next;
+
+   return ai;
+}
+
+
+/* a host with several addresses: the scanner races them without blocking
+ * on the refused or unresponsive ones */
+static void
+test_topology_scanner_multiple_addresses (void)
+{
+   mock_server_t *server;
+   mongoc_topology_scanner_t *ts;
+   mongoc_topology_scanner_node_t *node;
+   mongoc_socket_t *closed_sock;
+   struct sockaddr_in closed = {0};
+   mongoc_socklen_t closed_len = (mongoc_socklen_t) sizeof closed;
+   uint16_t port;
+   bool succeeded = false;
+   int64_t start;
+
+   server = mock_server_with_autoismaster (WIRE_VERSION_MIN);
+   port = mock_server_run (server);
+
+   /* nothing listens on this port once the socket is closed */
+   closed_sock = mongoc_socket_new (AF_INET, SOCK_STREAM, 0);
+   closed.sin_family = AF_INET;
+   closed.sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+   ASSERT_CMPINT (mongoc_socket_bind (closed_sock,
+                                      (struct sockaddr *) &closed,
+                                      sizeof closed),
+                  ==,
+                  0);
+   ASSERT_CMPINT (mongoc_socket_getsockname (
+                     closed_sock, (struct sockaddr *) &closed, &closed_len),
+                  ==,
+                  0);
+   mongoc_socket_destroy (closed_sock);
+
+   ts = mongoc_topology_scanner_new (
+      NULL, NULL, &_multiple_addresses_cb, &succeeded);
+   mongoc_topology_scanner_add (
+      ts, mongoc_uri_get_hosts (mock_server_get_uri (server)), 0);
+
+   /* refused, then TEST-NET-1 which fails or hangs, then the server */
+   node = mongoc_topology_scanner_get_node (ts, 0);
+   node->dns_results = _loopback_addrinfo (
+      ntohs (closed.sin_port),
+      INADDR_LOOPBACK,
+      _loopback_addrinfo (
+         port, 0xC0000201, _loopback_addrinfo (port, INADDR_LOOPBACK, NULL)));
+   node->current_dns_result = node->dns_results;
+
+   start = bson_get_monotonic_time ();
+   mongoc_topology_scanner_start (ts, TIMEOUT, false);
+   mongoc_topology_scanner_work (ts);
+
+   BSON_ASSERT (succeeded);
+   BSON_ASSERT (node->stream);
+   ASSERT_CMPINT64 (bson_get_monotonic_time () - start,
+                    <,
+                    (int64_t) 1000 * TIMEOUT / 2);
+
+   mongoc_topology_scanner_destroy (ts);
+   mock_server_destroy (server);
+}
+
+
 void
 test_topology_scanner_install (TestSuite *suite)
 {
@@ -424,4 +523,7 @@ test_topology_scanner_install (TestSuite *suite)
    TestSuite_AddMockServerTest (suite,
                                 "/TOPOLOGY/blocking_initiator",
                                 test_topology_scanner_blocking_initiator);
+   TestSuite_AddMockServerTest (suite,
+                                "/TOPOLOGY/scanner_multiple_addresses",
+                                test_topology_scanner_multiple_addresses);
 }
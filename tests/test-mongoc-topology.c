@@ -2,6 +2,7 @@
 #include <mongoc-uri-private.h>
 
 #include "mongoc-client-private.h"
+#include "mongoc-thread-private.h"
 #include "mongoc-util-private.h"
 #include "TestSuite.h"
 
@@ -1458,6 +1459,315 @@ test_compatible_null_error_pointer (void)
 }
 
 
+static void
+test_topology_snapshot (void)
+{
+   mock_server_t *server;
+   mongoc_client_pool_t *pool;
+   mongoc_client_t *client;
+   mongoc_topology_t *topology;
+   mongoc_topology_snapshot_t *snapshot;
+   mongoc_server_description_t *sd;
+   mongoc_server_stream_t *server_stream;
+   bson_error_t error;
+
+   server = mock_server_with_autoismaster (WIRE_VERSION_OP_MSG);
+   mock_server_run (server);
+   pool = mongoc_client_pool_new (mock_server_get_uri (server));
+   client = mongoc_client_pool_pop (pool);
+   topology = client->topology;
+
+   ASSERT_OR_PRINT (
+      mongoc_topology_select_server_id (topology, MONGOC_SS_READ, NULL, &error),
+      error);
+
+   /* the scanner published what it discovered */
+   snapshot = _mongoc_topology_get_snapshot (topology);
+   sd = mongoc_topology_description_server_by_id (
+      &snapshot->description, 1, NULL);
+   BSON_ASSERT (sd);
+   ASSERT_CMPINT (sd->type, ==, MONGOC_SERVER_STANDALONE);
+   BSON_ASSERT (bson_empty (&snapshot->description.cluster_time));
+
+   /* a reader keeps its snapshot while a new one is published */
+   bson_set_error (
+      &error, MONGOC_ERROR_STREAM, MONGOC_ERROR_STREAM_SOCKET, "error");
+   mongoc_topology_invalidate_server (topology, 1, &error);
+   ASSERT_CMPINT (sd->type, ==, MONGOC_SERVER_STANDALONE);
+   _mongoc_topology_snapshot_release (snapshot);
+
+   ASSERT_CMPINT (
+      _mongoc_topology_get_type (topology), ==, MONGOC_TOPOLOGY_SINGLE);
+   sd = mongoc_topology_server_by_id (topology, 1, &error);
+   ASSERT_OR_PRINT (sd, error);
+   ASSERT_CMPINT (sd->type, ==, MONGOC_SERVER_UNKNOWN);
+   mongoc_server_description_destroy (sd);
+
+   /* only a greater $clusterTime is published */
+   _mongoc_topology_update_cluster_time (
+      topology,
+      tmp_bson ("{'$clusterTime': {'clusterTime': {'$timestamp': "
+                "{'t': 2, 'i': 1}}, 'x': 'new'}}"));
+   _mongoc_topology_update_cluster_time (
+      topology,
+      tmp_bson ("{'$clusterTime': {'clusterTime': {'$timestamp': "
+                "{'t': 1, 'i': 1}}, 'x': 'old'}}"));
+
+   server_stream =
+      mongoc_cluster_stream_for_server (&client->cluster, 1, true, &error);
+   ASSERT_OR_PRINT (server_stream, error);
+   ASSERT_MATCH (&server_stream->cluster_time, "{'x': 'new'}");
+   mongoc_server_stream_cleanup (server_stream);
+
+   mongoc_client_pool_push (pool, client);
+   mongoc_client_pool_destroy (pool);
+   mock_server_destroy (server);
+}
+
+
+#define CONTENTION_THREADS 64
+#define CONTENTION_OPS 2000
+
+typedef struct {
+   mongoc_topology_t *topology;
+   const bson_t *reply;
+} contention_ctx_t;
+
+
+/* what every operation on a pooled client asks of the topology */
+static void *
+_contention_worker (void *data)
+{
+   contention_ctx_t *ctx = (contention_ctx_t *) data;
+   mongoc_server_description_t *sd;
+   mongoc_host_list_t *host;
+   bson_error_t error;
+   uint32_t id;
+   int i;
+
+   for (i = 0; i < CONTENTION_OPS; i++) {
+      id = mongoc_topology_select_server_id (
+         ctx->topology, MONGOC_SS_READ, NULL, &error);
+      ASSERT_OR_PRINT (id, error);
+      sd = mongoc_topology_server_by_id (ctx->topology, id, &error);
+      ASSERT_OR_PRINT (sd, error);
+      mongoc_server_description_destroy (sd);
+      host = _mongoc_topology_host_by_id (ctx->topology, id, &error);
+      ASSERT_OR_PRINT (host, error);
+      bson_free (host);
+      _mongoc_topology_update_cluster_time (ctx->topology, ctx->reply);
+   }
+
+   return NULL;
+}
+
+
+static void
+test_topology_contention_benchmark (void *unused)
+{
+   mock_server_t *server;
+   mongoc_client_pool_t *pool;
+   mongoc_client_t *client;
+   contention_ctx_t ctx;
+   mongoc_thread_t threads[CONTENTION_THREADS];
+   bson_t *reply;
+   int64_t start;
+   int64_t usec;
+   int i;
+
+   if (!TestSuite_CheckMockServerAllowed ()) {
+      return;
+   }
+
+   server = mock_server_with_autoismaster (WIRE_VERSION_OP_MSG);
+   mock_server_run (server);
+   pool = mongoc_client_pool_new (mock_server_get_uri (server));
+   client = mongoc_client_pool_pop (pool);
+   reply = BCON_NEW ("ok",
+                     BCON_INT32 (1),
+                     "$clusterTime",
+                     "{",
+                     "clusterTime",
+                     BCON_TIMESTAMP (1, 1),
+                     "}");
+
+   ctx.topology = client->topology;
+   ctx.reply = reply;
+
+   start = bson_get_monotonic_time ();
+
+   for (i = 0; i < CONTENTION_THREADS; i++) {
+      BSON_ASSERT (!mongoc_thread_create (
+         &threads[i], _contention_worker, (void *) &ctx));
+   }
+
+   for (i = 0; i < CONTENTION_THREADS; i++) {
+      mongoc_thread_join (threads[i]);
+   }
+
+   usec = bson_get_monotonic_time () - start;
+
+   if (test_suite_debug_output ()) {
+      printf ("      %d threads: %.0f selections per second\n",
+              CONTENTION_THREADS,
+              (double) CONTENTION_THREADS * CONTENTION_OPS * 1e6 /
+                 (double) BSON_MAX (usec, 1));
+      fflush (stdout);
+   }
+
+   bson_destroy (reply);
+   mongoc_client_pool_push (pool, client);
+   mongoc_client_pool_destroy (pool);
+   mock_server_destroy (server);
+}
+
+
+#define SELECTION_POLICY_THREADS 8
+#define SELECTION_POLICY_OPS 200
+#define SELECTION_POLICY_SLOW_USEC (20 * 1000)
+
+typedef struct {
+   mongoc_client_pool_t *pool;
+   int64_t *latencies;
+} selection_policy_ctx_t;
+
+
+/* the slow server: answers ping, but only after a delay */
+static bool
+_auto_ping_slow (request_t *request, void *data)
+{
+   if (!request->is_command || strcasecmp (request->command_name, "ping")) {
+      return false;
+   }
+
+   _mongoc_usleep (SELECTION_POLICY_SLOW_USEC);
+   mock_server_replies_ok_and_destroys (request);
+
+   return true;
+}
+
+
+static void *
+_selection_policy_worker (void *data)
+{
+   selection_policy_ctx_t *ctx = (selection_policy_ctx_t *) data;
+   mongoc_client_t *client;
+   bson_error_t error;
+   int64_t start;
+   int i;
+
+   client = mongoc_client_pool_pop (ctx->pool);
+
+   for (i = 0; i < SELECTION_POLICY_OPS; i++) {
+      start = bson_get_monotonic_time ();
+      ASSERT_OR_PRINT (mongoc_client_command_simple (client,
+                                                     "admin",
+                                                     tmp_bson ("{'ping': 1}"),
+                                                     NULL,
+                                                     NULL,
+                                                     &error),
+                       error);
+      ctx->latencies[i] = bson_get_monotonic_time () - start;
+   }
+
+   mongoc_client_pool_push (ctx->pool, client);
+
+   return NULL;
+}
+
+
+static int
+_cmp_int64 (const void *a, const void *b)
+{
+   int64_t x = *(const int64_t *) a;
+   int64_t y = *(const int64_t *) b;
+
+   return x < y ? -1 : x > y;
+}
+
+
+static void
+_test_selection_policy_benchmark (const char *policy)
+{
+   mock_server_t *fast;
+   mock_server_t *slow;
+   const char *mongos = "{'ok': 1, 'ismaster': true, 'msg': 'isdbgrid',"
+                        " 'minWireVersion': 2, 'maxWireVersion': 6}";
+   char *uri_str;
+   mongoc_uri_t *uri;
+   mongoc_client_pool_t *pool;
+   mongoc_thread_t threads[SELECTION_POLICY_THREADS];
+   selection_policy_ctx_t ctx[SELECTION_POLICY_THREADS];
+   int64_t *latencies;
+   const int n = SELECTION_POLICY_THREADS * SELECTION_POLICY_OPS;
+   int i;
+
+   fast = mock_server_new ();
+   mock_server_auto_ismaster (fast, mongos);
+   mock_server_autoresponds (fast, auto_ping, NULL, NULL);
+   mock_server_run (fast);
+
+   slow = mock_server_new ();
+   mock_server_auto_ismaster (slow, mongos);
+   mock_server_autoresponds (slow, _auto_ping_slow, NULL, NULL);
+   mock_server_run (slow);
+
+   /* both mongos are within the latency window */
+   uri_str = bson_strdup_printf ("mongodb://%s,%s/?" MONGOC_URI_LOCALTHRESHOLDMS
+                                 "=1000&" MONGOC_URI_SERVERSELECTIONPOLICY
+                                 "=%s",
+                                 mock_server_get_host_and_port (fast),
+                                 mock_server_get_host_and_port (slow),
+                                 policy);
+   uri = mongoc_uri_new (uri_str);
+   mongoc_uri_set_option_as_int32 (
+      uri, MONGOC_URI_MAXPOOLSIZE, SELECTION_POLICY_THREADS);
+   pool = mongoc_client_pool_new (uri);
+   latencies = bson_malloc (n * sizeof (int64_t));
+
+   for (i = 0; i < SELECTION_POLICY_THREADS; i++) {
+      ctx[i].pool = pool;
+      ctx[i].latencies = latencies + i * SELECTION_POLICY_OPS;
+      BSON_ASSERT (!mongoc_thread_create (
+         &threads[i], _selection_policy_worker, (void *) &ctx[i]));
+   }
+
+   for (i = 0; i < SELECTION_POLICY_THREADS; i++) {
+      mongoc_thread_join (threads[i]);
+   }
+
+   qsort (latencies, (size_t) n, sizeof (int64_t), _cmp_int64);
+
+   if (test_suite_debug_output ()) {
+      printf ("      %s: p50 %" PRId64 "us, p99 %" PRId64 "us\n",
+              policy,
+              latencies[n / 2],
+              latencies[n * 99 / 100]);
+      fflush (stdout);
+   }
+
+   bson_free (latencies);
+   mongoc_client_pool_destroy (pool);
+   mongoc_uri_destroy (uri);
+   bson_free (uri_str);
+   mock_server_destroy (slow);
+   mock_server_destroy (fast);
+}
+
+
+/* pings against one fast and one slow mongos */
+static void
+test_selection_policy_benchmark (void *unused)
+{
+   if (!TestSuite_CheckMockServerAllowed ()) {
+      return;
+   }
+
+   _test_selection_policy_benchmark ("random");
+   _test_selection_policy_benchmark ("powerOfTwoChoices");
+}
+
+
 void
 test_topology_install (TestSuite *suite)
 {
@@ -1586,4 +1896,18 @@ test_topology_install (TestSuite *suite)
                                 "/Topology/compatible_null_error_pointer",
                                 test_compatible_null_error_pointer,
                                 test_framework_skip_if_slow);
+   TestSuite_AddMockServerTest (
+      suite, "/Topology/snapshot", test_topology_snapshot);
+   TestSuite_AddFull (suite,
+                      "/Topology/benchmark/contention",
+                      test_topology_contention_benchmark,
+                      NULL,
+                      NULL,
+                      test_framework_skip_if_slow);
+   TestSuite_AddFull (suite,
+                      "/Topology/benchmark/selection_policy",
+                      test_selection_policy_benchmark,
+                      NULL,
+                      NULL,
+                      test_framework_skip_if_slow);
 }
@@ -1078,6 +1078,34 @@ test_mongoc_uri_compressors (void)
 #endif
 }
 
+static void
+test_mongoc_uri_server_selection_policy (void)
+{
+   mongoc_uri_t *uri;
+
+   uri = mongoc_uri_new ("mongodb://localhost/");
+   ASSERT_CMPSTR ("random",
+                  mongoc_uri_get_option_as_utf8 (
+                     uri, MONGOC_URI_SERVERSELECTIONPOLICY, "random"));
+   mongoc_uri_destroy (uri);
+
+   uri = mongoc_uri_new (
+      "mongodb://localhost/?serverSelectionPolicy=powerOfTwoChoices");
+   ASSERT (uri);
+   ASSERT_CMPSTR ("powerOfTwoChoices",
+                  mongoc_uri_get_option_as_utf8 (
+                     uri, MONGOC_URI_SERVERSELECTIONPOLICY, "random"));
+   mongoc_uri_destroy (uri);
+
+   capture_logs (true);
+   uri = mongoc_uri_new ("mongodb://localhost/?serverSelectionPolicy=fastest");
+   ASSERT (!uri);
+   ASSERT_CAPTURED_LOG ("serverSelectionPolicy",
+                        MONGOC_LOG_LEVEL_WARNING,
+                        "Unsupported value for \"serverSelectionPolicy\": "
+                        "\"fastest\"");
+}
+
 static void
 test_mongoc_uri_unescape (void)
 {
@@ -1921,6 +1949,9 @@ test_uri_install (TestSuite *suite)
    TestSuite_Add (
       suite, "/Uri/new_for_host_port", test_mongoc_uri_new_for_host_port);
    TestSuite_Add (suite, "/Uri/compressors", test_mongoc_uri_compressors);
+   TestSuite_Add (suite,
+                  "/Uri/server_selection_policy",
+                  test_mongoc_uri_server_selection_policy);
    TestSuite_Add (suite, "/Uri/unescape", test_mongoc_uri_unescape);
    TestSuite_Add (suite, "/Uri/read_prefs", test_mongoc_uri_read_prefs);
    TestSuite_Add (suite, "/Uri/read_concern", test_mongoc_uri_read_concern);
@@ -0,0 +1,253 @@
+#include <mongoc.h>
+#include <mongoc-thread-private.h>
+#include <mongoc-util-private.h>
+
+#include "TestSuite.h"
+#include "test-conveniences.h"
+#include "test-libmongoc.h"
+#include "mock_server/mock-server.h"
+
+
+#define N_THREADS 8
+
+
+typedef struct {
+   mongoc_mutex_t mutex;
+   int n_commands;
+   int n_documents;
+} combiner_test_t;
+
+
+/* acknowledge each insert command, failing the document with _id 3 */
+static bool
+combiner_insert_responder (request_t *request, void *data)
+{
+   combiner_test_t *test = (combiner_test_t *) data;
+   bson_string_t *errors;
+   char *reply_json;
+   bson_iter_t iter;
+   size_t i;
+   int n = 0;
+
+   if (!request->is_command || strcmp (request->command_name, "insert")) {
+      return false;
+   }
+
+   errors = bson_string_new ("");
+   for (i = 1; i < request->docs.len; i++) {
+      ASSERT (bson_iter_init_find (
+         &iter, request_get_doc (request, (int) i), "_id"));
+      if (bson_iter_int32 (&iter) == 3) {
+         bson_string_append_printf (errors,
+                                    "{'index': %d, 'code': 11000,"
+                                    " 'errmsg': 'dup'}",
+                                    (int) i - 1);
+      } else {
+         n++;
+      }
+   }
+
+   mongoc_mutex_lock (&test->mutex);
+   test->n_commands++;
+   test->n_documents += (int) request->docs.len - 1;
+   mongoc_mutex_unlock (&test->mutex);
+
+   reply_json = bson_strdup_printf (
+      "{'ok': 1, 'n': %d, 'writeErrors': [%s]}", n, errors->str);
+   mock_server_replies_simple (request, reply_json);
+   request_destroy (request);
+   bson_free (reply_json);
+   bson_string_free (errors, true);
+
+   return true;
+}
+
+
+typedef struct {
+   mongoc_write_combiner_t *combiner;
+   int32_t id;
+   bson_t reply;
+   bson_error_t error;
+   bool ret;
+} insert_thread_t;
+
+
+static void *
+insert_thread (void *data)
+{
+   insert_thread_t *thread = (insert_thread_t *) data;
+   bson_t *doc;
+
+   doc = BCON_NEW ("_id", BCON_INT32 (thread->id));
+   thread->ret = mongoc_write_combiner_insert_one (
+      thread->combiner, doc, &thread->reply, &thread->error);
+   bson_destroy (doc);
+
+   return NULL;
+}
+
+
+static mock_server_t *
+combiner_server (combiner_test_t *test)
+{
+   mock_server_t *server;
+
+   server = mock_server_with_autoismaster (WIRE_VERSION_OP_MSG);
+   mock_server_autoresponds (server, combiner_insert_responder, test, NULL);
+   mock_server_run (server);
+
+   return server;
+}
+
+
+/* concurrent inserts are sent in one command, and each caller gets its
+ * own result */
+static void
+test_write_combiner_batch (void)
+{
+   combiner_test_t test = {0};
+   insert_thread_t threads[N_THREADS] = {{0}};
+   mongoc_thread_t thread_ids[N_THREADS];
+   mock_server_t *server;
+   mongoc_client_pool_t *pool;
+   mongoc_write_combiner_t *combiner;
+   int i;
+
+   mongoc_mutex_init (&test.mutex);
+   server = combiner_server (&test);
+   pool = mongoc_client_pool_new (mock_server_get_uri (server));
+
+   /* the batch is sent when it's full, long before the wait expires */
+   combiner =
+      mongoc_write_combiner_new (pool, "db", "collection", N_THREADS, 60000);
+
+   for (i = 0; i < N_THREADS; i++) {
+      threads[i].combiner = combiner;
+      threads[i].id = i;
+      mongoc_thread_create (&thread_ids[i], insert_thread, &threads[i]);
+   }
+
+   for (i = 0; i < N_THREADS; i++) {
+      mongoc_thread_join (thread_ids[i]);
+   }
+
+   ASSERT_CMPINT (test.n_commands, ==, 1);
+   ASSERT_CMPINT (test.n_documents, ==, N_THREADS);
+
+   for (i = 0; i < N_THREADS; i++) {
+      if (i == 3) {
+         ASSERT (!threads[i].ret);
+         ASSERT_ERROR_CONTAINS (
+            threads[i].error, MONGOC_ERROR_COLLECTION, 11000, "dup");
+         ASSERT_MATCH (&threads[i].reply,
+                       "{'insertedCount': 0,"
+                       " 'writeErrors': [{'index': 0, 'code': 11000}]}");
+      } else {
+         ASSERT_OR_PRINT (threads[i].ret, threads[i].error);
+         ASSERT_MATCH (&threads[i].reply,
+                       "{'insertedCount': 1,"
+                       " 'writeErrors': {'$exists': false}}");
+      }
+
+      bson_destroy (&threads[i].reply);
+   }
+
+   mongoc_write_combiner_destroy (combiner);
+   mongoc_client_pool_destroy (pool);
+   mock_server_destroy (server);
+   mongoc_mutex_destroy (&test.mutex);
+}
+
+
+/* a batch that doesn't fill is sent when the wait expires */
+static void
+test_write_combiner_wait (void)
+{
+   combiner_test_t test = {0};
+   mock_server_t *server;
+   mongoc_client_pool_t *pool;
+   mongoc_write_combiner_t *combiner;
+   bson_t reply;
+   bson_error_t error;
+
+   mongoc_mutex_init (&test.mutex);
+   server = combiner_server (&test);
+   pool = mongoc_client_pool_new (mock_server_get_uri (server));
+   combiner = mongoc_write_combiner_new (pool, "db", "collection", 0, 10);
+
+   ASSERT_OR_PRINT (mongoc_write_combiner_insert_one (
+                       combiner, tmp_bson ("{'_id': 1}"), &reply, &error),
+                    error);
+   ASSERT_MATCH (&reply, "{'insertedCount': 1}");
+   bson_destroy (&reply);
+
+   /* invalid documents fail without being sent */
+   ASSERT (!mongoc_write_combiner_insert_one (
+      combiner, tmp_bson ("{'$bad': 1}"), &reply, &error));
+   ASSERT_ERROR_CONTAINS (
+      error, MONGOC_ERROR_COMMAND, MONGOC_ERROR_COMMAND_INVALID_ARG, "$bad");
+   bson_destroy (&reply);
+
+   ASSERT_CMPINT (test.n_commands, ==, 1);
+
+   mongoc_write_combiner_destroy (combiner);
+   mongoc_client_pool_destroy (pool);
+   mock_server_destroy (server);
+   mongoc_mutex_destroy (&test.mutex);
+}
+
+
+/* with w:0 there's no reply, the insert succeeds once it's sent */
+static void
+test_write_combiner_unacknowledged (void)
+{
+   mock_server_t *server;
+   mongoc_uri_t *uri;
+   mongoc_write_concern_t *wc;
+   mongoc_client_pool_t *pool;
+   mongoc_write_combiner_t *combiner;
+   request_t *request;
+   bson_t reply;
+   bson_error_t error;
+
+   server = mock_server_with_autoismaster (WIRE_VERSION_OP_MSG);
+   mock_server_run (server);
+   uri = mongoc_uri_copy (mock_server_get_uri (server));
+   wc = mongoc_write_concern_new ();
+   mongoc_write_concern_set_w (wc, 0);
+   mongoc_uri_set_write_concern (uri, wc);
+   pool = mongoc_client_pool_new (uri);
+   combiner = mongoc_write_combiner_new (pool, "db", "collection", 0, 10);
+
+   ASSERT_OR_PRINT (mongoc_write_combiner_insert_one (
+                       combiner, tmp_bson ("{'_id': 1}"), &reply, &error),
+                    error);
+   ASSERT (bson_empty (&reply));
+   bson_destroy (&reply);
+
+   request = mock_server_receives_msg (
+      server,
+      MONGOC_MSG_MORE_TO_COME,
+      tmp_bson ("{'insert': 'collection', 'writeConcern': {'w': 0}}"),
+      tmp_bson ("{'_id': 1}"));
+   request_destroy (request);
+
+   mongoc_write_combiner_destroy (combiner);
+   mongoc_client_pool_destroy (pool);
+   mongoc_write_concern_destroy (wc);
+   mongoc_uri_destroy (uri);
+   mock_server_destroy (server);
+}
+
+
+void
+test_write_combiner_install (TestSuite *suite)
+{
+   TestSuite_AddMockServerTest (
+      suite, "/WriteCombiner/batch", test_write_combiner_batch);
+   TestSuite_AddMockServerTest (
+      suite, "/WriteCombiner/wait", test_write_combiner_wait);
+   TestSuite_AddMockServerTest (suite,
+                                "/WriteCombiner/unacknowledged",
+                                test_write_combiner_unacknowledged);
+}
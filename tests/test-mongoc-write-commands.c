@@ -10,6 +10,8 @@
 
 #include "test-libmongoc.h"
 #include "test-conveniences.h"
+#include "mock_server/future-functions.h"
+#include "mock_server/mock-server.h"
 
 
 static void
@@ -271,6 +273,143 @@ test_bypass_validation (void *context)
    mongoc_client_destroy (client);
 }
 
+
+static void
+test_unacknowledged_op_msg (void)
+{
+   mock_server_t *server;
+   mongoc_client_t *client;
+   mongoc_collection_t *collection;
+   bson_t opts = BSON_INITIALIZER;
+   mongoc_write_concern_t *wc;
+   bson_error_t error;
+   future_t *future;
+   request_t *request;
+
+   server = mock_server_with_autoismaster (WIRE_VERSION_OP_MSG);
+   mock_server_run (server);
+   client = mongoc_client_new_from_uri (mock_server_get_uri (server));
+   collection = mongoc_client_get_collection (client, "db", "collection");
+   wc = mongoc_write_concern_new ();
+   mongoc_write_concern_set_w (wc, 0);
+   mongoc_write_concern_append (wc, &opts);
+
+   /* the insert is sent with moreToCome and completes without a reply */
+   future = future_collection_insert_one (
+      collection, tmp_bson ("{'_id': 1}"), &opts, NULL, &error);
+   request = mock_server_receives_msg (
+      server,
+      MONGOC_MSG_MORE_TO_COME,
+      tmp_bson ("{'insert': 'collection', 'writeConcern': {'w': 0}}"),
+      tmp_bson ("{'_id': 1}"));
+   ASSERT_OR_PRINT (future_get_bool (future), error);
+   future_destroy (future);
+   request_destroy (request);
+
+   /* the connection is still usable for acknowledged commands */
+   future = future_client_command_simple (
+      client, "admin", tmp_bson ("{'ping': 1}"), NULL, NULL, &error);
+   request = mock_server_receives_msg (
+      server, MONGOC_MSG_NONE, tmp_bson ("{'ping': 1}"));
+   mock_server_replies_simple (request, "{'ok': 1}");
+   ASSERT_OR_PRINT (future_get_bool (future), error);
+   future_destroy (future);
+   request_destroy (request);
+
+   mongoc_write_concern_destroy (wc);
+   bson_destroy (&opts);
+   mongoc_collection_destroy (collection);
+   mongoc_client_destroy (client);
+   mock_server_destroy (server);
+}
+
+
+#define UNACKNOWLEDGED_BENCHMARK_N 10000
+
+static bool
+_count_unacknowledged_inserts (request_t *request, void *data)
+{
+   int32_t *count = (int32_t *) data;
+
+   if (!request->is_command) {
+      return false;
+   }
+
+   if (!strcmp (request->command_name, "insert")) {
+      BSON_ASSERT (request->request_rpc.msg.flags == MONGOC_MSG_MORE_TO_COME);
+      bson_atomic_int_add (count, 1);
+      request_destroy (request);
+      return true;
+   }
+
+   if (!strcmp (request->command_name, "ping")) {
+      mock_server_replies_ok_and_destroys (request);
+      return true;
+   }
+
+   return false;
+}
+
+
+/* measure how many w:0 inserts per second a single client can push through
+ * one connection when the driver never waits for a server reply */
+static void
+test_unacknowledged_throughput (void *ctx)
+{
+   mock_server_t *server;
+   mongoc_client_t *client;
+   mongoc_collection_t *collection;
+   bson_t opts = BSON_INITIALIZER;
+   mongoc_write_concern_t *wc;
+   bson_error_t error;
+   int32_t count = 0;
+   int64_t start;
+   int64_t elapsed;
+   int i;
+
+   server = mock_server_with_autoismaster (WIRE_VERSION_OP_MSG);
+   mock_server_autoresponds (
+      server, _count_unacknowledged_inserts, &count, NULL);
+   mock_server_run (server);
+   client = mongoc_client_new_from_uri (mock_server_get_uri (server));
+   collection = mongoc_client_get_collection (client, "db", "collection");
+   wc = mongoc_write_concern_new ();
+   mongoc_write_concern_set_w (wc, 0);
+   mongoc_write_concern_append (wc, &opts);
+
+   start = bson_get_monotonic_time ();
+   for (i = 0; i < UNACKNOWLEDGED_BENCHMARK_N; i++) {
+      ASSERT_OR_PRINT (
+         mongoc_collection_insert_one (
+            collection, tmp_bson ("{'x': %d}", i), &opts, NULL, &error),
+         error);
+   }
+
+   /* the server handles one connection's messages in order, so once the ping
+    * is answered every insert has been consumed */
+   ASSERT_OR_PRINT (
+      mongoc_client_command_simple (
+         client, "admin", tmp_bson ("{'ping': 1}"), NULL, NULL, &error),
+      error);
+   elapsed = bson_get_monotonic_time () - start;
+   ASSERT_CMPINT (count, ==, UNACKNOWLEDGED_BENCHMARK_N);
+
+   if (test_suite_debug_output ()) {
+      printf ("      %d unacknowledged inserts in %.3f s (%.0f/s)\n",
+              UNACKNOWLEDGED_BENCHMARK_N,
+              (double) elapsed / 1e6,
+              UNACKNOWLEDGED_BENCHMARK_N * 1e6 /
+                 (double) BSON_MAX (elapsed, 1));
+      fflush (stdout);
+   }
+
+   mongoc_write_concern_destroy (wc);
+   bson_destroy (&opts);
+   mongoc_collection_destroy (collection);
+   mongoc_client_destroy (client);
+   mock_server_destroy (server);
+}
+
 void
 test_write_command_install (TestSuite *suite)
 {
@@ -283,4 +422,13 @@ test_write_command_install (TestSuite *suite)
                       NULL,
                       NULL,
                       test_framework_skip_if_max_wire_version_less_than_4);
+   TestSuite_AddMockServerTest (suite,
+                                "/WriteCommand/unacknowledged/op_msg",
+                                test_unacknowledged_op_msg);
+   TestSuite_AddFull (suite,
+                      "/WriteCommand/unacknowledged/throughput",
+                      test_unacknowledged_throughput,
+                      NULL,
+                      NULL,
+                      test_framework_skip_if_slow);
 }